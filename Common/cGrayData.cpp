@@ -32,6 +32,12 @@ CGrayItemInfo::CGrayItemInfo( ITEMID_TYPE id )
 		return;
 	}
 
+	if ( g_TileData.IsLoaded())
+	{
+		*static_cast <CUOItemTypeRec *>(this) = *g_TileData.GetItem( id );
+		return;
+	}
+
 	VERFILE_TYPE filedata;
 	long offset;
 	CUOIndexRec Index;
@@ -62,6 +68,12 @@ CGrayTerrainInfo::CGrayTerrainInfo( TERRAIN_TYPE id )
 {
 	ASSERT( id < TERRAIN_QTY );
 
+	if ( g_TileData.IsLoaded())
+	{
+		*static_cast <CUOTerrainTypeRec *>(this) = *g_TileData.GetTerrain( id );
+		return;
+	}
+
 	VERFILE_TYPE filedata;
 	long offset;
 	CUOIndexRec Index;
@@ -88,6 +100,54 @@ CGrayTerrainInfo::CGrayTerrainInfo( TERRAIN_TYPE id )
 	}
 }
 
+void CGrayMulti::SortItems()
+{
+	// Put the items in (dy,dx) cell order and index where each cell starts.
+	// So a height check on a big keep only looks at the few items on its own spot.
+	// Keep the file order inside each cell.
+	if ( m_iItemQty <= 0 )
+		return;
+
+	int dxMax = m_pItems[0].m_dx;
+	int dyMax = m_pItems[0].m_dy;
+	m_dxMin = m_pItems[0].m_dx;
+	m_dyMin = m_pItems[0].m_dy;
+	for ( int i=1; i<m_iItemQty; i++ )
+	{
+		m_dxMin = min( m_dxMin, m_pItems[i].m_dx );
+		m_dyMin = min( m_dyMin, m_pItems[i].m_dy );
+		dxMax = max( dxMax, (int) m_pItems[i].m_dx );
+		dyMax = max( dyMax, (int) m_pItems[i].m_dy );
+	}
+	m_iCellsX = dxMax - m_dxMin + 1;
+	m_iCellsY = dyMax - m_dyMin + 1;
+
+	int iCells = m_iCellsX * m_iCellsY;
+	m_pCellIndex = new int [ iCells + 1 ];
+	memset( m_pCellIndex, 0, sizeof(int) * ( iCells + 1 ));
+	for ( int i=0; i<m_iItemQty; i++ )
+	{
+		m_pCellIndex[ GetCell( m_pItems[i].m_dx, m_pItems[i].m_dy ) + 1 ] ++;
+	}
+	for ( int i=0; i<iCells; i++ )
+	{
+		m_pCellIndex[i+1] += m_pCellIndex[i];
+	}
+	if ( m_iItemQty <= 1 )
+		return;
+
+	int * piNext = new int [ iCells ];
+	memcpy( piNext, m_pCellIndex, sizeof(int) * iCells );
+	CUOMultiItemRec * pSorted = new CUOMultiItemRec [ m_iItemQty ];
+	for ( int i=0; i<m_iItemQty; i++ )
+	{
+		pSorted[ piNext[ GetCell( m_pItems[i].m_dx, m_pItems[i].m_dy ) ] ++ ] = m_pItems[i];
+	}
+	delete [] piNext;
+	delete [] m_pItems;
+	m_pItems = pSorted;
+}
+
 int CGrayMulti::Load( MULTI_TYPE id )
 {
 	// Just load the whole thing.
@@ -115,6 +175,8 @@ int CGrayMulti::Load( MULTI_TYPE id )
 		return( 0 );
 	}
 
+	SortItems();
+
 #ifdef GRAY_SVR
 	HitCacheTime();
 #endif
@@ -58,6 +58,42 @@ void CGrayStaticsBlock::LoadStatics(UINT ulBlockIndex)
 			throw CGrayError(LOGL_CRIT, E_FAIL, "CGrayMapBlock: Read fStatics0");
 		}
 	}
+
+	SortStatics();
+}
+
+void CGrayStaticsBlock::SortStatics()
+{
+	// Put the statics in cell order and index where each cell starts.
+	// Keep the file order inside each cell. (CWorld::GetHeight cares about that order)
+	// Anything off the block (bad data) goes at the end where no cell will see it.
+	int iCount[ UO_BLOCK_SIZE*UO_BLOCK_SIZE + 1 ];
+	memset( iCount, 0, sizeof(iCount));
+	for ( int i=0; i<m_iStatics; i++ )
+	{
+		iCount[ GetStaticCell( m_pStatics[i] ) ] ++;
+	}
+
+	int iStart = 0;
+	for ( int i=0; i<=UO_BLOCK_SIZE*UO_BLOCK_SIZE; i++ )
+	{
+		m_CellIndex[i] = iStart;
+		iStart += iCount[i];
+	}
+	m_CellIndex[UO_BLOCK_SIZE*UO_BLOCK_SIZE+1] = iStart;
+	if ( m_iStatics <= 1 )
+		return;
+
+	ASSERT( m_iStatics <= 0xFFFF );
+	CUOStaticItemRec * pSorted = new CUOStaticItemRec[m_iStatics];
+	int iNext[ UO_BLOCK_SIZE*UO_BLOCK_SIZE + 1 ];
+	memcpy( iNext, m_CellIndex, sizeof(iNext));
+	for ( int i=0; i<m_iStatics; i++ )
+	{
+		pSorted[ iNext[ GetStaticCell( m_pStatics[i] ) ] ++ ] = m_pStatics[i];
+	}
+	delete [] m_pStatics;
+	m_pStatics = pSorted;
 }
 
 
@@ -120,12 +156,7 @@ void CGrayMapBlock::Load(int bx, int by)
 		pFile = &(g_Install.m_File[VERFILE_MAP]);
 	}
 
-	if (!pFile->Seek(index.GetFileOffset()))
-	{
-		memset(&m_Terrain, 0, sizeof(m_Terrain));
-		throw CGrayError(LOGL_CRIT, E_FAIL, "CGrayMapBlock: Seek Ver");
-	}
-	if (pFile->Read(&m_Terrain, sizeof(CUOMapBlock)) <= 0)
+	if (!pFile->ReadAt(index.GetFileOffset(), &m_Terrain, sizeof(CUOMapBlock)))
 	{
 		memset(&m_Terrain, 0, sizeof(m_Terrain));
 		throw CGrayError(LOGL_CRIT, E_FAIL, "CGrayMapBlock: Read");
@@ -31,7 +31,17 @@ class CGrayStaticsBlock
 {
 private:
 	int m_iStatics;
-	CUOStaticItemRec * m_pStatics;	// dyn alloc array block.
+	CUOStaticItemRec * m_pStatics;	// dyn alloc array block. sorted by cell.
+	WORD m_CellIndex[ UO_BLOCK_SIZE*UO_BLOCK_SIZE + 2 ];	// first static of each cell. [64] = off the block.
+
+private:
+	static int GetStaticCell( const CUOStaticItemRec & rec )
+	{
+		if ( rec.m_x >= UO_BLOCK_SIZE || rec.m_y >= UO_BLOCK_SIZE )
+			return( UO_BLOCK_SIZE*UO_BLOCK_SIZE );
+		return( rec.m_y * UO_BLOCK_SIZE + rec.m_x );
+	}
+	void SortStatics();
 public:
 	void LoadStatics(UINT dwBlockIndex );
 public:
@@ -39,6 +49,7 @@ public:
 	{
 		m_iStatics = 0;
 		m_pStatics = NULL;
+		memset( m_CellIndex, 0, sizeof(m_CellIndex));
 	}
 	~CGrayStaticsBlock()
 	{
@@ -60,6 +71,20 @@ public:
 		return &(m_pStatics[i]);
 	}
 
+	// The statics on the cell xo,yo are [GetStaticCellStart,GetStaticCellEnd)
+	int GetStaticCellStart( int xo, int yo ) const
+	{
+		ASSERT( xo >= 0 && xo < UO_BLOCK_SIZE );
+		ASSERT( yo >= 0 && yo < UO_BLOCK_SIZE );
+		return( m_CellIndex[ yo*UO_BLOCK_SIZE + xo ] );
+	}
+	int GetStaticCellEnd( int xo, int yo ) const
+	{
+		ASSERT( xo >= 0 && xo < UO_BLOCK_SIZE );
+		ASSERT( yo >= 0 && yo < UO_BLOCK_SIZE );
+		return( m_CellIndex[ yo*UO_BLOCK_SIZE + xo + 1 ] );
+	}
+
 	bool IsStaticPoint(int i, int xo, int yo) const
 	{
 		
@@ -76,7 +101,34 @@ public:
 
 };
 
-class CGrayMapBlock : public CMemDynamic,	// Cache this from the MUL files. 8x8 block of the world.
+// What CWorld::GetHeight() needs to know about a cell. Worked out once from the MUL data.
+struct CGrayNavLevel	// a static that blocks or can be stood on. Same order as the statics. (ties go by order)
+{
+	signed char m_z;
+	signed char m_zTop;	// m_z + item height.
+	signed char m_zRoof;	// highest z of any static since the last level. (this one too) for CAN_I_ROOF
+	WORD m_wBlock;		// CAN_I_BLOCK etc. never 0
+};
+
+enum NAVTERRAIN_TYPE
+{
+	NAVTERRAIN_OPEN = 0,
+	NAVTERRAIN_BLOCK,	// UFLAG1_BLOCK terrain.
+	NAVTERRAIN_WATER,
+	NAVTERRAIN_NULL,	// TERRAIN_NULL = impassible interdungeon.
+	NAVTERRAIN_HOLE = 0x80,	// TERRAIN_HOLE. (| one of the above)
+};
+
+struct CGrayNavCell	// one per cell.
+{
+	WORD m_iLevelStart;	// this cell's levels are [m_iLevelStart,m_iLevelEnd)
+	WORD m_iLevelEnd;
+	signed char m_zRoof;	// highest z of any static after the last level. (-128 = none)
+	signed char m_zTerrain;
+	BYTE m_Terrain;		// NAVTERRAIN_TYPE
+};
+
+class CGrayMapBlock : public CGObListRec,	// Cache this from the MUL files. 8x8 block of the world. (in a cache LRU list)
 	public CGrayStaticsBlock
 #if defined(GRAY_SVR) || defined(GRAY_MAP)
 	, public CGrayCachedMulItem
@@ -89,6 +141,11 @@ private:
 
 	CUOMapBlock m_Terrain;
 
+	CGrayNavLevel * m_pNavLevels;		// [m_iNavLevels]
+	int m_iNavLevels;
+	CGrayNavCell m_NavCells[UO_BLOCK_SIZE*UO_BLOCK_SIZE];
+	bool m_fNav;		// SetNav() was done.
+
 #ifdef GRAY_MAP
 	WORD m_wMapColorMode;
 	WORD m_MapColor[UO_BLOCK_SIZE*UO_BLOCK_SIZE];
@@ -106,6 +163,9 @@ public:
 		m_p( pt )	// The upper left corner.
 	{
 		sm_iCount++;
+		m_pNavLevels = NULL;
+		m_iNavLevels = 0;
+		m_fNav = false;
 		ASSERT( ! UO_BLOCK_OFFSET(pt.m_x));
 		ASSERT( ! UO_BLOCK_OFFSET(pt.m_y));
 		Load( pt.m_x/UO_BLOCK_SIZE, pt.m_y/UO_BLOCK_SIZE );
@@ -115,12 +175,16 @@ public:
 		m_p( bx * UO_BLOCK_SIZE, by * UO_BLOCK_SIZE )
 	{
 		sm_iCount++;
+		m_pNavLevels = NULL;
+		m_iNavLevels = 0;
+		m_fNav = false;
 		Load( bx, by );
 	}
 
 	~CGrayMapBlock()
 	{
 		sm_iCount--;
+		delete [] m_pNavLevels;
 	}
 
 	int GetOffsetX( int x ) const
@@ -145,6 +209,37 @@ public:
 		return( &m_Terrain );
 	}
 
+	bool IsNavValid() const
+	{
+		return( m_fNav );
+	}
+	void SetNav( CGrayNavLevel * pNavLevels, int iNavLevels, const CGrayNavCell * pNavCells )
+	{
+		// pNavLevels = new [iNavLevels] and we own it now.
+		delete [] m_pNavLevels;
+		m_pNavLevels = pNavLevels;
+		m_iNavLevels = iNavLevels;
+		memcpy( m_NavCells, pNavCells, sizeof(m_NavCells));
+		m_fNav = true;
+	}
+	int GetNavLevelQty() const
+	{
+		return( m_iNavLevels );
+	}
+	const CGrayNavLevel * GetNavLevel( int i ) const
+	{
+		ASSERT( m_fNav );
+		ASSERT( i >= 0 && i < m_iNavLevels );
+		return( &m_pNavLevels[i] );
+	}
+	const CGrayNavCell * GetNavCell( int xo, int yo ) const
+	{
+		ASSERT( m_fNav );
+		ASSERT( xo >= 0 && xo < UO_BLOCK_SIZE );
+		ASSERT( yo >= 0 && yo < UO_BLOCK_SIZE );
+		return( &m_NavCells[ yo*UO_BLOCK_SIZE + xo ] );
+	}
+
 #ifdef GRAY_MAP
 	static COLOR_TYPE GetMapColorItem( WORD id );
 	static WORD GetMapColorMode( bool fMap, bool fStatics, bool fColor, signed char zclip );
@@ -195,21 +290,47 @@ private:
 	MULTI_TYPE m_id;
 	CUOMultiItemRec * m_pItems;
 	int m_iItemQty;
+
+	// Items are sorted by (dy,dx) cell. m_pCellIndex = first item of each cell in the bounding rect.
+	short m_dxMin;
+	short m_dyMin;
+	int m_iCellsX;
+	int m_iCellsY;
+	int * m_pCellIndex;	// m_iCellsX*m_iCellsY+1
 private:
 	void Init()
 	{
 		m_id = MULTI_QTY;
 		m_pItems = NULL;
 		m_iItemQty = 0;
+		m_dxMin = 0;
+		m_dyMin = 0;
+		m_iCellsX = 0;
+		m_iCellsY = 0;
+		m_pCellIndex = NULL;
 	}
 	void Release()
 	{
+		if ( m_pCellIndex )
+		{
+			delete [] m_pCellIndex;
+		}
 		if ( m_pItems )
 		{
 			delete [] m_pItems;
-			Init();
 		}
+		Init();
 	}
+	int GetCell( int dx, int dy ) const
+	{
+		// -1 = outside the multi.
+		dx -= m_dxMin;
+		dy -= m_dyMin;
+		if ( (unsigned) dx >= (unsigned) m_iCellsX || (unsigned) dy >= (unsigned) m_iCellsY )
+			return( -1 );
+		return( dy*m_iCellsX + dx );
+	}
+	void SortItems();
 public:
 	int Load( MULTI_TYPE id );
 	CGrayMulti()
@@ -234,6 +355,21 @@ public:
 		ASSERT( i<m_iItemQty );
 		return( m_pItems+i);
 	}
+	// The items on the cell dx,dy (from the multi's origin) are [GetCellStart,GetCellEnd)
+	int GetCellStart( int dx, int dy ) const
+	{
+		int iCell = GetCell( dx, dy );
+		if ( iCell < 0 )
+			return( 0 );
+		return( m_pCellIndex[ iCell ] );
+	}
+	int GetCellEnd( int dx, int dy ) const
+	{
+		int iCell = GetCell( dx, dy );
+		if ( iCell < 0 )
+			return( 0 );
+		return( m_pCellIndex[ iCell + 1 ] );
+	}
 	~CGrayMulti()
 	{
 		Release();
@@ -468,4 +468,134 @@ int CGObSortArray<TYPE, KEY_TYPE>::AddSortKey( TYPE pNew, KEY_TYPE key )
 	return( index );
 }
 
+////////////////////////////////////////////////////////////
+// CGHashSet = A set of non zero UINT values. (UID indexes)
+
+class CGHashSet
+{
+	// Open addressed (linear probe) so a lookup is usually one cache line.
+	// 0 = empty slot. Never more than half full.
+private:
+	UINT * m_pData;
+	int m_iSize;	// power of 2. 0 = nothing allocated yet.
+	int m_iCount;
+
+private:
+	CGHashSet( const CGHashSet & );
+	CGHashSet & operator=( const CGHashSet & );
+
+	int GetSlot( UINT dwVal ) const
+	{
+		return(( dwVal * 0x9E3779B1 ) >> 7 ) & ( m_iSize - 1 );
+	}
+	void SetSize( int iSize )
+	{
+		UINT * pOld = m_pData;
+		int iSizeOld = m_iSize;
+		m_pData = new UINT [ iSize ];
+		memset( m_pData, 0, sizeof(UINT) * iSize );
+		m_iSize = iSize;
+		for ( int i=0; i<iSizeOld; i++ )
+		{
+			if ( ! pOld[i] )
+				continue;
+			int j = GetSlot( pOld[i] );
+			while ( m_pData[j] )
+				j = ( j + 1 ) & ( m_iSize - 1 );
+			m_pData[j] = pOld[i];
+		}
+		delete [] pOld;
+	}
+
+public:
+	CGHashSet()
+	{
+		m_pData = NULL;
+		m_iSize = 0;
+		m_iCount = 0;
+	}
+	~CGHashSet()
+	{
+		delete [] m_pData;
+	}
+	int GetCount() const
+	{
+		return( m_iCount );
+	}
+	void Empty()
+	{
+		if ( m_iCount )
+		{
+			memset( m_pData, 0, sizeof(UINT) * m_iSize );
+			m_iCount = 0;
+		}
+	}
+	bool Find( UINT dwVal ) const
+	{
+		if ( ! m_iCount )
+			return( false );
+		for ( int i = GetSlot( dwVal ); m_pData[i]; i = ( i + 1 ) & ( m_iSize - 1 ))
+		{
+			if ( m_pData[i] == dwVal )
+				return( true );
+		}
+		return( false );
+	}
+	bool Add( UINT dwVal )
+	{
+		// RETURN: false = already have it.
+		if (( m_iCount + 1 ) * 2 > m_iSize )
+		{
+			SetSize( m_iSize ? ( m_iSize * 2 ) : 64 );
+		}
+		int i = GetSlot( dwVal );
+		for ( ; m_pData[i]; i = ( i + 1 ) & ( m_iSize - 1 ))
+		{
+			if ( m_pData[i] == dwVal )
+				return( false );
+		}
+		m_pData[i] = dwVal;
+		m_iCount++;
+		return( true );
+	}
+	bool Remove( UINT dwVal )
+	{
+		if ( ! m_iCount )
+			return( false );
+		int i = GetSlot( dwVal );
+		for ( ; m_pData[i] != dwVal; i = ( i + 1 ) & ( m_iSize - 1 ))
+		{
+			if ( ! m_pData[i] )
+				return( false );
+		}
+		// Pull back anything later in the run that could live here. (no tombstones)
+		int j = i;
+		while (true)
+		{
+			j = ( j + 1 ) & ( m_iSize - 1 );
+			if ( ! m_pData[j] )
+				break;
+			int k = GetSlot( m_pData[j] );
+			if ( ( j > i ) ? ( k <= i || k > j ) : ( k <= i && k > j ))
+			{
+				m_pData[i] = m_pData[j];
+				i = j;
+			}
+		}
+		m_pData[i] = 0;
+		m_iCount--;
+		return( true );
+	}
+
+	// Walk the slots. GetAt() = 0 for an empty slot.
+	int GetSize() const
+	{
+		return( m_iSize );
+	}
+	UINT GetAt( int i ) const
+	{
+		return( m_pData[i] );
+	}
+};
+
 #endif	// _INC_CARRAY_H
@@ -261,105 +261,77 @@ const WORD CCompressTree::xCompress_Base[256+1] =	// static
 
 bool CCompressTree::AddBranch( int Value, WORD wCode, int iBits )
 {
-	// adds a hex value related to it's binary compression code to the decompression tree. 
-    CCompressTree *pCur=this; 
-
-    if ( ! iBits ) return false;
-	
-	WORD wMask = 1 << (iBits-1);
-
-    // loop through each bit in the bitfield
-	for ( ;wMask; wMask >>= 1 )
-    {
-		// if a compression value read in conflicts with an existing
-		// compression value, the table is invalid.  Exit program.
-		if ( pCur->m_Value >= 0 )
+	// adds a hex value related to it's binary compression code to the decode table.
+	// The code fills every slot that starts with it. (the trailing bits are don't care)
+
+	if ( iBits <= 0 || iBits > COMPRESS_TREE_BITS )
+		return false;
+
+	int iSpan = 1 << ( COMPRESS_TREE_BITS - iBits );
+	int iStart = wCode << ( COMPRESS_TREE_BITS - iBits );
+	WORD wEntry = ( Value << 4 ) | iBits;
+
+	for ( int i=0; i<iSpan; i++ )
+	{
+		WORD wPrev = m_Table[ iStart + i ];
+		if ( wPrev && wPrev != wEntry )
 		{
 			// if you get here, this means that a new compression value is mutually exclusive
-			// with another value.  I.E. both 1101 and 110100 cannot exist in a tree because
+			// with another value.  I.E. both 1101 and 110100 cannot exist in a table because
 			// any decompression routine will stop as soon as it reads 1101
-			ASSERT(0); 
-			return false;
-		}
-        if ( wCode & wMask )
-		{	// if the bit is a 1
-			// make a new branch if we need to
-			if ( pCur->m_pOne == NULL )
-			{
-				pCur->m_pOne = new CCompressTree;
-			}
-			pCur = pCur->m_pOne;	// traverse to the (possibly new) branch
-		}
-		else
-		{	// if the bit is a 0
-			// make a new branch if we need to
-			if ( pCur->m_pZero == NULL )
-			{
-				pCur->m_pZero = new CCompressTree;
-			}
-			pCur = pCur->m_pZero;	// traverse to the (possibly new) branch
-		}
-    }
-	// if the end of this bitvalue is within an existing bitvalue's path
-	// the table is in error.  I.E. 111 is within 11101's path
-    if ( pCur->m_pOne != NULL || pCur->m_pZero != NULL )
-    {
-		ASSERT(0);
-		return( false );
-    }
-	// an entry already exists with this binary value
-    else if (pCur->m_Value>=0)
-    {
-		if (((BYTE)pCur->m_Value)!=Value)
-		{
-			// if they are not the same, the table is in error
 			ASSERT(0);
 			return( false );
 		}
-    }
-	else
-	{
-		// set the read in hex value at this compression location
-		pCur->m_Value=Value;
+		m_Table[ iStart + i ] = wEntry;
 	}
 	return( true );
 }
 
 int CCompressTree::Decode( BYTE * pOutput, const BYTE * pInput, int inpsize ) const
 {
+	// One table lookup per output byte.
 	// RETURN: output length.
 
 	ASSERT( IsLoaded() );
 
 	int dlen=0;
-	const CCompressTree *pCur = this;
+	unsigned long long qBits = 0;	// unused input bits are the low iBits of this.
+	int iBits = 0;
+	const BYTE * pInp = pInput;
+	const BYTE * pInpEnd = pInput + inpsize;
 
-	for ( int sbyte=0; sbyte<inpsize; sbyte++ )
+	for (;;)
 	{
-		BYTE ch = pInput[sbyte];
-		BYTE Mask = 0x80;
-		for ( int i=0;i<8;i++)
+		while ( iBits <= 56 && pInp < pInpEnd )
 		{
-			if ( ch & Mask )
-				pCur=pCur->m_pOne;
-			else
-				pCur=pCur->m_pZero;
-			if ( pCur == NULL ) 
-				return( -1 );
-
-			if (pCur->m_Value>=0)
-			{
-				if ( pCur->m_Value >= 256 )
-				{
-					// End of a logical packet. 
-					pCur=this;
-					break;	// rest of byte should be padded out. so skip it.
-				}
-				pOutput[dlen++] = pCur->m_Value;
-				pCur = this;
-			}
-			Mask >>= 1;
+			qBits = ( qBits << 8 ) | *pInp++;
+			iBits += 8;
+		}
+
+		int iIndex;
+		if ( iBits >= COMPRESS_TREE_BITS )
+			iIndex = (int)( qBits >> ( iBits - COMPRESS_TREE_BITS )) & (( 1 << COMPRESS_TREE_BITS ) - 1 );
+		else if ( iBits )
+			iIndex = (int)( qBits << ( COMPRESS_TREE_BITS - iBits )) & (( 1 << COMPRESS_TREE_BITS ) - 1 );
+		else
+			break;
+
+		WORD wEntry = m_Table[iIndex];
+		int iCodeBits = wEntry & 0xF;
+		if ( ! iCodeBits )
+			return( -1 );
+		if ( iCodeBits > iBits )
+			break;	// a partial code at the end. drop it.
+		iBits -= iCodeBits;
+
+		int iValue = wEntry >> 4;
+		if ( iValue >= 256 )
+		{
+			// End of a logical packet.
+			iBits &= ~7;	// rest of byte should be padded out. so skip it.
+			continue;
 		}
+		pOutput[dlen++] = iValue;
 	}
 
 	return( dlen );
@@ -377,38 +349,141 @@ bool CCompressTree::Load()
 			if ( ! AddBranch( i, wCode, iBits ))
 				return( false );
 		}
+		m_fLoaded = true;
 	}
 	return( true );
 }
 
 int CCompressTree::Encode( BYTE * pOutput, const BYTE * pInput, int inplen ) // static
 {
-	int iLen=0;
-	int bitidx=0;	// Offset in output byte (xOutVal)
-	BYTE xOutVal=0;	// Don't bother to init this. It will just roll off all junk anyhow.
+	// A stand alone compressed block. (it has its own end code)
+	// NOTE: pOutput must have room for inplen*11/8 + 4 bytes.
+	CCompressStream Stream( inplen );
+	int len = Stream.Encode( pOutput, pInput, inplen );
+	return( len + Stream.Finish( pOutput + len ));
+}
 
-	for ( int i=0; i <= inplen; i++ )
+int CCompressTree::EncodeBits( BYTE * pOutput, const BYTE * pInput, int inplen ) // static
+{
+	// The codes with no end code. For CCompressStream::AppendBits()
+	// The last byte is padded with 0.
+	// RETURN: length in bits.
+	CCompressStream Stream( inplen );
+	int len = Stream.Encode( pOutput, pInput, inplen );
+	if ( Stream.GetPendingBits())
 	{
-		WORD value = CCompressTree::xCompress_Base[ ( i == inplen ) ? 256 : pInput[i] ];
-		int nBits = value & 0xF;
-		value >>= 4;
-		while ( nBits-- )
+		pOutput[len] = Stream.GetPendingByte();
+	}
+	return( len * 8 + Stream.GetPendingBits());
+}
+
+////////////////////////////////////////////////////////////////////
+// -CCompressStream
+
+int CCompressStream::Open( BYTE * pOutput, int iLen )
+{
+	// iLen more input bytes go in this block. End it first if that would make it too big.
+	int len = 0;
+	if ( m_iLenRaw && m_iLenRaw + iLen > m_iLenMax )
+	{
+		len = Finish( pOutput );
+	}
+	m_iLenRaw += iLen;
+	return( len );
+}
+
+int CCompressStream::Encode( BYTE * pOutput, const BYTE * pInput, int iLen )
+{
+	// xCompress_Base is the per byte table. code = value >> 4, bits = value & 0xF (max 11)
+	// Collect the codes in a 64 bit accumulator and write 32 bits at a time.
+
+	BYTE * pOut = pOutput + Open( pOutput, iLen );
+	unsigned long long qBits = m_qBits;	// (high junk just rolls off)
+	int iBits = m_iBits;
+
+	for ( int i=0; i<iLen; i++ )
+	{
+		WORD value = CCompressTree::xCompress_Base[ pInput[i] ];
+		qBits = ( qBits << ( value & 0xF )) | ( value >> 4 );
+		iBits += value & 0xF;
+		if ( iBits >= 32 )
 		{
-			xOutVal <<= 1;
-			xOutVal |= (value >> nBits) & 0x1;
-			if ( ++bitidx == 8)
-			{
-				bitidx = 0;
-				pOutput[iLen++] = xOutVal;
-			}
+			iBits -= 32;
+			UINT dwOut = (UINT)( qBits >> iBits );
+			pOut[0] = (BYTE)( dwOut >> 24 );
+			pOut[1] = (BYTE)( dwOut >> 16 );
+			pOut[2] = (BYTE)( dwOut >> 8 );
+			pOut[3] = (BYTE)( dwOut );
+			pOut += 4;
 		}
 	}
-	if (bitidx)	// flush odd bits.
+	while ( iBits >= 8 )
 	{
-		pOutput[iLen++] = xOutVal << (8-bitidx);
+		iBits -= 8;
+		*pOut++ = (BYTE)( qBits >> iBits );
 	}
 
-	return( iLen );
+	m_qBits = qBits;
+	m_iBits = iBits;
+	return( (int)( pOut - pOutput ));
+}
+
+int CCompressStream::AppendBits( BYTE * pOutput, const BYTE * pBits, int iBits, int iLenRaw )
+{
+	// Codes that are already made. Just shift them to where we are.
+	BYTE * pOut = pOutput + Open( pOutput, iLenRaw );
+	unsigned long long qBits = m_qBits;
+	int iBytes = iBits / 8;
+	int i=0;
+	for ( ; i+4<=iBytes; i+=4 )
+	{
+		qBits = ( qBits << 32 ) | ((UINT) pBits[i] << 24 ) | ((UINT) pBits[i+1] << 16 ) | ((UINT) pBits[i+2] << 8 ) | pBits[i+3];
+		UINT dwOut = (UINT)( qBits >> m_iBits );
+		pOut[0] = (BYTE)( dwOut >> 24 );
+		pOut[1] = (BYTE)( dwOut >> 16 );
+		pOut[2] = (BYTE)( dwOut >> 8 );
+		pOut[3] = (BYTE)( dwOut );
+		pOut += 4;
+	}
+	for ( ; i<iBytes; i++ )
+	{
+		qBits = ( qBits << 8 ) | pBits[i];
+		*pOut++ = (BYTE)( qBits >> m_iBits );
+	}
+	m_qBits = qBits;
+	int iRest = iBits & 7;
+	if ( iRest )
+	{
+		m_qBits = ( m_qBits << iRest ) | ( pBits[iBytes] >> ( 8 - iRest ));
+		m_iBits += iRest;
+		if ( m_iBits >= 8 )
+		{
+			m_iBits -= 8;
+			*pOut++ = (BYTE)( m_qBits >> m_iBits );
+		}
+	}
+	return( (int)( pOut - pOutput ));
+}
+
+int CCompressStream::Finish( BYTE * pOutput )
+{
+	// End code. Then pad to a whole byte. (the client skips the rest of the byte)
+	WORD value = CCompressTree::xCompress_Base[ 256 ];
+	m_qBits = ( m_qBits << ( value & 0xF )) | ( value >> 4 );
+	m_iBits += value & 0xF;
+
+	BYTE * pOut = pOutput;
+	while ( m_iBits >= 8 )
+	{
+		m_iBits -= 8;
+		*pOut++ = (BYTE)( m_qBits >> m_iBits );
+	}
+	if ( m_iBits )	// flush odd bits.
+	{
+		*pOut++ = (BYTE)( m_qBits << ( 8 - m_iBits ));
+	}
+	Empty();
+	return( (int)( pOut - pOutput ));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -157,9 +157,29 @@ int CVarDefArray::FindValNum( int iVal ) const
 	return( -1 );
 }
 
+/////////////////////////////////////////////////////////////////////////
+// -CVarDef
+
+int CVarDef::sm_iAdds = 0;
+int CVarDef::sm_iDeletes = 0;
+
 /////////////////////////////////////////////////////////////////////////
 // -CExpression
 
+CExpression::CExpression()
+{
+	m_iRecurse = 0;
+	m_fCompile = true;
+	m_dwCacheHits = 0;
+	m_dwCacheMisses = 0;
+	m_dwCompiles = 0;
+}
+
+CExpression::~CExpression()
+{
+	ClearCache();
+}
+
 bool CExpression::SetVarDef( const TCHAR * pszName, const TCHAR * pszVal )
 {
 	int i = m_VarDefs.FindKey( pszName );
@@ -214,12 +234,34 @@ bool CExpression::GetVarDef( const TCHAR * & pArgs, long * plVal )
 	if ( pVarDef == NULL )
 		return( false );
 
-	const TCHAR * pszVal = pVarDef->GetVal();
-	*plVal = GetVal( pszVal );	// assume all defs are decimal defaults
+	*plVal = GetDefVal( pVarDef );
 	return true;
 }
 
-int CExpression::GetSingle( const TCHAR * & pArgs, bool fHexDef )
+int CExpression::GetDefVal( CVarDef * pVarDef )
+{
+	// assume all defs are decimal defaults
+	// Compile the value the 2nd time it gets used. (VAR values may only get used once)
+	ASSERT( pVarDef );
+	if ( ! m_fCompile )
+	{
+		const TCHAR * pszVal = pVarDef->GetVal();
+		return( ParseVal( pszVal, false ));
+	}
+	if ( pVarDef->m_pValProg == NULL )
+	{
+		if ( ! pVarDef->m_iValUses++ )
+		{
+			const TCHAR * pszVal = pVarDef->GetVal();
+			return( ParseVal( pszVal, false ));
+		}
+		pVarDef->m_pValProg = new CExprProg;
+		Compile( *pVarDef->m_pValProg, pVarDef->GetVal(), EXPRMODE_VAL );
+	}
+	return( GetProgVal( *pVarDef->m_pValProg ));
+}
+
+int CExpression::ParseSingle( const TCHAR * & pArgs, bool fHexDef )
 {
 	// Parse just a single expression without any operators or ranges.
 
@@ -231,7 +273,7 @@ int CExpression::GetSingle( const TCHAR * & pArgs, bool fHexDef )
 		if ( ! strnicmp( pArgs, "RAND(", 5 ))
 		{
 			pArgs += 5;
-			return( GetRandVal( GetVal( pArgs, false )));
+			return( GetRandVal( ParseVal( pArgs, false )));
 		}
 		break;
 	case 's':
@@ -291,13 +333,13 @@ int CExpression::GetSingle( const TCHAR * & pArgs, bool fHexDef )
 	case '[':
 	case '(': // Parse out a sub expression.
 		pArgs ++;
-		return( GetVal( pArgs, false ));
+		return( ParseVal( pArgs, false ));
 	case '~':	// Bitwise not.
 		pArgs++;
-		return( ~GetSingle( pArgs, false ));
+		return( ~ParseSingle( pArgs, false ));
 	case '!':	// boolean not.
 		pArgs++;
-		return( !GetSingle( pArgs, false )); 
+		return( !ParseSingle( pArgs, false )); 
 	case '\0':
 		return( 0 );
 	}
@@ -376,7 +418,7 @@ try_dec:
 	return( iVal );
 }
 
-int CExpression::GetVal( const TCHAR * & pExpr, bool fHexDef )
+int CExpression::ParseVal( const TCHAR * & pExpr, bool fHexDef )
 {
 	// Get a value (default decimal) that could also be an range expression.
 	// This does not parse beyond a comma !
@@ -399,8 +441,7 @@ int CExpression::GetVal( const TCHAR * & pExpr, bool fHexDef )
 	//	{ animal_colors 1 no_colors 1 } 	// weighted range
 	//	{ red_colors 1 34 39 1 }		// same (red_colors expands to a range)
 
-	static int iRecurse = 0;	// Make sure we don't recurse too much.
-	if ( iRecurse > 32 ) 
+	if ( m_iRecurse > 32 ) 
 	{
 		DEBUG_ERR(( "Exp_GetVal Too much recursion!\n" ));
 		return( 0 );
@@ -408,11 +449,11 @@ int CExpression::GetVal( const TCHAR * & pExpr, bool fHexDef )
 	if ( pExpr == NULL ) 
 		return( 0 );
 
-	iRecurse ++;
+	m_iRecurse ++;
 
 	GETNONWHITESPACE( pExpr );
 
-	long lVals[64];		// Maximum elements in a list
+	long lVals[EXPR_LIST_MAX];
 	int iQty = 0;
 	while (true)
 	{
@@ -424,7 +465,7 @@ getmorevals:
 		if ( pExpr[0] == ',' )
 			break;	// seperate feild.
 
-		lVals[iQty] = GetSingle( pExpr, fHexDef );
+		lVals[iQty] = ParseSingle( pExpr, fHexDef );
 		if ( ++iQty >= COUNTOF(lVals)-1 ) 
 			break;
 		if ( pExpr[0] == '-' && iQty == 1 )	// range seperator. (if directly after, I know this is sort of strange)
@@ -451,26 +492,26 @@ getmorevals:
 				continue;
 			case '+': 
 				pExpr++;
-				lVals[iQty-1] += GetSingle( pExpr, fHexDef ); 
+				lVals[iQty-1] += ParseSingle( pExpr, fHexDef ); 
 				break;
 			case '-': 
 				pExpr++;
-				lVals[iQty-1] -= GetSingle( pExpr, fHexDef ); 
+				lVals[iQty-1] -= ParseSingle( pExpr, fHexDef ); 
 				break;
 			case '*': 
 				pExpr++;
-				lVals[iQty-1] *= GetSingle( pExpr, fHexDef ); 
+				lVals[iQty-1] *= ParseSingle( pExpr, fHexDef ); 
 				break;
 			case '|': 
 				pExpr++;
 				if ( pExpr[0] == '|' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] = ( GetSingle( pExpr, fHexDef ) || lVals[iQty-1] );
+					lVals[iQty-1] = ( ParseSingle( pExpr, fHexDef ) || lVals[iQty-1] );
 				}
 				else	// bitwise
 				{
-					lVals[iQty-1] |= GetSingle( pExpr, fHexDef );
+					lVals[iQty-1] |= ParseSingle( pExpr, fHexDef );
 				}
 				break;
 			case '&': 
@@ -478,17 +519,17 @@ getmorevals:
 				if ( pExpr[0] == '&' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] = ( GetSingle( pExpr, fHexDef ) && lVals[iQty-1] );	// tricky stuff here. logical ops must come first or possibly not get processed.
+					lVals[iQty-1] = ( ParseSingle( pExpr, fHexDef ) && lVals[iQty-1] );	// tricky stuff here. logical ops must come first or possibly not get processed.
 				}
 				else	// bitwise
 				{
-					lVals[iQty-1] &= GetSingle( pExpr, fHexDef ); 
+					lVals[iQty-1] &= ParseSingle( pExpr, fHexDef ); 
 				}
 				break;
 			case '/': 
 				pExpr++;
 				{
-					long iVal = GetSingle( pExpr, fHexDef );
+					long iVal = ParseSingle( pExpr, fHexDef );
 					if ( ! iVal )
 					{
 						DEBUG_ERR(( "Exp_GetVal Divide by 0\n" ));
@@ -502,16 +543,16 @@ getmorevals:
 				if ( pExpr[0] == '=' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] = ( lVals[iQty-1] >= GetSingle( pExpr, fHexDef ));
+					lVals[iQty-1] = ( lVals[iQty-1] >= ParseSingle( pExpr, fHexDef ));
 				}
 				else if ( pExpr[0] == '>' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] >>= GetSingle( pExpr, fHexDef );
+					lVals[iQty-1] >>= ParseSingle( pExpr, fHexDef );
 				}
 				else
 				{
-					lVals[iQty-1] = ( lVals[iQty-1] > GetSingle( pExpr, fHexDef ));
+					lVals[iQty-1] = ( lVals[iQty-1] > ParseSingle( pExpr, fHexDef ));
 				}
 				break;
 			case '<': // boolean
@@ -519,16 +560,16 @@ getmorevals:
 				if ( pExpr[0] == '=' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] = ( lVals[iQty-1] <= GetSingle( pExpr, fHexDef ));
+					lVals[iQty-1] = ( lVals[iQty-1] <= ParseSingle( pExpr, fHexDef ));
 				}
 				else if ( pExpr[0] == '<' )	// boolean ?
 				{
 					pExpr++;
-					lVals[iQty-1] <<= GetSingle( pExpr, fHexDef );
+					lVals[iQty-1] <<= ParseSingle( pExpr, fHexDef );
 				}
 				else
 				{
-					lVals[iQty-1] = ( lVals[iQty-1] < GetSingle( pExpr, fHexDef )); 
+					lVals[iQty-1] = ( lVals[iQty-1] < ParseSingle( pExpr, fHexDef )); 
 				}
 				break;
 			case '!':
@@ -536,12 +577,12 @@ getmorevals:
 				if ( pExpr[0] != '=' ) 
 					goto nomorevals; // boolean ! is handled as a single expresion.
 				pExpr ++;
-				lVals[iQty-1] = ( lVals[iQty-1] != GetSingle( pExpr, fHexDef )); 
+				lVals[iQty-1] = ( lVals[iQty-1] != ParseSingle( pExpr, fHexDef )); 
 				break;
 			case '=': // boolean
 				while ( pExpr[0] == '=' ) 
 					pExpr ++;
-				lVals[iQty-1] = ( lVals[iQty-1] == GetSingle( pExpr, fHexDef )); 
+				lVals[iQty-1] = ( lVals[iQty-1] == ParseSingle( pExpr, fHexDef )); 
 				break;
 			default: 
 				if ( fWhitespace )
@@ -552,7 +593,14 @@ getmorevals:
 		}
 	}
 nomorevals:
-	iRecurse --;
+	m_iRecurse --;
+
+	return( GetListVal( lVals, iQty ));
+}
+
+int CExpression::GetListVal( const long * lVals, int iQty )
+{
+	// Pick one of the values or ranges GetVal() found.
 
 	if (iQty == 0) 
 	{
@@ -634,3 +682,539 @@ bailout:
 	return( lVals[i-2] + GetRandVal( lVals[i-1] - lVals[i-2] + 1 ));
 }
 
+int CExpression::GetSingle( const TCHAR * & pArgs, bool fHexDef )
+{
+	// Parse just a single expression without any operators or ranges.
+	// Text we have seen before runs compiled.
+
+	CExprProg * pProg = FindProg( pArgs, EXPRMODE_SINGLE | ( fHexDef ? EXPRMODE_HEX : 0 ));
+	if ( pProg != NULL && ! pProg->m_fText )
+	{
+		int iVal = GetProgVal( *pProg );
+		pArgs += pProg->GetLen();
+		return( iVal );
+	}
+	return( ParseSingle( pArgs, fHexDef ));
+}
+
+int CExpression::GetVal( const TCHAR * & pExpr, bool fHexDef )
+{
+	// Get a value (default decimal) that could also be an range expression. See ParseVal().
+	// Text we have seen before runs compiled.
+
+	CExprProg * pProg = FindProg( pExpr, fHexDef ? EXPRMODE_HEX : EXPRMODE_VAL );
+	if ( pProg != NULL && ! pProg->m_fText )
+	{
+		int iVal = GetProgVal( *pProg );
+		pExpr += pProg->GetLen();
+		return( iVal );
+	}
+	return( ParseVal( pExpr, fHexDef ));
+}
+
+long CExpression::GetBinaryOp( int op, long lVal1, long lVal2 )
+{
+	// The math ParseVal() does between 2 values.
+	switch ( op )
+	{
+	case EXPROP_ADD:	return( lVal1 + lVal2 );
+	case EXPROP_SUB:	return( lVal1 - lVal2 );
+	case EXPROP_MUL:	return( lVal1 * lVal2 );
+	case EXPROP_DIV:
+		if ( ! lVal2 )
+		{
+			DEBUG_ERR(( "Exp_GetVal Divide by 0\n" ));
+			return( lVal1 );
+		}
+		return( lVal1 / lVal2 );
+	case EXPROP_OR:		return( lVal1 | lVal2 );
+	case EXPROP_LOR:	return( lVal2 || lVal1 );
+	case EXPROP_AND:	return( lVal1 & lVal2 );
+	case EXPROP_LAND:	return( lVal2 && lVal1 );
+	case EXPROP_GT:		return( lVal1 > lVal2 );
+	case EXPROP_GE:		return( lVal1 >= lVal2 );
+	case EXPROP_SHR:	return( lVal1 >> lVal2 );
+	case EXPROP_LT:		return( lVal1 < lVal2 );
+	case EXPROP_LE:		return( lVal1 <= lVal2 );
+	case EXPROP_SHL:	return( lVal1 << lVal2 );
+	case EXPROP_NE:		return( lVal1 != lVal2 );
+	case EXPROP_EQ:		return( lVal1 == lVal2 );
+	}
+	ASSERT(0);
+	return( lVal1 );
+}
+
+/////////////////////////////////////////////////////////////////////////
+// -CExprProg
+
+void CExprProg::AddOp( EXPROP_TYPE op, long lVal )
+{
+	// Add an op. Work it out now if it only needs constants.
+	int iQty = (int) m_Ops.size();
+	switch ( op )
+	{
+	case EXPROP_CONST:
+		if ( ++m_iStack > m_iStackMax )
+			m_iStackMax = m_iStack;
+		break;
+	case EXPROP_RAND:
+		break;
+	case EXPROP_BNOT:
+	case EXPROP_LNOT:
+		if ( iQty && m_Ops[iQty-1].m_Op == EXPROP_CONST )
+		{
+			int iVal = m_Ops[iQty-1].m_lVal;
+			m_Ops[iQty-1].m_lVal = ( op == EXPROP_BNOT ) ? ~iVal : !iVal;
+			return;
+		}
+		break;
+	default:	// 2 values to 1.
+		ASSERT( op >= EXPROP_ADD && m_iStack >= 2 );
+		m_iStack --;
+		if ( iQty >= 2 && m_Ops[iQty-1].m_Op == EXPROP_CONST && m_Ops[iQty-2].m_Op == EXPROP_CONST )
+		{
+			m_Ops[iQty-2].m_lVal = CExpression::GetBinaryOp( op, m_Ops[iQty-2].m_lVal, m_Ops[iQty-1].m_lVal );
+			m_Ops.pop_back();
+			return;
+		}
+		break;
+	}
+	CExprOp Op;
+	Op.m_Op = op;
+	Op.m_lVal = lVal;
+	m_Ops.push_back( Op );
+}
+
+void CExprProg::AddDef( CVarDef * pVarDef )
+{
+	ASSERT( pVarDef );
+	CExprOp Op;
+	Op.m_Op = EXPROP_DEF;
+	Op.m_pVar = pVarDef;
+	m_Ops.push_back( Op );
+	m_fDefs = true;
+	if ( ++m_iStack > m_iStackMax )
+		m_iStackMax = m_iStack;
+}
+
+void CExprProg::AddList( int iQty )
+{
+	// GetVal() found iQty values.
+	if ( iQty <= 0 )
+	{
+		AddOp( EXPROP_CONST, 0 );
+		return;
+	}
+	if ( iQty == 1 )
+	{
+		// Just make it an int. (it already is unless the last op was math)
+		CExprOp & Op = m_Ops.back();
+		if ( Op.m_Op == EXPROP_CONST )
+		{
+			Op.m_lVal = (int) Op.m_lVal;
+			return;
+		}
+		if ( Op.m_Op < EXPROP_ADD )
+			return;
+	}
+	CExprOp Op;
+	Op.m_Op = EXPROP_LIST;
+	Op.m_lVal = iQty;
+	m_Ops.push_back( Op );
+	m_iStack -= iQty - 1;
+}
+
+bool CExprProg::IsStale() const
+{
+	// A CVarDef we point at may be gone. Or a name we did not find may be here now.
+	if ( m_fDefs && m_iDefDeletes != CVarDef::sm_iDeletes )
+		return( true );
+	if ( m_fMissing && m_iDefAdds != CVarDef::sm_iAdds )
+		return( true );
+	return( false );
+}
+
+/////////////////////////////////////////////////////////////////////////
+// -CExpression compiled
+
+void CExpression::CompileSingle( CExprProg & prog, const TCHAR * & pArgs, bool fHexDef, int iDepth )
+{
+	// ParseSingle() but put the ops in prog. Keep the two doing the same thing !
+	// Only RAND(), sub expressions, ~, ! and DEF names need ops. The rest is a number now.
+	// iDepth = ParseVal() calls this would be inside.
+
+	GETNONWHITESPACE( pArgs );
+	switch ( pArgs[0] )
+	{
+	case 'r':
+	case 'R':
+		if ( ! strnicmp( pArgs, "RAND(", 5 ))
+		{
+			pArgs += 5;
+			CompileVal( prog, pArgs, false, iDepth );
+			prog.AddOp( EXPROP_RAND );
+			return;
+		}
+		break;
+	case 's':
+	case 'S':
+		if ( ! strnicmp( pArgs, "STRCMP(", 7 ) || ! strnicmp( pArgs, "STRLEN(", 7 ))
+		{
+			prog.AddOp( EXPROP_CONST, ParseSingle( pArgs, fHexDef ));
+			return;
+		}
+		break;
+	case '{':
+	case '[':
+	case '(': // Parse out a sub expression.
+		pArgs ++;
+		CompileVal( prog, pArgs, false, iDepth );
+		return;
+	case '~':	// Bitwise not.
+		pArgs++;
+		CompileSingle( prog, pArgs, false, iDepth );
+		prog.AddOp( EXPROP_BNOT );
+		return;
+	case '!':	// boolean not.
+		pArgs++;
+		CompileSingle( prog, pArgs, false, iDepth );
+		prog.AddOp( EXPROP_LNOT );
+		return;
+	case '\0':
+		prog.AddOp( EXPROP_CONST, 0 );
+		return;
+	}
+
+	if ( pArgs[0] != '-' && pArgs[0] != '0' && pArgs[0] != '.' && ! isdigit( pArgs[0] ))
+	{
+		// is it an expression ?
+		CVarDef * pVarDef = GetVarDef( pArgs );
+		if ( pVarDef != NULL )
+		{
+			prog.AddDef( pVarDef );
+			return;
+		}
+		prog.m_fMissing = true;	// hex i guess.
+	}
+
+	prog.AddOp( EXPROP_CONST, ParseSingle( pArgs, fHexDef ));
+}
+
+void CExpression::CompileVal( CExprProg & prog, const TCHAR * & pExpr, bool fHexDef, int iDepth )
+{
+	// ParseVal() but put the ops in prog. Keep the two doing the same thing !
+
+	if ( iDepth > 32 )
+	{
+		prog.m_fText = true;	// Let ParseVal() complain about it.
+		prog.AddOp( EXPROP_CONST, 0 );
+		return;
+	}
+
+	GETNONWHITESPACE( pExpr );
+
+	int iQty = 0;
+	while (true)
+	{
+getmorevals:
+		if ( pExpr[0] == '\0' )
+			break;
+		if ( pExpr[0] == ';' )
+			break;	// seperate feild.
+		if ( pExpr[0] == ',' )
+			break;	// seperate feild.
+
+		CompileSingle( prog, pExpr, fHexDef, iDepth+1 );
+		if ( ++iQty >= EXPR_LIST_MAX-1 )
+			break;
+		if ( pExpr[0] == '-' && iQty == 1 )	// range seperator.
+		{
+			pExpr++;
+			continue;
+		}
+
+		bool fWhitespace = false;
+		while (true)
+		{
+			// Look for math type operator.
+			EXPROP_TYPE op;
+			switch ( pExpr[0] )
+			{
+			case ')':  // expression end markers.
+			case '}':
+			case ']':
+				pExpr++;	// consume this.
+				goto nomorevals;
+			case '\t':
+			case ' ':
+				fWhitespace = true;
+				pExpr++;
+				continue;
+			case '+':
+				pExpr++;
+				op = EXPROP_ADD;
+				break;
+			case '-':
+				pExpr++;
+				op = EXPROP_SUB;
+				break;
+			case '*':
+				pExpr++;
+				op = EXPROP_MUL;
+				break;
+			case '|':
+				pExpr++;
+				op = EXPROP_OR;
+				if ( pExpr[0] == '|' )	// boolean ?
+				{
+					pExpr++;
+					op = EXPROP_LOR;
+				}
+				break;
+			case '&':
+				pExpr++;
+				op = EXPROP_AND;
+				if ( pExpr[0] == '&' )	// boolean ?
+				{
+					pExpr++;
+					op = EXPROP_LAND;
+				}
+				break;
+			case '/':
+				pExpr++;
+				op = EXPROP_DIV;
+				break;
+			case '>': // boolean
+				pExpr++;
+				op = EXPROP_GT;
+				if ( pExpr[0] == '=' )
+				{
+					pExpr++;
+					op = EXPROP_GE;
+				}
+				else if ( pExpr[0] == '>' )
+				{
+					pExpr++;
+					op = EXPROP_SHR;
+				}
+				break;
+			case '<': // boolean
+				pExpr++;
+				op = EXPROP_LT;
+				if ( pExpr[0] == '=' )
+				{
+					pExpr++;
+					op = EXPROP_LE;
+				}
+				else if ( pExpr[0] == '<' )
+				{
+					pExpr++;
+					op = EXPROP_SHL;
+				}
+				break;
+			case '!':
+				pExpr ++;
+				if ( pExpr[0] != '=' )
+					goto nomorevals; // boolean ! is handled as a single expresion.
+				pExpr ++;
+				op = EXPROP_NE;
+				break;
+			case '=': // boolean
+				while ( pExpr[0] == '=' )
+					pExpr ++;
+				op = EXPROP_EQ;
+				break;
+			default:
+				if ( fWhitespace )
+					goto getmorevals;
+				goto nomorevals;
+			}
+			CompileSingle( prog, pExpr, fHexDef, iDepth+1 );
+			prog.AddOp( op );
+			fWhitespace = false;
+		}
+	}
+nomorevals:
+	prog.AddList( iQty );
+}
+
+void CExpression::Compile( CExprProg & prog, const TCHAR * pszText, BYTE bMode )
+{
+	// Turn the text into ops once. GetProgVal() runs them.
+	ASSERT( pszText );
+	if ( pszText != prog.m_sText.GetPtr())
+	{
+		prog.m_sText.Copy( pszText );
+	}
+	prog.m_Ops.clear();
+	prog.m_bMode = bMode;
+	prog.m_fText = false;
+	prog.m_fDefs = false;
+	prog.m_fMissing = false;
+	prog.m_iDefAdds = CVarDef::sm_iAdds;
+	prog.m_iDefDeletes = CVarDef::sm_iDeletes;
+	prog.m_iStack = 0;
+	prog.m_iStackMax = 0;
+
+	const TCHAR * pExpr = prog.m_sText;
+	bool fHexDef = ( bMode & EXPRMODE_HEX ) ? true : false;
+	if ( bMode & EXPRMODE_SINGLE )
+	{
+		CompileSingle( prog, pExpr, fHexDef, 0 );
+	}
+	else
+	{
+		CompileVal( prog, pExpr, fHexDef, 0 );
+	}
+	prog.m_iLen = pExpr - prog.m_sText.GetPtr();
+	ASSERT( prog.m_iStack == 1 );
+	if ( prog.m_iStackMax > EXPR_STACK_MAX )
+	{
+		prog.m_fText = true;
+	}
+	m_dwCompiles ++;
+}
+
+int CExpression::GetProgVal( CExprProg & prog )
+{
+	// Run the compiled ops.
+
+	if ( prog.IsStale())
+	{
+		Compile( prog, prog.m_sText.GetPtr(), prog.m_bMode );
+	}
+	if ( prog.m_fText )
+	{
+		const TCHAR * pszText = prog.m_sText;
+		bool fHexDef = ( prog.m_bMode & EXPRMODE_HEX ) ? true : false;
+		if ( prog.m_bMode & EXPRMODE_SINGLE )
+			return( ParseSingle( pszText, fHexDef ));
+		return( ParseVal( pszText, fHexDef ));
+	}
+	if ( m_iRecurse > 32 )
+	{
+		DEBUG_ERR(( "Exp_GetVal Too much recursion!\n" ));
+		return( 0 );
+	}
+
+	m_iRecurse ++;
+	long lStack[ EXPR_STACK_MAX ];
+	int iTop = 0;	// next free.
+	const CExprOp * pOp = &prog.m_Ops[0];
+	const CExprOp * pOpEnd = pOp + prog.m_Ops.size();
+	for ( ; pOp < pOpEnd; pOp++ )
+	{
+		switch ( pOp->m_Op )
+		{
+		case EXPROP_CONST:
+			lStack[iTop++] = pOp->m_lVal;
+			break;
+		case EXPROP_DEF:
+			lStack[iTop++] = GetDefVal( pOp->m_pVar );
+			break;
+		case EXPROP_RAND:
+			lStack[iTop-1] = GetRandVal( lStack[iTop-1] );
+			break;
+		case EXPROP_BNOT:
+			lStack[iTop-1] = ~ (int) lStack[iTop-1];
+			break;
+		case EXPROP_LNOT:
+			lStack[iTop-1] = ! (int) lStack[iTop-1];
+			break;
+		case EXPROP_LIST:
+			iTop -= pOp->m_lVal;
+			lStack[iTop] = GetListVal( &lStack[iTop], pOp->m_lVal );
+			iTop++;
+			break;
+		default:
+			iTop--;
+			lStack[iTop-1] = GetBinaryOp( pOp->m_Op, lStack[iTop-1], lStack[iTop] );
+			break;
+		}
+	}
+	m_iRecurse --;
+	ASSERT( iTop == 1 );
+	return( lStack[0] );
+}
+
+CExprProg * CExpression::FindProg( const TCHAR * pszText, BYTE bMode )
+{
+	// Have we seen this text before ? Compile it the 2nd time it comes by.
+	// RETURN: NULL = just parse it this time.
+
+	if ( ! m_fCompile || pszText == NULL )
+		return( NULL );
+
+	DWORD dwHash = 2166136261U ^ bMode;	// FNV-1a
+	int iLen = 0;
+	for ( ; pszText[iLen]; iLen++ )
+	{
+		dwHash ^= (BYTE) pszText[iLen];
+		dwHash *= 16777619U;
+	}
+
+	if ( m_Cache.empty())
+	{
+		m_Cache.resize( EXPR_CACHE_SIZE );
+	}
+	CExprCacheSlot & slot = m_Cache[ dwHash & ( EXPR_CACHE_SIZE - 1 ) ];
+	if ( slot.m_pProg != NULL && slot.m_dwHash == dwHash && slot.m_pProg->IsText( pszText, iLen, bMode ))
+	{
+		m_dwCacheHits ++;
+		if ( slot.m_pProg->IsStale())
+		{
+			Compile( *slot.m_pProg, slot.m_pProg->GetText(), bMode );
+		}
+		return( slot.m_pProg );
+	}
+
+	m_dwCacheMisses ++;
+	if ( slot.m_dwSeenHash != dwHash )
+	{
+		// Might be a one off. (text with <> already filled in)
+		slot.m_dwSeenHash = dwHash;
+		return( NULL );
+	}
+	if ( slot.m_pProg == NULL )
+	{
+		slot.m_pProg = new CExprProg;
+	}
+	slot.m_dwHash = dwHash;
+	slot.m_dwSeenHash = 0;
+	Compile( *slot.m_pProg, pszText, bMode );
+	return( slot.m_pProg );
+}
+
+void CExpression::ClearCache()
+{
+	for ( size_t i=0; i<m_Cache.size(); i++ )
+	{
+		if ( m_Cache[i].m_pProg )
+		{
+			delete m_Cache[i].m_pProg;
+		}
+	}
+	m_Cache.clear();
+}
+
+int CExpression::GetCacheCount() const
+{
+	int iCount = 0;
+	for ( size_t i=0; i<m_Cache.size(); i++ )
+	{
+		if ( m_Cache[i].m_pProg )
+			iCount ++;
+	}
+	return( iCount );
+}
+
+size_t CExpression::GetCacheMem() const
+{
+	size_t iMem = m_Cache.capacity() * sizeof(CExprCacheSlot);
+	for ( size_t i=0; i<m_Cache.size(); i++ )
+	{
+		if ( m_Cache[i].m_pProg )
+			iMem += m_Cache[i].m_pProg->GetMem();
+	}
+	return( iMem );
+}
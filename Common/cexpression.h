@@ -12,14 +12,145 @@
 #include "cstring.h"
 #include "carray.h"
 #include "cscript.h"
+#include <vector>
+
+class CVarDef;
+
+#define EXPR_LIST_MAX	64		// Maximum elements in a list. GetVal()
+#define EXPR_STACK_MAX	256		// Deeper than this in a CExprProg just parses the text.
+#define EXPR_CACHE_SIZE	4096	// Slots in the compiled expression cache. (power of 2)
+
+enum EXPRMODE_TYPE	// How a CExprProg reads its text.
+{
+	EXPRMODE_VAL = 0,	// GetVal()
+	EXPRMODE_HEX = 1,	// fHexDef
+	EXPRMODE_SINGLE = 2,	// GetSingle()
+};
+
+enum EXPROP_TYPE
+{
+	EXPROP_CONST = 0,	// push m_lVal
+	EXPROP_DEF,		// push the value of m_pVar.
+	EXPROP_RAND,	// RAND() of the top.
+	EXPROP_BNOT,	// ~
+	EXPROP_LNOT,	// !
+	EXPROP_LIST,	// the top m_lVal values are a list or range. pick one. (1 = just make it an int)
+	// Binary ops on the top 2. Same as GetVal() does them.
+	EXPROP_ADD,
+	EXPROP_SUB,
+	EXPROP_MUL,
+	EXPROP_DIV,
+	EXPROP_OR,
+	EXPROP_LOR,
+	EXPROP_AND,
+	EXPROP_LAND,
+	EXPROP_GT,
+	EXPROP_GE,
+	EXPROP_SHR,
+	EXPROP_LT,
+	EXPROP_LE,
+	EXPROP_SHL,
+	EXPROP_NE,
+	EXPROP_EQ,
+};
+
+struct CExprOp
+{
+	BYTE m_Op;	// EXPROP_TYPE
+	union
+	{
+		long m_lVal;
+		CVarDef * m_pVar;
+	};
+};
+
+class CExprProg
+{
+	// A GetVal() or GetSingle() compiled to reverse polish ops by CExpression::Compile().
+	// Constant parts are worked out already. DEF names point right at the CVarDef.
+	// Once any CVarDef is made or deleted that could be wrong, so we compile m_sText again.
+	friend class CExpression;
+private:
+	std::vector<CExprOp> m_Ops;
+	CGString m_sText;	// All the text we were given. (GetVal() may not use it all)
+	int m_iLen;			// How much of m_sText GetVal() uses.
+	BYTE m_bMode;		// EXPRMODE_TYPE
+	bool m_fText;		// Too deep to compile. just parse m_sText.
+	bool m_fDefs;		// Has EXPROP_DEF ops.
+	bool m_fMissing;	// Looked for a DEF name that was not there.
+	int m_iDefAdds;		// CVarDef::sm_iAdds when compiled.
+	int m_iDefDeletes;	// CVarDef::sm_iDeletes when compiled.
+	int m_iStack;		// Values on the stack as we compile.
+	int m_iStackMax;
+
+private:
+	void AddOp( EXPROP_TYPE op, long lVal = 0 );
+	void AddDef( CVarDef * pVar );
+	void AddList( int iQty );
+	bool IsStale() const;
+
+public:
+	CExprProg()
+	{
+		m_iLen = 0;
+		m_bMode = EXPRMODE_VAL;
+		m_fText = true;
+		m_fDefs = false;
+		m_fMissing = false;
+		m_iDefAdds = 0;
+		m_iDefDeletes = 0;
+		m_iStack = 0;
+		m_iStackMax = 0;
+	}
+	const TCHAR * GetText() const
+	{
+		return( m_sText );
+	}
+	int GetLen() const
+	{
+		return( m_iLen );
+	}
+	int GetOpCount() const
+	{
+		return( (int) m_Ops.size());
+	}
+	bool IsConst() const
+	{
+		return( ! m_fText && m_Ops.size() == 1 && m_Ops[0].m_Op == EXPROP_CONST );
+	}
+	bool IsText( const TCHAR * pszText, int iLen, BYTE bMode ) const
+	{
+		return( m_bMode == bMode && m_sText.GetLength() == iLen && ! memcmp( (const TCHAR *) m_sText, pszText, iLen ));
+	}
+	size_t GetMem() const
+	{
+		return( sizeof(CExprProg) + m_Ops.capacity() * sizeof(CExprOp) + m_sText.GetLength());
+	}
+};
 
 class CVarDef : public CMemDynamic, public CScriptObj	// A variable from GRAYDEFS.SCP or other.
 {
+	friend class CExpression;
 protected:
 	DECLARE_MEM_DYNAMIC;
 private:
 	const CGString m_sName;	// the key for sorting.
 	CGString m_sVal;	// the assigned value.
+	CExprProg * m_pValProg;	// m_sVal compiled. Once it has been used twice.
+	int m_iValUses;
+public:
+	static int sm_iAdds;	// CVarDef made. (a name a CExprProg did not find may be here now)
+	static int sm_iDeletes;	// CVarDef deleted. (a CExprProg may point at it)
+private:
+	void ClearValProg()
+	{
+		if ( m_pValProg )
+		{
+			delete m_pValProg;
+			m_pValProg = NULL;
+		}
+		m_iValUses = 0;
+	}
 public:
 	const TCHAR * GetName() const
 	{
@@ -32,6 +163,7 @@ public:
 	void SetVal( const TCHAR * pszVal )
 	{
 		m_sVal.Copy( pszVal );
+		ClearValProg();
 	}
 	bool r_LoadVal( CScript & s )
 	{
@@ -54,10 +186,21 @@ public:
 		m_sName( pszName ),
 		m_sVal( pszVal )
 	{
+		m_pValProg = NULL;
+		m_iValUses = 0;
+		sm_iAdds ++;
 	}
 	CVarDef( const TCHAR * pszName ) :
 		m_sName( pszName )
 	{
+		m_pValProg = NULL;
+		m_iValUses = 0;
+		sm_iAdds ++;
+	}
+	~CVarDef()
+	{
+		ClearValProg();
+		sm_iDeletes ++;
 	}
 };
 
@@ -81,13 +224,42 @@ struct CVarDefArray : public CGObSortArray< CVarDef *, const TCHAR *>
 	}
 };
 
+struct CExprCacheSlot
+{
+	DWORD m_dwHash;		// of m_pProg
+	DWORD m_dwSeenHash;	// last text that missed here. compile it if it comes again.
+	CExprProg * m_pProg;
+};
+
 extern class CExpression
 {
+private:
+	int m_iRecurse;	// Make sure we don't recurse too much.
+	std::vector<CExprCacheSlot> m_Cache;	// Compiled text by hash of the text.
+
+public:
+	CVarDefArray m_VarDefs;	 // Defined variables in sorted order.
+	bool m_fCompile;	// Compile the text we see more than once.
+	DWORD m_dwCacheHits;
+	DWORD m_dwCacheMisses;
+	DWORD m_dwCompiles;
+
 private:
 	CVarDef * GetVarDef( const TCHAR * & pArgs );
 	bool GetVarDef( const TCHAR * & pArgs, long * plVal );
+	int GetDefVal( CVarDef * pVarDef );
+	static int GetListVal( const long * lVals, int iQty );
+	int ParseSingle( const TCHAR * & pArgs, bool fHexDef );
+	int ParseVal( const TCHAR * & pExpr, bool fHexDef );
+	void CompileSingle( CExprProg & prog, const TCHAR * & pArgs, bool fHexDef, int iDepth );
+	void CompileVal( CExprProg & prog, const TCHAR * & pExpr, bool fHexDef, int iDepth );
+	CExprProg * FindProg( const TCHAR * pszText, BYTE bMode );
+
 public:
-	CVarDefArray m_VarDefs;	 // Defined variables in sorted order.
+	CExpression();
+	~CExpression();
+
+	static long GetBinaryOp( int op, long lVal1, long lVal2 );
 
 	int  GetSingle( const TCHAR * & pArgs, bool fHexDef = false );
 	inline int  GetSingle(TCHAR * & pArgs, bool fHexDef = false) {
@@ -99,6 +271,13 @@ public:
 		return GetVal(const_cast<const TCHAR * &>(pArgs), fHexDef);
 	}
 
+	void Compile( CExprProg & prog, const TCHAR * pszText, BYTE bMode = EXPRMODE_VAL );
+	int  GetProgVal( CExprProg & prog );
+
+	void ClearCache();
+	int GetCacheCount() const;
+	size_t GetCacheMem() const;
+
 	bool SetVarDef( const TCHAR * pszName, const TCHAR * pszVal );
 
 } g_Exp;
@@ -20,6 +20,12 @@
 #include "cfile.h"
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 void GetStrippedDirName( TCHAR * pszFilePath )
 {
 	int len = strlen( pszFilePath );
@@ -132,6 +138,110 @@ bool CGFile::OpenCopy( const CGFile & file, WORD wModeFlags )
 
 #endif
 
+//***************************************************************************
+// -CFileView
+
+bool CFileView::Open( const TCHAR * pszName )
+{
+	Close();
+	if ( pszName == NULL || ! pszName[0] )
+		return( false );
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFile( pszName, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hFile == INVALID_HANDLE_VALUE )
+		return( false );
+	DWORD dwSize = GetFileSize( hFile, NULL );
+	if ( dwSize == 0 || dwSize == INVALID_FILE_SIZE )
+	{
+		CloseHandle( hFile );
+		return( false );
+	}
+	m_hMap = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( hFile );	// the mapping keeps it open.
+	if ( m_hMap == NULL )
+		return( false );
+	m_pData = (const BYTE *) MapViewOfFile( m_hMap, FILE_MAP_READ, 0, 0, 0 );
+	if ( m_pData == NULL )
+	{
+		CloseHandle( m_hMap );
+		m_hMap = NULL;
+		return( false );
+	}
+#else
+	int hFile = open( pszName, O_RDONLY );
+	if ( hFile < 0 )
+		return( false );
+	struct stat st;
+	if ( fstat( hFile, &st ) != 0 || st.st_size <= 0 || st.st_size > 0x7fffffff )
+	{
+		close( hFile );
+		return( false );
+	}
+	DWORD dwSize = (DWORD) st.st_size;
+	void * pData = mmap( NULL, dwSize, PROT_READ, MAP_SHARED, hFile, 0 );
+	close( hFile );	// the mapping keeps it open.
+	if ( pData == MAP_FAILED )
+		return( false );
+	m_pData = (const BYTE *) pData;
+#endif
+
+	m_dwSize = dwSize;
+	return( true );
+}
+
+void CFileView::Close()
+{
+	if ( m_pData == NULL )
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile( m_pData );
+	CloseHandle( m_hMap );
+	m_hMap = NULL;
+#else
+	munmap( (void *) m_pData, m_dwSize );
+#endif
+	m_pData = NULL;
+	m_dwSize = 0;
+}
+
+void CFileView::Prefetch( DWORD dwOffset, DWORD dwLength ) const
+{
+	// Start reading it in now so we don't stall on it later.
+	if ( m_pData == NULL || dwOffset >= m_dwSize )
+		return;
+	if ( dwLength > m_dwSize - dwOffset )
+		dwLength = m_dwSize - dwOffset;
+#ifdef _WIN32
+	// Windows just reads it when we get there.
+#else
+	static const DWORD sm_dwPageMask = (DWORD) sysconf( _SC_PAGESIZE ) - 1;
+	DWORD dwStart = dwOffset &~ sm_dwPageMask;
+	madvise( (void *)( m_pData + dwStart ), dwLength + ( dwOffset - dwStart ), MADV_WILLNEED );
+#endif
+}
+
+#ifndef _AFXDLL
+
+bool CFileBin::ReadAt( DWORD dwOffset, void FAR * pData, DWORD dwLength )
+{
+	// Read from the view if we have one. else seek and read.
+	// RETURN: true = got all of it.
+	if ( m_View.IsOpen())
+	{
+		const BYTE * pSrc = m_View.GetData( dwOffset, dwLength );
+		if ( pSrc == NULL )
+			return( false );
+		memcpy( pData, pSrc, dwLength );
+		return( true );
+	}
+	if ( ! Seek( dwOffset, SEEK_SET ))
+		return( false );
+	return( Read( pData, dwLength ) == dwLength );
+}
+
+#endif
+
 //***************************************************************************
 // -CFileText
 
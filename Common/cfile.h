@@ -28,6 +28,7 @@ public:
 	virtual TCHAR * ReadLine( TCHAR FAR * pBuffer, size_t sizemax ) = 0;
 	virtual bool Write( const void FAR * pData, size_t iLen ) = 0;
 	virtual bool Seek( long offset = 0, int origin = SEEK_SET ) = 0;
+	virtual long Tell() const = 0;	// -1 = error.
 };
 
 class CGFile	// try to be compatible with MFC CFile class.
@@ -208,6 +209,55 @@ public:
 	}
 };
 
+class CFileView
+{
+	// A read only memory map of a whole file.
+	// Reads become a memcpy. The OS shares the pages with anyone else who has the file mapped.
+private:
+	const BYTE * m_pData;
+	DWORD m_dwSize;
+#ifdef _WIN32
+	HANDLE m_hMap;
+#endif
+
+private:
+	CFileView( const CFileView & );
+	CFileView & operator=( const CFileView & );
+
+public:
+	CFileView()
+	{
+		m_pData = NULL;
+		m_dwSize = 0;
+#ifdef _WIN32
+		m_hMap = NULL;
+#endif
+	}
+	~CFileView()
+	{
+		Close();
+	}
+	bool IsOpen() const
+	{
+		return( m_pData != NULL );
+	}
+	DWORD GetSize() const
+	{
+		return( m_dwSize );
+	}
+	const BYTE * GetData( DWORD dwOffset, DWORD dwLength ) const
+	{
+		// RETURN: NULL = not all in the view.
+		if ( dwOffset > m_dwSize || dwLength > m_dwSize - dwOffset )
+			return( NULL );
+		return( m_pData + dwOffset );
+	}
+
+	bool Open( const TCHAR * pszName );
+	void Close();
+	void Prefetch( DWORD dwOffset, DWORD dwLength ) const;	// we will want this soon.
+};
+
 #ifdef _WIN32 
 
 #ifndef HFILE_ERROR
@@ -260,6 +310,9 @@ protected:
 	}
 #endif
 
+public:
+	CFileView m_View;	// OpenView() = read from a memory map instead.
+
 public:
 	CFileBin()
 	{
@@ -277,6 +330,7 @@ public:
 
 	bool Close()
 	{
+		m_View.Close();
 		if ( ! IsFileOpen())
 			return( true );
 		HFILE hRet = _lclose( m_hFile );
@@ -301,6 +355,11 @@ public:
 	{
 		return( _hwrite( m_hFile, (const char *) pData, (long) dwLength ) == (long) dwLength );
 	}
+	bool OpenView()
+	{
+		return( m_View.Open( GetFilePath()));
+	}
+	bool ReadAt( DWORD dwOffset, void FAR * pData, DWORD dwLength );
 };
 
 #endif	// _AFXDLL
@@ -309,11 +368,24 @@ public:
 
 class CFileBin : public CFileText
 {
+public:
+	CFileView m_View;	// OpenView() = read from a memory map instead.
+
 public:
 	bool Open( const TCHAR * pszName = NULL, WORD uMode = OF_READ | OF_SHARE_DENY_NONE, void FAR * pExtra = NULL )
 	{
 		return( CGFile::Open( pszName, uMode | OF_BINARY, pExtra ));
 	}
+	bool Close()
+	{
+		m_View.Close();
+		return( CFileText::Close());
+	}
+	bool OpenView()
+	{
+		return( m_View.Open( GetFilePath()));
+	}
+	bool ReadAt( DWORD dwOffset, void FAR * pData, DWORD dwLength );
 };
 
 #endif	// ! _WIN32
@@ -152,7 +152,26 @@ bool CGrayInstall::OpenFile( VERFILE_TYPE i )
 	if ( pszName == NULL ) 
 		return( false );
 
-        return( OpenFile( m_File[i], pszName, OF_READ|OF_SHARE_DENY_NONE ));
+	if ( ! OpenFile( m_File[i], pszName, OF_READ|OF_SHARE_DENY_NONE ))
+		return( false );
+
+	switch ( i )
+	{
+	case VERFILE_MAP:
+	case VERFILE_STAIDX:
+	case VERFILE_STATICS:
+	case VERFILE_MULTIIDX:
+	case VERFILE_MULTI:
+	case VERFILE_VERDATA:
+	case VERFILE_TILEDATA:
+		// We read little bits of these all the time. Map them instead.
+		// If we can't (no address space ?) we just Seek() and Read() like before.
+		m_File[i].OpenView();
+		break;
+	default:
+		break;
+	}
+	return( true );
 }
 
 VERFILE_TYPE CGrayInstall::OpenFiles( DWORD dwMask )
@@ -199,11 +218,7 @@ bool CGrayInstall::ReadMulIndex( VERFILE_TYPE fileindex, VERFILE_TYPE filedata,
 	{
 		return( true );
 	}
-	if ( ! m_File[fileindex].Seek( id * sizeof(CUOIndexRec), SEEK_SET ))
-	{
-		return( false );
-	}
-	if ( m_File[fileindex].Read( (void *) &Index, sizeof(CUOIndexRec)) != sizeof(CUOIndexRec))
+	if ( ! m_File[fileindex].ReadAt( id * sizeof(CUOIndexRec), (void *) &Index, sizeof(CUOIndexRec)))
 	{
 		return( false );
 	}
@@ -216,16 +231,50 @@ bool CGrayInstall::ReadMulData( VERFILE_TYPE filedata, const CUOIndexRec & Index
 	{
 		filedata = VERFILE_VERDATA;
 	}
-	if ( ! m_File[filedata].Seek( Index.GetFileOffset(), SEEK_SET ))
-	{
-		return( false );
-	}
-	DWORD dwLength = Index.GetBlockLength();
-	if ( m_File[filedata].Read( pData, dwLength ) != dwLength )
+	return( m_File[filedata].ReadAt( Index.GetFileOffset(), pData, Index.GetBlockLength()));
+}
+
+void CGrayInstall::PrefetchMapBlocks( int bx, int by, int bxEnd, int byEnd ) const
+{
+	// Someone is headed this way. Get the map and statics for these blocks in from disk.
+	// Blocks are stored by column. (bx * UO_BLOCKS_Y + by)
+	if ( ! m_File[VERFILE_MAP].IsFileOpen() || ! m_File[VERFILE_STAIDX].IsFileOpen())
+		return;	// OpenFiles() not done yet.
+	bx = max( bx, 0 );
+	by = max( by, 0 );
+	bxEnd = min( bxEnd, UO_BLOCKS_X );
+	byEnd = min( byEnd, UO_BLOCKS_Y );
+	if ( bx >= bxEnd || by >= byEnd )
+		return;
+
+	const CFileView & MapView = m_File[VERFILE_MAP].m_View;
+	const CFileView & IndexView = m_File[VERFILE_STAIDX].m_View;
+	const CFileView & StaticsView = m_File[VERFILE_STATICS].m_View;
+	for ( ; bx < bxEnd; bx++ )
 	{
-		return( false );
+		DWORD dwBlock = bx * UO_BLOCKS_Y + by;
+		DWORD dwCount = byEnd - by;
+		MapView.Prefetch( dwBlock * sizeof(CUOMapBlock), dwCount * sizeof(CUOMapBlock));
+		IndexView.Prefetch( dwBlock * sizeof(CUOIndexRec), dwCount * sizeof(CUOIndexRec));
+
+		// The statics for a column are mostly together too.
+		const CUOIndexRec * pIndex = (const CUOIndexRec *) IndexView.GetData( dwBlock * sizeof(CUOIndexRec), dwCount * sizeof(CUOIndexRec));
+		if ( pIndex == NULL )
+			continue;
+		DWORD dwLo = 0xFFFFFFFF;
+		DWORD dwHi = 0;
+		for ( DWORD i=0; i<dwCount; i++ )
+		{
+			if ( ! pIndex[i].HasData())
+				continue;
+			dwLo = min( dwLo, pIndex[i].GetFileOffset());
+			dwHi = max( dwHi, pIndex[i].GetFileOffset() + pIndex[i].GetBlockLength());
+		}
+		if ( dwLo < dwHi )
+		{
+			StaticsView.Prefetch( dwLo, dwHi - dwLo );
+		}
 	}
-	return( true );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -303,4 +352,67 @@ bool CVerDataMul::FindVerDataBlock( VERFILE_TYPE type, DWORD id, CUOIndexRec & I
 	return( false );
 }
 
+//////////////////////////////////////////////////////////////////////
+// -CGrayTileData
+
+void CGrayTileData::ReadBlock( DWORD dwBlock, DWORD dwFileOffset, void * pTiles, size_t iSize )
+{
+	// Read one block of 32 tiles. From the verdata if it has a newer one.
+	// The UINT header of each block is skipped.
+	CUOIndexRec Index;
+	if ( g_VerData.FindVerDataBlock( VERFILE_TILEDATA, dwBlock, Index ))
+	{
+		if ( Index.GetBlockLength() < iSize + 4 ||
+			! g_Install.m_File[VERFILE_VERDATA].ReadAt( Index.GetFileOffset() + 4, pTiles, iSize ))
+		{
+			throw CGrayError(LOGL_CRIT, E_FAIL, "TileData: Read VerData");
+		}
+		return;
+	}
+	if ( ! g_Install.m_File[VERFILE_TILEDATA].ReadAt( dwFileOffset + 4, pTiles, iSize ))
+	{
+		throw CGrayError(LOGL_CRIT, E_FAIL, "TileData: Read");
+	}
+}
+
+void CGrayTileData::Load()
+{
+	// Read the whole thing in one go. About 1 meg.
+	// Call after g_VerData.Load()
+	Unload();
+	if ( ! g_Install.m_File[VERFILE_TILEDATA].IsFileOpen())
+		throw CGrayError(LOGL_CRIT, E_FAIL, "TileData: Not open");
+
+	m_pTerrain = new CUOTerrainTypeRec [ TERRAIN_QTY ];
+	m_pItems = new CUOItemTypeRec [ ITEMID_MULTI ];
 
+	try
+	{
+		DWORD dwBlock = 0;
+		DWORD dwOffset = 0;
+		for ( int i=0; i<TERRAIN_QTY; i += UOTILE_BLOCK_QTY, dwBlock++ )
+		{
+			ReadBlock( dwBlock, dwOffset, &m_pTerrain[i], sizeof(CUOTerrainTypeRec) * UOTILE_BLOCK_QTY );
+			dwOffset += sizeof(CUOTerrainTypeBlock);
+		}
+		ASSERT( dwOffset == UOTILE_TERRAIN_SIZE );
+		for ( int i=0; i<ITEMID_MULTI; i += UOTILE_BLOCK_QTY, dwBlock++ )
+		{
+			ReadBlock( dwBlock, dwOffset, &m_pItems[i], sizeof(CUOItemTypeRec) * UOTILE_BLOCK_QTY );
+			dwOffset += sizeof(CUOItemTypeBlock);
+		}
+	}
+	catch (...)
+	{
+		Unload();
+		throw;
+	}
+}
+
+void CGrayTileData::Unload()
+{
+	delete [] m_pTerrain;
+	m_pTerrain = NULL;
+	delete [] m_pItems;
+	m_pItems = NULL;
+}
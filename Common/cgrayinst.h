@@ -103,6 +103,7 @@ public:
 
 	bool ReadMulIndex( VERFILE_TYPE fileindex, VERFILE_TYPE filedata, DWORD id, CUOIndexRec & Index );
 	bool ReadMulData( VERFILE_TYPE filedata, const CUOIndexRec & Index, void * pData );
+	void PrefetchMapBlocks( int bx, int by, int bxEnd, int byEnd ) const;
 
 } g_Install;
 
@@ -138,4 +139,46 @@ public:
 
 } g_VerData;
 
+extern class CGrayTileData
+{
+	// All of tiledata.mul in memory. (with the verdata.mul patches put in)
+	// So CGrayItemInfo and CGrayTerrainInfo never have to go to the file.
+private:
+	CUOTerrainTypeRec * m_pTerrain;	// [TERRAIN_QTY]
+	CUOItemTypeRec * m_pItems;		// [ITEMID_MULTI]
+
+private:
+	void ReadBlock( DWORD dwBlock, DWORD dwFileOffset, void * pTiles, size_t iSize );
+
+public:
+	CGrayTileData()
+	{
+		m_pTerrain = NULL;
+		m_pItems = NULL;
+	}
+	~CGrayTileData()
+	{
+		Unload();
+	}
+	bool IsLoaded() const
+	{
+		return( m_pItems != NULL );
+	}
+	const CUOTerrainTypeRec * GetTerrain( TERRAIN_TYPE id ) const
+	{
+		ASSERT( IsLoaded());
+		ASSERT( id < TERRAIN_QTY );
+		return( &m_pTerrain[id] );
+	}
+	const CUOItemTypeRec * GetItem( ITEMID_TYPE id ) const
+	{
+		ASSERT( IsLoaded());
+		ASSERT( id < ITEMID_MULTI );
+		return( &m_pItems[id] );
+	}
+	void Load();	// NOTE: This will "throw" on failure !
+	void Unload();
+
+} g_TileData;
+
 #endif	// _INC_CGRAYINST_H
\ No newline at end of file
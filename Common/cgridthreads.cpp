@@ -0,0 +1,146 @@
+//
+// CGridThreads.cpp
+//
+
+#include "graycom.h"
+#include "cgridthreads.h"
+
+/////////////////////////////////////////////////////////////////
+// -CGridThreads
+
+CGridThreads::CGridThreads() :
+	m_iRunning( 0 )
+{
+	m_fStop = false;
+	m_uRun = 0;
+	m_pJob = NULL;
+	for ( int i=0; i<GRID_COLOR_QTY; i++ )
+	{
+		m_iNext[i] = 0;
+		m_iLeft[i] = 0;
+	}
+}
+
+CGridThreads::~CGridThreads()
+{
+	Stop();
+}
+
+void CGridThreads::Start( int iThreads )
+{
+	if ( iThreads < 0 )
+		iThreads = 0;
+	if ( iThreads > 64 )
+		iThreads = 64;
+	if ( iThreads == GetThreadCount())
+		return;
+
+	Stop();
+	m_fStop = false;
+	for ( int i=0; i<iThreads; i++ )
+	{
+		m_Threads.push_back( std::thread( EntryProc, this, i+1, m_uRun ));
+	}
+}
+
+void CGridThreads::Stop()
+{
+	if ( m_Threads.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		m_fStop = true;
+	}
+	m_Start.notify_all();
+	for ( size_t i=0; i<m_Threads.size(); i++ )
+	{
+		m_Threads[i].join();
+	}
+	m_Threads.clear();
+}
+
+void CGridThreads::EntryProc( CGridThreads * pThis, int iThread, unsigned int uRun ) // static
+{
+	// uRun = the last Run() before we started.
+	while ( true )
+	{
+		{
+			std::unique_lock<std::mutex> lock( pThis->m_Lock );
+			while ( ! pThis->m_fStop && pThis->m_uRun == uRun )
+			{
+				pThis->m_Start.wait( lock );
+			}
+			if ( pThis->m_fStop )
+				return;
+			uRun = pThis->m_uRun;
+		}
+		pThis->DoRun( iThread );
+	}
+}
+
+void CGridThreads::DoRun( int iThread )
+{
+	for ( int iColor=0; iColor<GRID_COLOR_QTY; iColor++ )
+	{
+		const std::vector<int> & Cells = m_Colors[iColor];
+		int iQty = (int) Cells.size();
+		if ( ! iQty )
+			continue;	// everyone skips it.
+		while ( true )
+		{
+			int i = m_iNext[iColor].fetch_add( 1 );
+			if ( i >= iQty )
+				break;
+			m_pJob->OnGridCell( iThread, Cells[i] );
+		}
+		// Wait for the rest to finish this colour. Its last cells may touch the next colour.
+		m_iLeft[iColor].fetch_sub( 1 );
+		while ( m_iLeft[iColor].load())
+		{
+			std::this_thread::yield();
+		}
+	}
+	m_iRunning.fetch_sub( 1 );
+}
+
+void CGridThreads::Run( CGridJob & Job, const int * piCells, int iQty, int iCols )
+{
+	ASSERT( ! m_iRunning.load());
+	for ( int i=0; i<GRID_COLOR_QTY; i++ )
+	{
+		m_Colors[i].clear();
+	}
+	for ( int i=0; i<iQty; i++ )
+	{
+		int iCell = piCells[i];
+		int iColor = (( iCell % iCols ) & 1 ) | ((( iCell / iCols ) & 1 ) << 1 );
+		m_Colors[iColor].push_back( iCell );
+	}
+
+	m_pJob = &Job;
+	int iThreads = GetThreadCount() + 1;	// and us.
+	for ( int i=0; i<GRID_COLOR_QTY; i++ )
+	{
+		m_iNext[i] = 0;
+		m_iLeft[i] = iThreads;
+	}
+	m_iRunning = iThreads;
+
+	if ( iThreads > 1 )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_Lock );
+			m_uRun ++;
+		}
+		m_Start.notify_all();
+	}
+
+	DoRun( 0 );	// help out.
+
+	// The others may still be looking at the last m_iLeft.
+	while ( m_iRunning.load())
+	{
+		std::this_thread::yield();
+	}
+	m_pJob = NULL;
+}
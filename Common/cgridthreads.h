@@ -0,0 +1,71 @@
+//
+// CGridThreads.h
+//
+// Run a job on a list of grid cells with a few threads.
+// The cells are coloured by (x&1,y&1) and done a colour at a time.
+// So 2 cells that touch (even on a corner) are never being worked on at the same time.
+//
+
+#ifndef _INC_CGRIDTHREADS_H
+#define _INC_CGRIDTHREADS_H
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CGridJob
+{
+public:
+	// iThread = 0 for the thread that called CGridThreads::Run(). 1 to GetThreadCount() for the rest.
+	// NOTE: This must not throw. The other threads would wait on us forever.
+	virtual void OnGridCell( int iThread, int iCell ) = 0;
+	virtual ~CGridJob()
+	{
+	}
+};
+
+class CGridThreads
+{
+	// The threads sleep between Run() calls. One wake up per Run().
+	// Between the colours they just spin on an atomic count. (the colours are short)
+#define GRID_COLOR_QTY	4
+private:
+	std::vector<std::thread> m_Threads;
+	std::mutex m_Lock;
+	std::condition_variable m_Start;	// a new Run() is ready.
+	bool m_fStop;
+	unsigned int m_uRun;		// goes up for each Run().
+
+	CGridJob * m_pJob;
+	std::vector<int> m_Colors[ GRID_COLOR_QTY ];
+	std::atomic<int> m_iNext[ GRID_COLOR_QTY ];	// next cell of the colour to hand out.
+	std::atomic<int> m_iLeft[ GRID_COLOR_QTY ];	// threads still on the colour.
+	std::atomic<int> m_iRunning;	// threads still in this Run().
+
+private:
+	CGridThreads( const CGridThreads & );
+	CGridThreads & operator=( const CGridThreads & );
+
+	static void EntryProc( CGridThreads * pThis, int iThread, unsigned int uRun );
+	void DoRun( int iThread );
+
+public:
+	CGridThreads();
+	~CGridThreads();
+
+	int GetThreadCount() const
+	{
+		return( (int) m_Threads.size());
+	}
+	void Start( int iThreads );	// 0 = Stop()
+	void Stop();
+
+	// Cells are index = x + y*iCols. Calling thread only. Returns when every cell is done.
+	// With no threads the calling thread does them all. (same colour order)
+	void Run( CGridJob & Job, const int * piCells, int iQty, int iCols );
+};
+
+#endif	// _INC_CGRIDTHREADS_H
@@ -118,6 +118,11 @@ public:
                 return true;
         }
 
+        virtual long Tell() const override
+        {
+                return static_cast<long>( m_Position );
+        }
+
 private:
         std::string m_Buffer;
         size_t m_Position;
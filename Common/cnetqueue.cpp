@@ -0,0 +1,420 @@
+//
+// CNetQueue.cpp
+//
+// Outbound data queues for the client sockets.
+// The client input buffer.
+//
+
+#include "graycom.h"
+#include "grayproto.h"	// MAX_BUFFER
+#include "cnetqueue.h"
+
+/////////////////////////////////////////////////////////////////
+// -CNetBroadcast
+
+CNetBroadcast::CNetBroadcast( const void * pData, int iLen ) :
+	m_iRefs( 1 )
+{
+	ASSERT( iLen > 0 && iLen <= MAX_BUFFER );
+	m_iLen = iLen;
+	m_pData = new BYTE [ iLen ];
+	memcpy( m_pData, pData, iLen );
+	m_iBitsCompressed = 0;
+	m_pCompressed = NULL;
+}
+
+CNetBroadcast::~CNetBroadcast()
+{
+	delete [] m_pData;
+	delete [] m_pCompressed;
+}
+
+const BYTE * CNetBroadcast::GetCompressed()
+{
+	// Just the codes. No end code, each client has its own open block to put them in.
+	if ( m_pCompressed == NULL )
+	{
+		m_pCompressed = new BYTE [ m_iLen * 2 + 4 ];
+		m_iBitsCompressed = CCompressTree::EncodeBits( m_pCompressed, m_pData, m_iLen );
+	}
+	return( m_pCompressed );
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetBroadcastList
+
+CNetBroadcast * CNetBroadcastList::Get( const void * pData, int iLen )
+{
+	for ( int i=0; i<m_iQty; i++ )
+	{
+		if ( m_pPackets[i]->IsSame( pData, iLen ))
+			return( m_pPackets[i] );
+	}
+	if ( m_iQty >= NET_BROADCAST_VERSIONS || iLen <= 0 || iLen > MAX_BUFFER )
+		return( NULL );
+	m_pPackets[m_iQty] = new CNetBroadcast( pData, iLen );
+	return( m_pPackets[m_iQty++] );
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetSegmentPool
+
+CNetSegmentPool g_NetSegments;
+
+#define NET_SEGMENT_SLAB	64	// segments per heap allocation.
+
+CNetSegmentPool::CNetSegmentPool()
+{
+	m_pFree = NULL;
+	m_iTotal = 0;
+	m_iUsed = 0;
+}
+
+CNetSegmentPool::~CNetSegmentPool()
+{
+	for ( size_t i=0; i<m_Slabs.size(); i++ )
+	{
+		delete [] m_Slabs[i];
+	}
+}
+
+CNetSegment * CNetSegmentPool::Alloc()
+{
+	std::lock_guard<std::mutex> lock( m_Lock );
+	if ( m_pFree == NULL )
+	{
+		CNetSegment * pSlab = new CNetSegment [ NET_SEGMENT_SLAB ];
+		m_Slabs.push_back( pSlab );
+		for ( int i=0; i<NET_SEGMENT_SLAB; i++ )
+		{
+			pSlab[i].m_pNext = m_pFree;
+			m_pFree = &pSlab[i];
+		}
+		m_iTotal += NET_SEGMENT_SLAB;
+	}
+	CNetSegment * pSeg = m_pFree;
+	m_pFree = pSeg->m_pNext;
+	m_iUsed ++;
+
+	pSeg->m_pNext = NULL;
+	pSeg->m_iStart = 0;
+	pSeg->m_iEnd = 0;
+	return( pSeg );
+}
+
+void CNetSegmentPool::Free( CNetSegment * pHead )
+{
+	if ( pHead == NULL )
+		return;
+	std::lock_guard<std::mutex> lock( m_Lock );
+	while ( pHead != NULL )
+	{
+		CNetSegment * pNext = pHead->m_pNext;
+		pHead->m_pNext = m_pFree;
+		m_pFree = pHead;
+		m_iUsed --;
+		pHead = pNext;
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetSendQueue
+
+CNetSendQueue::CNetSendQueue()
+{
+	m_pHead = NULL;
+	m_pTail = NULL;
+	m_iBytes = 0;
+}
+
+CNetSendQueue::~CNetSendQueue()
+{
+	Empty();
+}
+
+void CNetSendQueue::Empty()
+{
+	g_NetSegments.Free( m_pHead );
+	m_pHead = NULL;
+	m_pTail = NULL;
+	m_iBytes = 0;
+}
+
+void CNetSendQueue::Append( const BYTE * pData, int iLen )
+{
+	ASSERT( iLen >= 0 );
+	m_iBytes += iLen;
+	while ( iLen > 0 )
+	{
+		if ( m_pTail == NULL || m_pTail->m_iEnd >= NET_SEGMENT_SIZE )
+		{
+			CNetSegment * pSeg = g_NetSegments.Alloc();
+			if ( m_pTail == NULL )
+				m_pHead = pSeg;
+			else
+				m_pTail->m_pNext = pSeg;
+			m_pTail = pSeg;
+		}
+		int iCopy = min( iLen, NET_SEGMENT_SIZE - m_pTail->m_iEnd );
+		memcpy( m_pTail->m_Data + m_pTail->m_iEnd, pData, iCopy );
+		m_pTail->m_iEnd += iCopy;
+		pData += iCopy;
+		iLen -= iCopy;
+	}
+}
+
+void CNetSendQueue::Take( CNetSendQueue & queue )
+{
+	if ( queue.IsEmpty())
+		return;
+	if ( m_pTail == NULL )
+		m_pHead = queue.m_pHead;
+	else
+		m_pTail->m_pNext = queue.m_pHead;
+	m_pTail = queue.m_pTail;
+	m_iBytes += queue.m_iBytes;
+
+	queue.m_pHead = NULL;
+	queue.m_pTail = NULL;
+	queue.m_iBytes = 0;
+}
+
+int CNetSendQueue::Read( void * pData, int iLen )
+{
+	// Copy bytes off the front and drop them.
+	// RETURN: bytes read.
+	BYTE * pOut = (BYTE *) pData;
+	int iRead = 0;
+	while ( iRead < iLen && m_pHead != NULL )
+	{
+		CNetSegment * pSeg = m_pHead;
+		int iCopy = min( iLen - iRead, pSeg->m_iEnd - pSeg->m_iStart );
+		memcpy( pOut + iRead, pSeg->m_Data + pSeg->m_iStart, iCopy );
+		pSeg->m_iStart += iCopy;
+		iRead += iCopy;
+		if ( pSeg->m_iStart < pSeg->m_iEnd )
+			break;
+		m_pHead = pSeg->m_pNext;
+		pSeg->m_pNext = NULL;
+		g_NetSegments.Free( pSeg );
+	}
+	if ( m_pHead == NULL )
+	{
+		m_pTail = NULL;
+	}
+	m_iBytes -= iRead;
+	return( iRead );
+}
+
+int CNetSendQueue::Flush( CGSocket * pSocket )
+{
+	// Give the socket as much as it will take in one call. (never blocks)
+	// RETURN: bytes sent. -1 = socket error.
+
+#define NET_SEND_IOV	64
+	int iSent;
+#ifdef _WIN32
+	WSABUF Bufs[ NET_SEND_IOV ];
+	DWORD dwCount = 0;
+	for ( CNetSegment * pSeg = m_pHead; pSeg != NULL && dwCount < NET_SEND_IOV; pSeg = pSeg->m_pNext )
+	{
+		Bufs[dwCount].buf = (char *)( pSeg->m_Data + pSeg->m_iStart );
+		Bufs[dwCount].len = pSeg->m_iEnd - pSeg->m_iStart;
+		dwCount++;
+	}
+	if ( ! dwCount )
+		return( 0 );
+	DWORD dwSent = 0;
+	if ( WSASend( pSocket->GetSocket(), Bufs, dwCount, &dwSent, 0, NULL, NULL ) == SOCKET_ERROR )
+	{
+		return( ( WSAGetLastError() == WSAEWOULDBLOCK ) ? 0 : -1 );
+	}
+	iSent = (int) dwSent;
+#else
+	struct iovec Bufs[ NET_SEND_IOV ];
+	int iCount = 0;
+	for ( CNetSegment * pSeg = m_pHead; pSeg != NULL && iCount < NET_SEND_IOV; pSeg = pSeg->m_pNext )
+	{
+		Bufs[iCount].iov_base = (void *)( pSeg->m_Data + pSeg->m_iStart );
+		Bufs[iCount].iov_len = pSeg->m_iEnd - pSeg->m_iStart;
+		iCount++;
+	}
+	if ( ! iCount )
+		return( 0 );
+	struct msghdr msg;
+	memset( &msg, 0, sizeof(msg));
+	msg.msg_iov = Bufs;
+	msg.msg_iovlen = iCount;
+	iSent = sendmsg( pSocket->GetSocket(), &msg, MSG_DONTWAIT | MSG_NOSIGNAL );
+	if ( iSent < 0 )
+	{
+		return( ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ) ? 0 : -1 );
+	}
+#endif
+
+	// Drop what went out.
+	m_iBytes -= iSent;
+	int iLeft = iSent;
+	while ( iLeft > 0 )
+	{
+		CNetSegment * pSeg = m_pHead;
+		ASSERT( pSeg );
+		int iUsed = pSeg->m_iEnd - pSeg->m_iStart;
+		if ( iLeft < iUsed )
+		{
+			pSeg->m_iStart += iLeft;
+			break;
+		}
+		iLeft -= iUsed;
+		m_pHead = pSeg->m_pNext;
+		pSeg->m_pNext = NULL;
+		g_NetSegments.Free( pSeg );
+	}
+	if ( m_pHead == NULL )
+	{
+		m_pTail = NULL;
+	}
+	return( iSent );
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetRing
+
+CNetRing::CNetRing( size_t iSize ) :
+	m_iHead(0),
+	m_iTail(0)
+{
+	size_t iSizeP2 = 1;
+	while ( iSizeP2 < iSize )
+		iSizeP2 <<= 1;
+	m_pData = new BYTE [ iSizeP2 ];
+	m_iMask = iSizeP2 - 1;
+}
+
+CNetRing::~CNetRing()
+{
+	delete [] m_pData;
+}
+
+size_t CNetRing::Write( const void * pData, size_t iLen )
+{
+	// RETURN: bytes written. (may be less than asked if we are full)
+	size_t iHead = m_iHead.load( std::memory_order_relaxed );
+	size_t iTail = m_iTail.load( std::memory_order_acquire );
+	size_t iFree = GetSize() - ( iHead - iTail );
+	if ( iLen > iFree )
+		iLen = iFree;
+	if ( ! iLen )
+		return( 0 );
+
+	size_t iOffset = iHead & m_iMask;
+	size_t iFirst = GetSize() - iOffset;
+	if ( iFirst > iLen )
+		iFirst = iLen;
+	memcpy( m_pData + iOffset, pData, iFirst );
+	memcpy( m_pData, ((const BYTE *) pData ) + iFirst, iLen - iFirst );
+
+	m_iHead.store( iHead + iLen, std::memory_order_release );
+	return( iLen );
+}
+
+size_t CNetRing::Read( void * pData, size_t iLen )
+{
+	// RETURN: bytes read.
+	size_t iTail = m_iTail.load( std::memory_order_relaxed );
+	size_t iHead = m_iHead.load( std::memory_order_acquire );
+	size_t iUsed = iHead - iTail;
+	if ( iLen > iUsed )
+		iLen = iUsed;
+	if ( ! iLen )
+		return( 0 );
+
+	size_t iOffset = iTail & m_iMask;
+	size_t iFirst = GetSize() - iOffset;
+	if ( iFirst > iLen )
+		iFirst = iLen;
+	memcpy( pData, m_pData + iOffset, iFirst );
+	memcpy( ((BYTE *) pData ) + iFirst, m_pData, iLen - iFirst );
+
+	m_iTail.store( iTail + iLen, std::memory_order_release );
+	return( iLen );
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetRecvBuf
+
+CNetRecvBuf::CNetRecvBuf( int iSize, int iSizeMax, int iPacketMax )
+{
+	ASSERT( iSize > 0 && iSize <= iSizeMax );
+	m_iSizeMax = iSizeMax;
+	m_iPacketMax = iPacketMax;
+	m_iHead = 0;
+	m_iLen = 0;
+	m_iSize = 1;
+	while ( m_iSize < iSize )
+		m_iSize <<= 1;
+	m_pData = new BYTE [ m_iSize + GetExtra() ];
+}
+
+CNetRecvBuf::~CNetRecvBuf()
+{
+	delete [] m_pData;
+}
+
+void CNetRecvBuf::SetSize( int iSize )
+{
+	// Bigger buffer. The data moves to the front of it, so m_iHead = 0.
+	ASSERT( iSize >= m_iLen );
+	int iExtra = ( iSize < m_iPacketMax ) ? iSize : m_iPacketMax;
+	BYTE * pData = new BYTE [ iSize + iExtra ];
+	int iFirst = min( m_iLen, m_iSize - m_iHead );
+	memcpy( pData, m_pData + m_iHead, iFirst );
+	memcpy( pData + iFirst, m_pData, m_iLen - iFirst );
+	delete [] m_pData;
+	m_pData = pData;
+	m_iSize = iSize;
+	m_iHead = 0;
+}
+
+bool CNetRecvBuf::IsWhole( int iLen )
+{
+	ASSERT( iLen > 0 && iLen <= m_iPacketMax );
+	if ( m_iLen < iLen )
+		return( false );
+	int iWrap = m_iHead + iLen - m_iSize;
+	if ( iWrap > 0 )
+	{
+		memcpy( m_pData + m_iSize, m_pData, iWrap );
+	}
+	return( true );
+}
+
+void CNetRecvBuf::Skip( int iLen )
+{
+	// Just step over it. no copy.
+	ASSERT( iLen >= 0 && iLen <= m_iLen );
+	m_iLen -= iLen;
+	if ( ! m_iLen )
+		m_iHead = 0;	// start over at the front. so we rarely wrap.
+	else
+		m_iHead = ( m_iHead + iLen ) & ( m_iSize - 1 );
+}
+
+BYTE * CNetRecvBuf::GetTail( int & iRoom )
+{
+	// Up to the end of the buffer. Call again after AddTail() for the wrapped part.
+	// NOTE: May move the data. GetHead() is not the same after this.
+	if ( m_iLen >= m_iSize && m_iSize < m_iSizeMax )
+	{
+		SetSize( m_iSize << 1 );
+	}
+	int iTail = ( m_iHead + m_iLen ) & ( m_iSize - 1 );
+	iRoom = min( m_iSize - m_iLen, m_iSize - iTail );
+	return( m_pData + iTail );
+}
+
+void CNetRecvBuf::AddTail( int iLen )
+{
+	ASSERT( iLen >= 0 && m_iLen + iLen <= m_iSize );
+	m_iLen += iLen;
+}
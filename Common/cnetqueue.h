@@ -0,0 +1,275 @@
+//
+// CNetQueue.h
+//
+// Outbound data queues for the client sockets.
+// Packets shared by many clients.
+// The byte ring between a CNetThread and the main loop.
+// The input buffer of a client.
+//
+
+#ifndef _INC_CNETQUEUE_H
+#define _INC_CNETQUEUE_H
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/uio.h>
+#endif
+
+#ifndef MSG_DONTWAIT
+#define MSG_DONTWAIT	0	// _WIN32 client sockets are already FIONBIO
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL	0
+#endif
+
+class CGSocket;
+
+class CNetBroadcast
+{
+	// One packet that goes to lots of clients. (speech, moves etc)
+	// Built once, Huffman coded once (the first time a game client wants it), then each client
+	// shifts the codes into its own open compressed block. (CCompressStream::AppendBits)
+	// Never changes once built.
+	// NOTE: Refcounted since a CNetThread may still be using it after the main loop is done.
+private:
+	std::atomic<int> m_iRefs;
+	int m_iLen;
+	BYTE * m_pData;
+	int m_iBitsCompressed;	// 0 = not done yet.
+	BYTE * m_pCompressed;	// no end code.
+
+private:
+	~CNetBroadcast();
+	CNetBroadcast( const CNetBroadcast & );
+	CNetBroadcast & operator=( const CNetBroadcast & );
+
+public:
+	CNetBroadcast( const void * pData, int iLen );
+
+	void AddRef()
+	{
+		m_iRefs.fetch_add( 1, std::memory_order_relaxed );
+	}
+	void Release()
+	{
+		if ( m_iRefs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+			delete this;
+	}
+
+	const BYTE * GetData() const
+	{
+		return( m_pData );
+	}
+	int GetLength() const
+	{
+		return( m_iLen );
+	}
+	bool IsSame( const void * pData, int iLen ) const
+	{
+		return( iLen == m_iLen && ! memcmp( pData, m_pData, iLen ));
+	}
+	const BYTE * GetCompressed();	// main loop only til it is built. (before it is shared)
+	int GetCompressedBits() const
+	{
+		return( m_iBitsCompressed );
+	}
+};
+
+class CNetBroadcastList
+{
+	// Give the same packet to a loop of clients.
+	// Most clients get the exact same bytes. Some get their own version. (notoriety, language etc)
+	// Keep a few versions. If there are more than that just send the rest as normal packets.
+#define NET_BROADCAST_VERSIONS	4
+private:
+	CNetBroadcast * m_pPackets[ NET_BROADCAST_VERSIONS ];
+	int m_iQty;
+
+private:
+	CNetBroadcastList( const CNetBroadcastList & );
+	CNetBroadcastList & operator=( const CNetBroadcastList & );
+
+public:
+	CNetBroadcastList()
+	{
+		m_iQty = 0;
+	}
+	~CNetBroadcastList()
+	{
+		for ( int i=0; i<m_iQty; i++ )
+		{
+			m_pPackets[i]->Release();
+		}
+	}
+	CNetBroadcast * Get( const void * pData, int iLen );	// NULL = just send it normally.
+};
+
+#define NET_SEGMENT_SIZE	0x2000	// bytes in a CNetSegment.
+
+struct CNetSegment
+{
+	// A piece of a CNetSendQueue.
+	CNetSegment * m_pNext;
+	int m_iStart;	// first byte not sent yet.
+	int m_iEnd;		// bytes filled.
+	BYTE m_Data[ NET_SEGMENT_SIZE ];
+};
+
+class CNetSegmentPool
+{
+	// Where all the CNetSendQueue segments come from. Shared by the main loop and the CNetThreads.
+	// Allocated a slab at a time and kept for reuse. (never given back to the heap)
+private:
+	std::mutex m_Lock;
+	CNetSegment * m_pFree;
+	std::vector<CNetSegment *> m_Slabs;
+	int m_iTotal;
+	int m_iUsed;
+
+public:
+	CNetSegmentPool();
+	~CNetSegmentPool();
+
+	CNetSegment * Alloc();
+	void Free( CNetSegment * pHead );	// the whole chain.
+	int GetTotal() const
+	{
+		return( m_iTotal );
+	}
+	int GetUsed() const
+	{
+		return( m_iUsed );
+	}
+};
+
+extern CNetSegmentPool g_NetSegments;
+
+class CNetSendQueue
+{
+	// Data waiting for a socket to take it. A chain of CNetSegment, no size limit.
+	// NOTE: Not thread safe. Used by the main loop or by one CNetThread, not both.
+private:
+	CNetSegment * m_pHead;
+	CNetSegment * m_pTail;
+	int m_iBytes;
+
+private:
+	CNetSendQueue( const CNetSendQueue & );
+	CNetSendQueue & operator=( const CNetSendQueue & );
+
+public:
+	CNetSendQueue();
+	~CNetSendQueue();
+
+	int GetBytes() const
+	{
+		return( m_iBytes );
+	}
+	bool IsEmpty() const
+	{
+		return( m_pHead == NULL );
+	}
+	void Empty();
+	void Append( const BYTE * pData, int iLen );
+	void Take( CNetSendQueue & queue );	// move all of queue to the end of this.
+	int Read( void * pData, int iLen );	// take bytes off the front.
+	int Flush( CGSocket * pSocket );
+};
+
+class CNetRing
+{
+	// Lock free byte queue. Exactly one thread writes and exactly one other thread reads.
+	// NOTE: a single Write() becomes visible to the reader all at once.
+private:
+	BYTE * m_pData;
+	size_t m_iMask;		// size-1. size is a power of 2.
+	std::atomic<size_t> m_iHead;	// total bytes written. (only the writer changes this)
+	std::atomic<size_t> m_iTail;	// total bytes read. (only the reader changes this)
+
+private:
+	CNetRing( const CNetRing & );
+	CNetRing & operator=( const CNetRing & );
+
+public:
+	explicit CNetRing( size_t iSize );
+	~CNetRing();
+
+	size_t GetSize() const
+	{
+		return( m_iMask + 1 );
+	}
+	size_t GetUsed() const
+	{
+		return( m_iHead.load( std::memory_order_acquire ) - m_iTail.load( std::memory_order_acquire ));
+	}
+	size_t GetFree() const
+	{
+		return( GetSize() - GetUsed());
+	}
+
+	size_t Write( const void * pData, size_t iLen );	// writer thread only.
+	size_t Read( void * pData, size_t iLen );			// reader thread only.
+};
+
+class CNetRecvBuf
+{
+	// The input buffer of one client. Circular, but the current packet is always contiguous.
+	// If a packet wraps the end, IsWhole() copies the wrapped part to the extra space past the end.
+	// Starts small and doubles (up to iSizeMax) when a read finds it full.
+private:
+	BYTE * m_pData;		// m_iSize + GetExtra()
+	int m_iSize;		// power of 2.
+	int m_iSizeMax;
+	int m_iPacketMax;	// biggest packet IsWhole() will take.
+	int m_iHead;		// offset of the current packet.
+	int m_iLen;			// bytes we have not processed yet. starting at m_iHead.
+
+private:
+	CNetRecvBuf( const CNetRecvBuf & );
+	CNetRecvBuf & operator=( const CNetRecvBuf & );
+
+	int GetExtra() const
+	{
+		// A wrapped packet has at most min(size,packet)-1 bytes at the front.
+		return( ( m_iSize < m_iPacketMax ) ? m_iSize : m_iPacketMax );
+	}
+	void SetSize( int iSize );
+
+public:
+	CNetRecvBuf( int iSize, int iSizeMax, int iPacketMax );
+	~CNetRecvBuf();
+
+	int GetSize() const
+	{
+		return( m_iSize );
+	}
+	int GetLength() const
+	{
+		return( m_iLen );
+	}
+	int GetFree() const
+	{
+		return( m_iSizeMax - m_iLen );
+	}
+	BYTE * GetHead() const
+	{
+		return( m_pData + m_iHead );
+	}
+	void Empty()
+	{
+		m_iHead = 0;
+		m_iLen = 0;
+	}
+
+	bool IsWhole( int iLen );	// iLen bytes at GetHead() ?
+	void Skip( int iLen );		// done with the current packet.
+
+	BYTE * GetTail( int & iRoom );	// where the next read goes. 0 = full.
+	void AddTail( int iLen );		// iLen bytes were put at GetTail().
+};
+
+#endif	// _INC_CNETQUEUE_H
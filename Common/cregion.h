@@ -11,6 +11,7 @@
 
 #include "carray.h"
 #include "cscript.h"
+#include "cspatial.h"
 
 class CRegionBase;
 class CSector;
@@ -654,7 +655,7 @@ public:
 	}
 };
 
-class CObjBaseTemplate : public CGObListRec
+class CObjBaseTemplate : public CGObListRec, public CSpatialRec
 {
 	// A dynamic object of some sort.
 private:
@@ -674,6 +675,7 @@ protected:
 		// NOTE: Never copy m_UID
 		m_sName = pObj->m_sName;
 		m_p = pObj->m_p;
+		OnPointChange();
 	}
 
 	void SetPrivateUID(UINT dwIndex )
@@ -683,10 +685,17 @@ protected:
 	void SetUnkPoint( TCHAR * pszScript )
 	{
 		m_p.Read( pszScript );
+		OnPointChange();
 	}
 	void SetUnkZ( signed char z )
 	{
 		m_p.m_z = z;
+		OnPointChange();
+	}
+	void OnPointChange()
+	{
+		// Keep the sector CSpatialArray we are in the same as m_p.
+		SpatialMove( m_p.m_x, m_p.m_y, m_p.m_z );
 	}
 
 public:
@@ -781,6 +790,7 @@ public:
 		m_p.m_x = 0;	// these don't apply.
 		m_p.m_y = 0;
 		m_p.m_z	= layer; // layer equipped.
+		OnPointChange();
 	}
 
 	BYTE GetContainedLayer() const
@@ -796,6 +806,7 @@ public:
 		DEBUG_CHECK( IsItem());
 		DEBUG_CHECK( IsInContainer());
 		m_p.m_z = layer;
+		OnPointChange();
 	}
 	const CPointMap & GetContainedPoint() const
 	{
@@ -810,6 +821,7 @@ public:
 		m_p.m_x = pt.m_x;
 		m_p.m_y = pt.m_y;
 		m_p.m_z = LAYER_NONE;
+		OnPointChange();
 	}
 
 	void SetTopPoint( const CPointMap & pt )
@@ -817,6 +829,7 @@ public:
 		SetContainerFlags(0);
 		ASSERT( pt.IsValid() );	// already checked b4.
 		m_p = pt;
+		OnPointChange();
 	}
 	const CPointMap & GetTopPoint() const
 	{
@@ -827,6 +840,7 @@ public:
 	{
 		DEBUG_CHECK( IsTopLevel() || IsDisconnected());
 		m_p.m_z = z;
+		OnPointChange();
 	}
 	signed char GetTopZ() const
 	{
@@ -837,6 +851,7 @@ public:
 	void SetUnkPoint( const CPointMap & pt )
 	{
 		m_p = pt;
+		OnPointChange();
 	}
 	const CPointMap & GetUnkPoint() const
 	{
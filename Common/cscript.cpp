@@ -12,6 +12,8 @@
 #endif
 
 #include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 int CScriptObj::sm_iTrigArg;			// a modifying arg to the current trigger.
 
@@ -33,12 +35,17 @@ bool CScript::CFileTextStreamAdapter::Seek( long offset, int origin )
 	return m_Script.CFileText::Seek( offset, origin );
 }
 
-CScript::CScript() : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false )
+long CScript::CFileTextStreamAdapter::Tell() const
+{
+	return (long) m_Script.CFileText::GetPosition();
+}
+
+CScript::CScript() : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false ), m_pIndex( NULL )
 {
 	Init();
 }
 
-CScript::CScript( const TCHAR * pKey ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false )
+CScript::CScript( const TCHAR * pKey ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false ), m_pIndex( NULL )
 {
 	Init();
 	m_Buffer.Copy( pKey );
@@ -46,22 +53,16 @@ CScript::CScript( const TCHAR * pKey ) : m_DefaultStream( *this ), m_pStream( &m
 	GetArgNextStr();
 }
 
-CScript::CScript( IScriptTextStream * pStream, bool fTakeOwnership ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false )
+CScript::CScript( IScriptTextStream * pStream, bool fTakeOwnership ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false ), m_pIndex( NULL )
 {
 	Init();
 	AttachStream( pStream, fTakeOwnership );
 }
 
-CScript::CScript( const TCHAR * pszKey, const TCHAR * pVal ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false )
+CScript::CScript( const TCHAR * pszKey, const TCHAR * pVal ) : m_DefaultStream( *this ), m_pStream( &m_DefaultStream ), m_fOwnStream( false ), m_pIndex( NULL )
 {
 	Init();
-	int lenkey = strlen( pszKey );
-	int lenval = pVal ? strlen( pVal ) : 0;
-	ASSERT( lenkey+lenval+1 < MAX_SCRIPT_LINE_LEN );
-	m_pArg = m_Buffer.GetBuffer( MAX_SCRIPT_LINE_LEN );	// lenkey+lenval+1
-	strcpy( m_pArg, pszKey );
-	m_pArg += lenkey+1;
-	if ( pVal ) strcpy( m_pArg, pVal );
+	SetKeyArg( pszKey, pVal );
 }
 
 CScript::~CScript()
@@ -160,8 +161,20 @@ bool CScript::OpenCopy( const CScript & s, WORD wFlags )
 	DEBUG_CHECK( s.IsFileOpen());
 	Init();
 	AttachStream( NULL );
-	if ( ! CGFile::OpenCopy( s, wFlags ))
+	if ( s.IsImage())
+	{
+		// Our own place in the same memory. No handle to share.
+		Close();
+		m_sFileName = s.m_sFileName;
+		SetMode( wFlags );
+		m_ImageStream.Open( s.m_ImageStream.GetImage());
+		AttachStream( &m_ImageStream );
+	}
+	else if ( ! CGFile::OpenCopy( s, wFlags ))
+	{
 		return( false );
+	}
+	m_pIndex = s.m_pIndex;	// after. the Close() in there drops it.
 	m_Buffer.SetLength( MAX_SCRIPT_LINE_LEN );
 	return( true );
 }
@@ -174,6 +187,8 @@ bool CScript::Open( const TCHAR *pszFilename, WORD wFlags )
 
 	Init();
 	AttachStream( NULL );
+	m_ImageStream.Close();
+	m_pIndex = NULL;
 	m_Buffer.SetLength( MAX_SCRIPT_LINE_LEN );
 
 	if ( pszFilename == NULL )
@@ -209,6 +224,28 @@ bool CScript::Open( const TCHAR *pszFilename, WORD wFlags )
 	return( true );
 }
 
+bool CScript::LoadImage()
+{
+	// Read the open file into memory. All reads come from there now.
+	// Already an image = read it again. Copies open now keep the old one.
+	// RETURN: false = still the old way.
+
+	if ( ! IsFileOpen() || IsWriteMode() || IsBinaryMode())
+		return( false );
+
+	std::shared_ptr<CScriptImage> pImage( new CScriptImage );
+	if ( ! pImage->Load( GetFilePath()))
+		return( false );
+
+	AttachStream( NULL );
+	m_ImageStream.Close();
+	CFileText::Close();	// don't need the handle.
+	Init();
+	m_ImageStream.Open( pImage );
+	AttachStream( &m_ImageStream );
+	return( true );
+}
+
 bool CScript::ReadTextLine( bool fRemoveBlanks ) // Read a line from the opened script file
 {
         ASSERT( ! IsBinaryMode());
@@ -466,7 +503,18 @@ bool CScript::FindSection( const TCHAR *pszName, WORD wModeFlags, CScriptLink *p
 	{
 		CGString sSec;
 		sSec.Format( "[%s]", pszName );
-		if ( FindTextHeader( sSec, pPrev, wModeFlags ))
+		if ( m_pIndex != NULL && m_pIndex->CanFind( sSec ))
+		{
+			// Go right to it.
+			CScriptIndexRec rec;
+			if ( m_pIndex->Find( sSec, ( pPrev ) ? (long) pPrev->GetLinkOffset() : 0, rec ) &&
+				SeekLine( rec.m_lOffset, rec.m_iLineNum ))
+			{
+				strcpy( GetKey(), sSec );	// as if we just read the header.
+				return( true );
+			}
+		}
+		else if ( FindTextHeader( sSec, pPrev, wModeFlags ))
 		{
 			// Success
 			m_lSectionData = GetPosition();
@@ -537,6 +585,20 @@ bool CScript::ReadKeyParse() // Read line from script
 	return( true );
 }
 
+void CScript::SetKeyArg( const TCHAR * pszKey, const TCHAR * pVal )
+{
+	int lenkey = strlen( pszKey );
+	int lenval = pVal ? strlen( pVal ) : 0;
+	ASSERT( lenkey+lenval+1 < MAX_SCRIPT_LINE_LEN );
+	m_pArg = m_Buffer.GetBuffer( MAX_SCRIPT_LINE_LEN );	// lenkey+lenval+1
+	strcpy( m_pArg, pszKey );
+	m_pArg += lenkey+1;
+	if ( pVal )
+		strcpy( m_pArg, pVal );
+	else
+		m_pArg[0] = '\0';
+}
+
 TCHAR * CScript::GetArgNextStr()
 {
 	Parse( m_pArg, &m_pArg );
@@ -819,6 +881,8 @@ bool CScript::Close()
 {
 	EndSection();
 	AttachStream( NULL );
+	m_ImageStream.Close();	// before. CFileText thinks an image is an open file.
+	m_pIndex = NULL;
 	return CFileText::Close();
 }
 
@@ -909,6 +973,219 @@ void _cdecl CScript::WriteKeyFormat( const TCHAR * pszKey, const TCHAR * pszVal,
 	WriteKey( pszKey, sTmp );
 }
 
+///////////////////////////////////////////////////////////////
+// -CScriptImage
+
+void CScriptImage::GetFileStamp( const TCHAR * pszFilePath, DWORD & dwSize, time_t & FileTime ) // static
+{
+	struct stat st;
+	if ( pszFilePath == NULL || pszFilePath[0] == '\0' || stat( pszFilePath, &st ) != 0 )
+	{
+		dwSize = 0;
+		FileTime = 0;
+		return;
+	}
+	dwSize = (DWORD) st.st_size;
+	FileTime = st.st_mtime;
+}
+
+bool CScriptImage::Load( const TCHAR * pszFilePath )
+{
+	// Read all of it. Raw bytes. ReadTextLine() trims the CR off a CR LF.
+	GetFileStamp( pszFilePath, m_dwFileSize, m_FileTime );
+
+	FILE * pFile = fopen( pszFilePath, "rb" );
+	if ( pFile == NULL )
+		return( false );
+	m_Text.clear();
+	m_Text.reserve( m_dwFileSize );
+	TCHAR szTmp[ 16*1024 ];
+	while ( true )
+	{
+		size_t iLen = fread( szTmp, 1, sizeof(szTmp), pFile );
+		if ( iLen <= 0 )
+			break;
+		m_Text.insert( m_Text.end(), szTmp, szTmp + iLen );
+	}
+	bool fError = ( ferror( pFile ) != 0 );
+	fclose( pFile );
+	return( ! fError );
+}
+
+TCHAR * CScriptImageStream::ReadLine( TCHAR FAR * pBuffer, size_t sizemax )
+{
+	// Same as fgets(). Up to the newline (kept) or sizemax-1 chars.
+	if ( pBuffer == NULL || sizemax <= 0 || ! IsOpen())
+		return( NULL );
+	size_t iSize = m_pImage->GetSize();
+	if ( m_Pos >= iSize )
+		return( NULL );
+
+	const TCHAR * pText = m_pImage->GetText() + m_Pos;
+	size_t iMax = min( sizemax - 1, iSize - m_Pos );
+	const TCHAR * pEnd = (const TCHAR *) memchr( pText, '\n', iMax );
+	size_t iLen = ( pEnd ) ? ( pEnd - pText + 1 ) : iMax;
+	memcpy( pBuffer, pText, iLen );
+	pBuffer[iLen] = '\0';
+	m_Pos += iLen;
+	return( pBuffer );
+}
+
+bool CScriptImageStream::Write( const void FAR *, size_t )
+{
+	// Read only.
+	return( false );
+}
+
+bool CScriptImageStream::Seek( long offset, int origin )
+{
+	if ( ! IsOpen())
+		return( false );
+	long lBase = 0;
+	switch ( origin )
+	{
+	case SEEK_SET:
+		break;
+	case SEEK_CUR:
+		lBase = (long) m_Pos;
+		break;
+	case SEEK_END:
+		lBase = (long) m_pImage->GetSize();
+		break;
+	default:
+		return( false );
+	}
+	long lPos = lBase + offset;
+	if ( lPos < 0 )
+		return( false );
+	m_Pos = min( (size_t) lPos, m_pImage->GetSize());	// same as past the end of a file.
+	return( true );
+}
+
+long CScriptImageStream::Tell() const
+{
+	if ( ! IsOpen())
+		return( -1 );
+	return( (long) m_Pos );
+}
+
+///////////////////////////////////////////////////////////////
+// -CScriptIndex
+
+void CScriptIndex::GetStamp( const CScript & s, DWORD & dwSize, time_t & FileTime ) // static
+{
+	// What we would be reading. An image may be older than the file.
+	const CScriptImage * pImage = s.GetImage();
+	if ( pImage )
+	{
+		pImage->GetStamp( dwSize, FileTime );
+		return;
+	}
+	CScriptImage::GetFileStamp( s.GetFilePath(), dwSize, FileTime );
+}
+
+void CScriptIndex::Empty()
+{
+	m_Sections.clear();
+	m_fBuilt = false;
+	m_iRecs = 0;
+	m_sFilePath.Empty();
+	m_dwFileSize = 0;
+	m_FileTime = 0;
+}
+
+bool CScriptIndex::Build( CScript & s )
+{
+	// Read every header in the file. s = a copy we can move around in.
+	// RETURN: false = can't index it. (just scan it then)
+
+	Empty();
+	if ( s.IsBinaryMode())
+		return( false );
+
+	m_sFilePath = s.GetFilePath();
+	GetStamp( s, m_dwFileSize, m_FileTime );
+
+	if ( ! s.SeekLine( 0, 0 ))
+		return( false );
+	while ( s.ReadTextLine( true ))
+	{
+		const TCHAR * pszKey = s.GetKey();
+		if ( pszKey[0] != '[' )
+			continue;
+		if ( ! strnicmp( pszKey, "[EOF]", 5 ))
+			break;
+		const TCHAR * pszEnd = strchr( pszKey, ']' );
+		if ( pszEnd == NULL )
+			continue;	// FindTextHeader() could never match this.
+
+		std::string sName( pszKey, pszEnd - pszKey + 1 );
+		for ( size_t i=0; i<sName.size(); i++ )
+		{
+			sName[i] = toupper( sName[i] );
+		}
+		CScriptIndexRec rec;
+		rec.m_lOffset = s.GetPosition();
+		rec.m_iLineNum = s.GetLineNumber();
+		m_Sections[ sName ].push_back( rec );
+		m_iRecs ++;
+	}
+
+	m_fBuilt = true;
+	m_iBuilds ++;
+	return( true );
+}
+
+bool CScriptIndex::IsChanged( const CScript & s ) const
+{
+	if ( ! m_fBuilt )
+		return( true );
+	if ( strcmpi( m_sFilePath, s.GetFilePath()))
+		return( true );
+	DWORD dwSize;
+	time_t FileTime;
+	GetStamp( s, dwSize, FileTime );
+	return( dwSize != m_dwFileSize || FileTime != m_FileTime );
+}
+
+bool CScriptIndex::CanFind( const TCHAR * pszHeader ) const
+{
+	// A ']' inside the name would match past our key. Let the scan do those.
+	if ( ! m_fBuilt )
+		return( false );
+	const TCHAR * pszEnd = strchr( pszHeader, ']' );
+	return( pszEnd != NULL && pszEnd[1] == '\0' );
+}
+
+bool CScriptIndex::Find( const TCHAR * pszHeader, long lStart, CScriptIndexRec & rec )
+{
+	// The first header at or after lStart. (same as a scan from there)
+	// lStart = 0 or the data offset of a previous section.
+	m_dwLookups ++;
+
+	std::string sName( pszHeader );
+	for ( size_t i=0; i<sName.size(); i++ )
+	{
+		sName[i] = toupper( sName[i] );
+	}
+	std::unordered_map< std::string, std::vector<CScriptIndexRec> >::const_iterator it = m_Sections.find( sName );
+	if ( it != m_Sections.end())
+	{
+		const std::vector<CScriptIndexRec> & recs = it->second;
+		for ( size_t i=0; i<recs.size(); i++ )
+		{
+			if ( recs[i].m_lOffset > lStart )
+			{
+				rec = recs[i];
+				m_dwHits ++;
+				return( true );
+			}
+		}
+	}
+	m_dwMisses ++;
+	return( false );
+}
+
 #ifndef _AFXDLL
 
 //***************************************************************************
@@ -939,8 +1216,12 @@ bool CScriptLock::OpenCopy( const CScript & s, WORD uFlags )
 	if ( ! CScript::OpenCopy( s, uFlags ))
 		return( false );
 
-	m_lPrvOffset = s.GetPosition();
-	DEBUG_CHECK( m_lPrvOffset >= 0 );
+	if ( ! IsImage())
+	{
+		// We share the file handle. Put it back where it was when done.
+		m_lPrvOffset = s.GetPosition();
+		DEBUG_CHECK( m_lPrvOffset >= 0 );
+	}
 
 #ifdef GRAY_SVR
 	// Assume this is the new context !
@@ -989,6 +1270,260 @@ bool CScriptLock::FindSection( const TCHAR *pszName, WORD wModeFlags, CScriptLin
 
 #endif // GRAY_SVR
 
+///////////////////////////////////////////////////////////////
+// -CScriptCompiled
+
+static TRIGOP_TYPE GetTrigOp( const TCHAR * pszKey )
+{
+	// Same tests and order as CScriptObj::OnTriggerRun()
+	if ( ! strnicmp( pszKey, "ON", 2 ))
+		return( TRIGOP_ON );
+	if ( ! strcmpi( pszKey, "ENDIF" ) || ! strcmpi( pszKey, "END" ) || ! strcmpi( pszKey, "ENDFOR" ))
+		return( TRIGOP_ENDIF );
+	if ( ! strcmpi( pszKey, "ELSE" ))
+		return( TRIGOP_ELSE );
+	if ( ! strcmpi( pszKey, "ELIF" ) || ! strcmpi( pszKey, "ELSEIF" ))
+		return( TRIGOP_ELIF );
+	if ( ! strcmpi( pszKey, "IF" ))
+		return( TRIGOP_IF );
+	if ( ! strcmpi( pszKey, "BEGIN" ))
+		return( TRIGOP_BEGIN );
+	if ( ! strcmpi( pszKey, "RETURN" ))
+		return( TRIGOP_RETURN );
+	if ( ! strcmpi( pszKey, "FOROBJS" ))
+		return( TRIGOP_FOROBJS );
+	if ( ! strcmpi( pszKey, "FORITEMS" ))
+		return( TRIGOP_FORITEMS );
+	if ( ! strcmpi( pszKey, "FORCHARS" ))
+		return( TRIGOP_FORCHARS );
+	if ( ! strcmpi( pszKey, "DORAND" ))
+		return( TRIGOP_DORAND );
+	if ( ! strcmpi( pszKey, "ENDDO" ) || ! strcmpi( pszKey, "ENDRAND" ))
+		return( TRIGOP_ENDDO );
+	return( TRIGOP_VERB );
+}
+
+int CScriptCompiled::AddText( const TCHAR * pszText )
+{
+	int i = (int) m_Text.size();
+	if ( pszText == NULL )
+		pszText = "";
+	m_Text.insert( m_Text.end(), pszText, pszText + strlen( pszText ) + 1 );
+	return( i );
+}
+
+int CScriptCompiled::AddExpr( const TCHAR * pszText )
+{
+	CExprProg * pExpr = new CExprProg;
+	g_Exp.Compile( *pExpr, pszText );
+	m_Exprs.push_back( pExpr );
+	return( (int) m_Exprs.size() - 1 );
+}
+
+void CScriptCompiled::Empty()
+{
+	m_Lines.clear();
+	m_Triggers.clear();
+	m_Text.clear();
+	for ( size_t i=0; i<m_Exprs.size(); i++ )
+	{
+		delete m_Exprs[i];
+	}
+	m_Exprs.clear();
+}
+
+void CScriptCompiled::SetFalseEnds()
+{
+	// A false section reads lines, counting IF/BEGIN levels, til it hits ON,
+	// or ENDIF, ELSE, ELIF at its own level. Work out that line for every start at once.
+	// Starts that are still looking, deepest on top. (level they started at)
+	std::vector< std::pair<int,int> > Pending;
+	int iLevel = 0;
+	int iQty = GetLineCount();
+	for ( int i=0; i<iQty; i++ )
+	{
+		Pending.push_back( std::pair<int,int>( i, iLevel ));
+		switch ( GetOp(i))
+		{
+		case TRIGOP_ON:
+			for ( ; ! Pending.empty(); Pending.pop_back())
+			{
+				m_Lines[ Pending.back().first ].m_iFalseEnd = i;
+			}
+			iLevel = 0;
+			break;
+		case TRIGOP_ENDIF:
+		case TRIGOP_ELSE:
+		case TRIGOP_ELIF:
+			for ( ; ! Pending.empty() && Pending.back().second == iLevel; Pending.pop_back())
+			{
+				m_Lines[ Pending.back().first ].m_iFalseEnd = i;
+			}
+			if ( GetOp(i) == TRIGOP_ENDIF )
+				iLevel --;
+			break;
+		case TRIGOP_IF:
+		case TRIGOP_BEGIN:
+			iLevel ++;
+			break;
+		default:
+			break;
+		}
+	}
+	for ( ; ! Pending.empty(); Pending.pop_back())
+	{
+		m_Lines[ Pending.back().first ].m_iFalseEnd = iQty;
+	}
+}
+
+bool CScriptCompiled::Compile( CScript & s )
+{
+	Empty();
+
+	while ( s.ReadKeyParse())
+	{
+		CScriptCompiledLine line;
+		line.m_Op = GetTrigOp( s.GetKey());
+		line.m_iFalseEnd = -1;
+		line.m_iKey = AddText( s.GetKey());
+		line.m_iArg = AddText( s.GetArgStr());
+		line.m_iExpr = -1;
+		switch ( line.m_Op )
+		{
+		case TRIGOP_IF:
+		case TRIGOP_ELIF:
+		case TRIGOP_RETURN:
+			if ( strchr( s.GetArgStr(), '<' ) == NULL )	// else ParseText() will change it.
+				line.m_iExpr = AddExpr( s.GetArgStr());
+			break;
+		case TRIGOP_DORAND:	// never gets ParseText()
+			line.m_iExpr = AddExpr( s.GetArgStr());
+			break;
+		default:
+			break;
+		}
+		if ( line.m_Op == TRIGOP_ON )
+		{
+			m_Triggers.push_back( GetLineCount());
+		}
+		m_Lines.push_back( line );
+	}
+
+	SetFalseEnds();
+	return( true );
+}
+
+long CScriptCompiled::GetArgVal( int i, CScript & s ) const
+{
+	// s.GetArgVal() for line i. (s holds the line)
+	int iExpr = m_Lines[i].m_iExpr;
+	if ( iExpr < 0 || ! g_Exp.m_fCompile )
+		return( s.GetArgVal());
+	return( g_Exp.GetProgVal( *m_Exprs[iExpr] ));
+}
+
+int CScriptCompiled::FindTrigger( const TCHAR * pszTrigName ) const
+{
+	for ( size_t i=0; i<m_Triggers.size(); i++ )
+	{
+		if ( ! strcmpi( GetArg( m_Triggers[i] ), pszTrigName ))
+			return( m_Triggers[i] );
+	}
+	return( -1 );
+}
+
+DWORD CScriptCompiled::GetTrigMask( const TCHAR * const * ppszTrigNames, int iQty ) const
+{
+	// bit i = we have a trigger for ppszTrigNames[i]
+	ASSERT( iQty <= 32 );
+	DWORD dwMask = 0;
+	for ( int i=0; i<iQty; i++ )
+	{
+		if ( FindTrigger( ppszTrigNames[i] ) >= 0 )
+			dwMask |= ( 1 << i );
+	}
+	return( dwMask );
+}
+
+size_t CScriptCompiled::GetMem() const
+{
+	return( sizeof(CScriptCompiled) +
+		m_Lines.capacity() * sizeof(CScriptCompiledLine) +
+		m_Triggers.capacity() * sizeof(int) +
+		m_Text.capacity() +
+		m_Exprs.capacity() * sizeof(CExprProg*));
+}
+
+///////////////////////////////////////////////////////////////
+// -CScriptCompiledCache
+
+CScriptCompiledCache g_ScriptCompiled;
+
+CScriptCompiledCache::~CScriptCompiledCache()
+{
+	m_iRunning = 0;
+	Clear();
+}
+
+size_t CScriptCompiledCache::GetMem() const
+{
+	size_t iMem = 0;
+	std::map< std::pair<const CScript*,long>, CScriptCompiled* >::const_iterator it;
+	for ( it = m_Sections.begin(); it != m_Sections.end(); it++ )
+	{
+		iMem += it->second->GetMem();
+	}
+	return( iMem );
+}
+
+const CScriptCompiled * CScriptCompiledCache::Get( const CScript * pScriptBase, long lOffset, CScript & s )
+{
+	// s = open at lOffset in pScriptBase. compile it if we have not already.
+	std::pair<const CScript*,long> key( pScriptBase, lOffset );
+	std::map< std::pair<const CScript*,long>, CScriptCompiled* >::iterator it = m_Sections.find( key );
+	if ( it != m_Sections.end())
+		return( it->second );
+
+	CScriptCompiled * pProg = new CScriptCompiled;
+	pProg->Compile( s );
+	m_Sections[key] = pProg;
+	return( pProg );
+}
+
+void CScriptCompiledCache::Clear()
+{
+	// The scripts have changed. Every link must compile again.
+	m_iGen ++;
+	std::map< std::pair<const CScript*,long>, CScriptCompiled* >::iterator it;
+	for ( it = m_Sections.begin(); it != m_Sections.end(); it++ )
+	{
+		m_Retired.push_back( it->second );
+	}
+	m_Sections.clear();
+	if ( ! m_iRunning )
+	{
+		DeleteRetired();
+	}
+}
+
+void CScriptCompiledCache::DeleteRetired()
+{
+	for ( size_t i=0; i<m_Retired.size(); i++ )
+	{
+		delete m_Retired[i];
+	}
+	m_Retired.clear();
+}
+
+void CScriptCompiledCache::RemoveRun()
+{
+	ASSERT( m_iRunning > 0 );
+	if ( ! -- m_iRunning )
+	{
+		DeleteRetired();
+	}
+}
+
 #endif // _AFXDLL
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -1314,6 +1849,243 @@ TRIGRET_TYPE CScriptObj::OnTriggerScript( CScript & s, const TCHAR * pTrigName,
 	return( TRIGRET_RET_FALSE );
 }
 
+#ifndef _AFXDLL
+
+#ifdef GRAY_SVR
+
+TRIGRET_TYPE CScriptObj::OnTriggerForLoop( const CScriptCompiled & prog, int & iLine, CScript &s, int iType, CTextConsole * pSrc )
+{
+	// Same as the text OnTriggerForLoop() but from compiled lines.
+	// s = the FOR line.
+
+	int iDist = s.GetArgVal();
+
+	CObjBaseTemplate * pObj = dynamic_cast <CObjBaseTemplate *>(this);
+	if ( pObj == NULL )
+	{
+		iType = 0;
+		DEBUG_ERR(( "FOR Loop trigger on non-world object '%s'\n", GetName()));
+	}
+
+	CObjBaseTemplate * pObjTop = pObj->GetTopLevelObj();
+	CPointMap pt = pObjTop->GetTopPoint();
+
+	int iStartLine = iLine;
+	int iEndLine = iStartLine;
+
+	if ( iType & 1 )
+	{
+		CWorldSearch AreaItems( pt, iDist );
+		while(true)
+		{
+			CItem * pItem = AreaItems.GetItem();
+			if ( pItem == NULL )
+				break;
+			TRIGRET_TYPE iRet = OnTriggerRun( prog, iLine, s, TRIGRUN_SECTION_TRUE, pSrc );
+			if ( iRet != TRIGRET_ENDIF )
+			{
+				return( iRet );
+			}
+			iEndLine = iLine;
+			iLine = iStartLine;
+		}
+	}
+	if ( iType & 2 )
+	{
+		CWorldSearch AreaChars( pt, iDist );
+		while(true)
+		{
+			CChar * pChar = AreaChars.GetChar();
+			if ( pChar == NULL )
+				break;
+			TRIGRET_TYPE iRet = OnTriggerRun( prog, iLine, s, TRIGRUN_SECTION_TRUE, pSrc );
+			if ( iRet != TRIGRET_ENDIF )
+			{
+				return( iRet );
+			}
+			iEndLine = iLine;
+			iLine = iStartLine;
+		}
+	}
+
+	if ( iEndLine <= iStartLine )
+	{
+		// just skip to the end.
+		TRIGRET_TYPE iRet = OnTriggerRun( prog, iLine, s, TRIGRUN_SECTION_FALSE, pSrc );
+		if ( iRet != TRIGRET_ENDIF )
+		{
+			return( iRet );
+		}
+	}
+	else
+	{
+		iLine = iEndLine;
+	}
+	return( TRIGRET_ENDIF );
+}
+
+#endif
+
+TRIGRET_TYPE CScriptObj::OnTriggerRun( const CScriptCompiled & prog, int & iLine, CScript &s, TRIGRUN_TYPE trigrun, CTextConsole * pSrc, int iArg )
+{
+	// The text OnTriggerRun() for compiled lines. Keep the two doing the same thing !
+	// ARGS:
+	//  iLine = the next line to read.
+	//  s = holds the current line. (for r_Verb and ParseText)
+
+	sm_iTrigArg = iArg;
+
+	int iQty = prog.GetLineCount();
+	while ( true )
+	{
+		if ( trigrun == TRIGRUN_SECTION_FALSE )
+		{
+			// Ignoring this whole section. we already know where it stops.
+			iLine = prog.GetFalseEnd( iLine );
+		}
+		if ( iLine >= iQty )
+			break;
+
+		int iCur = iLine++;
+		TRIGOP_TYPE op = prog.GetOp( iCur );
+		if ( op == TRIGOP_ON )	// done with this section.
+			break;
+		if ( op == TRIGOP_ENDIF )
+			return( TRIGRET_ENDIF );
+		if ( op == TRIGOP_ELSE )
+			return( ( trigrun == TRIGRUN_SECTION_FALSE ) ? TRIGRET_ELSE : TRIGRET_ELIF_FALSE );
+		if ( op == TRIGOP_ELIF && trigrun != TRIGRUN_SECTION_FALSE )
+			return( TRIGRET_ELIF_FALSE );
+
+		s.SetKeyArg( prog.GetKey( iCur ), prog.GetArg( iCur ));
+
+#ifdef GRAY_SVR
+		if ( op == TRIGOP_FOROBJS || op == TRIGOP_FORITEMS || op == TRIGOP_FORCHARS )
+		{
+			TRIGRET_TYPE iRet = OnTriggerForLoop( prog, iLine, s,
+				( op == TRIGOP_FOROBJS ) ? 3 : (( op == TRIGOP_FORITEMS ) ? 1 : 2 ), pSrc );
+			if ( iRet != TRIGRET_ENDIF )
+			{
+				if ( iRet > TRIGRET_RET_DEFAULT )
+				{
+					DEBUG_MSG(( "WARNING: Trigger Bad For Ret %d '%s','%s'\n", iRet, s.GetKey(), s.GetArgStr())); 
+				}
+				return( iRet );
+			}
+			// The text version goes on with the line that ended the loop.
+			iCur = iLine - 1;
+			op = prog.GetOp( iCur );
+			s.SetKeyArg( prog.GetKey( iCur ), prog.GetArg( iCur ));
+		}
+		else if ( op == TRIGOP_DORAND )	// Do a random line in here.
+		{
+			int iVal = GetRandVal( prog.GetArgVal( iCur, s ));
+			while (true)
+			{
+				if ( iLine >= iQty ) 
+					return( TRIGRET_RET_DEFAULT );
+				iCur = iLine++;
+				s.SetKeyArg( prog.GetKey( iCur ), prog.GetArg( iCur ));
+				ParseText( s.GetArgStr(), pSrc );
+				if ( prog.GetOp( iCur ) == TRIGOP_ENDDO ) 
+					break;
+				if ( prog.GetOp( iCur ) == TRIGOP_BEGIN )	// do a section.
+				{
+					TRIGRET_TYPE iRet = OnTriggerRun( prog, iLine, s, (!iVal) ? TRIGRUN_SECTION_TRUE : TRIGRUN_SECTION_FALSE, pSrc, iArg );
+					if ( iRet != TRIGRET_ENDIF )
+					{
+						if ( iRet > TRIGRET_RET_DEFAULT )
+						{
+							DEBUG_MSG(( "WARNING: Trigger Bad Ret %d '%s','%s'\n", iRet, s.GetKey(), s.GetArgStr())); 
+						}
+						return( iRet );
+					}
+				}
+				else if ( ! iVal )
+				{
+					if ( ! r_Verb( s, pSrc )) 
+					{ 
+						DEBUG_MSG(( "WARNING: Trigger Bad Rand Verb '%s','%s'\n", s.GetKey(), s.GetArgStr())); 
+					}
+				}
+				iVal --;
+			}
+			continue;
+		}
+#endif
+
+		// Parse out any variables in it. (may act like a verb sometimes)
+		ParseText( s.GetArgStr(), pSrc );
+
+		if ( op == TRIGOP_ELIF )
+		{
+			return( prog.GetArgVal( iCur, s ) ? TRIGRET_ELSE : TRIGRET_ELIF_FALSE );
+		}
+
+		// Process the trigger.
+		if ( op == TRIGOP_RETURN )
+		{
+			return( prog.GetArgVal( iCur, s ) ? TRIGRET_RET_TRUE : TRIGRET_RET_FALSE );
+		}
+
+		if ( op == TRIGOP_IF )
+		{
+			bool fTrigger = prog.GetArgVal( iCur, s ) ? true : false;
+			bool fBeenTrue = false;
+			while (true)
+			{
+				TRIGRET_TYPE iRet = OnTriggerRun( prog, iLine, s, fTrigger ? TRIGRUN_SECTION_TRUE : TRIGRUN_SECTION_FALSE, pSrc, iArg );
+				if ( iRet < TRIGRET_ENDIF ) 
+					return( iRet );
+				if ( iRet == TRIGRET_ENDIF ) 
+					break;
+				fBeenTrue |= fTrigger;
+				if ( iRet == TRIGRET_ELSE ) 
+					fTrigger = ! fBeenTrue;
+				else 
+					fTrigger = false; 
+			}
+			continue;
+		}
+
+		if ( ! r_Verb( s, pSrc )) 
+		{ 
+			DEBUG_MSG(( "WARNING: Trigger Bad Verb '%s','%s'\n", s.GetKey(), s.GetArgStr())); 
+		}
+	}
+
+	return( TRIGRET_RET_DEFAULT );
+}
+
+TRIGRET_TYPE CScriptObj::OnTriggerScript( const CScriptCompiled * pProg, const TCHAR * pTrigName, CTextConsole * pSrc, int iArg )
+{
+	// look for exact trigger matches in a compiled section.
+
+	if ( pProg == NULL )
+		return( TRIGRET_RET_FALSE );
+	int iLine = pProg->FindTrigger( pTrigName );
+	if ( iLine < 0 )
+		return( TRIGRET_RET_FALSE );
+	iLine ++;
+
+	CScript s;
+	g_ScriptCompiled.AddRun();
+	TRIGRET_TYPE iRet;
+	try
+	{
+		iRet = OnTriggerRun( *pProg, iLine, s, TRIGRUN_SECTION_TRUE, pSrc, iArg );
+	}
+	catch (...)
+	{
+		g_ScriptCompiled.RemoveRun();
+		throw;
+	}
+	g_ScriptCompiled.RemoveRun();
+	return( iRet );
+}
+
+#endif // _AFXDLL
+
 bool CScriptObj::r_GetRef( const TCHAR * & pszKey, CScriptObj * & pRef, CTextConsole * pSrc )
 {
 #ifdef GRAY_SVR
@@ -13,8 +13,90 @@
 #include "cfile.h"
 #include "carray.h"
 #include <stdarg.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class CScriptLink;
+class CScriptIndex;
+class CExprProg;
+
+class CScriptImage
+{
+	// A whole text script file read into memory. It never changes once loaded.
+	// The base CScript and all its OpenCopy()s share it. A reload makes a new one.
+	// Anyone still reading the old one keeps it till they let go.
+private:
+	std::vector<TCHAR> m_Text;
+	DWORD m_dwFileSize;		// what the file was when we read it.
+	time_t m_FileTime;
+
+private:
+	CScriptImage( const CScriptImage & );
+	CScriptImage & operator=( const CScriptImage & );
+
+public:
+	CScriptImage()
+	{
+		m_dwFileSize = 0;
+		m_FileTime = 0;
+	}
+	static void GetFileStamp( const TCHAR * pszFilePath, DWORD & dwSize, time_t & FileTime );
+
+	bool Load( const TCHAR * pszFilePath );
+	size_t GetSize() const
+	{
+		return( m_Text.size());
+	}
+	const TCHAR * GetText() const
+	{
+		return( m_Text.empty() ? NULL : &m_Text[0] );
+	}
+	void GetStamp( DWORD & dwSize, time_t & FileTime ) const
+	{
+		dwSize = m_dwFileSize;
+		FileTime = m_FileTime;
+	}
+};
+
+class CScriptImageStream : public IScriptTextStream
+{
+	// Read lines out of a CScriptImage. Each reader has its own place in it.
+private:
+	std::shared_ptr<const CScriptImage> m_pImage;
+	size_t m_Pos;
+
+public:
+	CScriptImageStream()
+	{
+		m_Pos = 0;
+	}
+	bool IsOpen() const
+	{
+		return( m_pImage.get() != NULL );
+	}
+	const std::shared_ptr<const CScriptImage> & GetImage() const
+	{
+		return( m_pImage );
+	}
+	void Open( const std::shared_ptr<const CScriptImage> & pImage )
+	{
+		m_pImage = pImage;
+		m_Pos = 0;
+	}
+	void Close()
+	{
+		m_pImage.reset();
+		m_Pos = 0;
+	}
+
+	virtual TCHAR * ReadLine( TCHAR FAR * pBuffer, size_t sizemax );
+	virtual bool Write( const void FAR * pData, size_t iLen );
+	virtual bool Seek( long offset = 0, int origin = SEEK_SET );
+	virtual long Tell() const;
+};
 
 class CScript : public CFileText
 {
@@ -28,13 +110,16 @@ private:
 		virtual TCHAR * ReadLine( TCHAR FAR * pBuffer, size_t sizemax );
 		virtual bool Write( const void FAR * pData, size_t iLen );
 		virtual bool Seek( long offset = 0, int origin = SEEK_SET );
+		virtual long Tell() const;
 	};
 
 	CFileTextStreamAdapter m_DefaultStream;
+	CScriptImageStream m_ImageStream;	// LoadImage()
 	IScriptTextStream * m_pStream;
 	bool m_fOwnStream;
 
 	CGString m_Buffer;		// the buffer to hold data read.
+	CScriptIndex * m_pIndex;	// the sections in this file. (not owned) NULL = just scan for them.
 
 	long m_lSectionHead;	// File Offset to section header.
 	long m_lSectionData;	// File Offset to section data, not section header.
@@ -89,6 +174,25 @@ public:
 	bool OpenFind( const TCHAR *pszFilename, WORD Flags = OF_READ );
 #endif
 
+	// Read the whole file into memory and read from that. (no file handle)
+	bool LoadImage();
+	bool IsImage() const
+	{
+		return( m_ImageStream.IsOpen());
+	}
+	const CScriptImage * GetImage() const
+	{
+		return( m_ImageStream.GetImage().get());
+	}
+	virtual bool IsFileOpen() const
+	{
+		return( IsImage() || CFileText::IsFileOpen());
+	}
+	virtual DWORD GetPosition() const
+	{
+		return( m_pStream->Tell());
+	}
+
 private:
 	bool Seek( long offset = 0, int origin = SEEK_SET );
 protected:
@@ -107,6 +211,15 @@ public:
 		m_iLineNum = iLineNum;
 		return( Seek( offset, SEEK_SET ));
 	}
+	void SetIndex( CScriptIndex * pIndex )
+	{
+		// Copies of this file (OpenCopy) use it too.
+		m_pIndex = pIndex;
+	}
+	CScriptIndex * GetIndex() const
+	{
+		return( m_pIndex );
+	}
 
 	int GetLineNumber() const
 	{
@@ -135,6 +248,7 @@ public:
 	{
 		return(( m_pArg[0] ) ? true : false );
 	}
+	void SetKeyArg( const TCHAR * pszKey, const TCHAR * pszVal );	// as if we just read this line.
 
 	// find sections.
 	bool FindNextSection();
@@ -175,6 +289,79 @@ public:
 	}
 };
 
+struct CScriptIndexRec
+{
+	long m_lOffset;		// the section data. (just past the header)
+	int m_iLineNum;		// of the header.
+};
+
+class CScriptIndex
+{
+	// All the [SECTION] headers in one text script file. Read once when it is opened.
+	// CScript::FindSection() looks here instead of reading the file to find a section.
+	// Keyed on the upper case header up to the first ']'. Same as a FindTextHeader() match.
+	// Stops at [EOF] same as the scan.
+private:
+	std::unordered_map< std::string, std::vector<CScriptIndexRec> > m_Sections;	// in file order.
+	bool m_fBuilt;
+	int m_iRecs;
+	CGString m_sFilePath;	// what we read. To tell if it changed.
+	DWORD m_dwFileSize;
+	time_t m_FileTime;
+
+public:
+	DWORD m_dwLookups;
+	DWORD m_dwHits;
+	DWORD m_dwMisses;
+	int m_iBuilds;
+
+private:
+	CScriptIndex( const CScriptIndex & );
+	CScriptIndex & operator=( const CScriptIndex & );
+	static void GetStamp( const CScript & s, DWORD & dwSize, time_t & FileTime );
+
+public:
+	CScriptIndex()
+	{
+		m_fBuilt = false;
+		m_iRecs = 0;
+		m_dwFileSize = 0;
+		m_FileTime = 0;
+		m_dwLookups = 0;
+		m_dwHits = 0;
+		m_dwMisses = 0;
+		m_iBuilds = 0;
+	}
+
+	bool IsBuilt() const
+	{
+		return( m_fBuilt );
+	}
+	int GetSectionCount() const
+	{
+		return( m_iRecs );
+	}
+	int GetNameCount() const
+	{
+		return( (int) m_Sections.size());
+	}
+	int GetBucketCount() const
+	{
+		return( (int) m_Sections.bucket_count());
+	}
+	const TCHAR * GetFilePath() const
+	{
+		return( m_sFilePath );
+	}
+
+	void Empty();
+	bool Build( CScript & s );	// read all the headers from the start.
+	bool IsChanged( const CScript & s ) const;	// the file (or its image) is not what we read.
+
+	bool CanFind( const TCHAR * pszHeader ) const;
+	bool Find( const TCHAR * pszHeader, long lStart, CScriptIndexRec & rec );	// first one past lStart.
+};
+
 #ifndef _AFXDLL
 
 class CScriptLock : public CScript
@@ -208,6 +395,137 @@ public:
 #endif		
 };
 
+enum TRIGOP_TYPE
+{
+	// What a compiled script line does. (the keywords of CScriptObj::OnTriggerRun)
+	TRIGOP_VERB = 0,	// anything else. r_Verb()
+	TRIGOP_ON,			// ON=@Trigger = the start of the next trigger.
+	TRIGOP_IF,
+	TRIGOP_ELIF,		// ELIF, ELSEIF
+	TRIGOP_ELSE,
+	TRIGOP_ENDIF,		// ENDIF, END, ENDFOR
+	TRIGOP_BEGIN,
+	TRIGOP_RETURN,
+	TRIGOP_FOROBJS,
+	TRIGOP_FORITEMS,
+	TRIGOP_FORCHARS,
+	TRIGOP_DORAND,
+	TRIGOP_ENDDO,		// ENDDO, ENDRAND
+};
+
+struct CScriptCompiledLine
+{
+	BYTE m_Op;			// TRIGOP_TYPE
+	int m_iFalseEnd;	// a false section starting on this line stops on this line.
+	int m_iKey;			// offsets into the text.
+	int m_iArg;
+	int m_iExpr;		// the arg compiled as an expression. (m_Exprs) -1 = none.
+};
+
+class CScriptCompiled
+{
+	// A script section (EVENTS, ITEMDEF, CHARDEF, TRIG) read and split up once.
+	// Each line already knows what keyword it is and where a false IF/ELSE section ends.
+	// CScriptObj::OnTriggerScript() runs the triggers from this instead of the file.
+private:
+	std::vector<CScriptCompiledLine> m_Lines;
+	std::vector<int> m_Triggers;	// the ON= lines.
+	std::vector<TCHAR> m_Text;		// the keys and args.
+	std::vector<CExprProg*> m_Exprs;	// IF, ELIF, RETURN, DORAND args with nothing to ParseText().
+
+private:
+	CScriptCompiled( const CScriptCompiled & );
+	CScriptCompiled & operator=( const CScriptCompiled & );
+	int AddText( const TCHAR * pszText );
+	int AddExpr( const TCHAR * pszText );
+	void SetFalseEnds();
+	void Empty();
+
+public:
+	CScriptCompiled()
+	{
+	}
+	~CScriptCompiled()
+	{
+		Empty();
+	}
+	bool Compile( CScript & s );	// the rest of the section from here.
+
+	int GetLineCount() const
+	{
+		return( (int) m_Lines.size());
+	}
+	TRIGOP_TYPE GetOp( int i ) const
+	{
+		return( (TRIGOP_TYPE) m_Lines[i].m_Op );
+	}
+	int GetFalseEnd( int i ) const
+	{
+		// A false section that starts at line i ends here. (ON, ENDIF, ELSE or ELIF at the same level)
+		if ( i >= GetLineCount())
+			return( GetLineCount());
+		return( m_Lines[i].m_iFalseEnd );
+	}
+	const TCHAR * GetKey( int i ) const
+	{
+		return( &m_Text[ m_Lines[i].m_iKey ] );
+	}
+	const TCHAR * GetArg( int i ) const
+	{
+		return( &m_Text[ m_Lines[i].m_iArg ] );
+	}
+	long GetArgVal( int i, CScript & s ) const;
+	int FindTrigger( const TCHAR * pszTrigName ) const;	// the ON= line. -1 = none.
+	DWORD GetTrigMask( const TCHAR * const * ppszTrigNames, int iQty ) const;
+	size_t GetMem() const;
+};
+
+class CScriptCompiledCache
+{
+	// All the compiled sections by script and offset. Any CScriptLink to the same place shares it.
+	// Clear() when the scripts change. The links see the new generation and compile again.
+private:
+	std::map< std::pair<const CScript*,long>, CScriptCompiled* > m_Sections;
+	std::vector<CScriptCompiled*> m_Retired;	// cleared while a trigger was still running.
+	int m_iGen;
+	int m_iRunning;
+
+private:
+	CScriptCompiledCache( const CScriptCompiledCache & );
+	CScriptCompiledCache & operator=( const CScriptCompiledCache & );
+	void DeleteRetired();
+
+public:
+	CScriptCompiledCache()
+	{
+		m_iGen = 0;
+		m_iRunning = 0;
+	}
+	~CScriptCompiledCache();
+
+	int GetGen() const
+	{
+		return( m_iGen );
+	}
+	int GetCount() const
+	{
+		return( (int) m_Sections.size());
+	}
+	size_t GetMem() const;
+
+	const CScriptCompiled * Get( const CScript * pScriptBase, long lOffset, CScript & s );
+	void Clear();
+
+	// Hold off deleting sections while a trigger runs. (a verb could resync)
+	void AddRun()
+	{
+		m_iRunning ++;
+	}
+	void RemoveRun();
+};
+
+extern CScriptCompiledCache g_ScriptCompiled;
+
 class CScriptLink
 {
 	// A pre-indexed link into a script file.
@@ -215,12 +533,19 @@ private:
 	CScript * m_pScript;	// we already found the script.
 	long m_lOffset;		// we already found the offset.
 	long m_iLineNum;
+	const CScriptCompiled * m_pCompiled;	// the section compiled. (owned by g_ScriptCompiled)
+	int m_iCompiledGen;
+	DWORD m_dwTrigMask;		// GetTrigMask() of m_pCompiled.
+	bool m_fTrigMask;
 public:
 	void InitLink()
 	{
 		// Clear the link.
 		m_lOffset = -1;	// not yet tested.
 		m_iLineNum = -1;
+		m_pCompiled = NULL;
+		m_iCompiledGen = 0;
+		m_fTrigMask = false;
 	}
 	CScriptLink()
 	{
@@ -260,6 +585,7 @@ public:
 		m_lOffset = s.GetPosition();
 		DEBUG_CHECK(m_lOffset>=-1);
 		m_iLineNum = s.GetLineNumber();
+		m_pCompiled = NULL;
 	}
 	UINT GetLinkOffset() const
 	{
@@ -269,6 +595,7 @@ public:
 	void ClearLinkOffset()
 	{
 		m_lOffset = -1;
+		m_pCompiled = NULL;
 	}
 	UINT GetLinkLineNum() const
 	{
@@ -297,11 +624,44 @@ public:
 		}
 		return( true );
 	}
+	const CScriptCompiled * GetCompiled() const
+	{
+		// NULL = not compiled yet or the scripts changed since.
+		if ( m_pCompiled == NULL || m_iCompiledGen != g_ScriptCompiled.GetGen())
+			return( NULL );
+		return( m_pCompiled );
+	}
+	const CScriptCompiled * Compile( CScript & s )
+	{
+		// s = just opened with OpenLinkLock()
+		m_pCompiled = g_ScriptCompiled.Get( m_pScript, m_lOffset, s );
+		m_iCompiledGen = g_ScriptCompiled.GetGen();
+		m_fTrigMask = false;
+		return( m_pCompiled );
+	}
+	DWORD GetTrigMask( const TCHAR * const * ppszTrigNames, int iQty )
+	{
+		// Which of these triggers the section has. (bit per name)
+		// Always the same name table for a link. Compile() first.
+		const CScriptCompiled * pProg = GetCompiled();
+		if ( pProg == NULL )
+			return( 0 );
+		if ( ! m_fTrigMask )
+		{
+			m_dwTrigMask = pProg->GetTrigMask( ppszTrigNames, iQty );
+			m_fTrigMask = true;
+		}
+		return( m_dwTrigMask );
+	}
     const CScriptLink& operator=( const CScriptLink & link )
     {
 		m_pScript = link.m_pScript;
 		m_lOffset = link.m_lOffset;
 		m_iLineNum = link.m_iLineNum;
+		m_pCompiled = link.m_pCompiled;
+		m_iCompiledGen = link.m_iCompiledGen;
+		m_dwTrigMask = link.m_dwTrigMask;
+		m_fTrigMask = link.m_fTrigMask;
 		return( *this );
     }
 };
@@ -416,8 +776,15 @@ public:
 	// This object can be scripted. (but might not be)
 private:
 	TRIGRET_TYPE OnTriggerForLoop( CScript &s, int iType, CTextConsole * pSrc );
+#ifndef _AFXDLL
+	TRIGRET_TYPE OnTriggerForLoop( const CScriptCompiled & prog, int & iLine, CScript &s, int iType, CTextConsole * pSrc );
+	TRIGRET_TYPE OnTriggerRun( const CScriptCompiled & prog, int & iLine, CScript &s, TRIGRUN_TYPE trigger, CTextConsole * pSrc = NULL, int iArg = 0 );
+#endif
 protected:
 	TRIGRET_TYPE OnTriggerScript( CScript &s, const TCHAR * pszTrigName, CTextConsole * pSrc = NULL, int iArg = 0 );
+#ifndef _AFXDLL
+	TRIGRET_TYPE OnTriggerScript( const CScriptCompiled * pProg, const TCHAR * pszTrigName, CTextConsole * pSrc = NULL, int iArg = 0 );
+#endif
 	virtual bool OnTrigger( const TCHAR * pTrigName, CTextConsole * pSrc, int iArg )
 	{
 		return( false );
@@ -0,0 +1,167 @@
+//
+// CSpatial.cpp
+//
+
+#include "graycom.h"
+#include "cspatial.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPATIAL_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define SPATIAL_SSE2
+#endif
+
+/////////////////////////////////////////////////////////////////
+// -CSpatialRec
+
+CSpatialRec::~CSpatialRec()
+{
+	if ( m_pSpatial )
+	{
+		m_pSpatial->Remove( this );
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+// -CSpatialArray
+
+CSpatialArray::~CSpatialArray()
+{
+	// Let go of everything. (the owners may outlive us)
+	for ( size_t i=0; i<m_pRec.size(); i++ )
+	{
+		m_pRec[i]->m_pSpatial = NULL;
+		m_pRec[i]->m_iSpatialSlot = -1;
+	}
+}
+
+void CSpatialArray::Add( CSpatialRec * pRec, short x, short y, signed char z )
+{
+	ASSERT( pRec );
+	if ( pRec->m_pSpatial )
+	{
+		pRec->m_pSpatial->Remove( pRec );
+	}
+	pRec->m_pSpatial = this;
+	pRec->m_iSpatialSlot = GetCount();
+	m_x.push_back( x );
+	m_y.push_back( y );
+	m_z.push_back( z );
+	m_pRec.push_back( pRec );
+}
+
+void CSpatialArray::Remove( CSpatialRec * pRec )
+{
+	ASSERT( pRec );
+	if ( pRec->m_pSpatial != this )
+		return;
+
+	int i = pRec->m_iSpatialSlot;
+	int iLast = GetCount() - 1;
+	ASSERT( i >= 0 && i <= iLast && m_pRec[i] == pRec );
+	if ( i != iLast )
+	{
+		// Fill the hole with the last one.
+		m_x[i] = m_x[iLast];
+		m_y[i] = m_y[iLast];
+		m_z[i] = m_z[iLast];
+		m_pRec[i] = m_pRec[iLast];
+		m_pRec[i]->m_iSpatialSlot = i;
+	}
+	m_x.pop_back();
+	m_y.pop_back();
+	m_z.pop_back();
+	m_pRec.pop_back();
+	pRec->m_pSpatial = NULL;
+	pRec->m_iSpatialSlot = -1;
+}
+
+static int GetHighBit( unsigned int uMask )
+{
+	int i = -1;
+	while ( uMask )
+	{
+		uMask >>= 1;
+		i++;
+	}
+	return( i );
+}
+
+int CSpatialArray::FindPrev( int iStart, short x, short y, int iDist ) const
+{
+	if ( iDist < 0 )
+		return( -1 );
+	int i = ( iStart < GetCount()) ? iStart : GetCount();
+
+	// x in [xlo,xhi] and y in [ylo,yhi] is the same as max(dx,dy) <= iDist.
+	int xlo = max( x - iDist, -32768 );
+	int xhi = min( x + iDist, 32767 );
+	int ylo = max( y - iDist, -32768 );
+	int yhi = min( y + iDist, 32767 );
+
+#ifdef SPATIAL_AVX2
+	if ( i >= 16 )
+	{
+		const __m256i vxlo = _mm256_set1_epi16( (short) xlo );
+		const __m256i vxhi = _mm256_set1_epi16( (short) xhi );
+		const __m256i vylo = _mm256_set1_epi16( (short) ylo );
+		const __m256i vyhi = _mm256_set1_epi16( (short) yhi );
+		for ( ; i >= 16; i -= 16 )
+		{
+			__m256i vx = _mm256_loadu_si256( (const __m256i *) &m_x[i-16] );
+			__m256i vy = _mm256_loadu_si256( (const __m256i *) &m_y[i-16] );
+			__m256i vOut = _mm256_or_si256(
+				_mm256_or_si256( _mm256_cmpgt_epi16( vxlo, vx ), _mm256_cmpgt_epi16( vx, vxhi )),
+				_mm256_or_si256( _mm256_cmpgt_epi16( vylo, vy ), _mm256_cmpgt_epi16( vy, vyhi )));
+			unsigned int uMask = ~ (unsigned int) _mm256_movemask_epi8( vOut );	// 2 bits per short.
+			if ( uMask )
+				return( i - 16 + GetHighBit( uMask ) / 2 );
+		}
+	}
+#endif
+#ifdef SPATIAL_SSE2
+	if ( i >= 8 )
+	{
+		const __m128i vxlo = _mm_set1_epi16( (short) xlo );
+		const __m128i vxhi = _mm_set1_epi16( (short) xhi );
+		const __m128i vylo = _mm_set1_epi16( (short) ylo );
+		const __m128i vyhi = _mm_set1_epi16( (short) yhi );
+		for ( ; i >= 8; i -= 8 )
+		{
+			__m128i vx = _mm_loadu_si128( (const __m128i *) &m_x[i-8] );
+			__m128i vy = _mm_loadu_si128( (const __m128i *) &m_y[i-8] );
+			__m128i vOut = _mm_or_si128(
+				_mm_or_si128( _mm_cmpgt_epi16( vxlo, vx ), _mm_cmpgt_epi16( vx, vxhi )),
+				_mm_or_si128( _mm_cmpgt_epi16( vylo, vy ), _mm_cmpgt_epi16( vy, vyhi )));
+			unsigned int uMask = ~ (unsigned int) _mm_movemask_epi8( vOut ) & 0xFFFF;
+			if ( uMask )
+				return( i - 8 + GetHighBit( uMask ) / 2 );
+		}
+	}
+#endif
+
+	while ( --i >= 0 )
+	{
+		if ( m_x[i] >= xlo && m_x[i] <= xhi && m_y[i] >= ylo && m_y[i] <= yhi )
+			return( i );
+	}
+	return( -1 );
+}
+
+int CSpatialArray::FindPrevNew( int iStart, short x, short y, int iDist, short xOld, short yOld ) const
+{
+	int xlo = xOld - iDist;
+	int xhi = xOld + iDist;
+	int ylo = yOld - iDist;
+	int yhi = yOld + iDist;
+	int i = iStart;
+	while (( i = FindPrev( i, x, y, iDist )) >= 0 )
+	{
+		if ( m_x[i] < xlo || m_x[i] > xhi || m_y[i] < ylo || m_y[i] > yhi )
+			return( i );
+	}
+	return( -1 );
+}
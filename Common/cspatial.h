@@ -0,0 +1,115 @@
+//
+// CSpatial.h
+//
+// Packed (x,y,z) arrays of the objects in a sector list. So a range search
+// can throw out the far ones without touching the objects themselves.
+//
+
+#ifndef _INC_CSPATIAL_H
+#define _INC_CSPATIAL_H
+#pragma once
+
+#include <vector>
+
+class CSpatialArray;
+
+class CSpatialRec
+{
+	// Put this in anything that wants to be in a CSpatialArray.
+	// The owner must call SpatialMove() whenever its point changes.
+	// NOTE: Copies of this are NOT in the array.
+	friend class CSpatialArray;
+private:
+	CSpatialArray * m_pSpatial;	// NULL = not in an array.
+	int m_iSpatialSlot;
+
+public:
+	CSpatialRec()
+	{
+		m_pSpatial = NULL;
+		m_iSpatialSlot = -1;
+	}
+	CSpatialRec( const CSpatialRec & )
+	{
+		m_pSpatial = NULL;
+		m_iSpatialSlot = -1;
+	}
+	CSpatialRec & operator=( const CSpatialRec & )
+	{
+		return( *this );	// keep our own place.
+	}
+	~CSpatialRec();
+
+	bool IsInSpatial() const
+	{
+		return( m_pSpatial != NULL );
+	}
+	void SpatialMove( short x, short y, signed char z );
+};
+
+class CSpatialArray
+{
+	// Structure of arrays. Same order in each.
+	// Remove() moves the last one into the hole. So walk it from the top down
+	// if things may be removed as you go.
+private:
+	std::vector<short> m_x;
+	std::vector<short> m_y;
+	std::vector<signed char> m_z;
+	std::vector<CSpatialRec*> m_pRec;
+
+private:
+	CSpatialArray( const CSpatialArray & );
+	CSpatialArray & operator=( const CSpatialArray & );
+
+public:
+	CSpatialArray()
+	{
+	}
+	~CSpatialArray();
+
+	int GetCount() const
+	{
+		return( (int) m_pRec.size());
+	}
+	CSpatialRec * GetAt( int i ) const
+	{
+		return( m_pRec[i] );
+	}
+	short GetX( int i ) const
+	{
+		return( m_x[i] );
+	}
+	short GetY( int i ) const
+	{
+		return( m_y[i] );
+	}
+	signed char GetZ( int i ) const
+	{
+		return( m_z[i] );
+	}
+
+	void Add( CSpatialRec * pRec, short x, short y, signed char z );	// already in = move it here.
+	void Remove( CSpatialRec * pRec );	// not in here = nothing.
+	void SetPoint( int i, short x, short y, signed char z )
+	{
+		m_x[i] = x;
+		m_y[i] = y;
+		m_z[i] = z;
+	}
+
+	// The highest index below iStart within iDist of x,y. (same as CPointBase::GetDist)
+	// RETURN: -1 = none.
+	int FindPrev( int iStart, short x, short y, int iDist ) const;
+	// Same but only the ones that were NOT also within iDist of xOld,yOld. (came into range by moving)
+	int FindPrevNew( int iStart, short x, short y, int iDist, short xOld, short yOld ) const;
+};
+
+inline void CSpatialRec::SpatialMove( short x, short y, signed char z )
+{
+	if ( m_pSpatial == NULL )
+		return;
+	m_pSpatial->SetPoint( m_iSpatialSlot, x, y, z );
+}
+
+#endif	// _INC_CSPATIAL_H
@@ -0,0 +1,194 @@
+//
+// CTimerWheel.cpp
+//
+
+#include "graycom.h"
+#include "ctimerwheel.h"
+
+CTimerWheel::CTimerWheel()
+{
+	for ( int iLevel=0; iLevel<TIMER_WHEEL_LEVELS; iLevel++ )
+	{
+		for ( int i=0; i<TIMER_WHEEL_SLOTS; i++ )
+		{
+			m_Slots[iLevel][i].WheelInitHead();
+		}
+	}
+	m_Expired.WheelInitHead();
+	m_Now = 0;
+	m_iCount = 0;
+}
+
+CTimerWheel::~CTimerWheel()
+{
+	// Let go of everything. (the owners may outlive us)
+	for ( int iLevel=0; iLevel<TIMER_WHEEL_LEVELS; iLevel++ )
+	{
+		for ( int i=0; i<TIMER_WHEEL_SLOTS; i++ )
+		{
+			while ( ! m_Slots[iLevel][i].IsWheelHeadEmpty())
+			{
+				m_Slots[iLevel][i].m_pWheelNext->WheelUnlink();
+			}
+		}
+	}
+	while ( ! m_Expired.IsWheelHeadEmpty())
+	{
+		m_Expired.m_pWheelNext->WheelUnlink();
+	}
+}
+
+void CTimerWheel::Link( CTimerWheelRec * pRec )
+{
+	// Put it in the right slot for its time relative to m_Now.
+	time_t When = pRec->m_WheelTime;
+	if ( When < m_Now )
+		When = m_Now;	// late. it goes off on the next Advance()
+
+	time_t Diff = When - m_Now;
+	int iLevel = 0;
+	for ( ; iLevel < TIMER_WHEEL_LEVELS-1; iLevel++ )
+	{
+		if ( Diff < ((time_t) 1 << ( TIMER_WHEEL_BITS * ( iLevel + 1 ))))
+			break;
+	}
+	if ( iLevel == TIMER_WHEEL_LEVELS-1 )
+	{
+		// Can't be more than 1 turn of the top level away. It will just come back here.
+		time_t MaxDiff = ((time_t) 1 << ( TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS )) - ((time_t) 1 << ( TIMER_WHEEL_BITS * iLevel ));
+		if ( Diff > MaxDiff )
+			When = m_Now + MaxDiff;
+	}
+
+	int iSlot = (int)(( When >> ( TIMER_WHEEL_BITS * iLevel )) & ( TIMER_WHEEL_SLOTS - 1 ));
+	pRec->WheelLinkBefore( &m_Slots[iLevel][iSlot] );
+}
+
+void CTimerWheel::Insert( CTimerWheelRec * pRec, time_t When )
+{
+	ASSERT( pRec );
+	if ( pRec->IsInWheel())
+	{
+		pRec->WheelUnlink();
+	}
+	else
+	{
+		m_iCount++;
+	}
+	pRec->m_WheelTime = When;
+	Link( pRec );
+}
+
+void CTimerWheel::Remove( CTimerWheelRec * pRec )
+{
+	ASSERT( pRec );
+	if ( ! pRec->IsInWheel())
+		return;
+	pRec->WheelUnlink();
+	m_iCount--;
+}
+
+void CTimerWheel::Cascade( int iLevel, int iSlot )
+{
+	// This slot has come around. Move everything in it down to where it belongs now.
+	CTimerWheelRec Head;
+	Head.WheelInitHead();
+	CTimerWheelRec * pSlot = &m_Slots[iLevel][iSlot];
+	while ( ! pSlot->IsWheelHeadEmpty())
+	{
+		CTimerWheelRec * pRec = pSlot->m_pWheelNext;
+		pRec->WheelUnlink();
+		pRec->WheelLinkBefore( &Head );
+	}
+	while ( ! Head.IsWheelHeadEmpty())
+	{
+		CTimerWheelRec * pRec = Head.m_pWheelNext;
+		pRec->WheelUnlink();
+		Link( pRec );
+	}
+}
+
+void CTimerWheel::Rebuild( time_t Now )
+{
+	// The clock jumped. (or this is the first time)
+	// Quicker to put everything back from scratch than to walk all the ticks.
+	CTimerWheelRec Head;
+	Head.WheelInitHead();
+	for ( int iLevel=0; iLevel<TIMER_WHEEL_LEVELS; iLevel++ )
+	{
+		for ( int i=0; i<TIMER_WHEEL_SLOTS; i++ )
+		{
+			CTimerWheelRec * pSlot = &m_Slots[iLevel][i];
+			while ( ! pSlot->IsWheelHeadEmpty())
+			{
+				CTimerWheelRec * pRec = pSlot->m_pWheelNext;
+				pRec->WheelUnlink();
+				pRec->WheelLinkBefore( &Head );
+			}
+		}
+	}
+
+	m_Now = Now + 1;
+	while ( ! Head.IsWheelHeadEmpty())
+	{
+		CTimerWheelRec * pRec = Head.m_pWheelNext;
+		pRec->WheelUnlink();
+		if ( pRec->m_WheelTime <= Now )
+		{
+			pRec->WheelLinkBefore( &m_Expired );
+		}
+		else
+		{
+			Link( pRec );
+		}
+	}
+}
+
+void CTimerWheel::Advance( time_t Now )
+{
+	// Everything with a time <= Now goes on the expired list.
+	if ( Now < m_Now - 1 || Now - m_Now >= TIMER_WHEEL_JUMP )
+	{
+		Rebuild( Now );
+		return;
+	}
+
+	for ( ; m_Now <= Now; m_Now++ )
+	{
+		int iSlot = (int)( m_Now & ( TIMER_WHEEL_SLOTS - 1 ));
+		if ( ! iSlot )
+		{
+			// Bring down the timers from the levels above. Highest first.
+			int iLevel = 1;
+			for ( ; iLevel < TIMER_WHEEL_LEVELS-1; iLevel++ )
+			{
+				if (( m_Now >> ( TIMER_WHEEL_BITS * iLevel )) & ( TIMER_WHEEL_SLOTS - 1 ))
+					break;
+			}
+			for ( ; iLevel >= 1; iLevel-- )
+			{
+				Cascade( iLevel, (int)(( m_Now >> ( TIMER_WHEEL_BITS * iLevel )) & ( TIMER_WHEEL_SLOTS - 1 )));
+			}
+		}
+
+		CTimerWheelRec * pSlot = &m_Slots[0][iSlot];
+		while ( ! pSlot->IsWheelHeadEmpty())
+		{
+			CTimerWheelRec * pRec = pSlot->m_pWheelNext;
+			pRec->WheelUnlink();
+			pRec->WheelLinkBefore( &m_Expired );
+		}
+	}
+}
+
+CTimerWheelRec * CTimerWheel::GetExpired()
+{
+	// Take the next expired timer out of the wheel.
+	// NOTE: It may be put back by Insert() before we get the next one.
+	if ( m_Expired.IsWheelHeadEmpty())
+		return( NULL );
+	CTimerWheelRec * pRec = m_Expired.m_pWheelNext;
+	pRec->WheelUnlink();
+	m_iCount--;
+	return( pRec );
+}
@@ -0,0 +1,113 @@
+//
+// CTimerWheel.h
+//
+// Hierarchical timing wheel. Lots of timers, most far in the future, few firing each tick.
+//
+
+#ifndef _INC_CTIMERWHEEL_H
+#define _INC_CTIMERWHEEL_H
+#pragma once
+
+#include <ctime>
+
+class CTimerWheelRec
+{
+	// Put this in anything that wants to be in a CTimerWheel.
+	// NOTE: Copies of this are NOT in the wheel.
+	friend class CTimerWheel;
+private:
+	CTimerWheelRec * m_pWheelNext;
+	CTimerWheelRec * m_pWheelPrev;	// NULL = not in a wheel.
+	time_t m_WheelTime;
+
+private:
+	void WheelUnlink()
+	{
+		m_pWheelPrev->m_pWheelNext = m_pWheelNext;
+		m_pWheelNext->m_pWheelPrev = m_pWheelPrev;
+		m_pWheelNext = m_pWheelPrev = NULL;
+	}
+	void WheelLinkBefore( CTimerWheelRec * pHead )
+	{
+		m_pWheelNext = pHead;
+		m_pWheelPrev = pHead->m_pWheelPrev;
+		m_pWheelPrev->m_pWheelNext = this;
+		pHead->m_pWheelPrev = this;
+	}
+	void WheelInitHead()
+	{
+		m_pWheelNext = m_pWheelPrev = this;
+	}
+	bool IsWheelHeadEmpty() const
+	{
+		return( m_pWheelNext == this );
+	}
+
+public:
+	CTimerWheelRec()
+	{
+		m_pWheelNext = m_pWheelPrev = NULL;
+		m_WheelTime = 0;
+	}
+	CTimerWheelRec( const CTimerWheelRec & )
+	{
+		m_pWheelNext = m_pWheelPrev = NULL;
+		m_WheelTime = 0;
+	}
+	CTimerWheelRec & operator=( const CTimerWheelRec & )
+	{
+		return( *this );	// keep our own place in the wheel.
+	}
+	bool IsInWheel() const
+	{
+		return( m_pWheelPrev != NULL );
+	}
+	time_t GetWheelTime() const
+	{
+		return( m_WheelTime );
+	}
+};
+
+class CTimerWheel
+{
+	// 4 levels of 256 slots. Level 0 is one slot per tick. Each level up is 256 times coarser.
+	// Far timers get moved down a level (cascade) when their slot comes around.
+	// So Insert/Remove are O(1) and Advance() only touches what fires. (and what cascades)
+#define TIMER_WHEEL_BITS	8
+#define TIMER_WHEEL_SLOTS	(1<<TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS	4
+#define TIMER_WHEEL_JUMP	0x10000	// clock jumped more than this = just rebuild.
+private:
+	CTimerWheelRec m_Slots[ TIMER_WHEEL_LEVELS ][ TIMER_WHEEL_SLOTS ];
+	CTimerWheelRec m_Expired;	// Advance() put these here for GetExpired().
+	time_t m_Now;		// next tick not yet processed.
+	int m_iCount;		// in the wheel. (expired too)
+
+private:
+	CTimerWheel( const CTimerWheel & );
+	CTimerWheel & operator=( const CTimerWheel & );
+
+	void Link( CTimerWheelRec * pRec );
+	void Cascade( int iLevel, int iSlot );
+	void Rebuild( time_t Now );
+
+public:
+	CTimerWheel();
+	~CTimerWheel();
+
+	int GetCount() const
+	{
+		return( m_iCount );
+	}
+	time_t GetNow() const
+	{
+		return( m_Now );
+	}
+
+	void Insert( CTimerWheelRec * pRec, time_t When );	// already in = move it.
+	void Remove( CTimerWheelRec * pRec );				// not in = nothing.
+	void Advance( time_t Now );				// all timers <= Now go to the expired list.
+	CTimerWheelRec * GetExpired();			// take them off one at a time. NULL = done.
+};
+
+#endif	// _INC_CTIMERWHEEL_H
@@ -400,40 +400,80 @@ public:
 	void Encrypt( BYTE * pOutput, const BYTE * pInput, int iLen );
 };
 
+#define COMPRESS_TREE_BITS	11	// longest code in xCompress_Base.
+
 class CCompressTree
 {
 	// For compressing/decompressing stuff from game server to client.
-public:
-	int m_Value; // -1=tree branch, 0-255=character value, 256=PROXY_BRANCH_QTY-1=end
-    CCompressTree *m_pZero;
-    CCompressTree *m_pOne;
+	// Decode uses a flat table indexed by the next COMPRESS_TREE_BITS of input.
+	// Every entry is value<<4 | code bits. 0 = not loaded. value 256 = end of packet.
 private:
 	static const WORD xCompress_Base[256+1];
+	WORD m_Table[ 1 << COMPRESS_TREE_BITS ];
+	bool m_fLoaded;
 private:
 	bool AddBranch(int Value, WORD wCode, int iBits );
+	friend class CCompressStream;
 public:
 	CCompressTree()
 	{
-		m_Value=-1;	// just a pass thru branch til later.
-		m_pZero=NULL;
-		m_pOne=NULL;
-	}
-	~CCompressTree()
-	{
-		if ( m_pOne != NULL )
-			delete m_pOne;
-		if ( m_pZero != NULL )
-			delete m_pZero;
+		m_fLoaded = false;
+		memset( m_Table, 0, sizeof(m_Table));
 	}
 	static int Encode( BYTE * pOutput, const BYTE * pInput, int inplen );
+	static int EncodeBits( BYTE * pOutput, const BYTE * pInput, int inplen );
 	bool Load();
 	int  Decode( BYTE * pOutput, const BYTE * pInput, int inpsize ) const;
 	bool IsLoaded() const
 	{
-		return( m_pZero != NULL );
+		return( m_fLoaded );
 	}
 };
 
+class CCompressStream
+{
+	// Encode a run of blocks and shared packets as one compressed block. (one end code)
+	// Holds the bits that do not make a whole byte yet.
+	// NOTE: Never more than m_iLenMax input bytes between end codes. It does Finish() itself first.
+private:
+	unsigned long long m_qBits;	// pending bits are the low m_iBits of this.
+	int m_iBits;		// < 8 between calls.
+	int m_iLenRaw;		// input bytes since the last end code.
+	const int m_iLenMax;
+private:
+	int Open( BYTE * pOutput, int iLen );
+public:
+	explicit CCompressStream( int iLenMax ) :
+		m_iLenMax( iLenMax )
+	{
+		Empty();
+	}
+	void Empty()
+	{
+		m_qBits = 0;
+		m_iBits = 0;
+		m_iLenRaw = 0;
+	}
+	int GetLengthRaw() const
+	{
+		return( m_iLenRaw );
+	}
+	int GetPendingBits() const
+	{
+		return( m_iBits );
+	}
+	BYTE GetPendingByte() const
+	{
+		// The pending bits, left aligned and padded with 0.
+		return( (BYTE)( m_qBits << ( 8 - m_iBits )));
+	}
+
+	// RETURN: whole bytes put in pOutput.
+	int Encode( BYTE * pOutput, const BYTE * pInput, int iLen );	// room for iLen*11/8 + 4
+	int AppendBits( BYTE * pOutput, const BYTE * pBits, int iBits, int iLenRaw );	// from EncodeBits(). room for iBits/8 + 4
+	int Finish( BYTE * pOutput );	// end code and pad. room for 2
+};
+
 #ifdef WM_USER
 #define WM_GRAY_CLIENT_COMMAND	(WM_USER+123)	// command the client to do something.
 #endif
@@ -225,8 +225,8 @@ bool CServRef::r_LoadVal( CScript & s )
 		m_iClientsAvg = s.GetArgVal();
 		if ( m_iClientsAvg < 0 )
 			m_iClientsAvg = 0;
-		if ( m_iClientsAvg > FD_SETSIZE )	// Number is bugged !
-			m_iClientsAvg = FD_SETSIZE;
+		if ( m_iClientsAvg > MAX_CLIENT_SOCKETS )	// Number is bugged !
+			m_iClientsAvg = MAX_CLIENT_SOCKETS;
 		}
 		break;
 	case SC_CREATE:
@@ -313,7 +313,7 @@ get_clients:
 			int iClients = s.GetArgVal();
 			if ( iClients < 0 ) 
 				return( false );	// invalid
-			if ( iClients > FD_SETSIZE )	// Number is bugged !
+			if ( iClients > MAX_CLIENT_SOCKETS )	// Number is bugged !
 				return( false );
 			SetStat( SERV_STAT_CLIENTS, iClients );
 			if ( iClients > m_iClientsAvg )
@@ -78,7 +78,7 @@ CChar::CChar( CREID_TYPE baseID ) : CObjBase( false )
 		m_Skill[i] = 0;
 	}
 
-	m_time_last_regen = m_time_create = g_World.GetTime();
+	m_time_last_regen = m_time_regen = m_time_create = g_World.GetTime();
 	m_pDef = NULL;
 
 	m_pClient = NULL;	// is the char a logged in player ?
@@ -3178,14 +3178,15 @@ void CChar::UpdateMode( CClient * pExcludeClient, bool fFull )
 {
 	// If character status has been changed
 	// (Polymorph, war mode or hide), resend him
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pExcludeClient == pClient ) 
 			continue;
 		if ( ! pClient->CanSee( this ))
 		{
 			// In the case of "INVIS" used by GM's we must use this.
-			if ( GetDist( pClient->GetChar()) <= UO_MAP_VIEW_SIZE )
+			if ( pClient->IsKnown( this ))
 			{
 				pClient->addObjectRemove( this );
 			}
@@ -3209,7 +3210,10 @@ void CChar::UpdateMove( CPointMap pold, CClient * pExcludeClient )
 	// Who now sees this char ?
 	// Did they just see him move ?
 	MarkDirty( StorageDirtyType_Save );
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CNetBroadcastList Share;	// most see the same move packet.
+	CWorldSearchClient AreaClients( this );
+	AreaClients.AddPoint( pold );	// who saw me before the move.
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == pExcludeClient ) 
 			continue;	// no need to see self move.
@@ -3223,7 +3227,7 @@ void CChar::UpdateMove( CPointMap pold, CClient * pExcludeClient )
 		if ( pChar == NULL )
 			continue;
 
-		bool fCouldSee = ( pold.GetDist( pChar->GetTopPoint()) <= UO_MAP_VIEW_SIZE );
+		bool fCouldSee = pClient->IsKnown( this );
 
 		if ( ! pClient->CanSee( this ))
 		{	// can't see me now.
@@ -3231,7 +3235,7 @@ void CChar::UpdateMove( CPointMap pold, CClient * pExcludeClient )
 		}
 		else if ( fCouldSee )
 		{	// They see me move.
-			pClient->addCharMove( this );
+			pClient->addCharMove( this, &Share );
 		}
 		else
 		{	// first time this client has seen me.
@@ -3276,7 +3280,8 @@ void CChar::Update( const CClient * pClientExclude ) // If character status has
 {
 	// Or I changed looks.
 	// I moved or somebody moved me  ?
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == pClientExclude )
 			continue;
@@ -3686,7 +3691,8 @@ void CChar::Emote( const TCHAR * pText, CClient * pClientExclude, bool fPosessiv
 
 	CGString sMsgThem;
 	CGString sMsgUs;
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == pClientExclude ) 
 			continue;
@@ -4925,6 +4931,24 @@ const TCHAR * CChar::sm_szTrigName[CTRIG_QTY] =	// static
 	"@RegionChange" // when changing from one region to another one
 };
 
+bool CChar::IsTrigUsed( CTRIG_TYPE trigger )
+{
+	// Do any of my events have this trigger ?
+	DWORD dwMask = 0;
+	for ( int i=0; i<m_Events.GetCount(); i++ )
+	{
+		dwMask |= m_Events[i]->GetTrigMask();
+	}
+	if ( m_pNPC )
+	{
+		for ( int i=0; i<m_pDef->m_Events.GetCount(); i++ )
+		{
+			dwMask |= m_pDef->m_Events[i]->GetTrigMask();
+		}
+	}
+	return(( dwMask & ( 1 << trigger )) ? true : false );
+}
+
 bool CChar::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg )
 {
 	// Attach some trigger to the cchar. (PC or NPC)
@@ -4935,10 +4959,10 @@ bool CChar::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg
 
 	for ( int i=0; i<m_Events.GetCount(); i++ )
 	{
-		CScriptLock s;
-		if ( ! m_Events[i]->OpenFrag( s ))
+		const CScriptCompiled * pProg = m_Events[i]->GetFragCompiled();
+		if ( pProg == NULL )
 			continue;
-		if ( CScriptObj::OnTriggerScript( s, pszTrigName, pSrc, iArg ))
+		if ( CScriptObj::OnTriggerScript( pProg, pszTrigName, pSrc, iArg ))
 			return true;
 	}
 
@@ -4946,10 +4970,10 @@ bool CChar::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg
 	{
 		for ( int i=0; i<m_pDef->m_Events.GetCount(); i++ )
 		{
-			CScriptLock s;
-			if ( ! m_pDef->m_Events[i]->OpenFrag( s ))
+			const CScriptCompiled * pProg = m_pDef->m_Events[i]->GetFragCompiled();
+			if ( pProg == NULL )
 				continue;
-			if ( CScriptObj::OnTriggerScript( s, pszTrigName, pSrc, iArg ))
+			if ( CScriptObj::OnTriggerScript( pProg, pszTrigName, pSrc, iArg ))
 				return true;
 		}
 	}
@@ -5001,6 +5025,90 @@ int CChar::sm_Stat_Val_Regen[] =	// static (NOT CONST)
 	30*60*TICK_PER_SEC,	// Food regen (1 time per 30 minutes)
 };
 
+WORD CChar::OnTickRegen()
+{
+	// Run the regen counters up to now.
+	// NOTE: Only touches this char. SECTORTHREADS runs it on a worker thread.
+	//  m_time_regen keeps a second call in the same tick from counting the time again.
+	// RETURN: bit mask of the m_StatVal that are due. for OnTickRegenApply()
+
+	int iTimeDiff = g_World.GetTime() - m_time_regen;
+	if ( iTimeDiff <= 0 )
+		return( 0 );
+	m_time_regen = g_World.GetTime();
+
+	WORD wStats = 0;
+	for ( unsigned int i=0; i<COUNTOF(m_StatVal); i++ )
+	{
+		m_StatVal[i].m_regen += iTimeDiff;
+		unsigned short iRate = sm_Stat_Val_Regen[i];
+		if ( i == STAT_STR )	// HitPoints regen rate is related to food and stam.
+		{
+			if ( m_pPlayer )
+			{
+				if (IsStat(STATF_Fly))//when running no regen? I viewed this, but it doesn't seem really nice, check if we are standing still so reget regen rate normally
+				{
+					if ((m_pPlayer->m_LastWalk + 3) <= g_World.GetTime())
+						wStats |= REGEN_LANDED;	// ModStat() marks us dirty. not on a worker thread.
+					else
+						continue;
+				}
+
+				if (!m_food)
+				{
+					iRate += iRate / 2;	// much slower with no food.
+				}
+			}
+
+			// Fast metabolism bonus ? considering that mobiles can have much more stam that current dex, it's OK to check this
+			iRate += iRate / ( 2 * ( 1 + m_StatStam / 32 ));
+		}
+
+		if ( m_StatVal[i].m_regen < iRate )
+			continue;
+
+		m_StatVal[i].m_regen = 0;
+		wStats |= ( 1 << i );
+	}
+	return( wStats );
+}
+
+WORD CChar::OnTickPrepare()
+{
+	// SECTORTHREADS: the part of OnTick() that can be done ahead on a worker thread.
+	// Same tests as OnTick() for getting a regen tick.
+	// RETURN: OnTickRegen() stats for the main thread to apply.
+
+	int iTimeDiff = g_World.GetTime() - m_time_last_regen;
+	if ( iTimeDiff < TICK_PER_SEC )
+		return( 0 );
+	if ( IsStat( STATF_DEAD ) || m_StatHealth <= 0 )
+		return( 0 );
+	return( OnTickRegen());
+}
+
+void CChar::OnTickRegenApply( WORD wStats )
+{
+	// The stats that OnTickRegen() said are due. Tell everyone.
+	if ( wStats & REGEN_LANDED )
+	{
+		ModStat( STATF_Fly, false );
+	}
+	for ( unsigned int i=0; i<COUNTOF(m_StatVal); i++ )
+	{
+		if ( ! ( wStats & ( 1 << i )))
+			continue;
+		if ( i==3 )
+		{
+			OnFoodTick();
+		}
+		else if ( m_StatVal[i].m_val != HitManaStam_Get((STAT_TYPE)i))
+		{
+			UpdateStats( (STAT_TYPE) i, 1 );
+		}
+	}
+}
+
 bool CChar::OnTick()
 {
 	// Assume this is only called 1 time per sec.
@@ -5045,45 +5153,7 @@ bool CChar::OnTick()
 			return Death();
 		}
 
-		for ( int i=0; i<COUNTOF(m_StatVal); i++ )
-		{
-			m_StatVal[i].m_regen += iTimeDiff;
-			unsigned short iRate = sm_Stat_Val_Regen[i];
-			if ( i == STAT_STR )	// HitPoints regen rate is related to food and stam.
-			{
-				if ( m_pPlayer )
-				{
-					if (IsStat(STATF_Fly))//when running no regen? I viewed this, but it doesn't seem really nice, check if we are standing still so reget regen rate normally
-					{
-						if ((m_pPlayer->m_LastWalk + 3) <= g_World.GetTime())
-							ModStat(STATF_Fly, false);
-						else
-							continue;
-					}
-
-					if (!m_food)
-					{
-						iRate += iRate / 2;	// much slower with no food.
-					}
-				}
-
-				// Fast metabolism bonus ? considering that mobiles can have much more stam that current dex, it's OK to check this
-				iRate += iRate / ( 2 * ( 1 + m_StatStam / 32 ));
-			}
-
-			if ( m_StatVal[i].m_regen < iRate )
-				continue;
-
-			m_StatVal[i].m_regen = 0;
-			if ( i==3 )
-			{
-				OnFoodTick();
-			}
-			else if ( m_StatVal[i].m_val != HitManaStam_Get((STAT_TYPE)i))
-			{
-				UpdateStats( (STAT_TYPE) i, 1 );
-			}
-		}
+		OnTickRegenApply( OnTickRegen());	// nothing if SECTORTHREADS did it already.
 	}
 
 	if ( IsDisconnected())	// mounted horses can still get a tick.
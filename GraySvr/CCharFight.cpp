@@ -782,7 +782,8 @@ void CChar::Fight_Start( const CChar * pTarg )
 	if ( GetTopSector()->GetComplexity() > 7 )
 		return;	// too busy for this.
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == m_pClient ) 
 			continue;	// we know we are fighting.
@@ -534,6 +534,7 @@ void CChat::DecorateName(CGString &sName, const CChatChanMember * pMember, bool
 
 void CChat::Broadcast(CChatChanMember * pFrom, const char * pszText, const char * pszLang, bool fOverride)
 {
+	CNetBroadcastList Share;
 	CClient * pClient = g_Serv.GetClientHead();
 	for ( ; pClient; pClient = pClient->GetNext())
 	{
@@ -543,7 +544,7 @@ void CChat::Broadcast(CChatChanMember * pFrom, const char * pszText, const char
 		{
 			CGString sName;
 			DecorateName(sName, pFrom, fOverride);
-			pClient->SendChatMsg(CHATMSG_PlayerTalk, sName, pszText, pszLang);
+			pClient->SendChatMsg(CHATMSG_PlayerTalk, sName, pszText, pszLang, &Share);
 		}
 	}
 }
@@ -976,12 +977,13 @@ void CChatChannel::Broadcast(CHATMSG_TYPE iType, const char * pszName, const cha
 	else
 		sName = pszName;
 
+	CNetBroadcastList Share;
 	for (int i = 0; i < m_Members.GetCount(); i++)
 	{
 		// Check to see if the recipient is ignoring messages from the sender
 		// Just pass over it if it's a regular talk message
 		if (!m_Members[i]->IsIgnoring(pszName))
-			m_Members[i]->SendChatMsg(iType, sName, pszText, pszLang);
+			m_Members[i]->SendChatMsg(iType, sName, pszText, pszLang, &Share);
 
 		// If it's a private message, then tell the sender the recipient is ignoring them
 		else if (iType == CHATMSG_PlayerPrivate)
@@ -1213,10 +1215,10 @@ void CChatChanMember::RenameChannel(const char * pszName)
 		pChannel->RenameChannel(this, pszName);
 }
 
-void CChatChanMember::SendChatMsg(CHATMSG_TYPE iType, const TCHAR * pszName1, const TCHAR * pszName2, const char * pszLang)
+void CChatChanMember::SendChatMsg(CHATMSG_TYPE iType, const TCHAR * pszName1, const TCHAR * pszName2, const char * pszLang, CNetBroadcastList * pShare)
 {
 	DEBUG_CHECK( IsChatActive());
-	GetClient()->addChatSystemMessage(iType, pszName1, pszName2, pszLang);
+	GetClient()->addChatSystemMessage(iType, pszName1, pszName2, pszLang, pShare);
 }
 
 void CChatChanMember::ToggleReceiving()
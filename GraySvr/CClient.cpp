@@ -7,7 +7,10 @@
 /////////////////////////////////////////////////////////////////
 // -CClient stuff.
 
-CClient::CClient( SOCKET client ) : CGSocket( client )
+CClient::CClient( SOCKET client ) :
+	CGSocket( client ),
+	m_bin_Ring( CLIENT_RX_RING_START, CLIENT_RX_RING, sizeof( CEvent )),
+	m_bout_Stream( MAX_BUFFER )
 {
 	m_pChar = NULL;
 	m_pAccount = NULL;
@@ -20,8 +23,12 @@ CClient::CClient( SOCKET client ) : CGSocket( client )
 	m_Time_LastEvent = g_World.GetTime();
 
 	m_bin_PrvMsg = XCMD_QTY;
-	m_bin_len = 0;
+	m_bin = (CEvent *) m_bin_Ring.GetHead();
+	m_fRecvPending = false;
 	m_bout_len = 0;
+	m_fSendThrottle = false;
+	m_fSendOverflow = false;
+	m_pNetQueue = NULL;
 
 	m_WalkCount = -1;
 	m_fPaused = false;
@@ -38,6 +45,7 @@ CClient::CClient( SOCKET client ) : CGSocket( client )
 
 	g_Serv.ClientsInc();
 	g_Serv.m_Clients.InsertAfter( this );
+	g_Serv.SocketsAttach( this );
 
 	struct sockaddr_in Name;
 	GetPeerName( &Name );
@@ -104,6 +112,7 @@ void CClient::CharDisconnect()
 CClient::~CClient()
 {
 	g_Serv.StatDec( SERV_STAT_CLIENTS );
+	g_Serv.SocketsDetach( this );
 
 	struct sockaddr_in Name;
 	GetPeerName( &Name );
@@ -1111,12 +1120,12 @@ do_admin:
 			if ( pObj != NULL )
 			{
 				CPointMap pt = pObj->GetUnkPoint();
-				m_bin.Target.m_code = GetTargMode();
-				m_bin.Target.m_x = pt.m_x;
-				m_bin.Target.m_y = pt.m_y;
-				m_bin.Target.m_z = pt.m_z;
-				m_bin.Target.m_UID = pObj->GetUID();
-				m_bin.Target.m_id = 0;
+				m_bin->Target.m_code = GetTargMode();
+				m_bin->Target.m_x = pt.m_x;
+				m_bin->Target.m_y = pt.m_y;
+				m_bin->Target.m_z = pt.m_z;
+				m_bin->Target.m_UID = pObj->GetUID();
+				m_bin->Target.m_id = 0;
 				Event_Target();
 			}
 			break;
@@ -1191,13 +1200,13 @@ do_resend:
 		// Fake self target.
 		if ( GetTargMode() >= TARGMODE_MOUSE_TYPE )
 		{
-			m_bin.Target.m_code = GetTargMode();
+			m_bin->Target.m_code = GetTargMode();
 			CPointMap pt = m_pChar->GetTopPoint();
-			m_bin.Target.m_x = pt.m_x;
-			m_bin.Target.m_y = pt.m_y;
-			m_bin.Target.m_z = pt.m_z;
-			m_bin.Target.m_UID = m_pChar->GetUID();
-			m_bin.Target.m_id = 0;
+			m_bin->Target.m_x = pt.m_x;
+			m_bin->Target.m_y = pt.m_y;
+			m_bin->Target.m_z = pt.m_z;
+			m_bin->Target.m_UID = m_pChar->GetUID();
+			m_bin->Target.m_id = 0;
 			Event_Target();
 			break;
 		}
@@ -7,7 +7,7 @@
 
 #include "graysvr.h"	// predef header.
 
-BYTE CClient::xCompress_Buffer[MAX_BUFFER];	// static
+BYTE CClient::xCompress_Buffer[MAX_BUFFER*2];	// static
 CCompressTree CClient::sm_xComp;
 
 /////////////////////////////////////////////////////////////////
@@ -29,13 +29,15 @@ int CClient::xCompress( BYTE * pOutput, const BYTE * pInput, int inplen ) // sta
 	return( sm_xComp.Encode( pOutput, pInput, inplen ));
 }
 
-void CClient::xFlush() // Sends buffered data at once
+void CClient::xSendCompress()
 {
-	if ( m_bout_len <= 0 ) 
+	// Compress what we have onto the send queue. Leave the compressed block open for more.
+	// The socket gets it later. xFlush() or when it is writable.
+	if ( m_bout_len <= 0 )
 		return;
 	if ( ! m_fGameServer )	// acting as a login server to this client.
 	{
-		Send( m_bout.m_Raw, m_bout_len );
+		m_SendQueue.Append( m_bout.m_Raw, m_bout_len );
 		m_bout_len=0;
 		return;
 	}
@@ -44,15 +46,137 @@ void CClient::xFlush() // Sends buffered data at once
 	// Only the game server does this.
 	// This acts as a compression alg.
 
-	int len = xCompress( xCompress_Buffer, m_bout.m_Raw, m_bout_len );
+	if ( m_pNetQueue )
+	{
+		// The CNetThread will compress and send it. (and end its blocks)
+		xPushNetQueue( m_bout.m_Raw, m_bout_len, NULL );
+		m_bout_len=0;
+		return;
+	}
+
+	int len = m_bout_Stream.Encode( xCompress_Buffer, m_bout.m_Raw, m_bout_len );
 	ASSERT( len <= sizeof(xCompress_Buffer));
 
 	// DEBUG_MSG(( "%x:Send %d bytes as %d\n", GetSocket(), m_bout_len, len ));
 
-	Send( xCompress_Buffer, len );
+	m_SendQueue.Append( xCompress_Buffer, len );
 	m_bout_len=0;
 #endif
+}
 
+void CClient::xSendBlock()
+{
+	// Done building this block. The end code goes on so the client has all of it.
+	xSendCompress();
+#ifdef GRAY_GAME_SERVER
+	if ( m_bout_Stream.GetLengthRaw())
+	{
+		int len = m_bout_Stream.Finish( xCompress_Buffer );
+		m_SendQueue.Append( xCompress_Buffer, len );
+	}
+#endif
+}
+
+void CClient::xSendShared( const void *pData, int length, CNetBroadcastList * pShare )
+{
+	// Lots of clients get this exact packet. Don't Huffman code it for each of them.
+	// Its codes are shifted into our open compressed block. No end code between.
+#ifdef GRAY_GAME_SERVER
+	CNetBroadcast * pPacket = NULL;
+	if ( m_fGameServer && ! IsConsole())
+	{
+		pPacket = pShare->Get( pData, length );
+	}
+	if ( pPacket != NULL )
+	{
+		xSendCompress();	// what we have so far goes first.
+		const BYTE * pBits = pPacket->GetCompressed();
+		if ( m_pNetQueue )
+		{
+			xPushNetQueue( NULL, 0, pPacket );
+			return;
+		}
+		int len = m_bout_Stream.AppendBits( xCompress_Buffer, pBits, pPacket->GetCompressedBits(), pPacket->GetLength());
+		m_SendQueue.Append( xCompress_Buffer, len );
+		return;
+	}
+#endif
+	xSendReady( pData, length );
+}
+
+void CClient::xPushNetQueue( const BYTE * pData, int iLen, CNetBroadcast * pPacket )
+{
+	// Give a block (or a shared packet) to our CNetThread. Never wait for it.
+	// If it can't take it or we are way behind then this client is done.
+	if ( m_fSendOverflow )
+		return;
+	bool fPushed = ( pPacket ) ? m_pNetQueue->PushShared( pPacket ) : m_pNetQueue->Push( pData, iLen );
+	if ( fPushed && ! xIsSendOverflow( xGetSendQueued()))
+		return;
+	if ( fPushed )
+	{
+		DEBUG_ERR(( "%x:Client out queue overflow %d bytes, dropping client\n", GetSocket(), xGetSendQueued()));
+	}
+	m_fSendOverflow = true;
+}
+
+void CClient::xFlushQueue()
+{
+	// Give the socket as much as it will take. never block.
+	if ( m_SendQueue.IsEmpty())
+		return;
+	int iSent = m_SendQueue.Flush( this );
+	if ( iSent > 0 )
+	{
+		g_Serv.m_Profile.Count( PROFILE_DATA_TX, iSent );
+	}
+	if ( iSent < 0 || xIsSendOverflow( m_SendQueue.GetBytes()))
+	{
+		// the socket is dead or the client just is not reading.
+		if ( iSent >= 0 )
+		{
+			DEBUG_ERR(( "%x:Client out queue overflow %d bytes, dropping client\n", GetSocket(), m_SendQueue.GetBytes()));
+		}
+		m_SendQueue.Empty();
+		m_fSendOverflow = true;
+	}
+}
+
+void CClient::xFlush() // Sends buffered data at once
+{
+	xSendBlock();
+	xFlushQueue();
+}
+
+bool CClient::xIsSendOverflow( int iQueued ) const
+{
+	// Way past SENDQUEUEHIGH. Throttling did not help.
+	return( g_Serv.m_iSendQueueHigh && iQueued > g_Serv.m_iSendQueueHigh * 4 );
+}
+
+int CClient::xGetSendQueued()
+{
+	// Bytes waiting to go out to this client. (ours or the CNetThread's)
+	if ( m_pNetQueue )
+	{
+		return( m_pNetQueue->m_iSendBytes.load( std::memory_order_relaxed ) + m_pNetQueue->GetOutBytes());
+	}
+	return( m_SendQueue.GetBytes());
+}
+
+bool CClient::xIsSendThrottled()
+{
+	// Too much is waiting for this client. Stop doing what it asks til it catches up.
+	int iQueued = xGetSendQueued();
+	if ( ! m_fSendThrottle )
+	{
+		m_fSendThrottle = ( g_Serv.m_iSendQueueHigh && iQueued > g_Serv.m_iSendQueueHigh );
+	}
+	else if ( iQueued <= g_Serv.m_iSendQueueLow )
+	{
+		m_fSendThrottle = false;
+	}
+	return( m_fSendThrottle );
 }
 
 void CClient::xSend( const void *pData, int length )
@@ -66,9 +190,7 @@ void CClient::xSend( const void *pData, int length )
 	}
 	if ( m_bout_len + length > MAX_BUFFER )
 	{
-		DEBUG_ERR(( "%x:Client out overflow %d+%d!\n", GetSocket(), m_bout_len, length ));
-		ASSERT(0);
-		return;
+		xSendCompress();	// make room. packets never span blocks.
 	}
 	ASSERT(length);
 	memcpy( & ( m_bout.m_Raw[m_bout_len] ), pData, length );
@@ -78,24 +200,21 @@ void CClient::xSend( const void *pData, int length )
 void CClient::xSendReady( const void *pData, int length ) // We could send the packet now if we wanted to but wait til we have more.
 {
 	// We could send the packet now if we wanted to but wait til we have more.
-	if ( m_bout_len + length >= MAX_BUFFER )
-	{
-		xFlush();
-	}
 	xSend( pData, length );
-	if ( m_bout_len >= (MAX_BUFFER >> 1) )	// send only if we have a bunch.
+	if ( m_bout_len >= (MAX_BUFFER >> 1) )	// compress only if we have a bunch.
 	{
-		xFlush();
+		xSendCompress();
 	}
 }
 
 bool CClient::xCheckSize( int len )
 {
 	// Is there enough data from client to process this packet ?
+	// The packet is always contiguous at m_bin. (CNetRecvBuf copies the wrapped part)
 	if ( ! len || len > sizeof( CEvent ))
 		return( false );	// junk
 	m_bin_pkt = len;
-	return( m_bin_len >= len );
+	return( m_bin_Ring.IsWhole( len ));
 }
 
 void CClient::xProcess( bool fGood )
@@ -105,8 +224,8 @@ void CClient::xProcess( bool fGood )
 
 	if ( ! fGood || ! m_bin_pkt )	// toss all.
 	{
-		DEBUG_ERR(( "%x:Bad Msg 0%x Eat %d bytes, prv=0%x\n", GetSocket(), m_bin.Default.m_Cmd, m_bin_len, m_bin_PrvMsg ));
-		m_bin_len = 0;
+		DEBUG_ERR(( "%x:Bad Msg 0%x Eat %d bytes, prv=0%x\n", GetSocket(), m_bin->Default.m_Cmd, m_bin_Ring.GetLength(), m_bin_PrvMsg ));
+		m_bin_Ring.Empty();
 		if ( ! m_fGameServer )	// tell them about it.
 		{
 			addLoginErr( LOGIN_ERR_OTHER );
@@ -114,10 +233,10 @@ void CClient::xProcess( bool fGood )
 	}
 	else
 	{
-		ASSERT( m_bin_len >= m_bin_pkt );
-		memmove( m_bin.m_Raw, &(m_bin.m_Raw[m_bin_pkt]), m_bin_len-m_bin_pkt);
-		m_bin_len -= m_bin_pkt;
+		ASSERT( m_bin_Ring.GetLength() >= m_bin_pkt );
+		m_bin_Ring.Skip( m_bin_pkt );
 	}
+	m_bin = (CEvent *) m_bin_Ring.GetHead();
 	m_bin_pkt = 0;
 }
 
@@ -158,7 +277,7 @@ void CClient::xInit_DeCrypt_FindKey( const BYTE * pCryptData, int len )
 
 	for ( int i=0; i<len && n < 64; i++, n++ )
 	{
-		//m_bin.m_Raw[i] ^= m_RxCryptMaskLo;
+		//m_bin->m_Raw[i] ^= m_RxCryptMaskLo;
 		//DWORD MaskLo = m_RxCryptMaskLo;
 		//DWORD MaskHi = m_RxCryptMaskHi;
 		//m_RxCryptMaskHi = ((MaskHi >> 1) | (MaskLo << 31)) ^ MASTERKEY_HI;
@@ -166,7 +285,7 @@ void CClient::xInit_DeCrypt_FindKey( const BYTE * pCryptData, int len )
 
 		if ( n & 7 ) continue;
 
-		BYTE bVal = m_bin.m_Raw[i] ^ CalibrateData[ m_tmSetupConnect ];
+		BYTE bVal = m_bin->m_Raw[i] ^ CalibrateData[ m_tmSetupConnect ];
 
 		if ( n == 0 )
 		{
@@ -370,31 +489,66 @@ bool CClient::xRecvData() // Receive message from client
 	// High level Rx from Client.
 	// RETURN: false = dump the client.
 
-	int iPrev = m_bin_len;
-	int count = Receive( &(m_bin.m_Raw[iPrev]), MAX_BUFFER - iPrev );
-	if ( count <= 0 )	// I should always get data here.
+	int iPrev = m_bin_Ring.GetLength();
+	if ( m_bin_Ring.GetFree() <= 0 )
 	{
-		return( false ); // this means that the client is gone.
+		// Process what we have first. the rest waits in the kernel.
+		m_fRecvPending = true;
+		return( true );
+	}
+
+	// Fill up to the end of m_bin_Ring then wrap to the front. (it grows if it fills)
+	int count = 0;
+	while ( true )
+	{
+		int iRead;
+		BYTE * pTail = m_bin_Ring.GetTail( iRead );
+		m_bin = (CEvent *) m_bin_Ring.GetHead();	// it may have moved.
+		if ( iRead <= 0 )
+			break;	// full at CLIENT_RX_RING. m_fRecvPending is still set.
+		int iRet = Receive( pTail, iRead, MSG_DONTWAIT );
+		if ( iRet <= 0 )
+		{
+			m_fRecvPending = false;
+			if ( count )
+				break;
+			if ( iRet < 0 && CSocketReactor::IsWouldBlock())
+				return( true );	// drained. (edge triggered)
+			return( false ); // this means that the client is gone.
+		}
+		if ( m_Crypt.IsInit())
+		{
+			// Decrypt the data.
+			// TCP = no missed packets ! If we miss a packet we are screwed !
+			m_Crypt.Decrypt( pTail, pTail, iRet );
+		}
+		m_bin_Ring.AddTail( iRet );
+		count += iRet;
+
+		// A full read means there may be more. (edge triggered won't tell us again)
+		m_fRecvPending = ( iRet >= iRead );
+		if ( ! m_fRecvPending )
+			break;
 	}
-	m_bin_len += count;
 
 	if ( ! m_Crypt.IsInit())
 	{
 		// Must process the whole thing as one packet right now.
 		ASSERT( iPrev == 0 );
-		ASSERT( count == m_bin_len );
+		ASSERT( count == m_bin_Ring.GetLength());
+		ASSERT( m_bin == (CEvent *) m_bin_Ring.GetHead());
 
-		if ( m_bin_len > 5 && m_bin.m_CryptHeader == 0xFFFFFFFF )
+		if ( m_bin_Ring.GetLength() > 5 && m_bin->m_CryptHeader == 0xFFFFFFFF )
 		{
 			// special inter-server type message.
 			if ( IsBlockedIP())
 				return( false );
 
-			if ( m_bin.m_Raw[4] == 0 )
+			if ( m_bin->m_Raw[4] == 0 )
 			{
 				// Server Registration message
-				bool fRet = OnAutoServerRegisterRx( &m_bin.m_Raw[4], m_bin_len-4 );
-				m_bin_len = 0;	// eat the buffer.
+				bool fRet = OnAutoServerRegisterRx( &m_bin->m_Raw[4], m_bin_Ring.GetLength()-4 );
+				m_bin_Ring.Empty();	// eat the buffer.
 				return( fRet );
 			}
 		}
@@ -405,10 +559,10 @@ bool CClient::xRecvData() // Receive message from client
 		{
 			// Answer a question for this peer server.
 			bool fSuccess = false;
-			if ( m_bin_len <= 128 )
+			if ( m_bin_Ring.GetLength() <= 128 )
 			{
-				m_bin.m_Raw[m_bin_len] = '\0';
-				TCHAR * pszCmd = TrimWhitespace( (char*) m_bin.m_Raw );
+				m_bin->m_Raw[m_bin_Ring.GetLength()] = '\0';
+				TCHAR * pszCmd = TrimWhitespace( (char*) m_bin->m_Raw );
 				CGString sVal;
 				fSuccess = g_Serv.r_WriteVal( pszCmd, sVal, this );
 				if ( fSuccess )
@@ -416,44 +570,44 @@ bool CClient::xRecvData() // Receive message from client
 					xSendReady( sVal, sVal.GetLength()+1 );
 				}
 			}
-			m_bin_len = 0;	// eat the buffer.
+			m_bin_Ring.Empty();	// eat the buffer.
 			return( true );	// don't dump the connection.
 		}
 
 		if ( IsConsole())
 		{
 			// We already logged in or are in the process of logging in.
-			bool fRet = OnConsoleRx( m_bin.m_Raw, m_bin_len );
-			m_bin_len = 0;	// eat the buffer.
+			bool fRet = OnConsoleRx( m_bin->m_Raw, m_bin_Ring.GetLength() );
+			m_bin_Ring.Empty();	// eat the buffer.
 			return( fRet );
 		}
 
-		if ( m_bin_len < 4 )	// just a ping for server info.
+		if ( m_bin_Ring.GetLength() < 4 )	// just a ping for server info.
 		{
 			if ( IsBlockedIP())
 				return( false );
-			bool fRet = OnPingRx( m_bin.m_Raw, m_bin_len );
-			m_bin_len = 0;	// eat the buffer.
+			bool fRet = OnPingRx( m_bin->m_Raw, m_bin_Ring.GetLength() );
+			m_bin_Ring.Empty();	// eat the buffer.
 			return( fRet );
 		}
 #endif
 		// Assume it's a normal client log in.
-		xCheckSize( sizeof( m_bin.m_CryptHeader ));
+		xCheckSize( sizeof( m_bin->m_CryptHeader ));
 
 		// DEBUG_MSG(( "%x:CCrypt:Init %d.%d.%d.%d\n", GetSocket(), pDeCryptID[0], pDeCryptID[1], pDeCryptID[2], pDeCryptID[3] ));
 		bool fGame = false;
 		if ( count == 66 ) // SERVER_Login 1.26.0
 		{
-			m_Crypt.Init( m_bin.m_Raw, SERVER_Login ); // Init decryption table
+			m_Crypt.Init( m_bin->m_Raw, SERVER_Login ); // Init decryption table
 		}
 		else if ( count == 69 )	// Auto-registering server sending us info.
 		{
-			m_Crypt.Init( m_bin.m_Raw, SERVER_Game ); // Init decryption table
+			m_Crypt.Init( m_bin->m_Raw, SERVER_Game ); // Init decryption table
 			fGame = true;
 		}
 		else	// probably this is a login server.
 		{
-			m_Crypt.Init( m_bin.m_Raw ); // Init decryption table
+			m_Crypt.Init( m_bin->m_Raw ); // Init decryption table
 		}
 
 		if ( IsBlockedIP())
@@ -463,19 +617,41 @@ bool CClient::xRecvData() // Receive message from client
 		}
 
 		xProcess( true );
-	}
 
-	// Decrypt the data.
-	// TCP = no missed packets ! If we miss a packet we are screwed !
+		// The rest of the first read is already encrypted.
+		m_Crypt.Decrypt( m_bin->m_Raw, m_bin->m_Raw, m_bin_Ring.GetLength() );
+	}
 
-	// g_Log.Event( LOGL_TRACE, "Before\n" );
-	// g_Log.Dump( m_bin.m_Raw, m_bin_len );
+	// g_Log.Event( LOGL_TRACE, "After\n" );
+	// g_Log.Dump( m_bin->m_Raw, m_bin_Ring.GetLength() );
 
-	m_Crypt.Decrypt( m_bin.m_Raw+iPrev, m_bin.m_Raw+iPrev, m_bin_len-iPrev );
+	return( true );
+}
 
-	// g_Log.Event( LOGL_TRACE, "After\n" );
-	// g_Log.Dump( m_bin.m_Raw, m_bin_len );
+bool CClient::xRecvQueued()
+{
+	// The CNetThread has already read and decrypted this for us.
+	// RETURN: false = dump the client.
 
+	ASSERT( m_pNetQueue );
+	while ( true )	// up to the end of m_bin_Ring then wrap. (it grows if it fills)
+	{
+		int iRead;
+		BYTE * pTail = m_bin_Ring.GetTail( iRead );
+		m_bin = (CEvent *) m_bin_Ring.GetHead();	// it may have moved.
+		if ( iRead <= 0 )
+			break;
+		int iRet = (int) m_pNetQueue->m_In.Read( pTail, iRead );
+		m_bin_Ring.AddTail( iRet );
+		if ( iRet < iRead )
+			break;
+	}
+	// m_bin_Ring full = come back for the rest. (CServer::m_ClientsRecv)
+	m_fRecvPending = ( m_pNetQueue->m_In.GetUsed() != 0 );
+	if ( m_pNetQueue->m_fClosed.load( std::memory_order_acquire ) && ! m_fRecvPending )
+	{
+		return( false );	// this means that the client is gone.
+	}
 	return( true );
 }
 
@@ -594,8 +770,8 @@ bool CClient::Login_Relay( int iRelay ) // Relay player to a selected IP
 void CClient::Login_ServerList( char * pszAccount, char * pszPassword ) // Initial login (Login on "loginserver", new format)
 {
 	// If the messages are garbled make sure they are terminated to correct length.
-	pszAccount[ sizeof( m_bin.ServersReq.m_name ) -1 ] = '\0';
-	pszPassword[ sizeof( m_bin.ServersReq.m_password ) -1 ] = '\0';
+	pszAccount[ sizeof( m_bin->ServersReq.m_name ) -1 ] = '\0';
+	pszPassword[ sizeof( m_bin->ServersReq.m_password ) -1 ] = '\0';
 
 	// Make sure the first server matches the GetSockName here
 	if ( g_Log.IsLogged( LOGL_TRACE ))
@@ -80,6 +80,7 @@ void CClient::addObjectRemove( CObjUID uid )
 	cmd.Remove.m_Cmd = XCMD_Remove;
 	cmd.Remove.m_UID = uid;
 	xSendPkt( &cmd, sizeof( cmd.Remove ));
+	m_Known.Remove( uid.GetIndex());
 }
 
 void CClient::addRemoveAll( bool fItems, bool fChars )
@@ -136,6 +137,8 @@ void CClient::addItem_OnGround( CItem * pItem ) // Send items (on ground)
 	BYTE bFlags = 0;
 	BYTE bDir = DIR_N;
 
+	m_Known.Add( pItem->GetUID().GetIndex());
+
 	// Modify the values for the specific client/item.
 	bool fHumanCorpse = ( wID == ITEMID_CORPSE && CCharBase::IsHuman( pItem->GetCorpseType() ));
 
@@ -638,7 +641,7 @@ void CClient::addItemDragCancel( BYTE type )
 	xSendPkt( &cmd, sizeof( cmd.DragCancel ));
 }
 
-void CClient::addBarkUNICODE( const NCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color, TALKMODE_TYPE mode, FONT_TYPE font, const char * pszLanguage )
+void CClient::addBarkUNICODE( const NCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color, TALKMODE_TYPE mode, FONT_TYPE font, const char * pszLanguage, CNetBroadcastList * pShare )
 {
 	if ( pText == NULL ) return;
 
@@ -687,10 +690,10 @@ void CClient::addBarkUNICODE( const NCHAR * pText, const CObjBaseTemplate * pSrc
 	{
 		cmd.SpeakUNICODE.m_id = (dynamic_cast <const CChar*>(pSrc))->GetDispID();
 	}
-	xSendPkt( &cmd, len );
+	xSendPkt( &cmd, len, pShare );
 }
 
-void CClient::addBark(const TCHAR* pText, const CObjBaseTemplate* pSrc, COLOR_TYPE color, TALKMODE_TYPE mode, FONT_TYPE font)
+void CClient::addBark(const TCHAR* pText, const CObjBaseTemplate* pSrc, COLOR_TYPE color, TALKMODE_TYPE mode, FONT_TYPE font, CNetBroadcastList * pShare)
 {
 	if (pText == NULL)
 		return;
@@ -767,7 +770,7 @@ void CClient::addBark(const TCHAR* pText, const CObjBaseTemplate* pSrc, COLOR_TY
 		cmd.Speak.m_id = (dynamic_cast<const CChar*>(pSrc))->GetDispID();
 	}
 	strncpy(cmd.Speak.m_text, textToSend.c_str(), MAX_TALK_BUFFER); // use text here
-	xSendPkt(&cmd, len);
+	xSendPkt(&cmd, len, pShare);
 }
 
 void CClient::addObjMessage( const TCHAR *pMsg, const CObjBaseTemplate * pSrc, COLOR_TYPE color ) // The message when an item is clicked
@@ -931,7 +934,7 @@ void CClient::GetAdjustedCharID( const CChar * pChar, CREID_TYPE & id, COLOR_TYP
 	}
 }
 
-void CClient::addCharMove( const CChar * pChar )
+void CClient::addCharMove( const CChar * pChar, CNetBroadcastList * pShare )
 {
 	// This char has just moved on screen.
 	// or changed in a subtle way like "hidden"
@@ -963,7 +966,7 @@ void CClient::addCharMove( const CChar * pChar )
 		cmd.CharMove.m_z = m_pChar->GetTopZ();
 	}
 
-	xSendPkt( &cmd, sizeof(cmd.CharMove));
+	xSendPkt( &cmd, sizeof(cmd.CharMove), pShare );
 }
 
 void CClient::addChar( const CChar * pChar )
@@ -1049,6 +1052,7 @@ void CClient::addChar( const CChar * pChar )
 
 	cmd.Char.m_len = len;
 	xSendPkt( &cmd, len );
+	m_Known.Add( pChar->GetUID().GetIndex());
 }
 
 void CClient::addItemName( const CItem * pItem )
@@ -1250,6 +1254,7 @@ void CClient::addPlayerStart( CChar * pChar )
 {
 	m_pChar = pChar;
 	m_pChar->ClientAttach( this );
+	m_Known.Empty();
 	ASSERT( pChar->m_pPlayer && pChar->m_pNPC == NULL );
 
 	CItem * pItemChange = m_pChar->ContentFindType( ITEM_EQ_CLIENT_LINGER );
@@ -1832,26 +1837,78 @@ void CClient::addPlayerSee( const CPointMap & ptold )
 {
 	// adjust to my new location.
 	// What do I now see here ?
+	// ptold = not valid = the client has nothing. (resync)
+	// NOTE: For a move we only look at the edges of the view we just crossed.
+	//  Things that move or leave on their own fix m_Known as they go.
+	//  (CChar::UpdateMove, RemoveFromView, CItemsList::OnRemoveOb)
 
-	// What new things do i see (on the ground) ?
-	CWorldSearch AreaItems( m_pChar->GetTopPoint(), UO_MAP_VIEW_RADAR );
-	while (true)
+	static const int sm_ItemRange[] = { UO_MAP_VIEW_RADAR, UO_MAP_VIEW_SIZE };	// CItem::GetVisualRange()
+
+	CPointMap pt = m_pChar->GetTopPoint();
+	bool fMoved = ptold.IsValid();
+	int iItemRanges = fMoved ? COUNTOF(sm_ItemRange) : 1;
+	if ( ! fMoved )
 	{
-		CItem * pItem = AreaItems.GetItem();
-		if ( pItem == NULL ) 
-			break;
-		if ( ! CanSee( pItem )) 
-			continue;
+		m_Known.Empty();
+	}
+	else if ( m_Known.GetCount())
+	{
+		// What did i leave behind ? The client forgets things that are out of view.
+		// (multis are seen from further away, so they stay known out to GetVisualRange())
+		for ( int i=0; i<iItemRanges; i++ )
+		{
+			CWorldSearch AreaItems( ptold, sm_ItemRange[i] );
+			AreaItems.SetMovedFrom( pt );
+			while (true)
+			{
+				CItem * pItem = AreaItems.GetItem();
+				if ( pItem == NULL )
+					break;
+				if ( pt.GetDist( pItem->GetTopPoint()) > pItem->GetVisualRange())
+				{
+					m_Known.Remove( pItem->GetUID().GetIndex());
+				}
+			}
+		}
+		CWorldSearch AreaChars( ptold, UO_MAP_VIEW_SIZE );
+		AreaChars.SetMovedFrom( pt );
+		AreaChars.SetInertView( true );
+		while (true)
+		{
+			CChar * pChar = AreaChars.GetChar();
+			if ( pChar == NULL )
+				break;
+			m_Known.Remove( pChar->GetUID().GetIndex());
+		}
+	}
 
-		// I didn't see it before
-		if ( ptold.GetDist( pItem->GetTopPoint()) > UO_MAP_VIEW_SIZE )
+	// What new things do i see (on the ground) ?
+	for ( int i=0; i<iItemRanges; i++ )
+	{
+		CWorldSearch AreaItems( pt, sm_ItemRange[i] );
+		if ( fMoved )
 		{
+			AreaItems.SetMovedFrom( ptold );
+		}
+		while (true)
+		{
+			CItem * pItem = AreaItems.GetItem();
+			if ( pItem == NULL ) 
+				break;
+			if ( IsKnown( pItem ))
+				continue;	// I saw it before.
+			if ( ! CanSee( pItem )) 
+				continue;
 			addItem( pItem );
 		}
 	}
 
 	// What new people do i see ?
-	CWorldSearch AreaChars( m_pChar->GetTopPoint(), UO_MAP_VIEW_SIZE );
+	CWorldSearch AreaChars( pt, UO_MAP_VIEW_SIZE );
+	if ( fMoved )
+	{
+		AreaChars.SetMovedFrom( ptold );
+	}
 	AreaChars.SetInertView( IsPriv( PRIV_ALLSHOW ));	// show logged out chars?
 	while (true)
 	{
@@ -1860,13 +1917,11 @@ void CClient::addPlayerSee( const CPointMap & ptold )
 			break;
 		if ( m_pChar == pChar ) 
 			continue;	// I saw myself before.
+		if ( IsKnown( pChar ))
+			continue;
 		if ( ! CanSee( pChar )) 
 			continue;
-
-		if ( ptold.GetDist( pChar->GetTopPoint()) > UO_MAP_VIEW_SIZE )
-		{
-			addChar( pChar );
-		}
+		addChar( pChar );
 	}
 }
 
@@ -2426,7 +2481,7 @@ bool CClient::addBBoardMessage( const CItemContainer * pBoard, BYTE flag, CObjUI
 	int len = 4;
 	PACKUINT(cmd.BBoard.m_data+0,pMsgItem->GetUID());
 
-	if ( m_bin.BBoard.m_flag == 4 )
+	if ( m_bin->BBoard.m_flag == 4 )
 	{
 		// just the header has this ? (replied to message?)
 		PACKUINT(cmd.BBoard.m_data+4,0);
@@ -2468,7 +2523,7 @@ bool CClient::addBBoardMessage( const CItemContainer * pBoard, BYTE flag, CObjUI
 	strcpy( (TCHAR*) &cmd.BBoard.m_data[len], sDate );
 	len += lenstr;
 
-	if ( m_bin.BBoard.m_flag == 3 )
+	if ( m_bin->BBoard.m_flag == 3 )
 	{
 		// request for full message body
 		//
@@ -2635,7 +2690,7 @@ void CClient::addEnableChatButton()
 	xSendPkt( &cmd, sizeof(cmd.ReDrawAll)); // who knows what this does?
 }
 
-void CClient::addChatSystemMessage( CHATMSG_TYPE iType, const TCHAR * pszName1, const TCHAR * pszName2, const char * pszLang)
+void CClient::addChatSystemMessage( CHATMSG_TYPE iType, const TCHAR * pszName1, const TCHAR * pszName2, const char * pszLang, CNetBroadcastList * pShare )
 {
 	if (!g_Serv.m_fEnableChat)
 		return;
@@ -2660,7 +2715,7 @@ void CClient::addChatSystemMessage( CHATMSG_TYPE iType, const TCHAR * pszName1,
 
 	int len = sizeof(cmd.ChatReq) + (len1*2) + (len2*2);
 	cmd.ChatReq.m_len = len;
-	xSendPkt( &cmd, len );
+	xSendPkt( &cmd, len, pShare );
 }
 
 void CClient::addGumpMenu( TARGMODE_TYPE dwGumpID, const CGString * psControls, int iControls, const CGString * psText, int iTexts, int x, int y, CObjBase * pObj )
@@ -3228,7 +3283,7 @@ void CClient::Setup_CreateDialog() // All the character creation stuff
 	// ??? Make sure they don't already have too many chars !
 
         CChar* pChar = CChar::CreateBasic(CREID_MAN);
-        if (!pChar->InitPlayer(&m_bin, this))
+        if (!pChar->InitPlayer(m_bin, this))
         {
                 pChar->Delete();
                 return;
@@ -3311,6 +3366,7 @@ void CClient::Setup_ListReq( const TCHAR * pszAccount, const TCHAR * pszPassword
 {
 	// Gameserver login and character listing
 	m_fGameServer = true;	// Client thinks it's talking to a game server now.
+	g_Serv.SocketsAttachThread( this );	// NETTHREADS
 	if ( GetTargMode() == TARGMODE_SETUP_CONNECT ||
 		GetTargMode() == TARGMODE_SETUP_RELAY )
 	{
@@ -2176,6 +2176,33 @@ void CItem::ConvertBolttoCloth()
 	SetAmountUpdate( 50 * GetAmount());
 }
 
+bool CItem::IsTrigUsed( ITRIG_TYPE trigger, CTextConsole * pSrc )
+{
+	// Could OnTrigger() find anything to run for this ?
+	// Same places it looks. But only the trigger masks. no scripts run.
+
+	if ( pSrc == NULL ) 
+	{
+		pSrc = &g_Serv;
+	}
+	CChar * pChar = pSrc->GetChar();
+	if ( pChar && pChar->m_pPlayer && pChar->m_pPlayer->m_Plot1 )
+		return( true );	// plot items can catch anything.
+
+	DWORD dwMask;
+	if ( m_type >= ITEM_TRIGGER )
+	{
+		dwMask = g_Serv.GetTrigTypeMask( m_type );
+	}
+	else
+	{
+		if ( ! m_pDef->Can( CAN_TRIGGER ))
+			return( false );
+		dwMask = m_pDef->GetTrigMask( sm_szTrigName, ITRIG_QTY );
+	}
+	return(( dwMask & ( 1 << trigger )) ? true : false );
+}
+
 bool CItem::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg )
 {
 	// Is there trigger code in the script file ?
@@ -2200,13 +2227,13 @@ bool CItem::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg
 			ASSERT( i < 32 );
 			if ( ! ( dwPlot & 1 ))
 				continue;
-			CScriptLock s;
-			if ( ! g_Serv.ScriptLockPlot( s, i ))
+			const CScriptCompiled * pProg = g_Serv.GetPlotCompiled( i );
+			if ( pProg == NULL )
 			{
 				DEBUG_ERR(( "0%x '%s' has unhandled [PLOTITEM %d]\n", pChar->GetUID(), pChar->GetName(), i ));
 				continue;
 			}
-			TRIGRET_TYPE iRet = CScriptObj::OnTriggerScript( s, pszTrigName, pSrc, iArg );
+			TRIGRET_TYPE iRet = CScriptObj::OnTriggerScript( pProg, pszTrigName, pSrc, iArg );
 			if ( iRet == TRIGRET_RET_TRUE )
 			{
 				return( true );	// Block further action.
@@ -2216,11 +2243,12 @@ bool CItem::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg
 
 	// Do special stuff based on item type.
 
-	CScriptLock s;
+	const CScriptCompiled * pProg;
 	if ( m_type >= ITEM_TRIGGER )
 	{
 		// It has an assigned trigger type.
-		if ( ! g_Serv.ScriptLockTrig( s, m_type ))
+		pProg = g_Serv.GetTrigCompiled( m_type );
+		if ( pProg == NULL )
 		{
 			DEBUG_ERR(( "0%x '%s' has unhandled [TRIG %d]\n", pChar->GetUID(), pChar->GetName(), m_type ));
 			return( false );
@@ -2231,11 +2259,12 @@ bool CItem::OnTrigger( const TCHAR * pszTrigName, CTextConsole * pSrc, int iArg
 		// Look up the trigger in the GRAYITEM.SCP file.
 		if ( ! m_pDef->Can( CAN_TRIGGER ))
 			return( false );
-		if ( ! m_pDef->ScriptLockBase(s))
+		pProg = m_pDef->GetBaseCompiled();
+		if ( pProg == NULL )
 			return( false );
 	}
 
-	bool fRet = ( CScriptObj::OnTriggerScript( s, pszTrigName, pSrc, iArg ) == TRIGRET_RET_TRUE );
+	bool fRet = ( CScriptObj::OnTriggerScript( pProg, pszTrigName, pSrc, iArg ) == TRIGRET_RET_TRUE );
 
 	if ( ! fRet )
 	{
@@ -2283,7 +2312,8 @@ void CItem::Update( const CClient * pClientExclude )
 {
 	// Send this new item to all that can see it.
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == pClientExclude )
 			continue;
@@ -175,10 +175,9 @@ inline signed char CItemBase::GetItemHeightFlags( const CUOItemTypeRec & tile, W
 	return( tile.m_height );
 }
 
-signed char CItemBase::GetItemHeight( ITEMID_TYPE id, WORD & wBlockThis ) // static
+signed char CItemBase::GetItemHeightCalc( ITEMID_TYPE id, WORD & wBlockThis ) // static
 {
-	// Get just the height and the blocking flags for the item by id.
-	// used for walk block checking.
+	// Work out the height and the blocking flags for the item by id.
 
 	CUOItemTypeRec tile;
 	if ( ! GetItemData( id, &tile ))
@@ -194,6 +193,25 @@ signed char CItemBase::GetItemHeight( ITEMID_TYPE id, WORD & wBlockThis ) // sta
 	return( GetItemHeightFlags( tile, wBlockThis ));
 }
 
+alignas(64) CItemBase::CHeightRec CItemBase::sm_Height[ITEMID_MULTI];
+bool CItemBase::sm_fHeightTable = false;
+
+void CItemBase::InitHeightTable() // static
+{
+	// Do GetItemHeightCalc() once for every tile.
+	// CWorld::GetHeight() wants this for every static on every step.
+	sm_fHeightTable = false;
+	if ( ! g_TileData.IsLoaded())
+		return;
+	for ( int i=0; i<ITEMID_MULTI; i++ )
+	{
+		WORD wBlockThis;
+		sm_Height[i].m_z = GetItemHeightCalc( (ITEMID_TYPE) i, wBlockThis );
+		sm_Height[i].m_wBlock = wBlockThis;
+	}
+	sm_fHeightTable = true;
+}
+
 ITEMID_TYPE CItemBase::Flip( ITEMID_TYPE id ) const
 {
 	if ( m_flip_id.GetCount())
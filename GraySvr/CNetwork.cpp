@@ -0,0 +1,531 @@
+//
+// CNetwork.cpp
+//
+// Low level network plumbing for the game server sockets.
+//
+
+#include "graysvr.h"	// predef header.
+
+/////////////////////////////////////////////////////////////////
+// -CSocketReactor
+
+CSocketReactor::CSocketReactor()
+{
+#ifdef GRAY_EPOLL
+	m_hEpoll = -1;
+#endif
+}
+
+CSocketReactor::~CSocketReactor()
+{
+	Close();
+}
+
+bool CSocketReactor::Init()
+{
+#ifdef GRAY_EPOLL
+	if ( m_hEpoll >= 0 )
+		return( true );
+	m_hEpoll = epoll_create1( EPOLL_CLOEXEC );
+	if ( m_hEpoll < 0 )
+	{
+		DEBUG_ERR(( "epoll_create FAIL %d\n", errno ));
+		return( false );
+	}
+	m_Events.resize( 256 );
+#endif
+	return( true );
+}
+
+void CSocketReactor::Close()
+{
+#ifdef GRAY_EPOLL
+	if ( m_hEpoll >= 0 )
+	{
+		close( m_hEpoll );
+		m_hEpoll = -1;
+	}
+#else
+	m_Sockets.clear();
+#endif
+	m_Ready.clear();
+	m_Writable.clear();
+}
+
+bool CSocketReactor::Add( CGSocket * pSocket )
+{
+	ASSERT( pSocket );
+	ASSERT( pSocket->IsOpen());
+#ifdef GRAY_EPOLL
+	struct epoll_event ev;
+	memset( &ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;	// EPOLLOUT = the socket drained enough to take more.
+	ev.data.ptr = pSocket;
+	if ( epoll_ctl( m_hEpoll, EPOLL_CTL_ADD, pSocket->GetSocket(), &ev ))
+	{
+		DEBUG_ERR(( "%x:epoll_ctl ADD FAIL %d\n", pSocket->GetSocket(), errno ));
+		return( false );
+	}
+#else
+	if ( m_Sockets.size() >= FD_SETSIZE )
+		return( false );
+	m_Sockets.push_back( pSocket );
+#endif
+	return( true );
+}
+
+void CSocketReactor::Remove( CGSocket * pSocket )
+{
+	// Must be called before the socket is closed.
+	ASSERT( pSocket );
+#ifdef GRAY_EPOLL
+	if ( m_hEpoll >= 0 && pSocket->IsOpen())
+	{
+		struct epoll_event ev;	// old kernels want a non NULL pointer here.
+		epoll_ctl( m_hEpoll, EPOLL_CTL_DEL, pSocket->GetSocket(), &ev );
+	}
+#else
+	for ( size_t i=0; i<m_Sockets.size(); i++ )
+	{
+		if ( m_Sockets[i] != pSocket )
+			continue;
+		m_Sockets[i] = m_Sockets.back();
+		m_Sockets.pop_back();
+		break;
+	}
+#endif
+	// Don't hand out a dead pointer if we are in the middle of the ready list.
+	for ( size_t i=0; i<m_Ready.size(); i++ )
+	{
+		if ( m_Ready[i] == pSocket )
+			m_Ready[i] = NULL;
+	}
+	for ( size_t i=0; i<m_Writable.size(); i++ )
+	{
+		if ( m_Writable[i] == pSocket )
+			m_Writable[i] = NULL;
+	}
+}
+
+int CSocketReactor::Wait( int iTimeoutUSec )
+{
+	// we task sleep in here. NOTE: this is where we give time back to the OS.
+	// RETURN: number of sockets that are ready. (GetReady())
+	//  NOTE: entries may become NULL if Remove() is called before they are looked at.
+
+	m_Ready.clear();
+	m_Writable.clear();
+
+#ifdef GRAY_EPOLL
+	if ( m_hEpoll < 0 )
+		return( 0 );
+
+	int iTimeoutMS = ( iTimeoutUSec <= 0 ) ? 0 : (( iTimeoutUSec + 999 ) / 1000 );
+	int iRet = epoll_wait( m_hEpoll, &m_Events[0], (int) m_Events.size(), iTimeoutMS );
+	if ( iRet <= 0 )
+		return( 0 );
+
+	for ( int i=0; i<iRet; i++ )
+	{
+		if ( m_Events[i].events & EPOLLOUT )
+		{
+			m_Writable.push_back( (CGSocket *) m_Events[i].data.ptr );
+		}
+		if ( m_Events[i].events & ~EPOLLOUT )
+		{
+			m_Ready.push_back( (CGSocket *) m_Events[i].data.ptr );
+		}
+	}
+	if ( iRet == (int) m_Events.size() && m_Events.size() < MAX_CLIENT_SOCKETS )
+	{
+		// There may be more waiting. they will still be there next time.
+		m_Events.resize( m_Events.size() * 2 );
+	}
+#else
+	fd_set readfds;
+	FD_ZERO(&readfds);
+
+	SOCKET nfds = 0;
+	for ( size_t i=0; i<m_Sockets.size(); i++ )
+	{
+		SOCKET hSocket = m_Sockets[i]->GetSocket();
+		FD_SET(hSocket,&readfds);
+		if ( hSocket > nfds )
+			nfds = hSocket;
+	}
+
+	timeval Timeout;	// time to wait for data.
+	Timeout.tv_sec=0;
+	Timeout.tv_usec=iTimeoutUSec;	// micro seconds = 1/1000000
+	int iRet = select( nfds+1, &readfds, NULL, NULL, &Timeout );
+	if ( iRet <= 0 )
+		return( 0 );
+
+	for ( size_t i=0; i<m_Sockets.size(); i++ )
+	{
+		if ( FD_ISSET( m_Sockets[i]->GetSocket(), &readfds ))
+		{
+			m_Ready.push_back( m_Sockets[i] );
+		}
+	}
+#endif
+
+	return( (int) m_Ready.size());
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetClientQueue
+
+CNetClientQueue::CNetClientQueue( CNetThread * pThread ) :
+	m_pThread( pThread ),
+	m_In( MAX_BUFFER + 1 ),
+	m_Stream( MAX_BUFFER ),
+	m_iSendBytes( 0 ),
+	m_fClosed( false ),
+	m_fReady( false )
+{
+	m_fInPending = true;	// there might be something waiting already.
+}
+
+bool CNetClientQueue::Push( const BYTE * pData, int iLen )
+{
+	// Hand a block of xFlush() data to the thread.
+	// The block gets compressed as a unit, just as xFlush() would have done.
+	// Never waits. SENDQUEUEHIGH is what keeps this from growing.
+	// RETURN: false = the thread has closed the socket.
+	ASSERT( iLen > 0 && iLen <= MAX_BUFFER );
+	if ( m_fClosed.load( std::memory_order_acquire ))
+		return( false );
+
+	WORD wLen = (WORD) iLen;
+	std::lock_guard<std::mutex> lock( m_OutLock );
+	m_Out.Append( (const BYTE *) &wLen, sizeof(wLen));
+	m_Out.Append( pData, iLen );
+	return( true );
+}
+
+bool CNetClientQueue::PushShared( CNetBroadcast * pPacket )
+{
+	// Hand a reference to an already Huffman coded packet to the thread.
+	// Recorded as a zero length block followed by the pointer.
+	ASSERT( pPacket && pPacket->GetCompressedBits());
+	if ( m_fClosed.load( std::memory_order_acquire ))
+		return( false );
+
+	BYTE Temp[ sizeof(WORD) + sizeof(pPacket) ];
+	*((WORD *) Temp ) = 0;
+	memcpy( Temp + sizeof(WORD), &pPacket, sizeof(pPacket));
+	pPacket->AddRef();	// the thread owns this one now.
+	std::lock_guard<std::mutex> lock( m_OutLock );
+	m_Out.Append( Temp, sizeof(Temp));
+	return( true );
+}
+
+int CNetClientQueue::GetOutBytes()
+{
+	// Bytes the thread has not picked up yet. SENDQUEUEHIGH
+	std::lock_guard<std::mutex> lock( m_OutLock );
+	return( m_Out.GetBytes());
+}
+
+/////////////////////////////////////////////////////////////////
+// -CNetThread
+
+CNetThread::CNetThread() :
+	m_fStop( false ),
+	m_fHold( false ),
+	m_iBytesRx( 0 ),
+	m_iBytesTx( 0 )
+{
+}
+
+CNetThread::~CNetThread()
+{
+	Stop();
+}
+
+bool CNetThread::Start()
+{
+	if ( m_Thread.joinable())
+		return( true );
+	if ( ! m_Reactor.Init())
+		return( false );
+	m_fStop = false;
+	m_Thread = std::thread( EntryProc, this );
+	return( true );
+}
+
+void CNetThread::Stop()
+{
+	if ( ! m_Thread.joinable())
+		return;
+	m_fStop = true;
+	m_Thread.join();
+	m_Reactor.Close();
+}
+
+void CNetThread::EntryProc( CNetThread * pThis ) // static
+{
+	while ( ! pThis->m_fStop.load( std::memory_order_acquire ))
+	{
+		while ( pThis->m_fHold.load( std::memory_order_acquire ))
+		{
+			// Let the main loop have the lock.
+			std::this_thread::yield();
+		}
+		try
+		{
+			pThis->OnTick();
+		}
+		catch (...)	// catch all
+		{
+			DEBUG_ERR(( "CNetThread FAULT\n" ));
+		}
+	}
+}
+
+void CNetThread::OnTick()
+{
+	std::lock_guard<std::mutex> lock( m_Lock );
+
+	// NOTE: don't wait long. outgoing data is picked up by polling.
+	m_Reactor.Wait( m_RecvPending.empty() ? 1000 : 0 );
+
+	int iQty = m_Reactor.GetReadyCount();
+	for ( int i=0; i<iQty; i++ )
+	{
+		CClient * pClient = static_cast <CClient*>( m_Reactor.GetReady(i));
+		if ( pClient == NULL || ! m_Clients.count( pClient ))
+			continue;
+		if ( pClient->m_pNetQueue->m_fInPending )
+			continue;	// already on the list.
+		pClient->m_pNetQueue->m_fInPending = true;
+		m_RecvPending.push_back( pClient );
+	}
+
+	// RX + Decrypt
+	for ( size_t i=0; i<m_RecvPending.size(); )
+	{
+		CClient * pClient = m_RecvPending[i];
+		if ( RecvClient( pClient ))
+		{
+			i++;
+			continue;
+		}
+		pClient->m_pNetQueue->m_fInPending = false;
+		m_RecvPending[i] = m_RecvPending.back();
+		m_RecvPending.pop_back();
+	}
+
+	// Compress + TX
+	for ( std::unordered_set<CClient*>::iterator it = m_Clients.begin(); it != m_Clients.end(); ++it )
+	{
+		SendClient( *it );
+	}
+
+	// Sockets that can take more of what is queued.
+	iQty = m_Reactor.GetWritableCount();
+	for ( int i=0; i<iQty; i++ )
+	{
+		CClient * pClient = static_cast <CClient*>( m_Reactor.GetWritable(i));
+		if ( pClient == NULL || ! m_Clients.count( pClient ))
+			continue;
+		FlushClient( pClient );
+	}
+}
+
+bool CNetThread::RecvClient( CClient * pClient )
+{
+	// RETURN: true = there may be more to read later.
+	CNetClientQueue * pQueue = pClient->m_pNetQueue;
+	if ( pQueue->m_fClosed.load( std::memory_order_relaxed ))
+		return( false );
+
+	size_t iFree = pQueue->m_In.GetFree();
+	if ( ! iFree )
+		return( true );	// main loop is behind. leave it in the kernel for now.
+	if ( iFree > sizeof(m_Buffer))
+		iFree = sizeof(m_Buffer);
+
+	int count = pClient->CGSocket::Receive( m_Buffer, (int) iFree, MSG_DONTWAIT );
+	if ( count <= 0 )
+	{
+		if ( count < 0 && CSocketReactor::IsWouldBlock())
+			return( false );	// drained.
+		// the client is gone. the main loop will clean up.
+		m_Reactor.Remove( pClient );
+		pQueue->m_fClosed.store( true, std::memory_order_release );
+		SetReady( pClient );
+		return( false );
+	}
+
+	// TCP = no missed packets ! If we miss a packet we are screwed !
+	pClient->m_Crypt.Decrypt( m_Buffer, m_Buffer, count );
+	pQueue->m_In.Write( m_Buffer, count );
+	m_iBytesRx += count;
+	SetReady( pClient );
+
+	return( (size_t) count >= iFree );
+}
+
+void CNetThread::SendClient( CClient * pClient )
+{
+	// Compress and send everything the main loop has given us.
+	CNetClientQueue * pQueue = pClient->m_pNetQueue;
+	CNetSendQueue Out;
+	{
+		std::lock_guard<std::mutex> lock( pQueue->m_OutLock );
+		Out.Take( pQueue->m_Out );
+	}
+	while ( ! Out.IsEmpty())
+	{
+		WORD wLen;
+		Out.Read( &wLen, sizeof(wLen));	// Push() adds whole blocks.
+		if ( ! wLen )
+		{
+			// PushShared() Its codes go in the open block after the rest.
+			CNetBroadcast * pPacket;
+			Out.Read( &pPacket, sizeof(pPacket));
+			if ( ! pQueue->m_fClosed.load( std::memory_order_relaxed ))
+			{
+				int len = pQueue->m_Stream.AppendBits( m_Compress, pPacket->GetCompressed(), pPacket->GetCompressedBits(), pPacket->GetLength());
+				pQueue->m_Send.Append( m_Compress, len );
+			}
+			pPacket->Release();
+			continue;
+		}
+		Out.Read( m_Buffer, wLen );
+		if ( pQueue->m_fClosed.load( std::memory_order_relaxed ))
+			continue;
+
+		int len = pQueue->m_Stream.Encode( m_Compress, m_Buffer, wLen );
+		ASSERT( len <= (int) sizeof(m_Compress));
+		pQueue->m_Send.Append( m_Compress, len );
+	}
+	if ( pQueue->m_Stream.GetLengthRaw())
+	{
+		// One end code for everything the main loop gave us this time.
+		int len = pQueue->m_Stream.Finish( m_Compress );
+		pQueue->m_Send.Append( m_Compress, len );
+	}
+	FlushClient( pClient );
+}
+
+void CNetThread::FlushClient( CClient * pClient )
+{
+	// Give the socket what it will take. The rest waits for it to be writable.
+	CNetClientQueue * pQueue = pClient->m_pNetQueue;
+	if ( pQueue->m_Send.IsEmpty())
+		return;
+	if ( pQueue->m_fClosed.load( std::memory_order_relaxed ))
+	{
+		pQueue->m_Send.Empty();
+	}
+	else
+	{
+		int iSent = pQueue->m_Send.Flush( pClient );
+		if ( iSent > 0 )
+		{
+			m_iBytesTx += iSent;
+		}
+		if ( iSent < 0 || pClient->xIsSendOverflow( pQueue->m_Send.GetBytes()))
+		{
+			// the client is gone or can't keep up. the main loop will clean up.
+			m_Reactor.Remove( pClient );
+			pQueue->m_fClosed.store( true, std::memory_order_release );
+			pQueue->m_Send.Empty();
+			SetReady( pClient );
+		}
+	}
+	pQueue->m_iSendBytes.store( pQueue->m_Send.GetBytes(), std::memory_order_relaxed );
+}
+
+void CNetThread::SetReady( CClient * pClient )
+{
+	// Tell the main loop to look at this client. Once til it takes it.
+	if ( pClient->m_pNetQueue->m_fReady.exchange( true, std::memory_order_acq_rel ))
+		return;
+	std::lock_guard<std::mutex> lock( m_ReadyLock );
+	m_Ready.push_back( pClient );
+}
+
+void CNetThread::TakeReady( std::vector<CClient*> & Clients )
+{
+	// Add the clients that have something for the main loop. (CServer::m_ClientsRecv)
+	// m_fReady is cleared first, so anything that comes in after this gets them added again.
+	std::vector<CClient*> Ready;
+	{
+		std::lock_guard<std::mutex> lock( m_ReadyLock );
+		if ( m_Ready.empty())
+			return;
+		Ready.swap( m_Ready );
+	}
+	for ( size_t i=0; i<Ready.size(); i++ )
+	{
+		CClient * pClient = Ready[i];
+		pClient->m_pNetQueue->m_fReady.store( false, std::memory_order_release );
+		if ( pClient->m_fRecvPending )
+			continue;	// already on the list.
+		pClient->m_fRecvPending = true;
+		Clients.push_back( pClient );
+	}
+}
+
+void CNetThread::Attach( CClient * pClient )
+{
+	// Take over all the socket work for this client.
+	ASSERT( pClient->m_pNetQueue == NULL );
+	pClient->xSendBlock();	// end our open compressed block. The thread starts its own.
+
+	m_fHold = true;
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		pClient->m_pNetQueue = new CNetClientQueue( this );
+		pClient->m_fRecvPending = false;
+		m_Clients.insert( pClient );
+		pClient->m_pNetQueue->m_Send.Take( pClient->m_SendQueue );	// keep the order.
+		m_Reactor.Add( pClient );
+		m_RecvPending.push_back( pClient );	// see if anything is already waiting.
+	}
+	m_fHold = false;
+}
+
+void CNetThread::Detach( CClient * pClient )
+{
+	// Give the socket back to the main loop. (it is probably being deleted)
+	CNetClientQueue * pQueue = pClient->m_pNetQueue;
+	ASSERT( pQueue && pQueue->m_pThread == this );
+
+	m_fHold = true;
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		m_Clients.erase( pClient );
+		m_Reactor.Remove( pClient );
+		for ( size_t i=0; i<m_RecvPending.size(); i++ )
+		{
+			if ( m_RecvPending[i] != pClient )
+				continue;
+			m_RecvPending[i] = m_RecvPending.back();
+			m_RecvPending.pop_back();
+			break;
+		}
+		// Anything left to send goes out now, in order.
+		SendClient( pClient );
+	}
+	m_fHold = false;
+	{
+		std::lock_guard<std::mutex> lock( m_ReadyLock );
+		for ( size_t i=0; i<m_Ready.size(); i++ )
+		{
+			if ( m_Ready[i] != pClient )
+				continue;
+			m_Ready[i] = m_Ready.back();
+			m_Ready.pop_back();
+			break;
+		}
+	}
+
+	// NOTE: anything decrypted but not yet picked up by the main loop is lost.
+	pClient->m_pNetQueue = NULL;
+	delete pQueue;
+}
@@ -0,0 +1,173 @@
+//
+// CNetwork.h
+//
+// Low level network plumbing for the game server sockets.
+// Readiness notification for the client connections.
+// Optional network threads that do the socket RX/TX work for game clients.
+//
+
+#ifndef _INC_CNETWORK_H
+#define _INC_CNETWORK_H
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#endif
+#include "../Common/cnetqueue.h"
+
+#if defined(__linux__)
+#define GRAY_EPOLL	// edge triggered epoll() instead of select()
+#endif
+
+#ifdef GRAY_EPOLL
+#include <sys/epoll.h>
+// epoll has no compile time limit. The real limit is the process file limit. (ulimit -n)
+#define MAX_CLIENT_SOCKETS	0x10000
+#else
+// select() can only watch FD_SETSIZE sockets. (listen socket included)
+#define MAX_CLIENT_SOCKETS	(FD_SETSIZE-1)
+#endif
+
+class CGSocket;
+class CClient;
+
+class CSocketReactor
+{
+	// Tell us which of the registered sockets have something to read.
+	// epoll() on LINUX (edge triggered), select() everywhere else.
+	// NOTE: edge triggered means we only hear about a socket once per new batch of data.
+	//  The owner must read until the socket is drained or remember that it is not.
+private:
+#ifdef GRAY_EPOLL
+	int m_hEpoll;
+	std::vector<struct epoll_event> m_Events;
+#else
+	std::vector<CGSocket *> m_Sockets;	// everything we are watching.
+#endif
+	std::vector<CGSocket *> m_Ready;	// results of the last Wait()
+	std::vector<CGSocket *> m_Writable;
+
+public:
+	CSocketReactor();
+	~CSocketReactor();
+
+	bool Init();
+	void Close();
+	bool IsEdgeTriggered() const
+	{
+#ifdef GRAY_EPOLL
+		return( true );
+#else
+		return( false );
+#endif
+	}
+
+	static bool IsWouldBlock()
+	{
+		// The last non blocking socket call had nothing to do.
+#ifdef _WIN32
+		return( WSAGetLastError() == WSAEWOULDBLOCK );
+#else
+		return( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR );
+#endif
+	}
+
+	bool Add( CGSocket * pSocket );
+	void Remove( CGSocket * pSocket );
+
+	int Wait( int iTimeoutUSec );	// micro seconds = 1/1000000
+	int GetReadyCount() const
+	{
+		return( (int) m_Ready.size());
+	}
+	CGSocket * GetReady( int i ) const
+	{
+		return( m_Ready[i] );
+	}
+	int GetWritableCount() const
+	{
+		return( (int) m_Writable.size());
+	}
+	CGSocket * GetWritable( int i ) const
+	{
+		// The socket can take more data now. (epoll only, select() users just try every tick)
+		return( m_Writable[i] );
+	}
+};
+
+class CNetThread;
+
+struct CNetClientQueue
+{
+	// A game client that has been handed to a CNetThread.
+	CNetThread * const m_pThread;
+	CNetRing m_In;			// decrypted data. CNetThread -> main loop
+	std::mutex m_OutLock;	// for m_Out. only held to add or take.
+	CNetSendQueue m_Out;	// uncompressed xFlush() blocks. main loop -> CNetThread. (no limit)
+	CNetSendQueue m_Send;	// (thread only) compressed and waiting for the socket.
+	CCompressStream m_Stream;	// (thread only) the open compressed block at the end of m_Send.
+	std::atomic<int> m_iSendBytes;	// m_Send.GetBytes() for the main loop. SENDQUEUEHIGH
+	std::atomic<bool> m_fClosed;	// the thread saw the socket close.
+	std::atomic<bool> m_fReady;		// on the CNetThread ready list. cleared when the main loop takes it.
+	bool m_fInPending;		// (thread only) socket may still have data we have not read.
+
+	explicit CNetClientQueue( CNetThread * pThread );
+	bool Push( const BYTE * pData, int iLen );	// main loop only.
+	bool PushShared( CNetBroadcast * pPacket );	// main loop only.
+	int GetOutBytes();
+};
+
+class CNetThread
+{
+	// Socket RX, decrypt and TX compress/send for some of the game clients.
+	// The main loop only sees the CNetClientQueue of each client.
+private:
+	std::thread m_Thread;
+	std::atomic<bool> m_fStop;
+	std::atomic<bool> m_fHold;	// the main loop wants m_Lock.
+	std::mutex m_Lock;			// held by the thread while it works.
+
+	CSocketReactor m_Reactor;
+	std::unordered_set<CClient*> m_Clients;
+	std::vector<CClient*> m_RecvPending;
+	std::mutex m_ReadyLock;		// for m_Ready.
+	std::vector<CClient*> m_Ready;	// m_In has something or the socket closed. for the main loop.
+
+	BYTE m_Buffer[ MAX_BUFFER + 1 ];
+	BYTE m_Compress[ MAX_BUFFER * 2 ];	// Encode() can grow the data a bit.
+
+public:
+	std::atomic<int> m_iBytesRx;	// For CProfileData. main loop collects these.
+	std::atomic<int> m_iBytesTx;
+
+private:
+	static void EntryProc( CNetThread * pThis );
+	void OnTick();
+	bool RecvClient( CClient * pClient );
+	void SendClient( CClient * pClient );
+	void FlushClient( CClient * pClient );
+	void SetReady( CClient * pClient );
+
+public:
+	CNetThread();
+	~CNetThread();
+
+	bool Start();
+	void Stop();
+	int GetClientCount() const
+	{
+		return( (int) m_Clients.size());
+	}
+
+	void Attach( CClient * pClient );	// main loop only.
+	void Detach( CClient * pClient );	// main loop only.
+	void TakeReady( std::vector<CClient*> & Clients );	// main loop only.
+};
+
+#endif	// _INC_CNETWORK_H
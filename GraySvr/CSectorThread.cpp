@@ -0,0 +1,70 @@
+//
+// CSectorThread.cpp
+//
+
+#include "graysvr.h"	// predef header.
+
+/////////////////////////////////////////////////////////////////
+// -CSectorThreads
+
+CSectorThreads::CSectorThreads()
+{
+	m_iPulse = 0;
+	m_Cmds.resize( 1 );
+}
+
+void CSectorThreads::Start( int iThreads )
+{
+	m_Threads.Start( iThreads );
+	m_Cmds.resize( GetThreadCount() + 1 );
+}
+
+void CSectorThreads::Stop()
+{
+	m_Threads.Stop();
+	m_Cmds.resize( 1 );
+}
+
+void CSectorThreads::OnGridCell( int iThread, int iCell )
+{
+	try
+	{
+		g_World.m_Sectors[iCell].OnTickPrepare( m_iPulse, m_Cmds[iThread] );
+	}
+	catch (...)	// catch all
+	{
+		DEBUG_ERR(( "CSectorThreads FAULT\n" ));
+	}
+}
+
+void CSectorThreads::Merge()
+{
+	// Back on the main thread. Do what the sectors could not do themselves.
+	for ( size_t j=0; j<m_Cmds.size(); j++ )
+	{
+		CSectorTickCmds Cmds;
+		Cmds.swap( m_Cmds[j] );	// so an exception can't make us do these twice.
+		for ( size_t i=0; i<Cmds.size(); i++ )
+		{
+			Cmds[i].m_pChar->OnTickRegenApply( Cmds[i].m_wRegen );
+		}
+	}
+}
+
+void CSectorThreads::OnTickPrepare( const std::vector<CSector*> & Sectors, int iPulse )
+{
+	m_Cells.clear();
+	for ( size_t i=0; i<Sectors.size(); i++ )
+	{
+		int index = Sectors[i] - g_World.m_Sectors;
+		ASSERT( index >= 0 && index < SECTOR_QTY );
+		m_Cells.push_back( index );
+	}
+
+	m_iPulse = iPulse;
+	if ( ! m_Cells.empty())
+	{
+		m_Threads.Run( *this, &m_Cells[0], (int) m_Cells.size(), SECTOR_COLS );
+	}
+	Merge();
+}
@@ -0,0 +1,57 @@
+//
+// CSectorThread.h
+//
+// Worker threads for the part of the sector pulse that stays inside each sector. (SECTORTHREADS)
+//
+
+#ifndef _INC_CSECTORTHREAD_H
+#define _INC_CSECTORTHREAD_H
+#pragma once
+
+#include "../Common/cgridthreads.h"
+#include <vector>
+
+class CChar;
+class CSector;
+
+struct CSectorTickCmd
+{
+	// Something CSector::OnTickPrepare() found that has to be done on the main thread.
+	// (it sends to clients, runs scripts or touches another sector)
+	CChar * m_pChar;
+	WORD m_wRegen;		// CChar::OnTickRegen() stats that are due.
+};
+
+typedef std::vector<CSectorTickCmd> CSectorTickCmds;
+
+class CSectorThreads : public CGridJob
+{
+	// Run CSector::OnTickPrepare() on a few threads for all the sectors of a pulse.
+	// CGridThreads keeps sectors that touch off the threads at the same time.
+	// Each thread keeps its own CSectorTickCmds. The main thread does them when all are done.
+private:
+	CGridThreads m_Threads;
+	std::vector<int> m_Cells;	// sector indexes for this pulse.
+	std::vector<CSectorTickCmds> m_Cmds;	// one per thread. [0] = the main thread.
+	int m_iPulse;
+
+private:
+	CSectorThreads( const CSectorThreads & );
+	CSectorThreads & operator=( const CSectorThreads & );
+
+	virtual void OnGridCell( int iThread, int iCell );
+	void Merge();
+
+public:
+	CSectorThreads();
+
+	int GetThreadCount() const
+	{
+		return( m_Threads.GetThreadCount());
+	}
+	void Start( int iThreads );	// 0 = Stop()
+	void Stop();
+	void OnTickPrepare( const std::vector<CSector*> & Sectors, int iPulse );	// main thread only.
+};
+
+#endif	// _INC_CSECTORTHREAD_H
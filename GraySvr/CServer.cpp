@@ -1075,6 +1075,7 @@ CServer::CServer() : CServRef( GRAY_TITLE, SOCKET_LOCAL_ADDRESS )
 
 	m_Clock_Shutdown = 0;
 	m_Clock_Periodic = 0;
+	m_Clock_ClientSweep = 0;
 
 	m_iAdminClients = 0;
 	m_fResyncPause = false;
@@ -1082,8 +1083,12 @@ CServer::CServer() : CServRef( GRAY_TITLE, SOCKET_LOCAL_ADDRESS )
 	m_iPollServers = 0;
 	m_sRegisterServer = GRAY_MAIN_SERVER;
 	m_fMainLogServer = false;
+	m_iMapCacheSize = 32 * 1024 * 1024;
 	m_iMapCacheTime = 2 * 60 * TICK_PER_SEC;
 	m_iSectorSleepMask = 0x1ff;
+	m_iSectorThreads = 0;
+	m_iWorldTickBudget = 10;
+	m_fScriptImage = true;
 
 	m_fNamesLoaded = false;
 
@@ -1109,7 +1114,10 @@ CServer::CServer() : CServRef( GRAY_TITLE, SOCKET_LOCAL_ADDRESS )
 	m_iDecay_CorpsePlayer = 45*60*TICK_PER_SEC;
 	m_iDecay_CorpseNPC = 15*60*TICK_PER_SEC;
         // Accounts
-	m_nClientsMax = FD_SETSIZE-1;
+	m_nClientsMax = FD_SETSIZE-1;	// MAX_CLIENT_SOCKETS may be much bigger.
+	m_iNetThreads = 0;
+	m_iSendQueueHigh = 512*1024;
+	m_iSendQueueLow = 64*1024;
 	m_fRequireEmail = false;
 	m_nGuestsMax = 0;
 	m_nGuestsCur = 0;
@@ -1198,6 +1206,19 @@ void CServer::LoadChangedFiles()
 	// m_FragFiles
 	// m_WebPages
 
+	// Re-index the script files that changed on disk.
+	// (a SCRIPTIMAGE does not change until the resync reads it again)
+	bool fIndexed = false;
+	for ( int j=0; j<SCPFILE_QTY; j++ )
+	{
+		if ( IndexScpFile((SCPFILE_TYPE)j ))
+			fIndexed = true;
+	}
+	if ( fIndexed )
+	{
+		g_ScriptCompiled.Clear();	// compiled by offset. the offsets moved.
+	}
+
 	if ( m_sChangedBaseDir.IsEmpty())
 		return;
 
@@ -1213,6 +1234,9 @@ void CServer::LoadChangedFiles()
 	if ( iRet <= 0 )	// no files here.
 		return;
 
+	// Anything compiled from the old scripts is no good now.
+	g_ScriptCompiled.Clear();
+
 	bool fSetResync = false;
 	TCHAR szTmpDir[ _MAX_PATH ];
 	strcpy( szTmpDir, m_sChangedBaseDir );
@@ -1348,6 +1372,7 @@ bool CServer::OnConsoleCmd( CGString & sText, CTextConsole * pSrc )
 			"A = Accounts file update\n"
 			"B message = Broadcast a message\n"
 			"C = Clients List (%d)\n"
+			"F = Script file section index\n"
 			"G = Garbage collection\n"
 			"H = Hear all that is said (%s)\n"
 			"I = Information\n"
@@ -1434,6 +1459,16 @@ do_saving:
 	case 'I':
 		pSrc->SysMessage( GetStatusString( 0x22 ));
 		pSrc->SysMessage( GetStatusString( 0x24 ));
+		pSrc->SysMessagef( "Map cache: Blocks=%d, Mem=%iK/%iK, Hits=%u, Misses=%u, Evictions=%u\n",
+			g_World.m_MapCache.GetCount(),
+			g_World.m_MapCache.GetMem()/1024,
+			m_iMapCacheSize/1024,
+			g_World.m_MapCache.m_dwHits,
+			g_World.m_MapCache.m_dwMisses,
+			g_World.m_MapCache.m_dwEvictions );
+		break;
+	case 'F':
+		ListScpIndex( pSrc );
 		break;
 	case 'C':
 	case 'W':
@@ -1774,6 +1809,7 @@ enum SC_TYPE
 	SC_DUNGEONLIGHT,
 	SC_ENABLECHAT,
 	SC_EQUIPPEDCAST,				// m_fEquippedCast
+	SC_EXPRCOMPILE,			// g_Exp.m_fCompile
 	SC_FILES,	//
 	SC_FLIPDROPPEDITEMS,			// m_fFlipDroppedItems
 	SC_FORCEGARBAGECOLLECT,		// m_fSaveGarbageCollect
@@ -1794,6 +1830,7 @@ enum SC_TYPE
 	SC_LOOTINGISACRIME,		// m_fLootingIsACrime
 	SC_MAGICUNLOCKDOOR,		// m_iMagicUnlockDoor
 	SC_MAINLOGSERVER,		// m_fMainLogServer
+	SC_MAPCACHESIZE,			// m_iMapCacheSize
 	SC_MAPCACHETIME,
 	SC_MAXBASESKILL,			// m_iMaxBaseSkill
 	SC_MAXCHARSPERACCOUNT,	// m_iMaxCharsPerAccount
@@ -1812,6 +1849,7 @@ enum SC_TYPE
         SC_MYSQLPORT,
         SC_MYSQLPREFIX,
         SC_MYSQLUSER,
+	SC_NETTHREADS,			// m_iNetThreads
 	SC_NOWEATHER,				// m_fNoWeather
 	SC_NPCTRAINMAX,			// m_iTrainSkillMax
 	SC_NPCTRAINPERCENT,			// m_iTrainSkillPercent
@@ -1832,8 +1870,12 @@ enum SC_TYPE
 	SC_SAVEBACKGROUND,			// m_iSaveBackgroundTime
 	SC_SAVEPERIOD,
 	SC_SCPFILES,
+	SC_SCRIPTIMAGE,			// m_fScriptImage
 	SC_SECTORSLEEP,				// m_iSectorSleepMask
+	SC_SECTORTHREADS,		// m_iSectorThreads
 	SC_SECURE,
+	SC_SENDQUEUEHIGH,			// m_iSendQueueHigh
+	SC_SENDQUEUELOW,			// m_iSendQueueLow
 	SC_SNOOPCRIMINAL,
 	SC_SPEECHFILES,
 	SC_STAMINALOSSATWEIGHT,	// m_iStaminaLossAtWeight
@@ -1845,6 +1887,7 @@ enum SC_TYPE
 	SC_WOPPLAYER,
 	SC_WOPSTAFF,
 	SC_WORLDSAVE,
+	SC_WORLDTICKBUDGET,		// m_iWorldTickBudget
 	
 	SC_QTY
 };
@@ -1873,6 +1916,7 @@ const TCHAR * CServer::sm_KeyTable[SC_QTY] =
 	"DUNGEONLIGHT",
 	"ENABLECHAT",
 	"EQUIPPEDCAST",				// m_fEquippedCast
+	"EXPRCOMPILE",			// g_Exp.m_fCompile
 	"FILES",	//
 	"FLIPDROPPEDITEMS",			// m_fFlipDroppedItems
 	"FORCEGARBAGECOLLECT",		// m_fSaveGarbageCollect
@@ -1893,6 +1937,7 @@ const TCHAR * CServer::sm_KeyTable[SC_QTY] =
 	"LOOTINGISACRIME",		// m_fLootingIsACrime
 	"MAGICUNLOCKDOOR",		// m_iMagicUnlockDoor
 	"MAINLOGSERVER",		// m_fMainLogServer
+	"MAPCACHESIZE",			// m_iMapCacheSize
 	"MAPCACHETIME",
 	"MAXBASESKILL",			// m_iMaxBaseSkill
 	"MAXCHARSPERACCOUNT",	// m_iMaxCharsPerAccount
@@ -1911,6 +1956,7 @@ const TCHAR * CServer::sm_KeyTable[SC_QTY] =
         "MYSQLPORT",
         "MYSQLPREFIX",
         "MYSQLUSER",
+	"NETTHREADS",			// m_iNetThreads
 	"NOWEATHER",				// m_fNoWeather
 	"NPCTRAINMAX",			// m_iTrainSkillMax
 	"NPCTRAINPERCENT",			// m_iTrainSkillPercent
@@ -1931,8 +1977,12 @@ const TCHAR * CServer::sm_KeyTable[SC_QTY] =
 	"SAVEBACKGROUND",			// m_iSaveBackgroundTime
 	"SAVEPERIOD",
 	"SCPFILES",
+	"SCRIPTIMAGE",			// m_fScriptImage
 	"SECTORSLEEP",				// m_iSectorSleepMask
+	"SECTORTHREADS",		// m_iSectorThreads
 	"SECURE",
+	"SENDQUEUEHIGH",			// m_iSendQueueHigh
+	"SENDQUEUELOW",			// m_iSendQueueLow
 	"SNOOPCRIMINAL",
 	"SPEECHFILES",
 	"STAMINALOSSATWEIGHT",	// m_iStaminaLossAtWeight
@@ -1944,6 +1994,7 @@ const TCHAR * CServer::sm_KeyTable[SC_QTY] =
 	"WOPPLAYER",
 	"WOPSTAFF",
 	"WORLDSAVE",
+	"WORLDTICKBUDGET",		// m_iWorldTickBudget
 };
 
 bool CServer::r_LoadVal( CScript &s )
@@ -2008,6 +2059,9 @@ bool CServer::r_LoadVal( CScript &s )
 	case SC_EQUIPPEDCAST:
 		m_fEquippedCast = s.GetArgVal();
 		break;
+	case SC_EXPRCOMPILE:
+		g_Exp.m_fCompile = s.GetArgVal() ? true : false;
+		break;
 	case SC_FILES: // Get data files from here.
 		goto do_mulfiles;
 	case SC_FREESERVER:
@@ -2075,6 +2129,9 @@ bool CServer::r_LoadVal( CScript &s )
 do_mulfiles:
 		g_Install.SetPreferPath( GetMergedFileName( s.GetArgStr(), "" ));
 		break;
+	case SC_MAPCACHESIZE:
+		m_iMapCacheSize = s.GetArgVal() * 1024;
+		break;
 	case SC_MAPCACHETIME:
 		m_iMapCacheTime = s.GetArgVal() * TICK_PER_SEC;
 		break;
@@ -2135,6 +2192,9 @@ do_mulfiles:
 	case SC_NPCTRAINPERCENT:
 		m_iTrainSkillPercent = s.GetArgVal();
 		break;
+	case SC_NETTHREADS:
+		m_iNetThreads = s.GetArgVal();
+		break;
 	case SC_NOWEATHER:
 		m_fNoWeather = s.GetArgVal();
 		break;
@@ -2179,6 +2239,9 @@ do_mulfiles:
 	case SC_SCPFILES: // Get SCP files from here.
 		m_sSCPBaseDir = GetMergedFileName( s.GetArgStr(), "" );
 		break;
+	case SC_SECTORTHREADS:
+		m_iSectorThreads = s.GetArgVal();
+		break;
 	case SC_SECURE:
 		m_fSecure = s.GetArgVal();
 		SetSignals();
@@ -2192,9 +2255,18 @@ do_mulfiles:
 	case SC_STAMINALOSSATWEIGHT:
 		m_iStaminaLossAtWeight = s.GetArgVal();
 		break;
+	case SC_SENDQUEUEHIGH:
+		m_iSendQueueHigh = s.GetArgVal() * 1024;
+		break;
+	case SC_SENDQUEUELOW:
+		m_iSendQueueLow = s.GetArgVal() * 1024;
+		break;
 	case SC_SNOOPCRIMINAL:
 		m_iSnoopCriminal = s.GetArgVal();
 		break;
+	case SC_SCRIPTIMAGE:
+		m_fScriptImage = s.GetArgVal() ? true : false;
+		break;
 	case SC_SECTORSLEEP:
 		m_iSectorSleepMask = ( 1 << s.GetArgVal()) - 1;
 		break;
@@ -2224,6 +2296,9 @@ do_mulfiles:
 	case SC_WORLDSAVE: // Put save files here.
 		m_sWorldBaseDir = GetMergedFileName( s.GetArgStr(), "" );
 		break;
+	case SC_WORLDTICKBUDGET:
+		m_iWorldTickBudget = s.GetArgVal();
+		break;
 	case SC_AUTORESURRECT:
 		m_fAutoResurrect = s.GetArgVal();
 		break;
@@ -2397,6 +2472,9 @@ do_guilds:
 	case SC_EQUIPPEDCAST:
 		sVal.FormatVal( m_fEquippedCast );
 		break;
+	case SC_EXPRCOMPILE:
+		sVal.FormatVal( g_Exp.m_fCompile );
+		break;
 	case SC_FILES: // Get data files from here.
 		goto do_mulfiles;
 	case SC_FREESERVER:
@@ -2454,6 +2532,9 @@ do_freeserver:
 do_mulfiles:
 		sVal = g_Install.GetPreferPath( NULL );
 		break;
+	case SC_MAPCACHESIZE:
+		sVal.FormatVal( m_iMapCacheSize / 1024 );
+		break;
 	case SC_MAPCACHETIME:
 		sVal.FormatVal( m_iMapCacheTime / TICK_PER_SEC );
 		break;
@@ -2514,6 +2595,9 @@ do_mulfiles:
 	case SC_NPCTRAINPERCENT:
 		sVal.FormatVal( m_iTrainSkillPercent );
 		break;
+	case SC_NETTHREADS:
+		sVal.FormatVal( m_iNetThreads );
+		break;
 	case SC_NOWEATHER:
 		sVal.FormatVal( m_fNoWeather );
 		break;
@@ -2552,6 +2636,9 @@ do_mulfiles:
 	case SC_SCPFILES:	// Get SCP files from here.
 		sVal = m_sSCPBaseDir;
 		break;
+	case SC_SECTORTHREADS:
+		sVal.FormatVal( m_iSectorThreads );
+		break;
 	case SC_SECURE:
 		sVal.FormatVal( m_fSecure );
 		break;
@@ -2561,9 +2648,18 @@ do_mulfiles:
 	case SC_SPEECHFILES:
 		sVal = m_sSpeechBaseDir;
 		break;
+	case SC_SENDQUEUEHIGH:
+		sVal.FormatVal( m_iSendQueueHigh / 1024 );
+		break;
+	case SC_SENDQUEUELOW:
+		sVal.FormatVal( m_iSendQueueLow / 1024 );
+		break;
 	case SC_SNOOPCRIMINAL:
 		sVal.FormatVal( m_iSnoopCriminal );
 		break;
+	case SC_SCRIPTIMAGE:
+		sVal.FormatVal( m_fScriptImage );
+		break;
 	case SC_SECTORSLEEP:
 		sVal.FormatVal( GetLog2( m_iSectorSleepMask+1 )-1 );
 		break;
@@ -2593,6 +2689,9 @@ do_mulfiles:
 	case SC_WORLDSAVE:	// Put save files here.
 		sVal = m_sWorldBaseDir;
 		break;
+	case SC_WORLDTICKBUDGET:
+		sVal.FormatVal( m_iWorldTickBudget );
+		break;
 	case SC_AUTORESURRECT:
 		sVal.FormatVal(m_fAutoResurrect);
 		break;
@@ -3041,6 +3140,53 @@ void CServer::ListServers( CTextConsole * pConsole ) const
 	}
 }
 
+void CServer::ListScpIndex( CTextConsole * pConsole ) const
+{
+	// How the script section index is doing.
+	ASSERT( pConsole );
+
+	int iFiles = 0;
+	int iSections = 0;
+	DWORD dwLookups = 0;
+	DWORD dwHits = 0;
+	for ( int i=0; i<SCPFILE_QTY; i++ )
+	{
+		const CScriptIndex & Index = m_ScriptIndex[i];
+		if ( ! Index.IsBuilt())
+			continue;
+		pConsole->SysMessagef( "%s: Sections=%d, Names=%d, Buckets=%d, Lookups=%u, Hits=%u, Misses=%u, Builds=%d\n",
+			m_Scripts[i].GetFileTitle(),
+			Index.GetSectionCount(),
+			Index.GetNameCount(),
+			Index.GetBucketCount(),
+			Index.m_dwLookups,
+			Index.m_dwHits,
+			Index.m_dwMisses,
+			Index.m_iBuilds );
+		iFiles ++;
+		iSections += Index.GetSectionCount();
+		dwLookups += Index.m_dwLookups;
+		dwHits += Index.m_dwHits;
+	}
+	int iImages = 0;
+	size_t iImageMem = 0;
+	for ( int i=0; i<SCPFILE_QTY; i++ )
+	{
+		const CScriptImage * pImage = m_Scripts[i].GetImage();
+		if ( pImage == NULL )
+			continue;
+		iImages ++;
+		iImageMem += pImage->GetSize();
+	}
+	pConsole->SysMessagef( "Script index: Files=%d, Sections=%d, Lookups=%u, Hits=%u, Images=%d (%iK), Compiled=%d (%iK)\n",
+		iFiles, iSections, dwLookups, dwHits,
+		iImages, (int)( iImageMem/1024 ),
+		g_ScriptCompiled.GetCount(), (int)( g_ScriptCompiled.GetMem()/1024 ));
+	pConsole->SysMessagef( "Expressions: Compiled=%d (%iK), Hits=%u, Misses=%u, Compiles=%u\n",
+		g_Exp.GetCacheCount(), (int)( g_Exp.GetCacheMem()/1024 ),
+		g_Exp.m_dwCacheHits, g_Exp.m_dwCacheMisses, g_Exp.m_dwCompiles );
+}
+
 void CServer::ListClients( CTextConsole * pConsole ) const
 {
 	ASSERT( pConsole );
@@ -3092,54 +3238,181 @@ void CServer::ListClients( CTextConsole * pConsole ) const
 	}
 }
 
-void CServer::SocketsReceive() // Check for messages from the clients
+void CServer::SocketsAttach( CClient * pClient )
 {
-	// What sockets do I want to look at ?
-	fd_set readfds;
-	FD_ZERO(&readfds);
+	// A new client socket. Tell me when it has something to say.
+	ASSERT( pClient );
+	if ( ! m_SocketReactor.Add( pClient ))
+	{
+		DEBUG_ERR(( "%x:Can't watch client socket\n", pClient->GetSocket()));
+	}
+}
+
+void CServer::SocketsAttachThread( CClient * pClient )
+{
+	// This is a game client now. Let a CNetThread do its socket work. NETTHREADS
+	ASSERT( pClient );
+	if ( m_NetThreads.empty() || pClient->xIsNetThreaded())
+		return;
 
-	FD_SET(GetSocket(), &readfds);
-	int nfds = GetSocket();
+	CNetThread * pThread = m_NetThreads[0];
+	for ( size_t i=1; i<m_NetThreads.size(); i++ )
+	{
+		if ( m_NetThreads[i]->GetClientCount() < pThread->GetClientCount())
+			pThread = m_NetThreads[i];
+	}
+
+	SocketsDetach( pClient );
+	pThread->Attach( pClient );
+}
+
+void CServer::SocketsDetach( CClient * pClient )
+{
+	// The client is going away. Forget all about it.
+	ASSERT( pClient );
+	if ( pClient->xIsNetThreaded())
+	{
+		pClient->xGetNetThread()->Detach( pClient );
+	}
+	m_SocketReactor.Remove( pClient );
+	for ( size_t i=0; i<m_ClientsRecv.size(); i++ )
+	{
+		if ( m_ClientsRecv[i] == pClient )
+			m_ClientsRecv[i] = NULL;
+	}
+	for ( size_t i=0; i<m_ClientsRecvWork.size(); i++ )
+	{
+		if ( m_ClientsRecvWork[i] == pClient )
+			m_ClientsRecvWork[i] = NULL;
+	}
+}
 
-	CClient * pClientNext;
-	CClient * pClient = GetClientHead();
-	for ( ; pClient!=NULL; pClient = pClientNext )
+void CServer::SocketsAccept()
+{
+	// Any new connections ?
+	// Take all of them. The listen socket is non blocking so we will know when we are done.
+	for ( int iCount=0; iCount<MAX_CLIENT_SOCKETS; iCount++ )
 	{
-		pClientNext = pClient->GetNext();
-		SOCKET hSocket = pClient->GetSocket();
-		FD_SET(hSocket,&readfds);
-		if ( hSocket > nfds )
-			nfds = hSocket;
+		socklen_t len = sizeof( struct sockaddr_in );
+		struct sockaddr_in client_addr;
+
+		SOCKET hSocketClient = Accept( &client_addr, &len );
+		if ( hSocketClient < 0 || hSocketClient == INVALID_SOCKET )	// LINUX case is signed ?
+		{
+			if ( CSocketReactor::IsWouldBlock())
+				return;	// no more waiting.
+			// NOTE: Client_addr might be invalid.
+			g_Log.Event( LOGL_FATAL, "Failed at client connection to '%s'(?)\n", inet_ntoa( client_addr.sin_addr ));
+			return;
+		}
+
+		if ( CheckLogIPBlocked( client_addr.sin_addr, true ))
+		{
+			// kill it by allowing it to go out of scope.
+			CGSocket sock( hSocketClient );
+			continue;
+		}
+
+#ifdef _WIN32
+		DWORD lVal = 1;	// 0 =  block
+		int iRet = ioctlsocket( hSocketClient, FIONBIO, &lVal );
+#endif
+
+		new CClient( hSocketClient );
 	}
+}
 
+void CServer::SocketsReceive() // Check for messages from the clients
+{
 	// we task sleep in here. NOTE: this is where we give time back to the OS.
+	// Don't sleep if someone still has data sitting in the kernel.
+	// Or the world still has some of its pulse to do.
 
 	m_Profile.Start( PROFILE_IDLE );
 
-	timeval Timeout;	// time to wait for data.
-	Timeout.tv_sec=0;
-	Timeout.tv_usec=100;	// micro seconds = 1/1000000
-	int ret = select( nfds+1, &readfds, NULL, NULL, &Timeout );
-	if ( ret <= 0 )
-		return;
+	m_SocketReactor.Wait(( m_ClientsRecv.size() || g_World.IsTickPending()) ? 0 : 100 );
 
 	m_Profile.Start( PROFILE_NETWORK_RX );
 
+	// Only the sockets that have something for us.
+	bool fListen = false;
+	int iQty = m_SocketReactor.GetReadyCount();
+	for ( int i=0; i<iQty; i++ )
+	{
+		CGSocket * pSocket = m_SocketReactor.GetReady(i);
+		if ( pSocket == NULL )
+			continue;
+		if ( pSocket == this )
+		{
+			fListen = true;
+			continue;
+		}
+		CClient * pClient = static_cast <CClient*>( pSocket );
+		if ( pClient->xIsRecvPending())
+			continue;	// already on the list.
+		m_ClientsRecv.push_back( pClient );
+	}
+
+	// Sockets that can take more of what we have queued for them.
+	iQty = m_SocketReactor.GetWritableCount();
+	for ( int i=0; i<iQty; i++ )
+	{
+		CGSocket * pSocket = m_SocketReactor.GetWritable(i);
+		if ( pSocket == NULL || pSocket == this )
+			continue;
+		static_cast <CClient*>( pSocket )->xFlushQueue();
+	}
+
+	// And the ones the network threads have read something for.
+	for ( size_t i=0; i<m_NetThreads.size(); i++ )
+	{
+		m_NetThreads[i]->TakeReady( m_ClientsRecv );
+	}
+
 	// Any events from clients ?
-	for ( pClient = GetClientHead(); pClient!=NULL; pClient = pClientNext )
+	ASSERT( m_ClientsRecvWork.empty());
+	m_ClientsRecvWork.swap( m_ClientsRecv );
+	for ( size_t i=0; i<m_ClientsRecvWork.size(); i++ )
+	{
+		CClient * pClient = m_ClientsRecvWork[i];
+		if ( pClient == NULL )	// deleted while we were busy.
+			continue;
+		if ( ! ( pClient->xIsNetThreaded() ? pClient->xRecvQueued() : pClient->xRecvData()))
+		{
+			delete pClient;
+			continue;
+		}
+		if ( pClient->xIsRecvPending())
+		{
+			// Did not get it all. come back next time.
+			m_ClientsRecv.push_back( pClient );
+		}
+	}
+	m_ClientsRecvWork.clear();
+
+	for ( size_t i=0; i<m_NetThreads.size(); i++ )
+	{
+		m_Profile.Count( PROFILE_DATA_RX, m_NetThreads[i]->m_iBytesRx.exchange(0));
+		m_Profile.Count( PROFILE_DATA_TX, m_NetThreads[i]->m_iBytesTx.exchange(0));
+	}
+
+	if ( m_Clock_ClientSweep != g_World.GetTime())
 	{
-		pClientNext = pClient->GetNext();
-		if ( FD_ISSET( pClient->GetSocket(), &readfds ))
+		// Once per tick is plenty for this.
+		m_Clock_ClientSweep = g_World.GetTime();
+
+		CClient * pClientNext;
+		for ( CClient * pClient = GetClientHead(); pClient!=NULL; pClient = pClientNext )
 		{
-			if ( ! pClient->xRecvData())
+			pClientNext = pClient->GetNext();
+			if ( pClient->xIsSendDead())
 			{
+				// SENDQUEUEHIGH. It is not reading what we send.
 				delete pClient;
 				continue;
 			}
-		}
-		else
-		{
 			if ( m_iDeadSocketTimeMin &&
+				! pClient->xHasData() &&
 				( pClient->m_Time_LastEvent + m_iDeadSocketTimeMin ) < g_World.GetTime() &&
 				! pClient->IsConsole())
 			{
@@ -3148,41 +3421,17 @@ void CServer::SocketsReceive() // Check for messages from the clients
 				delete pClient;
 				continue;
 			}
-		}
-
-		// On a timer allow the client to walk.
-		// catch up with real time !
-		// while ( time blah blah )
-		pClient->addWalkCode( EXTDATA_WalkCode_Add, 1 );
-	}
-
-	// Any new connections ? what if there are several ???
-        if ( FD_ISSET( GetSocket(), &readfds))
-        {
-                socklen_t len = sizeof( struct sockaddr_in );
-                struct sockaddr_in client_addr;
-
-                SOCKET hSocketClient = Accept( &client_addr, &len );
-		if ( hSocketClient < 0 || hSocketClient == INVALID_SOCKET )	// LINUX case is signed ?
-		{
-			// NOTE: Client_addr might be invalid.
-			g_Log.Event( LOGL_FATAL, "Failed at client connection to '%s'(?)\n", inet_ntoa( client_addr.sin_addr ));
-			return;
-		}
 
-		if ( CheckLogIPBlocked( client_addr.sin_addr, true ))
-		{
-			// kill it by allowing it to go out of scope.
-			CGSocket sock( hSocketClient );
-			return;
+			// On a timer allow the client to walk.
+			// catch up with real time !
+			// while ( time blah blah )
+			pClient->addWalkCode( EXTDATA_WalkCode_Add, 1 );
 		}
+	}
 
-#ifdef _WIN32
-		DWORD lVal = 1;	// 0 =  block
-		int iRet = ioctlsocket( hSocketClient, FIONBIO, &lVal );
-#endif
-
-		new CClient( hSocketClient );
+	if ( fListen )
+	{
+		SocketsAccept();
 	}
 
 	m_Profile.Start( PROFILE_OVERHEAD );
@@ -3221,6 +3470,8 @@ void CServer::OnTick()
 		{
 			if ( ! pClient->xHasData())
 				continue;
+			if ( pClient->xIsSendThrottled())
+				continue;	// let it catch up first.
 
 			if ( m_fSecure )	// enable the try code.
 			{
@@ -3278,6 +3529,8 @@ bool CServer::SocketsInit() // Initialize sockets
 	int on=1;
 	int off=0;
 	iRet = setsockopt(GetSocket(), SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	// Non blocking so we can accept everyone that is waiting at once.
+	fcntl( GetSocket(), F_SETFL, fcntl( GetSocket(), F_GETFL, 0 ) | O_NONBLOCK );
 #endif
 
 	int bcode = Bind( m_ip.GetPort());
@@ -3289,11 +3542,34 @@ bool CServer::SocketsInit() // Initialize sockets
 	}
 
 	// Max number we can deal with. compile time thing.
-	if ( m_nClientsMax > FD_SETSIZE-1 )
-		m_nClientsMax = FD_SETSIZE-1;
+	if ( m_nClientsMax > MAX_CLIENT_SOCKETS )
+		m_nClientsMax = MAX_CLIENT_SOCKETS;
 
 	Listen();
 
+	if ( ! m_SocketReactor.Init() || ! m_SocketReactor.Add( this ))
+	{
+		g_Log.Event( LOGL_FATAL|LOGM_INIT, "Unable to watch listen socket\n");
+		return( false );
+	}
+
+	// Optional threads to do the socket work for the game clients.
+	for ( int i=0; i<m_iNetThreads && i<64; i++ )
+	{
+		CNetThread * pThread = new CNetThread;
+		if ( ! pThread->Start())
+		{
+			delete pThread;
+			g_Log.Event( LOGL_ERROR|LOGM_INIT, "Unable to start network thread %d\n", i );
+			break;
+		}
+		m_NetThreads.push_back( pThread );
+	}
+	if ( ! m_NetThreads.empty())
+	{
+		g_Log.Event( LOGM_INIT, "Using %d network threads.\n", (int) m_NetThreads.size());
+	}
+
 	// What are we listing our port as to the world.
 	// Tell the admin what we know.
 
@@ -3350,6 +3626,12 @@ bool CServer::SocketsInit() // Initialize sockets
 void CServer::SocketsClose()
 {
 	m_Clients.DeleteAll();
+	for ( size_t i=0; i<m_NetThreads.size(); i++ )
+	{
+		delete m_NetThreads[i];	// stops the thread.
+	}
+	m_NetThreads.clear();
+	m_SocketReactor.Close();
 #ifdef _WIN32
 	if ( m_wExitFlag )
 	{
@@ -3697,6 +3979,53 @@ bool CServer::ScriptLockTrig( CScriptLock & s, ITEM_TYPE index )
 	return( true );
 }
 
+const CScriptCompiled * CServer::GetPlotCompiled( int index )
+{
+	int i = m_PlotScpLinks.FindKey( index );
+	if ( i >= 0 )
+	{
+		const CScriptCompiled * pProg = m_PlotScpLinks[i]->GetCompiled();
+		if ( pProg )
+			return( pProg );
+	}
+
+	CScriptLock s;
+	if ( ! ScriptLockPlot( s, index ))
+		return( NULL );
+	i = m_PlotScpLinks.FindKey( index );
+	ASSERT( i >= 0 );
+	return( m_PlotScpLinks[i]->Compile( s ));
+}
+
+const CScriptCompiled * CServer::GetTrigCompiled( ITEM_TYPE index )
+{
+	int i = m_TrigScpLinks.FindKey( index );
+	if ( i >= 0 )
+	{
+		const CScriptCompiled * pProg = m_TrigScpLinks[i]->GetCompiled();
+		if ( pProg )
+			return( pProg );
+	}
+
+	CScriptLock s;
+	if ( ! ScriptLockTrig( s, index ))
+		return( NULL );
+	i = m_TrigScpLinks.FindKey( index );
+	ASSERT( i >= 0 );
+	return( m_TrigScpLinks[i]->Compile( s ));
+}
+
+DWORD CServer::GetTrigTypeMask( ITEM_TYPE index )
+{
+	// Which CItem triggers does [TRIG index] have ?
+	// 0xFFFFFFFF = there is no such section. (let CItem::OnTrigger complain)
+	if ( GetTrigCompiled( index ) == NULL )
+		return( 0xFFFFFFFF );
+	int i = m_TrigScpLinks.FindKey( index );
+	ASSERT( i >= 0 );
+	return( m_TrigScpLinks[i]->GetTrigMask( CItem::sm_szTrigName, ITRIG_QTY ));
+}
+
 bool CServer::SetScpFile( SCPFILE_TYPE i, const TCHAR * pszName )
 {
 	CScript * pFile = GetScpFile(i);
@@ -3706,6 +4035,36 @@ bool CServer::SetScpFile( SCPFILE_TYPE i, const TCHAR * pszName )
 	return true;
 }
 
+bool CServer::IndexScpFile( SCPFILE_TYPE i )
+{
+	// Read the section headers of this script file. Only if it changed since we last did.
+	// RETURN: true = it was (re)indexed.
+
+	CScript * pScript = GetScpFile(i);
+	CScriptIndex & Index = m_ScriptIndex[i];
+	if ( ! pScript->IsFileOpen())
+	{
+		pScript->SetIndex( NULL );
+		return( false );
+	}
+	if ( ! Index.IsChanged( *pScript ))
+	{
+		pScript->SetIndex( &Index );
+		return( false );
+	}
+
+	pScript->SetIndex( NULL );
+	CScriptLock s;
+	if ( ! s.OpenCopy( *pScript ) || ! Index.Build( s ))
+	{
+		Index.Empty();
+		return( false );
+	}
+	pScript->SetIndex( &Index );
+	DEBUG_MSG(( "Indexed %d sections in '%s'\n", Index.GetSectionCount(), pScript->GetFilePath()));
+	return( true );
+}
+
 bool CServer::LoadScripts()
 {
 	// open all my script files i'm going to use.
@@ -3746,6 +4105,11 @@ bool CServer::LoadScripts()
 				continue;
 			return( false );
 		}
+		if ( m_fScriptImage && ! pScript->LoadImage())
+		{
+			DEBUG_ERR(( "Script '%s' can't be read into memory\n", pScript->GetFilePath()));
+		}
+		IndexScpFile((SCPFILE_TYPE)j );
 	}
 
 	return( true );
@@ -3797,15 +4161,18 @@ bool CServer::Load()
 		return( false );
 	}
 
-	// Load the verdata cache.
+	// Load the verdata cache. Then all the tiledata with it.
 	try
 	{
 		g_VerData.Load();
+		g_TileData.Load();
 	}
 	catch(...)
 	{
 		return( false );
 	}
+	CItemBase::InitHeightTable();
+	g_World.m_MapCache.Empty();	// the nav data may have changed with it.
 
 	// If this is a resync. We need to reload the CBaseBase stuff we unloaded. (If it is in use)
 	g_World.ReLoadBases();
@@ -3857,6 +4224,7 @@ void CServer::Unload()
 
 	m_PlotScpLinks.RemoveAll();
 	m_TrigScpLinks.RemoveAll();
+	g_ScriptCompiled.Clear();
 
 	for ( j=0; j<PLEVEL_QTY; j++ )
 	{
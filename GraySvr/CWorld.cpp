@@ -7,6 +7,7 @@
 #include "MySqlStorageService.h"
 #include "Storage/MySql/MySqlLogging.h"
 
+#include <algorithm>
 #include <climits>
 #include <exception>
 
@@ -87,7 +88,9 @@ CWorldSearch::CWorldSearch( const CPointMap p, int iDist ) :
 {
 	// define a search of the world.
 	m_fInertCharUse = false;
-	m_pObj = m_pObjNext = NULL;
+	m_fMovedFrom = false;
+	m_pList = NULL;
+	m_iCur = 0;
 	m_fInertToggle = false;
 
 	m_pSectorBase = m_pSector = p.GetSector();
@@ -132,7 +135,7 @@ bool CWorldSearch::GetNextSector()
 			if ( m_pSectorBase == m_pSector )
 				continue;	// same as base.
 
-			m_pObj = NULL;	// start at head of next Sector.
+			m_pList = NULL;	// start at the top of next Sector.
 			return( true );
 		}
 		m_pntSector.m_x = m_rectSector.m_left;
@@ -140,74 +143,159 @@ bool CWorldSearch::GetNextSector()
 	return( false );	// done searching.
 }
 
-CItem * CWorldSearch::GetItem()
+void CWorldSearch::SetMovedFrom( const CPointMap & ptOld )
+{
+	// Only the things that are in range now but were not in range of ptOld.
+	// For a step that is just the strip along the leading edge.
+	m_fMovedFrom = true;
+	m_ptOld = ptOld;
+}
+
+bool CWorldSearch::IsSectorOld( const CSector * pSector ) const
+{
+	// SetMovedFrom() = All of this sector that is in range was in range of m_ptOld too ?
+	CRectMap rect = pSector->GetRect();
+	int iLeft = max( (int) rect.m_left, m_p.m_x - m_iDist );
+	int iRight = min( (int) rect.m_right - 1, m_p.m_x + m_iDist );
+	int iTop = max( (int) rect.m_top, m_p.m_y - m_iDist );
+	int iBottom = min( (int) rect.m_bottom - 1, m_p.m_y + m_iDist );
+	if ( iLeft > iRight || iTop > iBottom )
+		return( true );	// none of it is in range.
+	return( iLeft >= m_ptOld.m_x - m_iDist && iRight <= m_ptOld.m_x + m_iDist &&
+		iTop >= m_ptOld.m_y - m_iDist && iBottom <= m_ptOld.m_y + m_iDist );
+}
+
+CObjBase * CWorldSearch::GetNextObj( bool fChars )
 {
+	// Filter the packed points of the sector lists. Only touch the objects that are in range.
 	while (true)
 	{
-		if ( m_pObj == NULL )
+		if ( m_pList == NULL )
 		{
+			if ( m_fMovedFrom && IsSectorOld( m_pSector ))
+			{
+				if ( GetNextSector())
+					continue;
+				return( NULL );
+			}
 			m_fInertToggle = false;
-			m_pObj = STATIC_CAST <CObjBase*> ( m_pSector->m_Items_Inert.GetHead());
+			m_pList = fChars ? &( m_pSector->m_Chars.m_Spatial ) : &( m_pSector->m_Items_Inert.m_Spatial );
+			m_iCur = m_pList->GetCount();
 		}
+		if ( m_fMovedFrom )
+			m_iCur = m_pList->FindPrevNew( m_iCur, m_p.m_x, m_p.m_y, m_iDist, m_ptOld.m_x, m_ptOld.m_y );
 		else
+			m_iCur = m_pList->FindPrev( m_iCur, m_p.m_x, m_p.m_y, m_iDist );
+		if ( m_iCur >= 0 )
 		{
-			m_pObj = m_pObjNext;
+			CObjBase * pObj = STATIC_CAST <CObjBase*> ( static_cast <CObjBaseTemplate*> ( m_pList->GetAt( m_iCur )));
+			DEBUG_CHECK( m_p.GetDist( pObj->GetUnkPoint()) <= m_iDist );
+			return( pObj );
 		}
-		if ( m_pObj == NULL )
+		if ( ! m_fInertToggle && ( ! fChars || m_fInertCharUse ))
 		{
-			if ( ! m_fInertToggle )
-			{
-				m_fInertToggle = true;
-				m_pObj = STATIC_CAST <CObjBase*> ( m_pSector->m_Items_Timer.GetHead());
-				if ( m_pObj != NULL )
-					goto jumpover;
-			}
-			if ( GetNextSector())
-				continue;
-			return( NULL );
+			m_fInertToggle = true;
+			m_pList = fChars ? &( m_pSector->m_Chars_Disconnect.m_Spatial ) : &( m_pSector->m_Items_Timer.m_Spatial );
+			m_iCur = m_pList->GetCount();
+			continue;
 		}
-
-jumpover:
-		m_pObjNext = m_pObj->GetNext();
-		if ( m_p.GetDist( m_pObj->GetTopPoint()) <= m_iDist )
-			return( STATIC_CAST <CItem *> ( m_pObj ));
+		if ( GetNextSector())
+			continue;
+		return( NULL );
 	}
 }
 
+CItem * CWorldSearch::GetItem()
+{
+	return( STATIC_CAST <CItem *> ( GetNextObj( false )));
+}
+
 CChar * CWorldSearch::GetChar()
 {
-	while (true)
+	return( STATIC_CAST <CChar *> ( GetNextObj( true )));
+}
+
+//////////////////////////////////////////////////////////////////
+// -CWorldSearchClient
+
+CWorldSearchClient::CWorldSearchClient( const CPointMap & pt, int iDist )
+{
+	m_iCur = 0;
+	AddPoint( pt, iDist );
+}
+
+CWorldSearchClient::CWorldSearchClient( const CObjBaseTemplate * pObj, int iDist )
+{
+	// Everyone who might see this object. (it may be in a container)
+	m_iCur = 0;
+	ASSERT( pObj );
+	AddPoint( pObj->GetTopLevelObj()->GetTopPoint(), iDist );
+}
+
+void CWorldSearchClient::AddPoint( const CPointMap & pt, int iDist )
+{
+	// Add the clients in the sectors that are within iDist of this point.
+	// NOTE: UO_MAP_VIEW_RADAR is the furthest anyone can see. (CChar::CanSee)
+
+	if ( pt.m_x < 0 || pt.m_x >= UO_SIZE_X || pt.m_y < 0 || pt.m_y >= UO_SIZE_Y )
+		return;	// not in the world.
+
+	int iLeft = max( pt.m_x - iDist, 0 ) / SECTOR_SIZE_X;
+	int iRight = min( pt.m_x + iDist, UO_SIZE_X-1 ) / SECTOR_SIZE_X;
+	int iTop = max( pt.m_y - iDist, 0 ) / SECTOR_SIZE_Y;
+	int iBottom = min( pt.m_y + iDist, UO_SIZE_Y-1 ) / SECTOR_SIZE_Y;
+
+	for ( int y = iTop; y <= iBottom; y++ )
 	{
-		if ( m_pObj == NULL )
-		{
-			m_fInertToggle = false;
-			m_pObj = STATIC_CAST <CObjBase*> ( m_pSector->m_Chars.GetHead());
-		}
-		else
-		{
-			m_pObj = m_pObjNext;
-		}
-		if ( m_pObj == NULL )
+		for ( int x = iLeft; x <= iRight; x++ )
 		{
-			if ( ! m_fInertToggle && m_fInertCharUse )
+			CSector * pSector = &( g_World.m_Sectors[ ( y * SECTOR_COLS ) + x ] );
+			if ( ! pSector->HasClients())
+				continue;
+			if ( std::find( m_Sectors.begin(), m_Sectors.end(), pSector ) != m_Sectors.end())
+				continue;
+			m_Sectors.push_back( pSector );
+			for ( int i = 0; i < pSector->HasClients(); i++ )
 			{
-				m_fInertToggle = true;
-				m_pObj = STATIC_CAST <CObjBase*> ( m_pSector->m_Chars_Disconnect.GetHead());
-				if ( m_pObj != NULL )
-					goto jumpover;
+				m_Clients.push_back( pSector->GetClient( i ));
 			}
-			if ( GetNextSector())
-				continue;
-			return( NULL );
 		}
+	}
+}
 
-jumpover:
-		m_pObjNext = m_pObj->GetNext();
-		if ( m_p.GetDist( m_pObj->GetTopPoint()) <= m_iDist )
-			return( STATIC_CAST <CChar *> ( m_pObj ));
+void CWorldSearchClient::AddPriv( WORD wPriv )
+{
+	// Players that can hear or see from far away.
+	// NOTE: This one has to look at every client.
+	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	{
+		if ( ! pClient->IsPriv( wPriv ))
+			continue;
+		CChar * pChar = pClient->GetChar();
+		if ( pChar == NULL )
+			continue;
+		if ( std::find( m_Sectors.begin(), m_Sectors.end(), pChar->GetTopSector()) != m_Sectors.end())
+			continue;	// got it already.
+		m_Clients.push_back( pClient );
+	}
+}
+
+void CWorldSearchClient::AddAll()
+{
+	ASSERT( m_Clients.empty());
+	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	{
+		m_Clients.push_back( pClient );
 	}
 }
 
+CClient * CWorldSearchClient::GetClient()
+{
+	if ( m_iCur >= (int) m_Clients.size())
+		return( NULL );
+	return( m_Clients[ m_iCur++ ] );
+}
+
 //////////////////////////////////////////////////////////////////
 // -CWorld
 
@@ -218,6 +306,13 @@ CWorld::CWorld()
         m_fSaveForce = false;
         m_Clock_Sector = 0;
         m_Clock_Respawn = 0;
+	m_Sector_Pulse = 0;
+	m_PulseStage = WORLDPULSE_IDLE;
+	m_iPulseIndex = 0;
+	m_iPulseStep = 1;
+	m_iRespawnSector = SECTOR_QTY;
+	m_iRestockSector = SECTOR_QTY;
+	m_dwSliceEnd = 0;
 
         m_Clock_PrevSys = 0;
         m_Clock_Time = 0;
@@ -232,6 +327,182 @@ CWorld::CWorld()
         m_uStorageLoadSectorIndex = 0;
         m_uStorageLoadGMPageIndex = 0;
         m_uStorageLoadServerIndex = 0;
+
+	// Everyone starts awake. They go to sleep on their own.
+	// NOTE: Not SectorWake(). This runs in static init, g_Install may not even be built yet.
+	//  Nothing to prefetch anyhow, the MUL files open in LoadScripts().
+	m_SectorsAwake.reserve( SECTOR_QTY );
+	for ( int i=0; i<SECTOR_QTY; i++ )
+	{
+		m_Sectors[i].SetSectorAwake( true );
+		m_SectorsAwake.push_back( &m_Sectors[i] );
+	}
+}
+
+void CWorld::SectorWake( CSector * pSector )
+{
+	// This sector gets every pulse now. (clients, ships etc)
+	ASSERT( pSector );
+	if ( pSector->IsSectorAwake())
+		return;
+	pSector->SetSectorAwake( true );
+	m_SectorsAwake.push_back( pSector );
+
+	// Get the map around it off the disk before anyone walks there.
+	CRectMap rect = pSector->GetRect();
+	g_Install.PrefetchMapBlocks(
+		( rect.m_left - SECTOR_SIZE_X ) / UO_BLOCK_SIZE, ( rect.m_top - SECTOR_SIZE_Y ) / UO_BLOCK_SIZE,
+		( rect.m_right + SECTOR_SIZE_X ) / UO_BLOCK_SIZE, ( rect.m_bottom + SECTOR_SIZE_Y ) / UO_BLOCK_SIZE );
+}
+
+bool CWorld::IsSliceOver() const
+{
+	// Have we used up WORLDTICKBUDGET for this time around the main loop ?
+	if ( g_Serv.m_iWorldTickBudget <= 0 )
+		return( false );
+	return( (int)((DWORD) getclock() - m_dwSliceEnd ) >= 0 );
+}
+
+bool CWorld::OnTickSectorsPrepare()
+{
+	// SECTORTHREADS: CSector::OnTickPrepare() for all the sectors that will get this pulse.
+	// All at once on the threads. Not cut up by WORLDTICKBUDGET.
+
+	m_SectorThreads.Start( g_Serv.m_iSectorThreads );
+	if ( ! m_SectorThreads.GetThreadCount())
+		return( true );
+
+	m_SectorsPrepare.clear();
+	for ( int i = m_Sector_Pulse & ( m_iPulseStep - 1 ); i<SECTOR_QTY; i += m_iPulseStep )
+	{
+		if ( m_Sectors[i].IsSectorAwake())
+			continue;
+		m_SectorsPrepare.push_back( &m_Sectors[i] );
+	}
+	m_SectorsPrepare.insert( m_SectorsPrepare.end(), m_SectorsAwake.begin(), m_SectorsAwake.end());
+
+	m_SectorThreads.OnTickPrepare( m_SectorsPrepare, m_Sector_Pulse );
+	return( true );
+}
+
+bool CWorld::OnTickSectorsSleeping()
+{
+	// The sleeping sectors only get every m_iPulseStep pulses. (staggered by index)
+	// RETURN: false = out of time. pick up here next slice.
+
+	while ( m_iPulseIndex < SECTOR_QTY )
+	{
+		if ( IsSliceOver())
+			return( false );
+		CSector * pSector = &m_Sectors[m_iPulseIndex];
+		m_iPulseIndex += m_iPulseStep;	// before OnTick() so an exception can't get us stuck here.
+		if ( pSector->IsSectorAwake())
+			continue;
+		pSector->OnTick( m_Sector_Pulse );
+	}
+	return( true );
+}
+
+bool CWorld::OnTickSectorsAwake()
+{
+	// NOTE: OnTick() can wake up more sectors. They go on the end and get this pulse as well.
+	// So can the clients between slices.
+	// RETURN: false = out of time.
+
+	while ( m_iPulseIndex < (int) m_SectorsAwake.size())
+	{
+		if ( IsSliceOver())
+			return( false );
+		CSector * pSector = m_SectorsAwake[m_iPulseIndex++];
+		pSector->OnTick( m_Sector_Pulse );
+		if ( ! pSector->HasClients() && pSector->IsSectorSleeping())
+		{
+			// Nobody here for a while. Back to the sleep stagger.
+			pSector->SetSectorAwake( false );
+			m_SectorsAwake[--m_iPulseIndex] = m_SectorsAwake.back();
+			m_SectorsAwake.pop_back();
+		}
+	}
+	return( true );
+}
+
+bool CWorld::OnTickDelete()
+{
+	// Clean up our delete list.
+	// RETURN: false = out of time. The rest are out of the world already so they can wait.
+
+	bool fDone = true;
+	World_fDeleteCycle = true;
+	while ( true )
+	{
+		CObjBase * pDelete = STATIC_CAST <CObjBase*>( m_ObjDelete.GetHead());
+		if ( pDelete == NULL )
+			break;
+		if ( IsSliceOver())
+		{
+			fDone = false;
+			break;
+		}
+		NotifyStorageObjectRemoved( pDelete );
+		delete pDelete;
+	}
+	World_fDeleteCycle = false;
+	return( fDone );
+}
+
+void CWorld::OnTickSlice()
+{
+	// Do as much of the waiting world work as fits in WORLDTICKBUDGET.
+	// Then let CServer::OnTick() have the clients. We come back here next time around.
+
+	m_dwSliceEnd = (DWORD) getclock() + IMULDIV( g_Serv.m_iWorldTickBudget, CLOCKS_PER_SEC, 1000 );
+
+	while ( m_PulseStage != WORLDPULSE_IDLE )
+	{
+		bool fDone;
+		switch ( m_PulseStage )
+		{
+		case WORLDPULSE_PREPARE:
+			fDone = OnTickSectorsPrepare();
+			break;
+		case WORLDPULSE_SLEEPERS:
+			fDone = OnTickSectorsSleeping();
+			break;
+		case WORLDPULSE_AWAKE:
+			fDone = OnTickSectorsAwake();
+			break;
+		case WORLDPULSE_TIMERS:
+			fDone = OnTickTimers();
+			break;
+		case WORLDPULSE_DELETE:
+			fDone = OnTickDelete();
+			break;
+		default:
+			DEBUG_CHECK(0);
+			fDone = true;
+			break;
+		}
+		if ( ! fDone )
+			return;
+		m_PulseStage = (WORLDPULSE_TYPE)( m_PulseStage + 1 );
+		if ( m_PulseStage >= WORLDPULSE_QTY )
+			m_PulseStage = WORLDPULSE_IDLE;
+		m_iPulseIndex = ( m_PulseStage == WORLDPULSE_SLEEPERS ) ? ( m_Sector_Pulse & ( m_iPulseStep - 1 )) : 0;
+	}
+
+	// The big world sweeps go a sector at a time.
+	while ( m_iRespawnSector < SECTOR_QTY )
+	{
+		if ( IsSliceOver())
+			return;
+		m_Sectors[ m_iRespawnSector++ ].RespawnDeadNPCs();
+	}
+	while ( m_iRestockSector < SECTOR_QTY )
+	{
+		if ( IsSliceOver())
+			return;
+		m_Sectors[ m_iRestockSector++ ].Restock();
+	}
 }
 
 CWorld::~CWorld()
@@ -1996,18 +2267,14 @@ bool CWorld::r_Verb( CScript & s, CTextConsole * pSrc )
 void CWorld::RespawnDeadNPCs()
 {
 	// Respawn dead NPC's
-	for ( int i = 0; i<SECTOR_QTY; i++ )
-	{
-		m_Sectors[i].RespawnDeadNPCs();
-	}
+	// A sector at a time in OnTickSlice(). Already going = start over.
+	m_iRespawnSector = 0;
 }
 
 void CWorld::Restock()
 {
-	for ( int i = 0; i<SECTOR_QTY; i++ )
-	{
-		m_Sectors[i].Restock();
-	}
+	// A sector at a time in OnTickSlice().
+	m_iRestockSector = 0;
 }
 
 void CWorld::Close()
@@ -2017,6 +2284,7 @@ void CWorld::Close()
 		Save( true );
 	}
 	m_File.Close();
+	m_SectorThreads.Stop();
 	for ( int i = 0; i<SECTOR_QTY; i++ )
 	{
 		m_Sectors[i].Close();
@@ -2253,8 +2521,19 @@ void CWorld::Speak( const CObjBaseTemplate * pSrc, const TCHAR * pText, COLOR_TY
 
 	CGString sTextName;	// name labelled text.
 	CGString sTextGhost; // ghost speak.
+	CNetBroadcastList Share;	// most hear the same packet.
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients;	// who might hear this ?
+	if ( iHearRange == 0xFFFF )
+	{
+		AreaClients.AddAll();
+	}
+	else
+	{
+		AreaClients.AddPoint( pSrc->GetTopPoint(), iHearRange );
+		AreaClients.AddPriv( PRIV_HEARALL );
+	}
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient->IsConsole())
 		{
@@ -2320,7 +2599,7 @@ void CWorld::Speak( const CObjBaseTemplate * pSrc, const TCHAR * pText, COLOR_TY
 			pClient->addSound( Sounds_Ghost[ GetRandVal( COUNTOF( Sounds_Ghost )) ], pSrc );
 		}
 
-		pClient->addBark( pszSpeak, pSrc, color, mode, font );
+		pClient->addBark( pszSpeak, pSrc, color, mode, font, &Share );
 	}
 }
 
@@ -2357,8 +2636,19 @@ void CWorld::SpeakUNICODE( const CObjBaseTemplate * pSrc, const NCHAR * pText, C
 
 	//NCHAR wTextName[256];	// name labelled text.
 	//NCHAR wTextGhost[256]; // ghost speak.
+	CNetBroadcastList Share;	// most hear the same packet.
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients;	// who might hear this ?
+	if ( iHearRange == 0xFFFF )
+	{
+		AreaClients.AddAll();
+	}
+	else
+	{
+		AreaClients.AddPoint( pSrc->GetTopPoint(), iHearRange );
+		AreaClients.AddPriv( PRIV_HEARALL );
+	}
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient->IsConsole())
 		{
@@ -2427,7 +2717,7 @@ void CWorld::SpeakUNICODE( const CObjBaseTemplate * pSrc, const NCHAR * pText, C
 			pClient->addSound( Sounds_Ghost[ GetRandVal( COUNTOF( Sounds_Ghost )) ], pSrc );
 		}
 
-		pClient->addBarkUNICODE( pszSpeak, pSrc, color, mode, font, pszLanguage );
+		pClient->addBarkUNICODE( pszSpeak, pSrc, color, mode, font, pszLanguage, &Share );
 	}
 }
 
@@ -2442,7 +2732,8 @@ void CWorld::OverHeadMessage(const CObjBaseTemplate* pSrc, const TCHAR* pText, C
 		pCharSrc = dynamic_cast <const CChar*> (pSrc);
 	}
 
-	for (CClient* pClient = g_Serv.GetClientHead(); pClient != NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( pSrc, UO_MAP_VIEW_SIZE );
+	for (CClient* pClient = AreaClients.GetClient(); pClient != NULL; pClient = AreaClients.GetClient())
 	{
 		if (pSrc != NULL)
 		{
@@ -2471,7 +2762,8 @@ void CWorld::OverHeadMessageUNICODE(const CObjBaseTemplate* pSrc, const NCHAR* p
 		pCharSrc = dynamic_cast <const CChar*> (pSrc);
 	}
 
-	for (CClient* pClient = g_Serv.GetClientHead(); pClient != NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( pSrc, UO_MAP_VIEW_SIZE );
+	for (CClient* pClient = AreaClients.GetClient(); pClient != NULL; pClient = AreaClients.GetClient())
 	{
 		if (pSrc != NULL)
 		{
@@ -2590,6 +2882,57 @@ const TCHAR * CWorld::GetGameTime() const
 	return( GetTimeMinDesc( GetGameWorldTime()));
 }
 
+bool CWorld::OnTickTimers()
+{
+	// decay items on ground = time out spells / gates etc.. etc..
+	// Just the ones in m_TimerWheel that go off now.
+	// RETURN: false = out of time. The rest stay on the expired list for next slice.
+
+	g_Serv.m_Profile.Start( PROFILE_ITEMS );
+
+	if ( ! m_iPulseIndex )
+	{
+		// Only once per pulse. Items put back at GetTime() wait for the next pulse.
+		m_TimerWheel.Advance( GetTime());
+		m_iPulseIndex = 1;
+	}
+	bool fDone = true;
+	while (true)
+	{
+		if ( IsSliceOver())
+		{
+			fDone = false;
+			break;
+		}
+		CItem * pItem = STATIC_CAST <CItem*>( m_TimerWheel.GetExpired());
+		if ( pItem == NULL )
+			break;
+		DEBUG_CHECK( ! pItem->IsWeird());
+		DEBUG_CHECK( pItem->IsTimerSet());
+		DEBUG_CHECK( pItem->GetParent() == &( pItem->GetTopSector()->m_Items_Timer ));
+		if ( ! pItem->IsTimerExpired())
+		{
+			// Somebody changed m_timeout behind our back.
+			m_TimerWheel.Insert( pItem, GetTime() + pItem->GetTimerDiff());
+			continue;
+		}
+		if ( ! pItem->OnTick())
+		{
+			pItem->Delete();
+			continue;
+		}
+		if ( ! pItem->IsInWheel() && pItem->IsTopLevel() &&
+			pItem->GetParent() == &( pItem->GetTopSector()->m_Items_Timer ))
+		{
+			// The timer was not reset. Try again next pulse. (just like before)
+			m_TimerWheel.Insert( pItem, GetTime());
+		}
+	}
+
+	g_Serv.m_Profile.Start( PROFILE_OVERHEAD );
+	return( fDone );
+}
+
 void CWorld::OnTick()
 {
 	// Set the game time from the real world clock. getclock()
@@ -2607,6 +2950,7 @@ void CWorld::OnTick()
 	{
 		if ( iTimeSysDiff == 0 ) // time is less than TICK_PER_SEC
 		{
+			OnTickSlice();	// still working on the last pulse ?
 			return;
 		}
 
@@ -2638,26 +2982,24 @@ void CWorld::OnTick()
 
 	m_Clock_Time = Clock_New;
 
-	if ( m_Clock_Sector <= GetTime())
+	if ( m_Clock_Sector <= GetTime() && m_PulseStage == WORLDPULSE_IDLE )
 	{
 		// Only need a SECTOR_TICK_PERIOD tick to do world stuff.
+		// If the last pulse is not done yet this one just starts late.
 		m_Clock_Sector = GetTime() + SECTOR_TICK_PERIOD;	// Next hit time.
 		m_Sector_Pulse ++;
-		for ( int i=0; i<SECTOR_QTY; i++ )
+
+		// Sleeping sectors only get every (m_iSectorSleepMask+1) pulses. (staggered by index)
+		m_iPulseStep = g_Serv.m_iSectorSleepMask + 1;
+		if ( ! ( m_Sector_Pulse & 0x7f ))
 		{
-			m_Sectors[i].OnTick( m_Sector_Pulse );
+			// Everyone needs the light level change. (CSector::OnTick does that before it sleeps)
+			m_iPulseStep = 1;
 		}
+		m_iPulseIndex = 0;
+		m_PulseStage = WORLDPULSE_PREPARE;
 
-		World_fDeleteCycle = true;
-		FlushDeletedObjects();	// clean up our delete list.
-		World_fDeleteCycle = false;
-	}
-	if ( m_Clock_Save <= GetTime())
-	{
-		// Auto save world
-		m_Clock_Save = GetTime() + g_Serv.m_iSavePeriod;
-		g_Log.Flush();
-		Save( false );
+		m_MapCache.Trim();	// drop the map blocks no one has used in a while.
 	}
 	if ( m_Clock_Respawn <= GetTime())
 	{
@@ -2665,5 +3007,15 @@ void CWorld::OnTick()
 		m_Clock_Respawn = GetTime() + (20*60*TICK_PER_SEC);
 		RespawnDeadNPCs();
 	}
+
+	OnTickSlice();
+
+	if ( m_Clock_Save <= GetTime() && m_PulseStage == WORLDPULSE_IDLE )
+	{
+		// Auto save world
+		m_Clock_Save = GetTime() + g_Serv.m_iSavePeriod;
+		g_Log.Flush();
+		Save( false );
+	}
 }
 
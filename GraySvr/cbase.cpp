@@ -244,6 +244,26 @@ bool CBaseBase::ScriptLockBase( CScriptLock &s )
 	return( false );
 }
 
+const CScriptCompiled * CBaseBase::GetBaseCompiled()
+{
+	// The triggers in this definition. compiled the first time.
+	const CScriptCompiled * pProg = m_ScriptLink.GetCompiled();
+	if ( pProg )
+		return( pProg );
+	CScriptLock s;
+	if ( ! ScriptLockBase( s ))
+		return( NULL );
+	return( m_ScriptLink.Compile( s ));
+}
+
+DWORD CBaseBase::GetTrigMask( const TCHAR * const * ppszTrigNames, int iQty )
+{
+	// Which of these triggers does the definition have ?
+	if ( GetBaseCompiled() == NULL )
+		return( 0 );
+	return( m_ScriptLink.GetTrigMask( ppszTrigNames, iQty ));
+}
+
 #if 0
 
 CBaseBase * CBaseBase::FindName( const TCHAR * pszName ) // static
@@ -544,7 +564,8 @@ void CObjBase::Sound( SOUND_TYPE id, int iOnce ) const // Play sound effect for
 	if ( id <= 0 ) 
 		return;
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( ! pClient->CanSee( this )) continue;
 		pClient->addSound( id, this, iOnce );
@@ -555,7 +576,8 @@ void CObjBase::Effect( EFFECT_TYPE motion, ITEMID_TYPE id, const CObjBase * pSou
 {
 	// show for everyone near by.
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( ! pClient->CanSee( this ))
 			continue;
@@ -612,7 +634,8 @@ void CObjBase::UpdateCanSee( const CCommand * pCmd, int iLen, CClient * pClientE
 {
 	// Send this update message to everyone who can see this.
 	// NOTE: Need not be a top level object. CanSee() will calc that.
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( this );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClient == pClientExclude )
 			continue;
@@ -1387,7 +1410,8 @@ void CObjBase::RemoveFromView( CClient * pClientExclude )
 
 	CObjBaseTemplate * pObjTop = GetTopLevelObj();
 
-	for ( CClient * pClient = g_Serv.GetClientHead(); pClient!=NULL; pClient = pClient->GetNext())
+	CWorldSearchClient AreaClients( pObjTop );
+	for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
 	{
 		if ( pClientExclude == pClient ) 
 			continue;
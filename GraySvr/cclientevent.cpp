@@ -69,37 +69,37 @@ void CClient::Event_MapEdit( CObjUID uid )
 	// dialog sends the same msg as
 	// request to edit in either mode...strange huh?
 
-	switch (m_bin.MapEdit.m_action)
+	switch (m_bin->MapEdit.m_action)
 	{
 	case MAP_ADD: // add pin
 		if ( pMap->m_Pins.GetCount() > CItemMap::MAX_PINS ) 
 			return;	// too many.
-		pMap->m_Pins.Add( CMapPinRec( m_bin.MapEdit.m_pin_x, m_bin.MapEdit.m_pin_y ));
+		pMap->m_Pins.Add( CMapPinRec( m_bin->MapEdit.m_pin_x, m_bin->MapEdit.m_pin_y ));
 		break;
 	case MAP_INSERT: // insert between 2 pins
 		if ( pMap->m_Pins.GetCount() > CItemMap::MAX_PINS ) 
 			return;	// too many.
-		pMap->m_Pins.InsertAt( m_bin.MapEdit.m_pin, CMapPinRec( m_bin.MapEdit.m_pin_x, m_bin.MapEdit.m_pin_y ));
+		pMap->m_Pins.InsertAt( m_bin->MapEdit.m_pin, CMapPinRec( m_bin->MapEdit.m_pin_x, m_bin->MapEdit.m_pin_y ));
 		break;
 	case MAP_MOVE: // move pin
 		{
-			if ( m_bin.MapEdit.m_pin >= pMap->m_Pins.GetCount())
+			if ( m_bin->MapEdit.m_pin >= pMap->m_Pins.GetCount())
 			{
 				SysMessage( "That's strange... (bad pin)" );
 				break;
 			}
-			pMap->m_Pins[m_bin.MapEdit.m_pin].m_x = m_bin.MapEdit.m_pin_x;
-			pMap->m_Pins[m_bin.MapEdit.m_pin].m_y = m_bin.MapEdit.m_pin_y;
+			pMap->m_Pins[m_bin->MapEdit.m_pin].m_x = m_bin->MapEdit.m_pin_x;
+			pMap->m_Pins[m_bin->MapEdit.m_pin].m_y = m_bin->MapEdit.m_pin_y;
 			break;
 		}
 	case MAP_DELETE: // delete pin
 		{
-			if ( m_bin.MapEdit.m_pin >= pMap->m_Pins.GetCount())
+			if ( m_bin->MapEdit.m_pin >= pMap->m_Pins.GetCount())
 			{
 				SysMessage( "That's strange... (bad pin)" );
 				break;
 			}
-			pMap->m_Pins.RemoveAt(m_bin.MapEdit.m_pin);
+			pMap->m_Pins.RemoveAt(m_bin->MapEdit.m_pin);
 			break;
 		}
 		break;
@@ -127,7 +127,7 @@ void CClient::Event_Item_Dye( CObjUID uid ) // Rehue an item
 	}
 
 	ClearTargMode();
-	COLOR_TYPE color = m_bin.DyeVat.m_color ;
+	COLOR_TYPE color = m_bin->DyeVat.m_color ;
 
 	if ( ! IsPriv( PRIV_GM ))
 	{
@@ -190,10 +190,10 @@ void CClient::Event_Book_Page( CObjUID uid ) // Book window
 		return;
 	}
 
-	int iPage = m_bin.BookPage.m_page[0].m_pagenum;	// page.
+	int iPage = m_bin->BookPage.m_page[0].m_pagenum;	// page.
 	DEBUG_CHECK( iPage > 0 );
 
-	if ( m_bin.BookPage.m_page[0].m_lines == 0xFFFF || m_bin.BookPage.m_len <= 0x0d )
+	if ( m_bin->BookPage.m_page[0].m_lines == 0xFFFF || m_bin->BookPage.m_len <= 0x0d )
 	{
 		// just a request for pages.
 		addBookPage( pBook, iPage );
@@ -205,9 +205,9 @@ void CClient::Event_Book_Page( CObjUID uid ) // Book window
 	if ( pText == NULL || ! pBook->IsBookWritable()) // not blank ?
 		return;
 
-	int iLines = m_bin.BookPage.m_page[0].m_lines;
+	int iLines = m_bin->BookPage.m_page[0].m_lines;
 	DEBUG_CHECK( iLines <= 8 );
-	DEBUG_CHECK( m_bin.BookPage.m_pages == 1 );
+	DEBUG_CHECK( m_bin->BookPage.m_pages == 1 );
 
 	if ( ! iLines || iPage <= 0 || iPage > 16 ) 
 		return;
@@ -218,7 +218,7 @@ void CClient::Event_Book_Page( CObjUID uid ) // Book window
 	TCHAR szTemp[ MAX_SCRIPT_LINE_LEN ];
 	for ( int i=0; i<iLines; i++ )
 	{
-		len += strcpylen( szTemp+len, m_bin.BookPage.m_page[0].m_text+len );
+		len += strcpylen( szTemp+len, m_bin->BookPage.m_page[0].m_text+len );
 		szTemp[len++] = '\t';
 	}
 
@@ -275,11 +275,11 @@ void CClient::Event_Item_Drop() // Item is dropped
 {
 	// This started from the Event_Item_Pickup()
 
-	CObjUID uidItem( m_bin.ItemDropReq.m_UID );
+	CObjUID uidItem( m_bin->ItemDropReq.m_UID );
 	CItem * pItem = uidItem.ItemFind();
-	CObjUID uidOn( m_bin.ItemDropReq.m_UIDCont );	// dropped on this item.
+	CObjUID uidOn( m_bin->ItemDropReq.m_UIDCont );	// dropped on this item.
 	CObjBase * pObjOn = uidOn.ObjFind();
-	CPointMap  pt( m_bin.ItemDropReq.m_x, m_bin.ItemDropReq.m_y, m_bin.ItemDropReq.m_z );
+	CPointMap  pt( m_bin->ItemDropReq.m_x, m_bin->ItemDropReq.m_y, m_bin->ItemDropReq.m_z );
 
 	if ( g_Log.IsLogged( LOGL_TRACE ))
 	{
@@ -498,11 +498,11 @@ void CClient::Event_Item_Equip() // Item is dropped on paperdoll
 {
 	// This started from the Event_Item_Pickup()
 
-	CObjUID uidItem( m_bin.ItemEquipReq.m_UID );
+	CObjUID uidItem( m_bin->ItemEquipReq.m_UID );
 	CItem * pItem = uidItem.ItemFind();
-	CObjUID uidChar( m_bin.ItemEquipReq.m_UIDChar );
+	CObjUID uidChar( m_bin->ItemEquipReq.m_UIDChar );
 	CChar * pChar = uidChar.CharFind();
-	LAYER_TYPE layer = (LAYER_TYPE)( m_bin.ItemEquipReq.m_layer );
+	LAYER_TYPE layer = (LAYER_TYPE)( m_bin->ItemEquipReq.m_layer );
 
 	if ( pItem == NULL ||
 		GetTargMode() != TARGMODE_DRAG ||
@@ -559,20 +559,20 @@ void CClient::Event_Skill_Locks()
 {
 	// Skill lock buttons in the skills window.
 	ASSERT( GetChar());
-	ASSERT( m_bin.Skill.m_Cmd == XCMD_Skill );		// 0= 0x3A
+	ASSERT( m_bin->Skill.m_Cmd == XCMD_Skill );		// 0= 0x3A
 	ASSERT( GetChar()->m_pPlayer );
 	DEBUG_CHECK( ! m_Crypt.GetClientVersion() || m_Crypt.GetClientVersion() >= 12602 );
 
-	int len = m_bin.Skill.m_len;
+	int len = m_bin->Skill.m_len;
 	len -= 3;
 	for ( int i=0; len; i++ )
 	{
-		SKILL_TYPE index = (SKILL_TYPE)(WORD) m_bin.Skill.skills[i].m_index;
-		SKILLLOCK_TYPE state = (SKILLLOCK_TYPE) m_bin.Skill.skills[i].m_lock;
+		SKILL_TYPE index = (SKILL_TYPE)(WORD) m_bin->Skill.skills[i].m_index;
+		SKILLLOCK_TYPE state = (SKILLLOCK_TYPE) m_bin->Skill.skills[i].m_lock;
 
 		GetChar()->m_pPlayer->Skill_SetLock( index, state );
 
-		len -= sizeof( m_bin.Skill.skills[0] );
+		len -= sizeof( m_bin->Skill.skills[0] );
 	}
 }
 
@@ -837,16 +837,16 @@ void CClient::Event_MenuChoice() // Choice from GMMenu or Itemmenu received
 	// result of addItemMenu call previous.
 	// select = 0 = cancel.
 
-	TARGMODE_TYPE menuid = (TARGMODE_TYPE)(UINT) m_bin.MenuChoice.m_menuid;
+	TARGMODE_TYPE menuid = (TARGMODE_TYPE)(UINT) m_bin->MenuChoice.m_menuid;
 	if ( menuid != GetTargMode() ||
-		m_bin.MenuChoice.m_UID != m_pChar->GetUID())
+		m_bin->MenuChoice.m_UID != m_pChar->GetUID())
 	{
 		DEBUG_ERR(( "%x: Menu choice unrequested %d!=%d\n", GetSocket(), menuid, m_Targ_Mode ));
 		return;
 	}
 
 	ClearTargMode();
-	WORD select = m_bin.MenuChoice.m_select;
+	WORD select = m_bin->MenuChoice.m_select;
 
 	// Item Script or GM menu script got us here.
 	if ( menuid < TARGMODE_MENU_SKILL )
@@ -981,7 +981,7 @@ void CClient::Event_VendorBuy( CObjUID uidVendor )
 {
 	// Client buying items from the Vendor
 
-	if ( m_bin.VendorBuy.m_flag == 0 )	// just a close command.
+	if ( m_bin->VendorBuy.m_flag == 0 )	// just a close command.
 		return;
 
 	CChar * pVendor = uidVendor.CharFind();
@@ -1009,16 +1009,16 @@ void CClient::Event_VendorBuy( CObjUID uidVendor )
 	// Calculate the total cost of goods.
 	int costtotal=0;
 	bool fSoldout = false;
-	int nItems = (m_bin.VendorBuy.m_len - 8) / sizeof( m_bin.VendorBuy.items[0] );
+	int nItems = (m_bin->VendorBuy.m_len - 8) / sizeof( m_bin->VendorBuy.items[0] );
 	int i=0;
 	for ( ;i<nItems;i++)
 	{
-		if (m_bin.VendorBuy.items[i].m_amount < 1)
+		if (m_bin->VendorBuy.items[i].m_amount < 1)
 		{
 			return;
 		}
 
-		CObjUID uid( m_bin.VendorBuy.items[i].m_UID );
+		CObjUID uid( m_bin->VendorBuy.items[i].m_UID );
 		CItemVendable * pItem = dynamic_cast <CItemVendable *> (uid.ItemFind());
 
 		if ( pItem == NULL )
@@ -1029,12 +1029,12 @@ void CClient::Event_VendorBuy( CObjUID uidVendor )
 		long iPrice = pItem->GetBuyPrice();
 		if ( ! iPrice || 
 			pItem->GetTopLevelObj() != pVendor ||
-			m_bin.VendorBuy.items[i].m_amount > pItem->GetAmount())
+			m_bin->VendorBuy.items[i].m_amount > pItem->GetAmount())
 		{
 			fSoldout = true;
 			continue;
 		}
-		costtotal += m_bin.VendorBuy.items[i].m_amount * iPrice;
+		costtotal += m_bin->VendorBuy.items[i].m_amount * iPrice;
 	}
 
 
@@ -1066,14 +1066,14 @@ void CClient::Event_VendorBuy( CObjUID uidVendor )
 	// Move the items bought into your pack.
 	for ( i=0;i<nItems;i++)
 	{
-		CObjUID uid( m_bin.VendorBuy.items[i].m_UID );
+		CObjUID uid( m_bin->VendorBuy.items[i].m_UID );
 		CItem * pItem = uid.ItemFind();
 		if ( pItem == NULL ) 
 			continue;	// ignore it i guess.
 		if ( ! pItem->IsValidSaleItem( true )) 
 			continue;	// sorry can't buy this !
 
-		WORD amount = m_bin.VendorBuy.items[i].m_amount;
+		WORD amount = m_bin->VendorBuy.items[i].m_amount;
 		pItem->SetAmount( pItem->GetAmount() - amount );
 
 		switch ( pItem->m_type )
@@ -1117,7 +1117,7 @@ nohair:
 
 		if ( pVendor->IsStat( STATF_Pet ) ||
 			( pItem->GetAmount() == 0 &&
-			m_bin.VendorBuy.items[i].m_layer == LAYER_VENDOR_EXTRA ))
+			m_bin->VendorBuy.items[i].m_layer == LAYER_VENDOR_EXTRA ))
 		{
 			// we can buy it all.
 			// not allowed to delete all from LAYER_VENDOR_STOCK
@@ -1165,7 +1165,7 @@ void CClient::Event_VendorSell( CObjUID uidVendor )
 		SysMessage( "Too far away from the Vendor" );
 		return;
 	}
-	if ( ! m_bin.VendorSell.m_count )
+	if ( ! m_bin->VendorSell.m_count )
 	{
 		addVendorClose( pVendor );
 		// pVendor->Speak( "You have sold nothing" );
@@ -1188,9 +1188,9 @@ void CClient::Event_VendorSell( CObjUID uidVendor )
 	int iGold = 0;
 	bool fShortfall = false;
 
-	for ( int i=0; i<m_bin.VendorSell.m_count; i++ )
+	for ( int i=0; i<m_bin->VendorSell.m_count; i++ )
 	{
-		CObjUID uid( m_bin.VendorSell.items[i].m_UID );
+		CObjUID uid( m_bin->VendorSell.items[i].m_UID );
 		CItemVendable * pItem = dynamic_cast <CItemVendable *> (uid.ItemFind());
 		if ( pItem == NULL ) 
 			continue;
@@ -1214,7 +1214,7 @@ void CClient::Event_VendorSell( CObjUID uidVendor )
 			continue;
 
 		// Now how much did i say i wanted to sell ?
-		int amount = m_bin.VendorSell.items[i].m_amount;
+		int amount = m_bin->VendorSell.items[i].m_amount;
 		if ( pItem->GetAmount() < amount )	// Selling more than i have ?
 		{
 			amount = pItem->GetAmount();
@@ -1292,28 +1292,28 @@ void CClient::Event_BBoardRequest( CObjUID uid )
 		return;
 	}
 
-	switch ( m_bin.BBoard.m_flag )
+	switch ( m_bin->BBoard.m_flag )
 	{
 	case 3:
 	case 4:
 		// request for message header and/or body.
-		if ( m_bin.BBoard.m_len != 0x0c )
+		if ( m_bin->BBoard.m_len != 0x0c )
 		{
-			DEBUG_ERR(( "%x:BBoard feed back message bad length %d\n", GetSocket(), (int) m_bin.BBoard.m_len ));
+			DEBUG_ERR(( "%x:BBoard feed back message bad length %d\n", GetSocket(), (int) m_bin->BBoard.m_len ));
 			return;
 		}
-		if ( ! addBBoardMessage( pBoard, m_bin.BBoard.m_flag, (UINT)( m_bin.BBoard.m_UIDMsg )))
+		if ( ! addBBoardMessage( pBoard, m_bin->BBoard.m_flag, (UINT)( m_bin->BBoard.m_UIDMsg )))
 		{
 			// sanity check fails.
-			addObjectRemoveCantSee( (UINT)( m_bin.BBoard.m_UIDMsg ), "the message" );
+			addObjectRemoveCantSee( (UINT)( m_bin->BBoard.m_UIDMsg ), "the message" );
 			return;
 		}
 		break;
 	case 5:
 		// Submit a message
-		if ( m_bin.BBoard.m_len < 0x0c )
+		if ( m_bin->BBoard.m_len < 0x0c )
 		{
-			DEBUG_ERR(( "%x:BBoard feed back message bad length %d\n", GetSocket(), (int) m_bin.BBoard.m_len ));
+			DEBUG_ERR(( "%x:BBoard feed back message bad length %d\n", GetSocket(), (int) m_bin->BBoard.m_len ));
 			return;
 		}
 		if ( ! m_pChar->CanTouch( pBoard ))
@@ -1328,22 +1328,22 @@ void CClient::Event_BBoardRequest( CObjUID uid )
 		}
 		// if pMsgItem then this is a reply to it !
 		{
-			int lenstr = m_bin.BBoard.m_data[0];
+			int lenstr = m_bin->BBoard.m_data[0];
 			if (lenstr > 36) //the name must be lower or equal to 36 chars, to avoid exiting from view
 				return;
 			//we will first iter to check if strings are OK, we don't want unexpected errors or other buggy things
-			if (ChkStr((TCHAR*)&m_bin.BBoard.m_data[1], "/n/r[]"))
+			if (ChkStr((TCHAR*)&m_bin->BBoard.m_data[1], "/n/r[]"))
 				return;
 			int len = 1 + lenstr;
-			int lines = m_bin.BBoard.m_data[len++];
+			int lines = m_bin->BBoard.m_data[len++];
 			if (lines > 80) lines = 80;	// limit this. 80 lines is a good value
 
 			while (--lines)
 			{
-				lenstr = m_bin.BBoard.m_data[len++];
-				if (lenstr > 36 || strlen((TCHAR*)&m_bin.BBoard.m_data[len]) >= lenstr)//36 chars per single line
+				lenstr = m_bin->BBoard.m_data[len++];
+				if (lenstr > 36 || strlen((TCHAR*)&m_bin->BBoard.m_data[len]) >= lenstr)//36 chars per single line
 					return;
-				if(ChkStr((TCHAR*)&m_bin.BBoard.m_data[len], "/n/r[]"))
+				if(ChkStr((TCHAR*)&m_bin->BBoard.m_data[len], "/n/r[]"))
 					return;
 
 				len += lenstr;
@@ -1356,20 +1356,20 @@ void CClient::Event_BBoardRequest( CObjUID uid )
 				return;
 			}
 
-			lenstr = m_bin.BBoard.m_data[0];
-			pMsgNew->SetName( (const TCHAR*) &m_bin.BBoard.m_data[1] );
+			lenstr = m_bin->BBoard.m_data[0];
+			pMsgNew->SetName( (const TCHAR*) &m_bin->BBoard.m_data[1] );
 			pMsgNew->m_itBook.m_TimeID = g_World.GetTime() | 0x80000000;
 			pMsgNew->m_sAuthor = m_pChar->GetName();
 			pMsgNew->m_uidLink = m_pChar->GetUID();	// Link it to you forever.
 
 			len = 1 + lenstr;
-			lines = m_bin.BBoard.m_data[len++];
+			lines = m_bin->BBoard.m_data[len++];
 			if ( lines > 32 ) lines = 32;	// limit this.
 
 			while ( lines-- )
 			{
-				lenstr = m_bin.BBoard.m_data[len++];
-				pMsgNew->AddPageText( (const TCHAR*) &m_bin.BBoard.m_data[len] );
+				lenstr = m_bin->BBoard.m_data[len++];
+				pMsgNew->AddPageText( (const TCHAR*) &m_bin->BBoard.m_data[len] );
 				len += lenstr;
 			}
 
@@ -1378,15 +1378,15 @@ void CClient::Event_BBoardRequest( CObjUID uid )
 		break;
 	case 6://remove message
 	{
-		if (m_bin.BBoard.m_len < 0x0c)
+		if (m_bin->BBoard.m_len < 0x0c)
 		{
-			DEBUG_ERR(("%x:BBoard remove message bad length %d\n", GetSocket(), (int)m_bin.BBoard.m_len));
+			DEBUG_ERR(("%x:BBoard remove message bad length %d\n", GetSocket(), (int)m_bin->BBoard.m_len));
 			return;
 		}
 
-		if (m_bin.BBoard.m_UID == pBoard->GetUID())//allow message delete to GM and OWNER of the message
+		if (m_bin->BBoard.m_UID == pBoard->GetUID())//allow message delete to GM and OWNER of the message
 		{
-			CObjUID uidItem(m_bin.BBoard.m_UIDMsg);
+			CObjUID uidItem(m_bin->BBoard.m_UIDMsg);
 			if (!uidItem || !uidItem.IsItem())
 				return;
 			CItem* pItem = uidItem.ItemFind();
@@ -1400,7 +1400,7 @@ void CClient::Event_BBoardRequest( CObjUID uid )
 		break;
 	}
 	default:
-		DEBUG_ERR(( "%x:BBoard unknown flag %d\n", GetSocket(), (int) m_bin.BBoard.m_flag ));
+		DEBUG_ERR(( "%x:BBoard unknown flag %d\n", GetSocket(), (int) m_bin->BBoard.m_flag ));
 		return;
 	}
 }
@@ -1416,7 +1416,7 @@ void CClient::Event_SecureTrade( CObjUID uid )
 		return;
 
 	// perform the trade.
-	switch ( m_bin.SecureTrade.m_action )
+	switch ( m_bin->SecureTrade.m_action )
 	{
 	case 1: // Cancel trade.  Send each person cancel messages, move items.
 		pCont->Delete();
@@ -1428,7 +1428,7 @@ void CClient::Event_SecureTrade( CObjUID uid )
 			SysMessage( "You are too far away to trade items" );
 			return;
 		}
-		pCont->Trade_Status( m_bin.SecureTrade.m_UID1 );
+		pCont->Trade_Status( m_bin->SecureTrade.m_UID1 );
 		return;
 	}
 }
@@ -1942,30 +1942,30 @@ void CClient::Event_TalkUNICODE()
 	// ENU = English
 	// FRC = French
 
-	if (!m_pAccount || m_bin.TalkUNICODE.m_mode == TALKMODE_BROADCAST || m_bin.TalkUNICODE.m_color > 0x0BB6 || m_bin.TalkUNICODE.m_font > 0x09)
+	if (!m_pAccount || m_bin->TalkUNICODE.m_mode == TALKMODE_BROADCAST || m_bin->TalkUNICODE.m_color > 0x0BB6 || m_bin->TalkUNICODE.m_font > 0x09)
 		return;
 
-	if (m_bin.TalkUNICODE.m_mode == TALKMODE_WHISPER && g_Serv.m_iWhisperColor > 0)
+	if (m_bin->TalkUNICODE.m_mode == TALKMODE_WHISPER && g_Serv.m_iWhisperColor > 0)
 	{
-		m_bin.TalkUNICODE.m_color = g_Serv.m_iWhisperColor;
+		m_bin->TalkUNICODE.m_color = g_Serv.m_iWhisperColor;
 	}
 
 	TCHAR szText[MAX_TALK_BUFFER];
-	int iLen = CvtNUNICODEToSystem( szText, m_bin.TalkUNICODE.m_utext, sizeof( szText ));
-	if ( iLen <= 0 || ChkStrn((char*)m_bin.TalkUNICODE.m_utext, "\n\r", iLen))
+	int iLen = CvtNUNICODEToSystem( szText, m_bin->TalkUNICODE.m_utext, sizeof( szText ));
+	if ( iLen <= 0 || ChkStrn((char*)m_bin->TalkUNICODE.m_utext, "\n\r", iLen))
 		return;
 
-	m_bin.TalkUNICODE.m_utext[ iLen ] = '\0';
+	m_bin->TalkUNICODE.m_utext[ iLen ] = '\0';
 
-	if ( ! strnicmp( m_bin.TalkUNICODE.m_lang, "ENU", 3 ))
+	if ( ! strnicmp( m_bin->TalkUNICODE.m_lang, "ENU", 3 ))
 	{
 		// It's just english anyhow.
-		Event_Talk( szText, m_bin.TalkUNICODE.m_color, (TALKMODE_TYPE)( m_bin.TalkUNICODE.m_mode ));
+		Event_Talk( szText, m_bin->TalkUNICODE.m_color, (TALKMODE_TYPE)( m_bin->TalkUNICODE.m_mode ));
 		return;
 	}
 
 	// store the language of choice.
-	strncpy( m_pAccount->m_lang, m_bin.TalkUNICODE.m_lang, sizeof(m_pAccount->m_lang));
+	strncpy( m_pAccount->m_lang, m_bin->TalkUNICODE.m_lang, sizeof(m_pAccount->m_lang));
 	m_pAccount->m_lang[sizeof(m_pAccount->m_lang)-1] = '\0';
 
 	// Non-english.
@@ -1973,9 +1973,9 @@ void CClient::Event_TalkUNICODE()
 	{
 		if ( g_Log.IsLoggedMask( LOGM_PLAYER_SPEAK ))
 		{
-			g_Log.Event( LOGM_PLAYER_SPEAK, "%x:'%s' Says UNICODE '%s' '%s' mode=%d\n", GetSocket(), m_pChar->GetName(), m_pAccount->m_lang, szText, m_bin.Talk.m_mode );
+			g_Log.Event( LOGM_PLAYER_SPEAK, "%x:'%s' Says UNICODE '%s' '%s' mode=%d\n", GetSocket(), m_pChar->GetName(), m_pAccount->m_lang, szText, m_bin->Talk.m_mode );
 		}
-		m_pChar->SpeakUNICODE( m_bin.TalkUNICODE.m_utext, m_bin.Talk.m_color, (TALKMODE_TYPE) m_bin.Talk.m_mode, m_pAccount->m_lang );
+		m_pChar->SpeakUNICODE( m_bin->TalkUNICODE.m_utext, m_bin->Talk.m_color, (TALKMODE_TYPE) m_bin->Talk.m_mode, m_pAccount->m_lang );
 	}
 
 	Event_Talk_Common( szText );
@@ -2024,9 +2024,9 @@ bool CClient::Event_DeathOption( BYTE mode )
 	}
 
 	// Toggle manifest mode.
-	if ( ! xCheckSize( sizeof( m_bin.DeathMenu ))) 
+	if ( ! xCheckSize( sizeof( m_bin->DeathMenu ))) 
 		return(false);
-	Event_CombatMode( m_bin.DeathMenu.m_manifest );
+	Event_CombatMode( m_bin->DeathMenu.m_manifest );
 	return( true );
 }
 
@@ -2042,30 +2042,30 @@ void CClient::Event_SetName( CObjUID uid )
 	if ( ! pChar->NPC_IsOwnedBy( m_pChar ) )
 		return;
 
-	if ( g_Serv.IsObscene( m_bin.CharName.m_name ))
+	if ( g_Serv.IsObscene( m_bin->CharName.m_name ))
 		return;
 
 	if (ChkStr((char*)&pChar[0], "\n\r[]@\\^£$%&=#§*<>|1234567890,.-;:_/\"!?()°+çòàùèéì"))
 		return;
 
 	//name must not contain any unwanted spaces
-	pChar->SetName(strip_extra_spaces(m_bin.CharName.m_name, true));
+	pChar->SetName(strip_extra_spaces(m_bin->CharName.m_name, true));
 }
 
 void CClient::Event_GumpTextIn()
 {
 	// Text was typed into the gump on the screen.
-	// m_bin.GumpText
+	// m_bin->GumpText
 	// result of addGumpInputBox. GumpInputBox
 
-	TARGMODE_TYPE dialog = (TARGMODE_TYPE) (UINT) m_bin.GumpText.m_dialogID;
+	TARGMODE_TYPE dialog = (TARGMODE_TYPE) (UINT) m_bin->GumpText.m_dialogID;
 
-	BYTE parent = m_bin.GumpText.m_parentID; // the original dialog #, shortened to a BYTE
-	BYTE button = m_bin.GumpText.m_buttonID;
+	BYTE parent = m_bin->GumpText.m_parentID; // the original dialog #, shortened to a BYTE
+	BYTE button = m_bin->GumpText.m_buttonID;
 
-	BYTE retcode = m_bin.GumpText.m_retcode; // 0=canceled, 1=okayed
-	WORD textlen = m_bin.GumpText.m_textlen; // length of text entered
-	TCHAR * pszText = strip_extra_spaces(m_bin.GumpText.m_text, false);
+	BYTE retcode = m_bin->GumpText.m_retcode; // 0=canceled, 1=okayed
+	WORD textlen = m_bin->GumpText.m_textlen; // length of text entered
+	TCHAR * pszText = strip_extra_spaces(m_bin->GumpText.m_text, false);
 
 	CGString sStr;
 
@@ -2134,9 +2134,9 @@ void CClient::Event_GumpButton()
 	// possibly multiple check boxes.
 
 	// First let's completely decode this packet
-	TARGMODE_TYPE dialog = (TARGMODE_TYPE)(UINT)( m_bin.GumpButton.m_dialogID );
-	CObjUID uid = (UINT) m_bin.GumpButton.m_UID;
-	UINT dwButtonID = m_bin.GumpButton.m_buttonID;
+	TARGMODE_TYPE dialog = (TARGMODE_TYPE)(UINT)( m_bin->GumpButton.m_dialogID );
+	CObjUID uid = (UINT) m_bin->GumpButton.m_UID;
+	UINT dwButtonID = m_bin->GumpButton.m_buttonID;
 
 	if ( dialog != GetTargMode())
 	{
@@ -2148,16 +2148,16 @@ void CClient::Event_GumpButton()
 	CObjBase * pObj = uid.ObjFind();
 
 	UINT iCheckID[32]; // This should do for most pages...
-	UINT iCheckQty = m_bin.GumpButton.m_checkQty; // this has the total of all checked boxes and radios
+	UINT iCheckQty = m_bin->GumpButton.m_checkQty; // this has the total of all checked boxes and radios
 	ASSERT( iCheckQty < COUNTOF(iCheckID));
 	int i = 0;
 	for ( ; i < iCheckQty; i++ ) // Store the returned checked boxes' ids for possible later use
 	{
-		iCheckID[i] = m_bin.GumpButton.m_checkIds[i];
+		iCheckID[i] = m_bin->GumpButton.m_checkIds[i];
 	}
 
 	// Find out how many textentry boxes we have that returned data
-	CEvent * pMsg = (CEvent *)(((BYTE*)(&m_bin))+(iCheckQty-1)*sizeof(m_bin.GumpButton.m_checkIds[0]));
+	CEvent * pMsg = (CEvent *)(((BYTE*)(m_bin))+(iCheckQty-1)*sizeof(m_bin->GumpButton.m_checkIds[0]));
 	UINT iTextQty = pMsg->GumpButton.m_textQty;
 
 	WORD iTextID[96]; // Store textentry boxes' ids in here
@@ -2943,22 +2943,22 @@ void CClient::Event_Target()
 	// NOTE: Make sure they can actually validly target this item !
 
 	ASSERT(m_pChar);
-	if ( m_bin.Target.m_code != GetTargMode())
+	if ( m_bin->Target.m_code != GetTargMode())
 	{
 		DEBUG_ERR(( "%x: Unrequested target info ?\n", GetSocket()));
 		SysMessage( "Unexpected target info" );
 		return;
 	}
-	if ( m_bin.Target.m_x == 0xFFFF && m_bin.Target.m_UID == 0 )
+	if ( m_bin->Target.m_x == 0xFFFF && m_bin->Target.m_UID == 0 )
 	{
 		// canceled
 		SetTargMode();
 		return;
 	}
 
-	CObjUID uid( m_bin.Target.m_UID );
-	CPointMap pt( m_bin.Target.m_x, m_bin.Target.m_y, m_bin.Target.m_z );
-	ITEMID_TYPE id = (ITEMID_TYPE)(WORD) m_bin.Target.m_id;	// if static tile.
+	CObjUID uid( m_bin->Target.m_UID );
+	CPointMap pt( m_bin->Target.m_x, m_bin->Target.m_y, m_bin->Target.m_z );
+	ITEMID_TYPE id = (ITEMID_TYPE)(WORD) m_bin->Target.m_id;	// if static tile.
 
 	TARGMODE_TYPE prevmode = GetTargMode();
 	ClearTargMode();
@@ -3038,31 +3038,31 @@ bool CClient::xDispatchMsg()
 	m_Time_LastEvent = g_World.GetTime();	// We will always get pinged every couple minutes or so
 
 	// check the packet size first.
-	if ( m_bin.Default.m_Cmd >= XCMD_QTY ) // bad packet type ?
+	if ( m_bin->Default.m_Cmd >= XCMD_QTY ) // bad packet type ?
 		return( false );
 
 #if 0
-	if ( Packet_Lengths_20000[m_bin.Default.m_Cmd] >= 0x8000 ) // var length
+	if ( Packet_Lengths_20000[m_bin->Default.m_Cmd] >= 0x8000 ) // var length
 	{
 		if ( ! xCheckSize(3))
 			return(false);
-		if ( ! xCheckSize(m_bin.Talk.m_len ))
+		if ( ! xCheckSize(m_bin->Talk.m_len ))
 			return(false);
 	}
 	else
 	{
 		// NOTE: What about client version differences !
-		if ( ! xCheckSize( Packet_Lengths_20000[m_bin.Default.m_Cmd] ))
+		if ( ! xCheckSize( Packet_Lengths_20000[m_bin->Default.m_Cmd] ))
 			return(false);
 	}
 #endif
 
-	if ( m_bin.Default.m_Cmd == XCMD_Ping )
+	if ( m_bin->Default.m_Cmd == XCMD_Ping )
 	{
 		// Ping from client. Always ping back.
-		if ( ! xCheckSize( sizeof( m_bin.Ping )))
+		if ( ! xCheckSize( sizeof( m_bin->Ping )))
 			return(false);
-		xSendReady( m_bin.m_Raw, sizeof( m_bin.Ping ));	// ping back.
+		xSendReady( m_bin->m_Raw, sizeof( m_bin->Ping ));	// ping back.
 		return( true );
 	}
 
@@ -3070,25 +3070,25 @@ bool CClient::xDispatchMsg()
 	{
 		// login server or a game server that has not yet logged in.
 
-		switch ( m_bin.Default.m_Cmd )
+		switch ( m_bin->Default.m_Cmd )
 		{
 		case XCMD_ServersReq: // First Login
-			if ( ! xCheckSize( sizeof( m_bin.ServersReq ))) return(false);
-			Login_ServerList( m_bin.ServersReq.m_name, m_bin.ServersReq.m_password );
+			if ( ! xCheckSize( sizeof( m_bin->ServersReq ))) return(false);
+			Login_ServerList( m_bin->ServersReq.m_name, m_bin->ServersReq.m_password );
 			break;
 		case XCMD_ServerSelect:// Server Select - relay me to the server.
-			if ( ! xCheckSize( sizeof( m_bin.ServerSelect ))) return(false);
-			return Login_Relay( m_bin.ServerSelect.m_select );
+			if ( ! xCheckSize( sizeof( m_bin->ServerSelect ))) return(false);
+			return Login_Relay( m_bin->ServerSelect.m_select );
 		case XCMD_CharListReq: // Second Login to select char
-			if ( ! xCheckSize( sizeof( m_bin.CharListReq ))) return(false);
-			Setup_ListReq( m_bin.CharListReq.m_account, m_bin.CharListReq.m_password );
+			if ( ! xCheckSize( sizeof( m_bin->CharListReq ))) return(false);
+			Setup_ListReq( m_bin->CharListReq.m_account, m_bin->CharListReq.m_password );
 			break;
 		case XCMD_Spy: // Spy not sure what this does. tells us stuff about the clients world.
-			if ( ! xCheckSize( sizeof( m_bin.Spy ))) return(false);
+			if ( ! xCheckSize( sizeof( m_bin->Spy ))) return(false);
 			// DEBUG_MSG(( "%x:Spy1\n", GetSocket()));
 			break;
 		case XCMD_War: // Tab = Combat Mode (toss this)
-			if ( ! xCheckSize( sizeof( m_bin.War ))) return(false);
+			if ( ! xCheckSize( sizeof( m_bin->War ))) return(false);
 			break;
 		default:
 			return( false );
@@ -3100,36 +3100,36 @@ bool CClient::xDispatchMsg()
 	// We should be encrypted below here.
 
 	// Get messages from the client.
-	switch ( m_bin.Default.m_Cmd )
+	switch ( m_bin->Default.m_Cmd )
 	{
 	case XCMD_Create: // Character Create
 		if ( m_Crypt.GetClientVersion() >= 12600 )
 		{
-			if ( ! xCheckSize( sizeof( m_bin.Create ))) return(false);
+			if ( ! xCheckSize( sizeof( m_bin->Create ))) return(false);
 		}
 		else
 		{
-			if ( ! xCheckSize( sizeof( m_bin.Create_v25 ))) return(false);
+			if ( ! xCheckSize( sizeof( m_bin->Create_v25 ))) return(false);
 		}
 		Setup_CreateDialog();
 		return( true );
 	case XCMD_CharDelete: // Character Delete
-		if ( ! xCheckSize( sizeof( m_bin.CharDelete ))) return(false);
-		if ( ! Setup_Delete( m_bin.CharDelete.m_slot ))
+		if ( ! xCheckSize( sizeof( m_bin->CharDelete ))) return(false);
+		if ( ! Setup_Delete( m_bin->CharDelete.m_slot ))
 		{
 			addSysMessage( "Character Not Deleted" );
 		}
 		return( true );
 	case XCMD_CharPlay: // Character Select
-		if ( ! xCheckSize( sizeof( m_bin.CharPlay ))) return(false);
-		if ( ! Setup_Play( m_bin.CharPlay.m_slot ))
+		if ( ! xCheckSize( sizeof( m_bin->CharPlay ))) return(false);
+		if ( ! Setup_Play( m_bin->CharPlay.m_slot ))
 		{
 			addLoginErr( LOGIN_ERR_NONE );
 		}
 		return( true );
 	case XCMD_TipReq: // Get Tip
-		if ( ! xCheckSize( sizeof( m_bin.TipReq ))) return(false);
-		Event_Tips( m_bin.TipReq.m_index + 1 );
+		if ( ! xCheckSize( sizeof( m_bin->TipReq ))) return(false);
+		Event_Tips( m_bin->TipReq.m_index + 1 );
 		return( true );
 	}
 
@@ -3139,208 +3139,208 @@ bool CClient::xDispatchMsg()
 	//////////////////////////////////////////////////////
 	// We are now playing.
 
-	switch ( m_bin.Default.m_Cmd )
+	switch ( m_bin->Default.m_Cmd )
 	{
 	case XCMD_Walk: // Walk
 		if ( m_Crypt.GetClientVersion() >= 12600 )
 		{
-			if ( ! xCheckSize( sizeof( m_bin.Walk_v26 ))) return(false);
-			Event_Walking( m_bin.Walk_v26.m_dir, m_bin.Walk_v26.m_count, m_bin.Walk_v26.m_cryptcode );
+			if ( ! xCheckSize( sizeof( m_bin->Walk_v26 ))) return(false);
+			Event_Walking( m_bin->Walk_v26.m_dir, m_bin->Walk_v26.m_count, m_bin->Walk_v26.m_cryptcode );
 		}
 		else
 		{
-			if ( ! xCheckSize( sizeof( m_bin.Walk_v25 ))) return(false);
-			Event_Walking( m_bin.Walk_v25.m_dir, m_bin.Walk_v25.m_count, 0 );
+			if ( ! xCheckSize( sizeof( m_bin->Walk_v25 ))) return(false);
+			Event_Walking( m_bin->Walk_v25.m_dir, m_bin->Walk_v25.m_count, 0 );
 		}
 		break;
 	case XCMD_Talk: // Speech or at least text was typed.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize(m_bin.Talk.m_len )) return(false);
-		Event_Talk( m_bin.Talk.m_text, m_bin.Talk.m_color, (TALKMODE_TYPE)( m_bin.Talk.m_mode ));
+		if ( ! xCheckSize(m_bin->Talk.m_len )) return(false);
+		Event_Talk( m_bin->Talk.m_text, m_bin->Talk.m_color, (TALKMODE_TYPE)( m_bin->Talk.m_mode ));
 		break;
 	case XCMD_Attack: // Attack
-		if ( ! xCheckSize( sizeof( m_bin.Click ))) return(false);
-		Event_Attack( (UINT) m_bin.Click.m_UID );
+		if ( ! xCheckSize( sizeof( m_bin->Click ))) return(false);
+		Event_Attack( (UINT) m_bin->Click.m_UID );
 		break;
 	case XCMD_DClick:// Doubleclick
-		if ( ! xCheckSize( sizeof( m_bin.Click ))) return(false);
-		Event_DoubleClick( (UINT) m_bin.Click.m_UID, ((UINT)(m_bin.Click.m_UID)) & UID_SPEC, true );
+		if ( ! xCheckSize( sizeof( m_bin->Click ))) return(false);
+		Event_DoubleClick( (UINT) m_bin->Click.m_UID, ((UINT)(m_bin->Click.m_UID)) & UID_SPEC, true );
 		break;
 	case XCMD_ItemPickupReq: // Pick up Item
-		if ( ! xCheckSize( sizeof( m_bin.ItemPickupReq ))) return(false);
-		Event_Item_Pickup( (UINT) m_bin.ItemPickupReq.m_UID, m_bin.ItemPickupReq.m_amount );
+		if ( ! xCheckSize( sizeof( m_bin->ItemPickupReq ))) return(false);
+		Event_Item_Pickup( (UINT) m_bin->ItemPickupReq.m_UID, m_bin->ItemPickupReq.m_amount );
 		break;
 	case XCMD_ItemDropReq: // Drop Item
-		if ( ! xCheckSize( sizeof( m_bin.ItemDropReq ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->ItemDropReq ))) return(false);
 		Event_Item_Drop();
 		break;
 	case XCMD_Click: // Singleclick
-		if ( ! xCheckSize( sizeof( m_bin.Click ))) return(false);
-		Event_SingleClick( (UINT) m_bin.Click.m_UID );
+		if ( ! xCheckSize( sizeof( m_bin->Click ))) return(false);
+		Event_SingleClick( (UINT) m_bin->Click.m_UID );
 		break;
 	case XCMD_ExtCmd: // Ext. Command
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.ExtCmd.m_len )) return(false);
-		Event_ExtCmd( (EXTCMD_TYPE) m_bin.ExtCmd.m_type, m_bin.ExtCmd.m_name );
+		if ( ! xCheckSize( m_bin->ExtCmd.m_len )) return(false);
+		Event_ExtCmd( (EXTCMD_TYPE) m_bin->ExtCmd.m_type, m_bin->ExtCmd.m_name );
 		break;
 	case XCMD_ItemEquipReq: // Equip Item
-		if ( ! xCheckSize( sizeof( m_bin.ItemEquipReq ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->ItemEquipReq ))) return(false);
 		Event_Item_Equip();
 		break;
 	case XCMD_WalkAck: // Resync Request
-		if ( ! xCheckSize( sizeof( m_bin.WalkAck ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->WalkAck ))) return(false);
 		addReSync();
 		break;
 	case XCMD_DeathMenu:	// DeathOpt (un)Manifest ghost
 		if ( ! xCheckSize(2)) return(false);
-		if ( ! Event_DeathOption( m_bin.DeathMenu.m_mode )) return( false );
+		if ( ! Event_DeathOption( m_bin->DeathMenu.m_mode )) return( false );
 		break;
 	case XCMD_CharStatReq: // Status Request
-		if ( ! xCheckSize( sizeof( m_bin.CharStatReq ))) return(false);
-		if ( m_bin.CharStatReq.m_type == 4 ) addCharStatWindow( (UINT) m_bin.CharStatReq.m_UID );
-		if ( m_bin.CharStatReq.m_type == 5 ) addSkillWindow(g_Serv.SKILL_MAX);
+		if ( ! xCheckSize( sizeof( m_bin->CharStatReq ))) return(false);
+		if ( m_bin->CharStatReq.m_type == 4 ) addCharStatWindow( (UINT) m_bin->CharStatReq.m_UID );
+		if ( m_bin->CharStatReq.m_type == 5 ) addSkillWindow(g_Serv.SKILL_MAX);
 		break;
 	case XCMD_Skill:	// Skill locking.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.Skill.m_len )) return(false);
+		if ( ! xCheckSize( m_bin->Skill.m_len )) return(false);
 		Event_Skill_Locks();
 		break;
 	case XCMD_VendorBuy:	// Buy item from vendor.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.VendorBuy.m_len )) return(false);
-		Event_VendorBuy( (UINT) m_bin.VendorBuy.m_UIDVendor );
+		if ( ! xCheckSize( m_bin->VendorBuy.m_len )) return(false);
+		Event_VendorBuy( (UINT) m_bin->VendorBuy.m_UIDVendor );
 		break;
 	case XCMD_MapEdit:	// plot course on map.
-		if ( ! xCheckSize( sizeof( m_bin.MapEdit ))) return(false);
-		Event_MapEdit( (UINT) m_bin.MapEdit.m_UID );
+		if ( ! xCheckSize( sizeof( m_bin->MapEdit ))) return(false);
+		Event_MapEdit( (UINT) m_bin->MapEdit.m_UID );
 		break;
 	case XCMD_BookPage: // Read/Change Book
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.BookPage.m_len )) return(false);
-		Event_Book_Page( (UINT) m_bin.BookPage.m_UID );
+		if ( ! xCheckSize( m_bin->BookPage.m_len )) return(false);
+		Event_Book_Page( (UINT) m_bin->BookPage.m_UID );
 		break;
 	case XCMD_Options: // Options set
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.Options.m_len )) return(false);
-		DEBUG_MSG(( "%x:XCMD_Options len=%d\n", GetSocket(), m_bin.Options.m_len ));
+		if ( ! xCheckSize( m_bin->Options.m_len )) return(false);
+		DEBUG_MSG(( "%x:XCMD_Options len=%d\n", GetSocket(), m_bin->Options.m_len ));
 		break;
 	case XCMD_Target: // Targeting
-		if ( ! xCheckSize( sizeof( m_bin.Target ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->Target ))) return(false);
 		Event_Target();
 		break;
 	case XCMD_SecureTrade: // Secure trading
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.SecureTrade.m_len )) return(false);
-		Event_SecureTrade( (UINT) m_bin.SecureTrade.m_UID );
+		if ( ! xCheckSize( m_bin->SecureTrade.m_len )) return(false);
+		Event_SecureTrade( (UINT) m_bin->SecureTrade.m_UID );
 		break;
 	case XCMD_BBoard: // BBoard Request.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.BBoard.m_len )) return(false);
-		Event_BBoardRequest( (UINT) m_bin.BBoard.m_UID );
+		if ( ! xCheckSize( m_bin->BBoard.m_len )) return(false);
+		Event_BBoardRequest( (UINT) m_bin->BBoard.m_UID );
 		break;
 	case XCMD_War: // Combat Mode
-		if ( ! xCheckSize( sizeof( m_bin.War ))) return(false);
-		Event_CombatMode( m_bin.War.m_warmode );
+		if ( ! xCheckSize( sizeof( m_bin->War ))) return(false);
+		Event_CombatMode( m_bin->War.m_warmode );
 		break;
 	case XCMD_CharName: // Rename Character(pet)
-		if ( ! xCheckSize( sizeof( m_bin.CharName ))) return(false);
-		Event_SetName( (UINT) m_bin.CharName.m_UID );
+		if ( ! xCheckSize( sizeof( m_bin->CharName ))) return(false);
+		Event_SetName( (UINT) m_bin->CharName.m_UID );
 		break;
 	case XCMD_MenuChoice: // Menu Choice
-		if ( ! xCheckSize( sizeof( m_bin.MenuChoice ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->MenuChoice ))) return(false);
 		Event_MenuChoice();
 		break;
 	case XCMD_BookOpen:	// Change a books title/author.
 		if ( m_Crypt.GetClientVersion() >= 12600 )
 		{
-			if ( ! xCheckSize( sizeof( m_bin.BookOpen_v26 ))) return(false);
-			Event_Book_Title( (UINT) m_bin.BookOpen_v26.m_UID, m_bin.BookOpen_v26.m_title, m_bin.BookOpen_v26.m_author );
+			if ( ! xCheckSize( sizeof( m_bin->BookOpen_v26 ))) return(false);
+			Event_Book_Title( (UINT) m_bin->BookOpen_v26.m_UID, m_bin->BookOpen_v26.m_title, m_bin->BookOpen_v26.m_author );
 		}
 		else
 		{
-			if ( ! xCheckSize( sizeof( m_bin.BookOpen_v25 ))) return(false);
-			Event_Book_Title( (UINT) m_bin.BookOpen_v25.m_UID, m_bin.BookOpen_v25.m_title, m_bin.BookOpen_v25.m_author );
+			if ( ! xCheckSize( sizeof( m_bin->BookOpen_v25 ))) return(false);
+			Event_Book_Title( (UINT) m_bin->BookOpen_v25.m_UID, m_bin->BookOpen_v25.m_title, m_bin->BookOpen_v25.m_author );
 		}
 		break;
 	case XCMD_DyeVat: // Color Select Dialog
-		if ( ! xCheckSize( sizeof( m_bin.DyeVat ))) return(false);
-		Event_Item_Dye( (UINT) m_bin.DyeVat.m_UID );
+		if ( ! xCheckSize( sizeof( m_bin->DyeVat ))) return(false);
+		Event_Item_Dye( (UINT) m_bin->DyeVat.m_UID );
 		break;
 	case XCMD_Prompt: // Response to console prompt.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.Prompt.m_len )) return(false);
-		Event_PromptResp( m_bin.Prompt.m_text, m_bin.Prompt.m_len-sizeof(m_bin.Prompt));
+		if ( ! xCheckSize( m_bin->Prompt.m_len )) return(false);
+		Event_PromptResp( m_bin->Prompt.m_text, m_bin->Prompt.m_len-sizeof(m_bin->Prompt));
 		break;
 	case XCMD_HelpPage: // GM Page
-		if ( ! xCheckSize( sizeof( m_bin.HelpPage ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->HelpPage ))) return(false);
 		Cmd_Script_Menu( TARGMODE_MENU_GM_PAGE );
 		break;
 	case XCMD_VendorSell: // Vendor Sell
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.VendorSell.m_len )) return(false);
-		Event_VendorSell( (UINT) m_bin.VendorSell.m_UIDVendor );
+		if ( ! xCheckSize( m_bin->VendorSell.m_len )) return(false);
+		Event_VendorSell( (UINT) m_bin->VendorSell.m_UIDVendor );
 		break;
 	case XCMD_Scroll:	// Scroll Closed
-		if ( ! xCheckSize( sizeof( m_bin.Scroll ))) return(false);
-		DEBUG_MSG(( "%x:XCMD_Scroll(close) 0%x\n", GetSocket(), m_bin.Scroll.m_scrollID ));
+		if ( ! xCheckSize( sizeof( m_bin->Scroll ))) return(false);
+		DEBUG_MSG(( "%x:XCMD_Scroll(close) 0%x\n", GetSocket(), m_bin->Scroll.m_scrollID ));
 		break;
 	case XCMD_GumpText:	// Gump text input
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.GumpText.m_len ) || strlen((char*)m_bin.GumpText.m_text) >= m_bin.GumpText.m_textlen || ChkStr((char*)m_bin.GumpText.m_text, "\n\r[]")) return(false);
+		if ( ! xCheckSize( m_bin->GumpText.m_len ) || strlen((char*)m_bin->GumpText.m_text) >= m_bin->GumpText.m_textlen || ChkStr((char*)m_bin->GumpText.m_text, "\n\r[]")) return(false);
 		Event_GumpTextIn();
 		break;
 	case XCMD_TalkUNICODE:	// Talk unicode.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize(m_bin.TalkUNICODE.m_len )) return(false);
+		if ( ! xCheckSize(m_bin->TalkUNICODE.m_len )) return(false);
 		SetPrivFlags( PRIV_T2A );
 		Event_TalkUNICODE();
 		break;
 	case XCMD_GumpButton:	// Gump menu.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.GumpButton.m_len )) return(false);
+		if ( ! xCheckSize( m_bin->GumpButton.m_len )) return(false);
 		Event_GumpButton();
 		break;
 
 	case XCMD_ChatText:	// ChatText
 		if (!g_Serv.m_fEnableChat) return(false);
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.ChatText.m_len )) return(false);
+		if ( ! xCheckSize( m_bin->ChatText.m_len )) return(false);
 		SetPrivFlags( PRIV_T2A );
-		Event_ChatText( m_bin.ChatText.m_lang, m_bin.ChatText.m_utext, m_bin.ChatText.m_len );
+		Event_ChatText( m_bin->ChatText.m_lang, m_bin->ChatText.m_utext, m_bin->ChatText.m_len );
 		break;
 	case XCMD_Chat: // Chat
 		if (!g_Serv.m_fEnableChat) return(false);
-		if ( ! xCheckSize( sizeof( m_bin.Chat))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->Chat))) return(false);
 		SetPrivFlags( PRIV_T2A );
-		Event_ChatButton(m_bin.Chat.m_uname);
+		Event_ChatButton(m_bin->Chat.m_uname);
 		break;
 	case XCMD_ToolTipReq:	// Tool Tip
-		if ( ! xCheckSize( sizeof( m_bin.ToolTipReq ))) return(false);
+		if ( ! xCheckSize( sizeof( m_bin->ToolTipReq ))) return(false);
 		SetPrivFlags( PRIV_T2A );
-		Event_ToolTip( (UINT) m_bin.ToolTipReq.m_UID );
+		Event_ToolTip( (UINT) m_bin->ToolTipReq.m_UID );
 		break;
 	case XCMD_CharProfile:	// Get Character Profile.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.CharProfile.m_len )) return(false);
+		if ( ! xCheckSize( m_bin->CharProfile.m_len )) return(false);
 		SetPrivFlags( PRIV_T2A );
 		DEBUG_MSG(( "%x:XCMD_CharProfile\n", GetSocket()));
 		SysMessage( "Sorry No profile info is available yet" );
 		// ??? we should do something with this !
 		break;
 	case XCMD_MailMsg:	// Some new OSI packet
-		if ( ! xCheckSize( sizeof(m_bin.MailMsg))) return(false);
-		Event_MailMsg( (UINT) m_bin.MailMsg.m_uid1, (UINT) m_bin.MailMsg.m_uid2 );
+		if ( ! xCheckSize( sizeof(m_bin->MailMsg))) return(false);
+		Event_MailMsg( (UINT) m_bin->MailMsg.m_uid1, (UINT) m_bin->MailMsg.m_uid2 );
 		break;
 	case XCMD_ClientVersion:	// Client Version string packet
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize(m_bin.ClientVersion.m_len)) return(false);
+		if ( ! xCheckSize(m_bin->ClientVersion.m_len)) return(false);
 		SetPrivFlags( PRIV_T2A );
 		// DEBUG_MSG(( "%x:XCMD_ClientVersion\n", GetSocket()));
 		break;
 	case XCMD_ExtData:	// Add someone to the party system.
 		if ( ! xCheckSize(3)) return(false);
-		if ( ! xCheckSize( m_bin.ExtData.m_len )) return(false);
-		Event_ExtData( (EXTDATA_TYPE)(WORD) m_bin.ExtData.m_type, m_bin.ExtData.m_len-5, m_bin.ExtData.m_data );
+		if ( ! xCheckSize( m_bin->ExtData.m_len )) return(false);
+		Event_ExtData( (EXTDATA_TYPE)(WORD) m_bin->ExtData.m_type, m_bin->ExtData.m_len-5, m_bin->ExtData.m_data );
 		break;
 
 	default:
@@ -3349,7 +3349,7 @@ bool CClient::xDispatchMsg()
 	}
 
 	// This is the last message we are pretty sure we got correctly.
-	m_bin_PrvMsg = (XCMD_TYPE) m_bin.Default.m_Cmd;
+	m_bin_PrvMsg = (XCMD_TYPE) m_bin->Default.m_Cmd;
 	return( true );
 }
 
@@ -478,9 +478,9 @@ bool CClient::OnTarg_Tile( const CPointMap & pt )
 				{
 					int x2=pBlock->GetOffsetX(ptCur.m_x);
 					int y2=pBlock->GetOffsetY(ptCur.m_y);
-					for ( int i=0; i<pBlock->GetStaticQty(); i++ )
+					int iEnd = pBlock->GetStaticCellEnd( x2, y2 );
+					for ( int i=pBlock->GetStaticCellStart( x2, y2 ); i<iEnd; i++ )
 					{
-						if ( ! pBlock->IsStaticPoint( i, x2, y2 )) continue;
 						const CUOStaticItemRec * pStatic = pBlock->GetStatic(i);
 
 						// This static is at the coordinates in question.
@@ -509,9 +509,9 @@ bool CClient::OnTarg_Tile( const CPointMap & pt )
 				{
 					int x2=pBlock->GetOffsetX(ptCur.m_x);
 					int y2=pBlock->GetOffsetY(ptCur.m_y);
-					for ( int i=0; i<pBlock->GetStaticQty(); i++ )
+					int iEnd = pBlock->GetStaticCellEnd( x2, y2 );
+					for ( int i=pBlock->GetStaticCellStart( x2, y2 ); i<iEnd; i++ )
 					{
-						if ( ! pBlock->IsStaticPoint( i, x2, y2 )) continue;
 						const CUOStaticItemRec * pStatic = pBlock->GetStatic(i);
 						// This static is at the coordinates in question.
 						s.Printf( "%i %i %i %i 0\n",
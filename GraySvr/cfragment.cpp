@@ -230,6 +230,26 @@ bool CFragmentDef::OpenFrag( CScriptLock & s )
 	return( true );
 }
 
+const CScriptCompiled * CFragmentDef::GetFragCompiled()
+{
+	// The triggers in this fragment. compiled the first time.
+	const CScriptCompiled * pProg = m_ScriptLink.GetCompiled();
+	if ( pProg )
+		return( pProg );
+	CScriptLock s;
+	if ( ! OpenFrag( s ))
+		return( NULL );
+	return( m_ScriptLink.Compile( s ));
+}
+
+DWORD CFragmentDef::GetTrigMask()
+{
+	// Which CChar triggers does this fragment have ?
+	if ( GetFragCompiled() == NULL )
+		return( 0 );
+	return( m_ScriptLink.GetTrigMask( CChar::sm_szTrigName, CTRIG_QTY ));
+}
+
 CFragmentDef * CFragmentDef::FindFragName( const TCHAR * pszName, bool fAdd )	// static private
 {
 	// PURPOSE:
@@ -16,14 +16,35 @@ void CCharsActiveList::OnRemoveOb( CGObListRec * pObRec )
 	DEBUG_CHECK( pChar->IsTopLevel());
 	if ( pChar->IsClient())
 	{
-		ClientDetach();
+		ClientDetach( pChar->GetClient());
 		m_LastClientTime = g_World.GetTime();	// mark time in case it's the last client
 	}
+	m_Spatial.Remove( pChar );
 	CGObList::OnRemoveOb(pObRec);
 	DEBUG_CHECK( pChar->GetParent() == NULL );
 	pChar->SetContainerFlags(UID_SPEC);
 }
 
+//////////////////////////////////////////////////////////////
+// -CCharsDisconnectList
+
+void CCharsDisconnectList::OnRemoveOb( CGObListRec * pObRec )
+{
+	CChar * pChar = STATIC_CAST <CChar*>(pObRec);
+	ASSERT( pChar );
+	m_Spatial.Remove( pChar );
+	CGObList::OnRemoveOb(pObRec);
+}
+
+void CCharsDisconnectList::InsertAfter( CGObListRec * pNewRec, CGObListRec * pPrev )
+{
+	CGObList::InsertAfter( pNewRec, pPrev );
+	CChar * pChar = STATIC_CAST <CChar*>(pNewRec);
+	ASSERT( pChar );
+	const CPointMap & pt = pChar->GetUnkPoint();
+	m_Spatial.Add( pChar, pt.m_x, pt.m_y, pt.m_z );
+}
+
 //////////////////////////////////////////////////////////////
 // -CItemList
 
@@ -35,16 +56,48 @@ void CItemsList::OnRemoveOb( CGObListRec * pObRec )
 	ASSERT( pItem );
 	// ASSERT( pItem->m_p.IsValid());
 	DEBUG_CHECK( pItem->IsTopLevel());
+	if ( g_Serv.GetClientHead() != NULL )
+	{
+		// Into a container, moved or gone. The clients around may still think they have it.
+		CWorldSearchClient AreaClients( pItem->GetTopPoint());
+		for ( CClient * pClient = AreaClients.GetClient(); pClient!=NULL; pClient = AreaClients.GetClient())
+		{
+			pClient->ForgetKnown( pItem );
+		}
+	}
+	m_Spatial.Remove( pItem );
 	CGObList::OnRemoveOb(pObRec);
 	DEBUG_CHECK( pItem->GetParent() == NULL );
 	pItem->SetContainerFlags(UID_SPEC);	// It is no place for the moment.
 }
 
+//////////////////////////////////////////////////////////////
+// -CItemsTimerList
+
+void CItemsTimerList::OnRemoveOb( CGObListRec * pObRec )
+{
+	CItem * pItem = STATIC_CAST <CItem*>(pObRec);
+	ASSERT( pItem );
+	g_World.m_TimerWheel.Remove( pItem );
+	CItemsList::OnRemoveOb(pObRec);
+}
+
+void CItemsTimerList::AddToSector( CItem * pItem )
+{
+	// Timer is already set. It goes off in the CWorld::OnTick after that.
+	CItemsList::AddToSector( pItem );
+	DEBUG_CHECK( pItem->IsTimerSet());
+	g_World.m_TimerWheel.Insert( pItem, g_World.GetTime() + pItem->GetTimerDiff());
+}
+
 //////////////////////////////////////////////////////////////////
 // -CSector
 
 CSector::CSector()
 {
+	m_fAwake = false;
+	m_fPrepareLight = false;
+	m_iPreparePulse = -1;
 	m_weather = WEATHER_DRY;
 	m_locallight = LIGHT_BRIGHT;	// set based on time later.
 	SetDefaultWeatherChance();
@@ -243,40 +296,6 @@ void CSector::r_Write( CScript & s )
 	}
 }
 
-const CGrayMapBlock * CSector::GetMapBlock( const CPointMap & pt )
-{
-	// Get a map block from the cache. load it if not.
-
-	ASSERT( pt.IsValid());
-	CPointMap pntBlock( UO_BLOCK_ALIGN(pt.m_x), UO_BLOCK_ALIGN(pt.m_y));
-	ASSERT( m_CacheMap.GetCount() <= (UO_BLOCK_SIZE * UO_BLOCK_SIZE));
-
-	// Find it in cache.
-	for ( int i=0; i<m_CacheMap.GetCount(); i++ )
-	{
-		if ( pntBlock.IsSame2D( m_CacheMap[i]->m_p ))
-		{
-			m_CacheMap[i]->HitCacheTime();
-			return( m_CacheMap[i] );
-		}
-	}
-
-	// else load it.
-	CGrayMapBlock * pMapBlock;
-	try
-	{
-		pMapBlock = new CGrayMapBlock( pntBlock );
-	}
-	catch(...)
-	{
-		return( NULL );
-	}
-
-	// Add it to the cache.
-	m_CacheMap.Add( pMapBlock );
-	return( pMapBlock );
-}
-
 int CSector::GetLocalTime() const
 {
 	// The local time of day (in minutes) is based on Global Time and latitude
@@ -616,12 +635,13 @@ void CSector::MoveToSector( CChar * pChar )
 		}
 		// Provide the weather as an arg as we are not in the new location yet.
 		pClient->addWeather( GetWeather());
+		SetSectorWakeStatus();
 	}
 
 	m_Chars.AddToSector( pChar );	// remove from previous spot.
 }
 
-inline bool CSector::IsSectorSleeping() const
+bool CSector::IsSectorSleeping() const
 {
 	long iAge = g_World.GetTime() - GetLastClientTime();
 	return( iAge > 10*60*TICK_PER_SEC );
@@ -631,6 +651,7 @@ void CSector::SetSectorWakeStatus()
 {
 	// Ships may enter a sector before it's riders ! ships need working timers to move !
 	m_Chars.m_LastClientTime = g_World.GetTime();
+	g_World.SectorWake( this );
 }
 
 void CSector::Close( void )
@@ -788,6 +809,37 @@ void CSector::Restock( long iTime )
 	}
 }
 
+void CSector::OnTickPrepare( int iPulseCount, CSectorTickCmds & Cmds )
+{
+	// SECTORTHREADS: The part of OnTick() that stays in this sector. On a worker thread.
+	// Nothing in here may touch clients, scripts, other sectors or g_World lists.
+	// That goes in Cmds for the main thread.
+
+	m_iPreparePulse = iPulseCount;
+	m_fPrepareLight = false;
+	if ( ! ( iPulseCount & 0x7f ))	// 30 seconds or so.
+	{
+		BYTE blightprv = m_locallight;
+		m_locallight = GetLightCalc( false );
+		m_fPrepareLight = ( m_locallight != blightprv );
+	}
+
+	// Same sleep test as OnTick()
+	if ( ! HasClients() && IsSectorSleeping() &&
+		( iPulseCount & g_Serv.m_iSectorSleepMask ) != ( GetIndex() & g_Serv.m_iSectorSleepMask ))
+		return;
+
+	for ( CChar * pChar = STATIC_CAST <CChar*>( m_Chars.GetHead()); pChar != NULL; pChar = pChar->GetNext())
+	{
+		CSectorTickCmd Cmd;
+		Cmd.m_wRegen = pChar->OnTickPrepare();
+		if ( ! Cmd.m_wRegen )
+			continue;
+		Cmd.m_pChar = pChar;
+		Cmds.push_back( Cmd );
+	}
+}
+
 void CSector::OnTick( int iPulseCount )
 {
 	// CWorld gives OnTick() to all CSectors.
@@ -798,7 +850,12 @@ void CSector::OnTick( int iPulseCount )
 	// applied fast enough.
 
 	bool fLightChange = false;
-	if ( ! ( iPulseCount & 0x7f ))	// 30 seconds or so.
+	if ( m_iPreparePulse == iPulseCount )
+	{
+		fLightChange = m_fPrepareLight;	// OnTickPrepare() did it.
+		m_fPrepareLight = false;
+	}
+	else if ( ! ( iPulseCount & 0x7f ))	// 30 seconds or so.
 	{
 		// check for local light level change ?
 		BYTE blightprv = m_locallight;
@@ -917,37 +974,6 @@ void CSector::OnTick( int iPulseCount )
 	}
 
 	// decay items on ground = time out spells / gates etc.. etc..
-	// No need to check these so often !
-
-	g_Serv.m_Profile.Start( PROFILE_ITEMS );
-
-	CItem * pItemNext;
-	for ( CItem * pItem = STATIC_CAST <CItem*>( m_Items_Timer.GetHead()); pItem != NULL; pItem = pItemNext )
-	{
-		DEBUG_CHECK( ! pItem->IsWeird());
-		DEBUG_CHECK( pItem->IsTimerSet());
-		pItemNext = pItem->GetNext();
-		if ( ! pItem->IsTimerExpired()) 
-			continue;	// not ready yet.
-		if ( ! pItem->OnTick())
-		{
-			pItem->Delete();
-		}
-	}
-
-	g_Serv.m_Profile.Start( PROFILE_OVERHEAD );
-
-	if ( fSleeping || ! ( iPulseCount & 0x7f ))	// 30 seconds or so.
-	{
-		// delete the static CGrayMapBlock items that have not been used recently.
-		for ( int i=0; i<m_CacheMap.GetCount(); i++ )
-		{
-			if ( fSleeping || m_CacheMap[i]->GetCacheAge() >= g_Serv.m_iMapCacheTime )
-			{
-				m_CacheMap.DeleteAt(i);
-				i--;
-			}
-		}
-	}
+	// CWorld::OnTick() does these from g_World.m_TimerWheel. Only the ones that go off.
 }
 
@@ -54,6 +54,160 @@ const CGrayMulti* CWorld::GetMultiItemDefs(ITEMID_TYPE itemid)
 	return(pMulti);
 }
 
+//////////////////////////////////////////////////////////////////
+// -CWorldMapCache
+
+CWorldMapCache::CWorldMapCache()
+{
+	m_pBlocks = new CGrayMapBlock * [ UO_BLOCKS_X * UO_BLOCKS_Y ];
+	memset( m_pBlocks, 0, UO_BLOCKS_X * UO_BLOCKS_Y * sizeof(CGrayMapBlock*));
+	m_iMem = 0;
+	m_dwHits = 0;
+	m_dwMisses = 0;
+	m_dwEvictions = 0;
+}
+
+CWorldMapCache::~CWorldMapCache()
+{
+	Empty();
+	delete [] m_pBlocks;
+}
+
+const CGrayMapBlock * CWorldMapCache::LoadBlock( const CPointMap & pt )
+{
+	m_dwMisses ++;
+
+	CGrayMapBlock * pBlock = NULL;
+	try
+	{
+		pBlock = new CGrayMapBlock( CPointMap( UO_BLOCK_ALIGN(pt.m_x), UO_BLOCK_ALIGN(pt.m_y)));
+		InitNav( pBlock );
+	}
+	catch(...)
+	{
+		delete pBlock;
+		return( NULL );
+	}
+
+	pBlock->HitCacheTime();
+	InsertAfter( pBlock );
+	m_pBlocks[ GetBlockIndex( pt.m_x, pt.m_y ) ] = pBlock;
+	m_iMem += GetBlockMem( pBlock );
+
+	// Make room for it.
+	while ( m_iMem > g_Serv.m_iMapCacheSize )
+	{
+		CGrayMapBlock * pOld = STATIC_CAST <CGrayMapBlock*>( GetTail());
+		if ( pOld->GetCacheAge() <= 0 )	// all used this tick.
+			break;
+		DeleteBlock( pOld );
+	}
+	return( pBlock );
+}
+
+void CWorldMapCache::InitNav( CGrayMapBlock * pBlock ) // static
+{
+	// Work out once what CWorld::GetHeight() would get from the MUL data for this block.
+	// Each cell keeps only the statics that block or can be stood on. (the levels)
+	// The rest only count for CAN_I_ROOF so they are folded into m_zRoof.
+	// Multis and dynamic items are not in here. GetHeight() still looks at those itself.
+	std::vector<CGrayNavLevel> Levels;
+	CGrayNavCell NavCells[UO_BLOCK_SIZE*UO_BLOCK_SIZE];
+	for ( int y=0; y<UO_BLOCK_SIZE; y++ )
+	{
+		for ( int x=0; x<UO_BLOCK_SIZE; x++ )
+		{
+			CGrayNavCell & Cell = NavCells[ y*UO_BLOCK_SIZE + x ];
+			Cell.m_iLevelStart = Levels.size();
+			signed char zRoof = -128;
+
+			int iEnd = pBlock->GetStaticCellEnd( x, y );
+			for ( int i = pBlock->GetStaticCellStart( x, y ); i < iEnd; i++ )
+			{
+				const CUOStaticItemRec * pStatic = pBlock->GetStatic(i);
+				if ( pStatic->m_z > zRoof )
+					zRoof = pStatic->m_z;
+				WORD wBlockThis = 0;
+				signed char zTop = pStatic->m_z + CItemBase::GetItemHeight( (ITEMID_TYPE) pStatic->m_wTileID, wBlockThis );
+				if ( ! wBlockThis )
+					continue;	// GetHeight() would never stand on it.
+				CGrayNavLevel Level;
+				Level.m_z = pStatic->m_z;
+				Level.m_zTop = zTop;
+				Level.m_zRoof = zRoof;
+				Level.m_wBlock = wBlockThis;
+				Levels.push_back( Level );
+				zRoof = -128;
+			}
+			Cell.m_iLevelEnd = Levels.size();
+			Cell.m_zRoof = zRoof;
+
+			const CUOMapMeter * pMeter = pBlock->GetTerrain( x, y );
+			Cell.m_zTerrain = pMeter->m_z;
+			if ( pMeter->m_wTerrainIndex == TERRAIN_NULL )
+			{
+				Cell.m_Terrain = NAVTERRAIN_NULL;
+			}
+			else if ( pMeter->IsTerrainWater())
+			{
+				Cell.m_Terrain = NAVTERRAIN_WATER;
+			}
+			else
+			{
+				CGrayTerrainInfo land( pMeter->m_wTerrainIndex );
+				Cell.m_Terrain = ( land.m_flags & UFLAG1_BLOCK ) ? NAVTERRAIN_BLOCK : NAVTERRAIN_OPEN;
+			}
+			if ( pMeter->m_wTerrainIndex == TERRAIN_HOLE )
+			{
+				Cell.m_Terrain |= NAVTERRAIN_HOLE;
+			}
+		}
+	}
+
+	int iLevels = Levels.size();
+	CGrayNavLevel * pNavLevels = NULL;
+	if ( iLevels )
+	{
+		pNavLevels = new CGrayNavLevel [ iLevels ];
+		memcpy( pNavLevels, &Levels[0], iLevels * sizeof(CGrayNavLevel));
+	}
+	pBlock->SetNav( pNavLevels, iLevels, NavCells );
+}
+
+void CWorldMapCache::DeleteBlock( CGrayMapBlock * pBlock )
+{
+	ASSERT( pBlock );
+	ASSERT( m_pBlocks[ GetBlockIndex( pBlock->m_p.m_x, pBlock->m_p.m_y ) ] == pBlock );
+	m_pBlocks[ GetBlockIndex( pBlock->m_p.m_x, pBlock->m_p.m_y ) ] = NULL;
+	m_iMem -= GetBlockMem( pBlock );
+	m_dwEvictions ++;
+	delete pBlock;
+}
+
+void CWorldMapCache::Trim()
+{
+	// Drop from the tail (least recently used) til we are under budget and nothing is too old.
+	while ( ! IsEmpty())
+	{
+		CGrayMapBlock * pOld = STATIC_CAST <CGrayMapBlock*>( GetTail());
+		int iAge = pOld->GetCacheAge();
+		if ( iAge <= 0 )
+			break;
+		if ( m_iMem <= g_Serv.m_iMapCacheSize &&
+			( g_Serv.m_iMapCacheTime <= 0 || iAge < g_Serv.m_iMapCacheTime ))
+			break;
+		DeleteBlock( pOld );
+	}
+}
+
+void CWorldMapCache::Empty()
+{
+	while ( ! IsEmpty())
+	{
+		DeleteBlock( STATIC_CAST <CGrayMapBlock*>( GetHead()));
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 // Map reading and blocking.
 
@@ -219,45 +373,39 @@ signed char CWorld::GetHeight(const CPointBase& pt, WORD& wBlockFlags, const CRe
 	const CGrayMapBlock* pMapBlock = GetMapBlock(pt);
 	ASSERT(pMapBlock);
 
-	int iQty = pMapBlock->GetStaticQty();
-	if (iQty)  // no static items here.
+	const CGrayNavCell* pCell = pMapBlock->GetNavCell(UO_BLOCK_OFFSET(pt.m_x), UO_BLOCK_OFFSET(pt.m_y));
+	for (int i = pCell->m_iLevelStart; i < pCell->m_iLevelEnd; i++)
 	{
-		int x2 = pMapBlock->GetOffsetX(pt.m_x);
-		int y2 = pMapBlock->GetOffsetY(pt.m_y);
-		for (int i = 0; i < iQty; i++)
+		// Only the statics that block or can be stood on. The others are in m_zRoof.
+		const CGrayNavLevel* pLevel = pMapBlock->GetNavLevel(i);
+		if (pLevel->m_zRoof > zmyhead)
+			fRoof = true;
+		signed char z = pLevel->m_z;
+		if (z > zmyhead)
+			continue;	// over my head so ignore it
+		if (z < (pt.m_z - PLAYER_HEIGHT))
+			continue;	// Don't have to check TOO far down under us.
+
+		// This static is at the coordinates in question.
+		// enough room for me to stand here ?
+		WORD wBlockThis = pLevel->m_wBlock;
+		signed char ztop = pLevel->m_zTop;
+		if (ztop < ztry) continue;	// under something else. (ignore it)
+		if (wBlockThis & CAN_I_PLATFORM)
 		{
-			if (!pMapBlock->IsStaticPoint(i, x2, y2))
-				continue;
-			const CUOStaticItemRec* pStatic = pMapBlock->GetStatic(i);
-			signed char z = pStatic->m_z;
-			if (z > zmyhead)
-			{
-				fRoof = true;
-				continue;	// over my head so ignore it
-			}
-			if (z < (pt.m_z - PLAYER_HEIGHT))
-				continue;	// Don't have to check TOO far down under us.
-
-			// This static is at the coordinates in question.
-			// enough room for me to stand here ?
-			WORD wBlockThis = 0;
-			signed char ztop = z + CItemBase::GetItemHeight((ITEMID_TYPE)pStatic->m_wTileID, wBlockThis);
-			if (ztop < ztry) continue;	// under something else. (ignore it)
-			if (!wBlockThis) continue;	// doesn't block me in any way
-			if (wBlockThis & CAN_I_PLATFORM)
-			{
-				if (wBlockThis == CAN_I_PLATFORM && ztop > zmyhead) continue; // ignore platforms that i can walk under.
-			}
-			else
-			{
-				if (ztop <= ztry)	continue;	// always take the platform in a tie
-			}
-			ztry = ztop;	// step on it if we can.
-			wBlockRes = wBlockThis;
-			if (ztry >= pt.m_z + PLAYER_PLATFORM_STEP && (wBlockThis & CAN_I_BLOCK) && !(wBlockThis & CAN_I_CLIMB))
-				goto zfixup;
+			if (wBlockThis == CAN_I_PLATFORM && ztop > zmyhead) continue; // ignore platforms that i can walk under.
+		}
+		else
+		{
+			if (ztop <= ztry)	continue;	// always take the platform in a tie
 		}
+		ztry = ztop;	// step on it if we can.
+		wBlockRes = wBlockThis;
+		if (ztry >= pt.m_z + PLAYER_PLATFORM_STEP && (wBlockThis & CAN_I_BLOCK) && !(wBlockThis & CAN_I_CLIMB))
+			goto zfixup;
 	}
+	if (pCell->m_zRoof > zmyhead)
+		fRoof = true;
 
 	// Any multi items here ?
 	if (pRegion != NULL && pRegion->IsMatchType(REGION_TYPE_MULTI))
@@ -272,16 +420,14 @@ signed char CWorld::GetHeight(const CPointBase& pt, WORD& wBlockFlags, const CRe
 				int x2 = pt.m_x - pItem->GetTopPoint().m_x;
 				int y2 = pt.m_y - pItem->GetTopPoint().m_y;
 
-				int iQty = pMulti->GetItemCount();
-				for (int i = 0; iQty--; i++)
+				int iEnd = pMulti->GetCellEnd(x2, y2);
+				for (int i = pMulti->GetCellStart(x2, y2); i < iEnd; i++)
 				{
 					const CUOMultiItemRec* pMultiItem = pMulti->GetItem(i);
 					ASSERT(pMultiItem);
 
 					if (!pMultiItem->m_visible)
 						continue;
-					if (pMultiItem->m_dx != x2 || pMultiItem->m_dy != y2)
-						continue;
 
 					signed char zitem = pItem->GetTopZ() + pMultiItem->m_dz;
 					if (zitem > zmyhead)
@@ -355,37 +501,35 @@ signed char CWorld::GetHeight(const CPointBase& pt, WORD& wBlockFlags, const CRe
 			wBlockRes = wBlockThis;
 		}
 
-		const CUOMapMeter* pMeter = pMapBlock->GetTerrain(UO_BLOCK_OFFSET(pt.m_x), UO_BLOCK_OFFSET(pt.m_y));
-		ASSERT(pMeter);
-		if (pMeter->m_z > zmyhead && pMeter->m_wTerrainIndex != TERRAIN_HOLE)
+		bool fHole = (pCell->m_Terrain & NAVTERRAIN_HOLE) ? true : false;
+		if (pCell->m_zTerrain > zmyhead && !fHole)
 			fRoof = true;
 
 		if (ztry == -UO_SIZE_Z ||
-			(pMeter->m_wTerrainIndex != TERRAIN_HOLE &&
-				pMeter->m_z > ztry &&
-				pMeter->m_z < zmyhead))
+			(!fHole &&
+				pCell->m_zTerrain > ztry &&
+				pCell->m_zTerrain < zmyhead))
 		{
-			ztry = pMeter->m_z;
-			if (pMeter->m_wTerrainIndex == TERRAIN_NULL)	// inter dungeon type.
+			ztry = pCell->m_zTerrain;
+			switch (pCell->m_Terrain & ~NAVTERRAIN_HOLE)
 			{
+			case NAVTERRAIN_NULL:	// inter dungeon type.
 				if (!(wBlockFlags & CAN_C_PASSWALLS))
 				{
 					wBlockRes = CAN_I_BLOCK;
 					ztry = UO_SIZE_Z;
 				}
-			}
-			else if (pMeter->IsTerrainWater())
-			{
+				break;
+			case NAVTERRAIN_WATER:
 				// water tiles = we can swim ?
 				wBlockRes = CAN_I_WATER;
-			}
-			else
-			{
-				CGrayTerrainInfo land(pMeter->m_wTerrainIndex);
-				if (land.m_flags & UFLAG1_BLOCK)
-					wBlockRes = CAN_I_BLOCK;
-				else
-					wBlockRes = 0;
+				break;
+			case NAVTERRAIN_BLOCK:
+				wBlockRes = CAN_I_BLOCK;
+				break;
+			default:
+				wBlockRes = 0;
+				break;
 			}
 		}
 	}
@@ -111,6 +111,7 @@ CServer		g_Serv;	// current state stuff not saved.
 CMain		g_Main;
 CGrayInstall g_Install;
 CVerDataMul	g_VerData;
+CGrayTileData	g_TileData;
 CExpression g_Exp;	// Global script variables.
 CLog		g_Log;
 CEventLog * g_pLog = &g_Log;
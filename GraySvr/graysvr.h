@@ -28,8 +28,11 @@ extern size_t DEBUG_ValidateAlloc( const void * pThis );
 #include "../Common/cgrayinst.h"
 #include "../Common/cregion.h"
 #include "../Common/cGrayMap.h"
+#include "../Common/ctimerwheel.h"
 #include "CParty.h"
 #include "CVarDefMap.h"
+#include "CNetwork.h"
+#include "CSectorThread.h"
 #include <memory>
 #include <set>
 #include <string>
@@ -403,6 +406,8 @@ public:
 	void DupeCopy( const CBaseBase * pSrc );
 
 	bool ScriptLockBase( CScriptLock & s );
+	const CScriptCompiled * GetBaseCompiled();
+	DWORD GetTrigMask( const TCHAR * const * ppszTrigNames, int iQty );
 };
 
 #define DAMAGE_GOD		0x001	// Nothing can block this.
@@ -939,7 +944,7 @@ public:
 
 	CChatChannel * GetChannel() const { return m_pChannel; }
 	void SetChannel(CChatChannel * pChannel) { m_pChannel = pChannel; }
-	void SendChatMsg(CHATMSG_TYPE iType, const TCHAR * pszName1 = NULL, const TCHAR * pszName2 = NULL, const char * pszLang = NULL);
+	void SendChatMsg(CHATMSG_TYPE iType, const TCHAR * pszName1 = NULL, const TCHAR * pszName2 = NULL, const char * pszLang = NULL, CNetBroadcastList * pShare = NULL);
 	void RenameChannel(const TCHAR * pszName);
 
 	void Ignore(const TCHAR * pszName);
@@ -1175,6 +1180,9 @@ struct CMultiComponentItem	// a component item of a multi.
 	signed char m_dz;
 };
 
+#define CLIENT_RX_RING	0x10000	// max size of the circular input buffer per client. power of 2, at least 2*MAX_BUFFER.
+#define CLIENT_RX_RING_START	0x1000	// what it starts at. It grows when a read finds it full.
+
 struct CMenuItem 	// describe a menu item.
 {
 	WORD m_id;			// ITEMID_TYPE normally
@@ -1184,6 +1192,7 @@ struct CMenuItem 	// describe a menu item.
 class CClient : public CGObListRec, public CScriptObj, public CGSocket, public CChatChanMember, public CTextConsole
 {
 	// TCP/IP connection to the player.
+	friend class CNetThread;
 	static const TCHAR * sm_KeyTable[];
 protected:
 	DECLARE_MEM_DYNAMIC;
@@ -1198,12 +1207,13 @@ private:
 	CAccount * m_pAccount;		// The account name. we logged in on
 public:
 
-	static BYTE xCompress_Buffer[MAX_BUFFER];
+	static BYTE xCompress_Buffer[MAX_BUFFER*2];	// Encode() can make things bigger.
 
 	time_t m_Time_Login;		// World clock of login time. "LASTCONNECTTIME"
 	time_t m_Time_LastEvent;	// Last time we got event from client.
 
 	CPointMap m_pntSoundRecur;	// Get rid of this in the future !!???
+	CGHashSet m_Known;			// GetIndex() of the chars and items on the ground that the client has now.
 
 	// GM only stuff.
 	CGMPage * m_pGMPage;		// Current GM page we are connected to.
@@ -1278,10 +1288,16 @@ private:
 	// ??? Since we really only deal with one input at a time we can make this static ?
 	XCMD_TYPE m_bin_PrvMsg;
 	int m_bin_pkt;		// the current packet to decode. (estimated length)
-	int m_bin_len;
-	CEvent m_bin;		// in buffer. (from client)
+	bool m_fRecvPending;	// the socket may still have data we have not read yet. (edge triggered)
+	CEvent * m_bin;		// the current packet. m_bin_Ring.GetHead() (see xCheckSize)
+	CNetRecvBuf m_bin_Ring;	// in buffer. (from client)
 	int m_bout_len;
 	CCommand m_bout;	// out buffer. (to client) (we can build output to multiple clients at the same time)
+	CCompressStream m_bout_Stream;	// the open compressed block at the end of m_SendQueue.
+	CNetSendQueue m_SendQueue;	// xFlush() output the socket has not taken yet.
+	bool m_fSendThrottle;	// SENDQUEUEHIGH reached. don't listen to the client til it gets to SENDQUEUELOW.
+	bool m_fSendOverflow;	// can't keep up at all. dump the client.
+	CNetClientQueue * m_pNetQueue;	// A CNetThread does the socket work for us. NETTHREADS
 
 	// encrypt/decrypt stuff.
 	CCrypt m_Crypt;			// Client source communications are always encrypted.
@@ -1313,6 +1329,9 @@ private:
 	// Low level message traffic.
 	void xSend( const void *pData, int length ); // Buffering send function
 	void xSendReady( const void *pData, int length ); // We could send the packet now if we wanted to but wait til we have more.
+	void xSendCompress();	// m_bout to m_SendQueue. The compressed block stays open.
+	void xSendBlock();	// m_bout to m_SendQueue and end the compressed block.
+	void xSendShared( const void *pData, int length, CNetBroadcastList * pShare ); // Lots of clients get this same packet.
 	bool xCheckSize( int len );	// check packet.
 
 #ifdef NDEBUG
@@ -1467,14 +1486,39 @@ public:
 	static int xDeCompress( BYTE * pOutput, const BYTE * pInput, int inplen );
 
 	void xFlush();				// Sends buffered data at once
-	void xSendPkt( const CCommand * pCmd, int length )
+	void xFlushQueue();			// Give the socket what is in m_SendQueue.
+	int  xGetSendQueued();
+	bool xIsSendThrottled();
+	bool xIsSendOverflow( int iQueued ) const;
+	void xPushNetQueue( const BYTE * pData, int iLen, CNetBroadcast * pPacket );
+	bool xIsSendDead() const
+	{
+		return( m_fSendOverflow );
+	}
+	void xSendPkt( const CCommand * pCmd, int length, CNetBroadcastList * pShare = NULL )
 	{
-		xSendReady((const void *)( pCmd->m_Raw ), length );
+		if ( pShare )
+			xSendShared((const void *)( pCmd->m_Raw ), length, pShare );
+		else
+			xSendReady((const void *)( pCmd->m_Raw ), length );
 	}
 	bool xHasData() const
 	{
-		return( m_bin_len ? true : false );
+		return( m_bin_Ring.GetLength() ? true : false );
+	}
+	bool xIsRecvPending() const
+	{
+		return( m_fRecvPending );
 	}
+	bool xIsNetThreaded() const
+	{
+		return( m_pNetQueue != NULL );
+	}
+	CNetThread * xGetNetThread() const
+	{
+		return( m_pNetQueue ? m_pNetQueue->m_pThread : NULL );
+	}
+	bool xRecvQueued();			// Pick up what the CNetThread has for us.
 	void xProcess( bool fGood );	// Process a packet
 	bool xRecvData();			// High Level Receive message from client
 	bool xDispatchMsg();
@@ -1514,7 +1558,7 @@ public:
 	void addPlayerWarMode();
 	void addPlayerWalkCancel();
 
-	void addCharMove( const CChar * pChar );
+	void addCharMove( const CChar * pChar, CNetBroadcastList * pShare = NULL );
 	void addChar( const CChar * pChar );
 	void addCharName( const CChar * pChar ); // Singleclick text for a character
 	void addItemName( const CItem * pItem );
@@ -1527,8 +1571,8 @@ public:
 	void addEffect( EFFECT_TYPE motion, ITEMID_TYPE id, const CObjBaseTemplate * pDst, const CObjBaseTemplate * pSrc, BYTE speed = 5, BYTE loop = 1, bool explode = false );
 	void addSound( SOUND_TYPE id, const CObjBaseTemplate * pBase = NULL, int iRepeat = 1 );
 
-	void addBark( const TCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color = COLOR_DEFAULT, TALKMODE_TYPE mode = TALKMODE_SAY, FONT_TYPE font = FONT_BOLD );
-	void addBarkUNICODE( const NCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color = COLOR_DEFAULT, TALKMODE_TYPE mode = TALKMODE_SAY, FONT_TYPE font = FONT_BOLD, const char * pszLanguage = NULL );
+	void addBark( const TCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color = COLOR_DEFAULT, TALKMODE_TYPE mode = TALKMODE_SAY, FONT_TYPE font = FONT_BOLD, CNetBroadcastList * pShare = NULL );
+	void addBarkUNICODE( const NCHAR * pText, const CObjBaseTemplate * pSrc, COLOR_TYPE color = COLOR_DEFAULT, TALKMODE_TYPE mode = TALKMODE_SAY, FONT_TYPE font = FONT_BOLD, const char * pszLanguage = NULL, CNetBroadcastList * pShare = NULL );
 	void addSysMessage( const TCHAR * pMsg ); // System message (In lower left corner)
 	void addObjMessage( const TCHAR * pMsg, const CObjBaseTemplate * pSrc, COLOR_TYPE color = COLOR_TEXT_DEF ); // The message when an item is clicked
 
@@ -1574,7 +1618,7 @@ public:
 	void add_Admin_Dialog( int iPage );
 
 	void addEnableChatButton();
-	void addChatSystemMessage(CHATMSG_TYPE iType, const TCHAR * pszName1 = NULL, const TCHAR * pszName2 = NULL, const char * pszLang = NULL);
+	void addChatSystemMessage(CHATMSG_TYPE iType, const TCHAR * pszName1 = NULL, const TCHAR * pszName2 = NULL, const char * pszLang = NULL, CNetBroadcastList * pShare = NULL);
 
 	bool addWalkCode( EXTDATA_TYPE iType, int iQty );
 
@@ -1623,6 +1667,16 @@ public:
 	void SysMessage( const TCHAR * pMsg ) const; // System message (In lower left corner)
 	void ColorSysMessage(const TCHAR* pMsg, COLOR_TYPE color, FONT_TYPE font) const;
 	bool CanSee( const CObjBaseTemplate * pObj ) const;
+	bool IsKnown( const CObjBaseTemplate * pObj ) const
+	{
+		// We sent it and the client should still have it.
+		return( m_Known.Find( pObj->GetUID().GetIndex()));
+	}
+	void ForgetKnown( const CObjBaseTemplate * pObj )
+	{
+		// It went away and nobody told the client. It gets sent again if it turns up in view.
+		m_Known.Remove( pObj->GetUID().GetIndex());
+	}
 	bool Gump_Setup( TARGMODE_TYPE targmode, CObjBase * pObj );
 	bool UseInterWorldGate( const CItem * pItem );
 	int OnSkill_Done( SKILL_TYPE skill, CObjUID uid );
@@ -1890,8 +1944,17 @@ private:
 	static CItemBase * MakeDupeReplacement( CItemBase * pBase, ITEMID_TYPE iddupe );
 	static CItemBase * SetMultiRegion( CItemBase * pBase, CScript & s, const CUOItemTypeRec &tile );
 	static signed char GetItemHeightFlags( const CUOItemTypeRec & tile, WORD & wBlockThis );
+	static signed char GetItemHeightCalc( ITEMID_TYPE id, WORD & wBlockThis );
 	bool Load();
 
+	struct CHeightRec	// GetItemHeight() for a tile.
+	{
+		WORD m_wBlock;		// CAN_I_BLOCK etc.
+		signed char m_z;
+	};
+	static CHeightRec sm_Height[ITEMID_MULTI];	// built from g_TileData by InitHeightTable()
+	static bool sm_fHeightTable;
+
 protected:
 	SCPFILE_TYPE GetScpFileIndex( bool fSecondary ) const
 	{
@@ -1933,6 +1996,7 @@ public:
 	static TCHAR * GetNamePluralize( const TCHAR * pszNameBase, bool fPluralize );
 	static bool GetItemData( ITEMID_TYPE id, CUOItemTypeRec * ptile );
 	static signed char GetItemHeight( ITEMID_TYPE id, WORD & MoveFlags );
+	static void InitHeightTable();
 
 	ITEMID_TYPE GetID() const { return((ITEMID_TYPE) GetBaseID()); }
 	ITEMID_TYPE GetDispID() const { return((ITEMID_TYPE) m_wDispIndex ); }
@@ -2004,6 +2068,18 @@ inline bool CItemBase::IsVisibleLayer( LAYER_TYPE layer ) // static
 	return( LAYER_IS_VISIBLE( layer ));
 }
 
+inline signed char CItemBase::GetItemHeight( ITEMID_TYPE id, WORD & wBlockThis ) // static
+{
+	// Get just the height and the blocking flags for the item by id.
+	// used for walk block checking.
+	if ( sm_fHeightTable && (unsigned) id < ITEMID_MULTI )
+	{
+		wBlockThis = sm_Height[id].m_wBlock;
+		return( sm_Height[id].m_z );
+	}
+	return( GetItemHeightCalc( id, wBlockThis ));
+}
+
 inline bool CItemBase::IsValidDispID( ITEMID_TYPE id ) // static
 {
 	// Is this id in the base artwork set ?
@@ -2046,7 +2122,7 @@ enum ITRIG_TYPE
 	ITRIG_QTY,
 };
 
-class CItem : public CObjBase
+class CItem : public CObjBase, public CTimerWheelRec
 {
 protected:
 	DECLARE_MEM_DYNAMIC;
@@ -2640,10 +2716,13 @@ public:
 
 private:
 	bool OnTrigger( const TCHAR * pTrigName, CTextConsole * pSrc, int iArg = 0 );
+	bool IsTrigUsed( ITRIG_TYPE trigger, CTextConsole * pSrc );
 public:
 	bool OnTrigger( ITRIG_TYPE trigger, CTextConsole * pSrc, int iArg = 0 )
 	{
 		ASSERT( trigger < ITRIG_QTY );
+		if ( ! IsTrigUsed( trigger, pSrc ))	// no script has it. don't bother.
+			return( false );
 		return( OnTrigger( sm_szTrigName[trigger], pSrc, iArg ));
 	}
 	void Emote( const TCHAR * pText, CChar * pCharSrc = NULL );
@@ -3429,6 +3508,8 @@ public:
 
 	const TCHAR * GetFragName() const;
 	bool OpenFrag( CScriptLock & s );
+	const CScriptCompiled * GetFragCompiled();
+	DWORD GetTrigMask();	// CTRIG_TYPE bits.
 };
 
 class CFragmentArray : public CGPtrTypeArray<CFragmentDef*>
@@ -3824,6 +3905,7 @@ public:
 	} m_StatVal[4];
 
 	time_t m_time_last_regen;	// When did i get my last regen tick ?
+	time_t m_time_regen;		// m_StatVal[].m_regen has been counted up to here. (OnTickRegen)
 	time_t m_time_create;		// When was i created ?
 
 	// Some character action in progress.
@@ -4263,10 +4345,13 @@ public:
 
 private:
 	bool OnTrigger( const TCHAR * pTrigName, CTextConsole * pSrc, int iArg = 0 );
+	bool IsTrigUsed( CTRIG_TYPE trigger );
 public:
 	bool OnTrigger(CTRIG_TYPE trigger, CTextConsole* pSrc, int iArg = 0)
 	{
 		ASSERT(trigger < CTRIG_QTY);
+		if ( ! IsTrigUsed( trigger ))	// no event has it. don't bother.
+			return( false );
 		return(OnTrigger(sm_szTrigName[trigger], pSrc, iArg));
 	}
 
@@ -4603,6 +4688,10 @@ public:
 
 	bool OnEquipTick( CItem * pItem );
 	void OnFoodTick();
+#define REGEN_LANDED	0x100	// OnTickRegen() = stopped running. (STATF_Fly)
+	WORD OnTickRegen();
+	WORD OnTickPrepare();
+	void OnTickRegenApply( WORD wStats );
 	bool OnTick();
 
 	static CChar * CreateBasic( CREID_TYPE baseID );
@@ -4650,14 +4739,22 @@ class CItemsDisconnectList : public CGObList
 
 class CCharsDisconnectList : public CGObList
 {
+	// Idle player characters. Dead NPC's and ridden horses.
+protected:
+	void OnRemoveOb( CGObListRec* pObRec );
+public:
+	CSpatialArray m_Spatial;	// same as the list. for CWorldSearch
+public:
+	void InsertAfter( CGObListRec * pNewRec, CGObListRec * pPrev = NULL );
 };
 
 class CCharsActiveList : public CGObList
 {
 private:
-	int	   m_iClients;			// How many clients in this sector now?
+	CGPtrTypeArray<CClient*> m_Clients;	// The clients that have a char in this sector now.
 public:
 	time_t m_LastClientTime;	// age the sector based on last client here.
+	CSpatialArray m_Spatial;	// same as the list. for CWorldSearch
 private:
 	void InsertAfter( CGObListRec * pNewRec, CGObListRec * pPrev = NULL )
 	{
@@ -4666,36 +4763,47 @@ private:
 protected:
 	void OnRemoveOb( CGObListRec* pObRec );	// Override this = called when removed from list.
 public:
-	int HasClients() const { return( m_iClients ); }
-	void ClientAttach()
+	int HasClients() const { return( m_Clients.GetCount()); }
+	CClient * GetClient( int i ) const
 	{
-		m_iClients++;
+		return( m_Clients[i] );
 	}
-	void ClientDetach()
+	void ClientAttach( CClient * pClient )
 	{
-		DEBUG_CHECK(m_iClients>0);
-		m_iClients--;
+		ASSERT( pClient );
+		DEBUG_CHECK( m_Clients.FindPtr( pClient ) < 0 );
+		m_Clients.Add( pClient );
+	}
+	void ClientDetach( CClient * pClient )
+	{
+		if ( ! m_Clients.RemovePtr( pClient ))
+		{
+			DEBUG_CHECK( 0 );
+		}
 	}
 	void AddToSector( CChar * pChar )
 	{
 		ASSERT( pChar );
 		// ASSERT( pChar->m_p.IsValid());
+		CGObList::InsertAfter(pChar);
+		const CPointMap & pt = pChar->GetUnkPoint();
+		m_Spatial.Add( pChar, pt.m_x, pt.m_y, pt.m_z );
 		if ( pChar->IsClient())
 		{
-			ClientAttach();
+			ClientAttach( pChar->GetClient());
 		}
-		CGObList::InsertAfter(pChar);
 	}
 	CCharsActiveList()
 	{
 		m_LastClientTime = 0;
-		m_iClients = 0;
 	}
 };
 
 class CItemsList : public CGObList
 {
 	// Top level list of items.
+public:
+	CSpatialArray m_Spatial;	// same as the list. for CWorldSearch
 private:
 	void InsertAfter( CGObListRec * pNewRec, CGObListRec * pPrev = NULL )
 	{
@@ -4710,7 +4818,77 @@ public:
 		// Assume MoveTo() is being called as well
 		ASSERT( pItem );
 		CGObList::InsertAfter( pItem );
+		const CPointMap & pt = pItem->GetUnkPoint();
+		m_Spatial.Add( pItem, pt.m_x, pt.m_y, pt.m_z );
+	}
+};
+
+class CItemsTimerList : public CItemsList
+{
+	// Items on the ground that have timers.
+	// They are in g_World.m_TimerWheel as long as they are in here. So no one has to look at them till they go off.
+protected:
+	void OnRemoveOb( CGObListRec* pObRec );
+public:
+	void AddToSector( CItem * pItem );
+};
+
+class CWorldMapCache : public CGObList
+{
+	// All the CGrayMapBlock(s) loaded from the MUL files.
+	// m_pBlocks is indexed by block x,y so finding one is a single lookup.
+	// Each block gets its nav data when loaded. (the levels per cell GetHeight() can stand on)
+	// The list is most recently used first. We drop from the tail when over MAPCACHESIZE
+	// or not used for MAPCACHETIME. Never drop one used this tick. (someone may be holding it)
+private:
+	CGrayMapBlock ** m_pBlocks;	// [UO_BLOCKS_Y*UO_BLOCKS_X]
+	int m_iMem;		// bytes used by the blocks we have.
+public:
+	DWORD m_dwHits;
+	DWORD m_dwMisses;
+	DWORD m_dwEvictions;
+
+private:
+	CWorldMapCache( const CWorldMapCache & );
+	CWorldMapCache & operator=( const CWorldMapCache & );
+
+	static int GetBlockIndex( int x, int y )
+	{
+		return(( y / UO_BLOCK_SIZE ) * UO_BLOCKS_X + ( x / UO_BLOCK_SIZE ));
+	}
+	static int GetBlockMem( const CGrayMapBlock * pBlock )
+	{
+		return( sizeof(CGrayMapBlock) + pBlock->GetStaticQty() * sizeof(CUOStaticItemRec) + pBlock->GetNavLevelQty() * sizeof(CGrayNavLevel));
 	}
+	static void InitNav( CGrayMapBlock * pBlock );
+	const CGrayMapBlock * LoadBlock( const CPointMap & pt );
+	void DeleteBlock( CGrayMapBlock * pBlock );
+
+public:
+	CWorldMapCache();
+	~CWorldMapCache();
+
+	int GetMem() const
+	{
+		return( m_iMem );
+	}
+	const CGrayMapBlock * GetMapBlock( const CPointMap & pt )
+	{
+		// Get a map block from the cache. load it if not.
+		ASSERT( pt.IsValid());
+		CGrayMapBlock * pBlock = m_pBlocks[ GetBlockIndex( pt.m_x, pt.m_y ) ];
+		if ( pBlock == NULL )
+			return( LoadBlock( pt ));
+		m_dwHits ++;
+		pBlock->HitCacheTime();
+		if ( pBlock != GetHead())
+		{
+			InsertAfter( pBlock );	// to the front.
+		}
+		return( pBlock );
+	}
+	void Trim();
+	void Empty();
 };
 
 class CSector : public CScriptObj	// square region of the world.
@@ -4722,6 +4900,9 @@ private:
 	static const TCHAR * sm_KeyTable[];
 
 	bool   m_fSaveParity;		// has the sector been saved relative to the char entering it ?
+	bool   m_fAwake;			// in g_World.m_SectorsAwake
+	bool   m_fPrepareLight;		// OnTickPrepare() changed m_locallight.
+	int    m_iPreparePulse;		// pulse OnTickPrepare() was done for. (SECTORTHREADS)
 	WEATHER_TYPE m_weather;		// the weather in this area now.
 
 #define LIGHT_OVERRIDE 0x80
@@ -4729,14 +4910,13 @@ private:
 	BYTE m_RainChance;	// 0 to 100%
 	BYTE m_ColdChance;		// Will be snow if rain chance success.
 
-	CGObArray<CGrayMapBlock*> m_CacheMap;	// Cache Map Stuff
 	CGObArray<CTeleport*> m_Teleports;	// CTeleport
 
 public:
 	// Search for items and chars in a region must check 4 quandrants around location.
 	CCharsActiveList m_Chars;		// CChar(s) in this CSector.
 	CCharsDisconnectList m_Chars_Disconnect;	// Idle player characters. Dead NPC's and ridden horses.
-	CItemsList m_Items_Timer;	// CItem(s) in this CSector that need timers.
+	CItemsTimerList m_Items_Timer;	// CItem(s) in this CSector that need timers.
 	CItemsList m_Items_Inert;	// CItem(s) in this CSector. (no timer required)
 	CGObList m_Regions;		// CRegionBase(s) in this CSector.
 
@@ -4754,6 +4934,7 @@ public:
 	{
 		ASSERT( ! HasClients());
 	}
+	void OnTickPrepare( int iPulse, CSectorTickCmds & Cmds );
 	void OnTick( int iPulse );
 
 	// Location map units.
@@ -4852,15 +5033,28 @@ public:
 	}
 	bool IsSectorSleeping() const;
 	void SetSectorWakeStatus();	// Ships may enter a sector before it's riders !
+	bool IsSectorAwake() const
+	{
+		return( m_fAwake );
+	}
+	void SetSectorAwake( bool fAwake )
+	{
+		m_fAwake = fAwake;
+	}
+	CClient * GetClient( int i ) const
+	{
+		return( m_Chars.GetClient( i ));
+	}
 	void ClientAttach( CChar * pChar )
 	{
 		if ( ! IsCharActiveIn( pChar )) return;
-		m_Chars.ClientAttach();
+		m_Chars.ClientAttach( pChar->GetClient());
+		SetSectorWakeStatus();
 	}
 	void ClientDetach( CChar * pChar )
 	{
 		if ( ! IsCharActiveIn( pChar )) return;
-		m_Chars.ClientDetach();
+		m_Chars.ClientDetach( pChar->GetClient());
 	}
 	void MoveToSector( CChar * pChar );
 
@@ -4877,7 +5071,6 @@ public:
 	const CTeleport * GetTeleport( const CPointMap & pt ) const;
 	void UnLoadRegions();
 
-	const CGrayMapBlock * GetMapBlock( const CPointMap & pt );
 	void Restock( long iTime = 0 );
 	void RespawnDeadNPCs();
 	CItem * CheckNaturalResource( const CPointMap & pt, ITEM_TYPE Type, bool fTest = true );
@@ -4906,6 +5099,17 @@ struct CMultiDefArray : public CGObSortArray< CGrayMulti*, MULTI_TYPE >
 	}
 };
 
+enum WORLDPULSE_TYPE	// The stages of a sector pulse. Each can stop when out of time and pick up later.
+{
+	WORLDPULSE_IDLE = 0,	// nothing left to do til the next m_Clock_Sector.
+	WORLDPULSE_PREPARE,		// SECTORTHREADS does CSector::OnTickPrepare() for the whole pulse.
+	WORLDPULSE_SLEEPERS,	// the sleeping sectors whose turn it is.
+	WORLDPULSE_AWAKE,		// m_SectorsAwake
+	WORLDPULSE_TIMERS,		// m_TimerWheel
+	WORLDPULSE_DELETE,		// m_ObjDelete
+	WORLDPULSE_QTY,
+};
+
 extern class CWorld : public CScriptObj	// the world. Stuff saved in *World.SCP file.
 {
 	static const TCHAR * sm_Table[];
@@ -4920,6 +5124,14 @@ private:
 	time_t	m_Clock_Respawn;	// when to res dead NPC's ?
 	int		m_Sector_Pulse;		// Slow some stuff down that doesn't need constant processing.
 
+	// The pulse is done in slices of WORLDTICKBUDGET ms. So the clients don't wait on all of it.
+	WORLDPULSE_TYPE m_PulseStage;	// What part of the current pulse are we on ?
+	int		m_iPulseIndex;		// Where in that part.
+	int		m_iPulseStep;		// Sleeping sector stride for this pulse.
+	int		m_iRespawnSector;	// Next sector to RespawnDeadNPCs(). SECTOR_QTY = not doing it.
+	int		m_iRestockSector;	// Next sector to Restock(). SECTOR_QTY = not doing it.
+	DWORD	m_dwSliceEnd;		// getclock() to stop this slice at.
+
 	int		m_iSaveCount;	// Current archival backup status.
 	int		m_iSaveStage;	// Current stage of the background save.
 
@@ -4952,7 +5164,12 @@ public:
         size_t  m_uStorageLoadTimerIndex;
 
         // World data.
+	CTimerWheel m_TimerWheel;	// Items on the ground with timers. (CItemsTimerList) before m_Sectors !
 	CSector m_Sectors[ SECTOR_QTY ];
+	std::vector<CSector*> m_SectorsAwake;	// The sectors that get every pulse. The rest get the sleep stagger.
+	std::vector<CSector*> m_SectorsPrepare;	// The sectors getting this pulse. for m_SectorThreads
+	CSectorThreads m_SectorThreads;
+	CWorldMapCache m_MapCache;	// CGrayMapBlock(s) loaded from the MUL files.
 	CItemsDisconnectList m_ItemsNew;	// Item created but not yet placed in the world.
 	CCharsDisconnectList m_CharsNew;	// Chars created but not yet placed.
 	CGObList m_ObjDelete;		// Objects to be deleted.
@@ -4997,6 +5214,13 @@ private:
         bool LoadSectionFromStorage();
         void NotifyStorageObjectRemoved( CObjBase * pObj );
         void FlushDeletedObjects();
+	bool IsSliceOver() const;
+	void OnTickSlice();
+	bool OnTickSectorsPrepare();
+	bool OnTickSectorsSleeping();
+	bool OnTickSectorsAwake();
+	bool OnTickTimers();
+	bool OnTickDelete();
         void GetBackupName( CGString & sArchive, TCHAR chType ) const;
         void SaveForce(); // Save world state
 
@@ -5054,11 +5278,11 @@ public:
 	signed char GetHeight( const CPointBase & pt, WORD & wBlockFlags, const CRegionBase * pRegion = NULL ); // Height of player who walked to X/Y/OLDZ
 	const CGrayMapBlock * GetMapBlock( const CPointMap & pt )
 	{
-		return( pt.GetSector()->GetMapBlock(pt));
+		return( m_MapCache.GetMapBlock(pt));
 	}
-	const CUOMapMeter * GetMapMeter( const CPointMap & pt ) const // Height of MAP0.MUL at given coordinates
+	const CUOMapMeter * GetMapMeter( const CPointMap & pt ) // Height of MAP0.MUL at given coordinates
 	{
-		const CGrayMapBlock * pMapBlock = pt.GetSector()->GetMapBlock(pt);
+		const CGrayMapBlock * pMapBlock = m_MapCache.GetMapBlock(pt);
 		ASSERT(pMapBlock);
 		return( pMapBlock->GetTerrain( UO_BLOCK_OFFSET(pt.m_x), UO_BLOCK_OFFSET(pt.m_y)));
 	}
@@ -5095,6 +5319,12 @@ public:
 	bool r_LoadVal( CScript & s ) ;
 
 	void OnTick();
+	bool IsTickPending() const
+	{
+		// Still more world work to do in the next slice ?
+		return( m_PulseStage != WORLDPULSE_IDLE || m_iRespawnSector < SECTOR_QTY || m_iRestockSector < SECTOR_QTY );
+	}
+	void SectorWake( CSector * pSector );
 
 	void GarbageCollection();
 	int  FixObj( CObjBase * pObj, int iUID = 0 );
@@ -5142,9 +5372,11 @@ private:
 	const CPointMap m_p;		// Base point of our search.
 	const int m_iDist;			// How far from the point are we interested in
 	bool m_fInertCharUse;
+	bool m_fMovedFrom;			// SetMovedFrom() = skip what was in range of m_ptOld too.
+	CPointMap m_ptOld;
 
-	CObjBase * m_pObj;	// The current object of interest.
-	CObjBase * m_pObjNext;	// In case the object get deleted.
+	const CSpatialArray * m_pList;	// The sector list we are in. NULL = start the next one.
+	int m_iCur;			// Last index returned. We go down so removing it does not skip any.
 	bool m_fInertToggle;
 
 	CSector * m_pSectorBase;	// Don't search the center sector 2 times.
@@ -5153,15 +5385,39 @@ private:
 	CRectMap m_rectSector;		// A rectangle containing our sectors we can search.
 private:
 	bool GetNextSector();
+	bool IsSectorOld( const CSector * pSector ) const;
+	CObjBase * GetNextObj( bool fChars );
 public:
 	CWorldSearch( const CPointMap pt, int iDist = 0 );
 	void SetInertView( bool fView ) { m_fInertCharUse = fView; }
+	void SetMovedFrom( const CPointMap & ptOld );	// just what came into range going from ptOld to pt.
 	void SetRegion( const CRegionBase * pRegion );
 	void SetFilter( const TCHAR * pszFilter );
 	CChar * GetChar();
 	CItem * GetItem();
 };
 
+class CWorldSearchClient	// the clients that might see something at a point.
+{
+	// Just the clients with a char in the CSector(s) around the point(s). Not every client on the server.
+	// NOTE: Takes a copy of the sector lists first. So it is safe to do anything to the client we get.
+private:
+	std::vector<CClient*> m_Clients;
+	std::vector<CSector*> m_Sectors;	// Don't add a sector 2 times.
+	int m_iCur;
+public:
+	CWorldSearchClient()
+	{
+		m_iCur = 0;
+	}
+	CWorldSearchClient( const CPointMap & pt, int iDist = UO_MAP_VIEW_RADAR );
+	CWorldSearchClient( const CObjBaseTemplate * pObj, int iDist = UO_MAP_VIEW_RADAR );
+	void AddPoint( const CPointMap & pt, int iDist = UO_MAP_VIEW_RADAR );
+	void AddPriv( WORD wPriv );	// plus anyone with this priv that we don't have yet. (PRIV_HEARALL)
+	void AddAll();				// every client. (consoles too)
+	CClient * GetClient();
+};
+
 // Internal defs.
 
 struct CPotionDef : public CMemDynamic, public CScriptObj
@@ -5754,6 +6010,7 @@ extern class CServer : public CGSocket, public CServRef, public CTextConsole	//
 private:
 	// My base script files that are used frequently.
 	CScript m_Scripts[ SCPFILE_QTY ];
+	CScriptIndex m_ScriptIndex[ SCPFILE_QTY ];	// the sections in each. (kept across resync)
 	
 
 public:
@@ -5795,8 +6052,12 @@ public:
 	int  m_iPollServers;		// background polling of peer servers. (minutes)
 	CGString m_sRegisterServer;	// GRAY_MAIN_SERVER
 	bool m_fMainLogServer;		// This is the main log server. Will list any server that polls.
+	int  m_iMapCacheSize;		// Bytes of map data to keep loaded.
 	int  m_iMapCacheTime;		// Time in sec to keep unused map data.
 	int	 m_iSectorSleepMask;	// The mask for how long sectors will sleep.
+	int  m_iSectorThreads;		// Threads for the CSector::OnTickPrepare() part of the pulse. 0 = main loop does it all.
+	int  m_iWorldTickBudget;	// ms of world pulse work per main loop. 0 = the whole pulse at once.
+	bool m_fScriptImage;		// Read the script files into memory once. Not a file handle per script lock.
 
 	CGString m_sWorldBaseDir;	// "e:\graysvr\worldsave\"
 	CGString m_sAcctBaseDir;		// Where do the account files go/come from ?
@@ -5829,7 +6090,10 @@ public:
 	bool m_fRequireEmail;		// Valid Email required to leave GUEST mode.
 	int  m_iDeadSocketTimeMin;
 	bool m_fArriveDepartMsg;    // General switch to turn on/off arrival/depart messages.
-	int  m_nClientsMax;			// Maximum (FD_SETSIZE) open connections to server
+	int  m_nClientsMax;			// Maximum (MAX_CLIENT_SOCKETS) open connections to server
+	int  m_iNetThreads;			// Number of threads to do game client socket work. 0 = main loop does it.
+	int  m_iSendQueueHigh;		// bytes queued for a client before we stop listening to it. 4x = dump it. 0 = no limit.
+	int  m_iSendQueueLow;		// bytes queued for a client before we listen again.
 	int  m_nGuestsMax;			// Allow guests who have no accounts ?
 	int  m_iClientLingerTime;	// How long logged out clients linger in seconds.
 	int  m_iMinCharDeleteTime;	// How old must a char be ? (minutes)
@@ -5910,6 +6174,14 @@ public:
 	int m_nGuestsCur;		// How many of the current clients are "guests". Not accurate !
 	CGObList m_Clients;		// Current list of clients (CClient)
 
+private:
+	CSocketReactor m_SocketReactor;		// Which sockets have data for us ?
+	std::vector<CClient*> m_ClientsRecv;	// Clients that may still have unread data.
+	std::vector<CClient*> m_ClientsRecvWork;	// m_ClientsRecv being processed now.
+	time_t m_Clock_ClientSweep;	// last time we looked for dead sockets.
+	std::vector<CNetThread*> m_NetThreads;	// NETTHREADS
+public:
+
 	// login server stuff. 0 = us.
 	CBackTask  m_BackTask;
 	CServerArray m_Servers; // Servers list. we act like the login server with this.
@@ -5961,6 +6233,7 @@ private:
 	bool LoadDefs();
 	bool LoadTables();
 	bool LoadScripts();
+	bool IndexScpFile( SCPFILE_TYPE i );
 
 	void SetSignals();
 	void LoadChangedFiles();
@@ -5993,6 +6266,10 @@ public:
 	bool SetLogIPBlock( const TCHAR * pszIP, bool fBlock );
 
 	bool SocketsInit(); // Initialize sockets
+	void SocketsAttach( CClient * pClient );
+	void SocketsDetach( CClient * pClient );
+	void SocketsAttachThread( CClient * pClient );
+	void SocketsAccept();
 	void SocketsReceive();
 	void SocketsFlush();
 	void SocketsClose();
@@ -6027,6 +6304,7 @@ public:
 
 private:
 	void ListServers( CTextConsole * pConsole ) const;
+	void ListScpIndex( CTextConsole * pConsole ) const;
 	void SetResyncPause( bool fPause, CTextConsole * pSrc );
 
 public:
@@ -6041,6 +6319,9 @@ public:
 	CScript * ScriptLock( CScriptLock & s, SCPFILE_TYPE i, const TCHAR * pszSection = NULL, WORD wModeFlags = 0 );
 	bool ScriptLockPlot( CScriptLock & s, int index );
 	bool ScriptLockTrig( CScriptLock & s, ITEM_TYPE index );
+	const CScriptCompiled * GetPlotCompiled( int index );
+	const CScriptCompiled * GetTrigCompiled( ITEM_TYPE index );
+	DWORD GetTrigTypeMask( ITEM_TYPE index );	// ITRIG_TYPE bits.
 
 	const COreDef * GetOreEntry( int iMiningSkill ) const;
 	const COreDef * GetOreColor( COLOR_TYPE color ) const;
@@ -0,0 +1,113 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+        void CheckSame( const CGHashSet & set, const std::unordered_set<UINT> & ref, UINT dwMax )
+        {
+                if ( set.GetCount() != (int) ref.size())
+                {
+                        throw std::runtime_error( "CGHashSet count is wrong" );
+                }
+                for ( UINT dw = 1; dw <= dwMax; dw++ )
+                {
+                        if ( set.Find( dw ) != ( ref.count( dw ) != 0 ))
+                        {
+                                throw std::runtime_error( "CGHashSet Find does not match the reference set" );
+                        }
+                }
+                // Walking the slots gives each value once.
+                std::unordered_set<UINT> walked;
+                for ( int i = 0; i < set.GetSize(); i++ )
+                {
+                        UINT dw = set.GetAt( i );
+                        if ( ! dw )
+                                continue;
+                        if ( ! walked.insert( dw ).second )
+                        {
+                                throw std::runtime_error( "CGHashSet has a value twice" );
+                        }
+                }
+                if ( walked != ref )
+                {
+                        throw std::runtime_error( "CGHashSet slots do not match the reference set" );
+                }
+        }
+}
+
+TEST_CASE( TestHashSetMatchesReference )
+{
+        // Random adds and removes. Small value range so the runs get long and the removes
+        // have to pull things back across the wrap.
+        std::mt19937 rng( 3 );
+        CGHashSet set;
+        std::unordered_set<UINT> ref;
+        static const UINT sm_dwMax = 3000;
+
+        for ( int iStep = 0; iStep < 200000; iStep++ )
+        {
+                UINT dw = 1 + rng() % sm_dwMax;
+                bool fAdd = ( rng() % 100 ) < (( iStep / 20000 ) % 2 ? 35 : 65 );      // grow, then shrink.
+                if ( fAdd )
+                {
+                        bool fNew = ref.insert( dw ).second;
+                        if ( set.Add( dw ) != fNew )
+                        {
+                                throw std::runtime_error( "CGHashSet Add return is wrong" );
+                        }
+                }
+                else
+                {
+                        bool fHad = ref.erase( dw ) != 0;
+                        if ( set.Remove( dw ) != fHad )
+                        {
+                                throw std::runtime_error( "CGHashSet Remove return is wrong" );
+                        }
+                }
+                if ( iStep % 5000 == 0 )
+                {
+                        CheckSame( set, ref, sm_dwMax );
+                }
+        }
+        CheckSame( set, ref, sm_dwMax );
+
+        // Values that all start in the last 4 slots of a 64 slot table. (same hash as CGHashSet::GetSlot)
+        // One long run that wraps to the front, so removes have to pull some back and leave others.
+        CGHashSet collide;
+        std::unordered_set<UINT> refCollide;
+        std::vector<UINT> order;
+        UINT dw = 0;
+        while ( order.size() < 24 )
+        {
+                dw++;
+                if (((( dw * 0x9E3779B1 ) >> 7 ) & 63 ) < 60 )
+                        continue;
+                collide.Add( dw );
+                refCollide.insert( dw );
+                order.push_back( dw );
+        }
+        if ( collide.GetSize() != 64 )
+        {
+                throw std::runtime_error( "CGHashSet grew too soon for this test" );
+        }
+        for ( size_t k = 0; k < order.size(); k += 2 )
+        {
+                collide.Remove( order[k] );
+                refCollide.erase( order[k] );
+                CheckSame( collide, refCollide, dw );
+        }
+
+        set.Empty();
+        ref.clear();
+        CheckSame( set, ref, sm_dwMax );
+        if ( set.Remove( 5 ) || set.Find( 5 ))
+        {
+                throw std::runtime_error( "CGHashSet not empty after Empty()" );
+        }
+}
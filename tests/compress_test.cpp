@@ -0,0 +1,537 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "graymul.h"
+#include "grayproto.h"
+#include "cnetqueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        // The original bit at a time encoder, kept here as the reference output.
+        const WORD g_ReferenceBase[256+1] =
+        {
+                0x0002, 0x01f5, 0x0226, 0x0347, 0x0757, 0x0286, 0x03b6, 0x0327,
+                0x0e08, 0x0628, 0x0567, 0x0798, 0x19d9, 0x0978, 0x02a6, 0x0577,
+                0x0718, 0x05b8, 0x1cc9, 0x0a78, 0x0257, 0x04f7, 0x0668, 0x07d8,
+                0x1919, 0x1ce9, 0x03f7, 0x0909, 0x0598, 0x07b8, 0x0918, 0x0c68,
+                0x02d6, 0x1869, 0x06f8, 0x0939, 0x1cca, 0x05a8, 0x1aea, 0x1c0a,
+                0x1489, 0x14a9, 0x0829, 0x19fa, 0x1719, 0x1209, 0x0e79, 0x1f3a,
+                0x14b9, 0x1009, 0x1909, 0x0136, 0x1619, 0x1259, 0x1339, 0x1959,
+                0x1739, 0x1ca9, 0x0869, 0x1e99, 0x0db9, 0x1ec9, 0x08b9, 0x0859,
+                0x00a5, 0x0968, 0x09c8, 0x1c39, 0x19c9, 0x08f9, 0x18f9, 0x0919,
+                0x0879, 0x0c69, 0x1779, 0x0899, 0x0d69, 0x08c9, 0x1ee9, 0x1eb9,
+                0x0849, 0x1649, 0x1759, 0x1cd9, 0x05e8, 0x0889, 0x12b9, 0x1729,
+                0x10a9, 0x08d9, 0x13a9, 0x11c9, 0x1e1a, 0x1e0a, 0x1879, 0x1dca,
+                0x1dfa, 0x0747, 0x19f9, 0x08d8, 0x0e48, 0x0797, 0x0ea9, 0x0e19,
+                0x0408, 0x0417, 0x10b9, 0x0b09, 0x06a8, 0x0c18, 0x0717, 0x0787,
+                0x0b18, 0x14c9, 0x0437, 0x0768, 0x0667, 0x04d7, 0x08a9, 0x02f6,
+                0x0c98, 0x0ce9, 0x1499, 0x1609, 0x1baa, 0x19ea, 0x39fa, 0x0e59,
+                0x1949, 0x1849, 0x1269, 0x0307, 0x06c8, 0x1219, 0x1e89, 0x1c1a,
+                0x11da, 0x163a, 0x385a, 0x3dba, 0x17da, 0x106a, 0x397a, 0x24ea,
+                0x02e7, 0x0988, 0x33ca, 0x32ea, 0x1e9a, 0x0bf9, 0x3dfa, 0x1dda,
+                0x32da, 0x2eda, 0x30ba, 0x107a, 0x2e8a, 0x3dea, 0x125a, 0x1e8a,
+                0x0e99, 0x1cda, 0x1b5a, 0x1659, 0x232a, 0x2e1a, 0x3aeb, 0x3c6b,
+                0x3e2b, 0x205a, 0x29aa, 0x248a, 0x2cda, 0x23ba, 0x3c5b, 0x251a,
+                0x2e9a, 0x252a, 0x1ea9, 0x3a0b, 0x391b, 0x23ca, 0x392b, 0x3d5b,
+                0x233a, 0x2cca, 0x390b, 0x1bba, 0x3a1b, 0x3c4b, 0x211a, 0x203a,
+                0x12a9, 0x231a, 0x3e0b, 0x29ba, 0x3d7b, 0x202a, 0x3adb, 0x213a,
+                0x253a, 0x32ca, 0x23da, 0x23fa, 0x32fa, 0x11ca, 0x384a, 0x31ca,
+                0x17ca, 0x30aa, 0x2e0a, 0x276a, 0x250a, 0x3e3b, 0x396a, 0x18fa,
+                0x204a, 0x206a, 0x230a, 0x265a, 0x212a, 0x23ea, 0x3acb, 0x393b,
+                0x3e1b, 0x1dea, 0x3d6b, 0x31da, 0x3e5b, 0x3e4b, 0x207a, 0x3c7b,
+                0x277a, 0x3d4b, 0x0c08, 0x162a, 0x3daa, 0x124a, 0x1b4a, 0x264a,
+                0x33da, 0x1d1a, 0x1afa, 0x39ea, 0x24fa, 0x373b, 0x249a, 0x372b,
+                0x1679, 0x210a, 0x23aa, 0x1b8a, 0x3afb, 0x18ea, 0x2eca, 0x0627,
+                0x00d4
+        };
+
+        int ReferenceEncode( BYTE * pOutput, const BYTE * pInput, int inplen )
+        {
+                int iLen = 0;
+                int bitidx = 0;
+                BYTE xOutVal = 0;
+
+                for ( int i = 0; i <= inplen; i++ )
+                {
+                        WORD value = g_ReferenceBase[( i == inplen ) ? 256 : pInput[i]];
+                        int nBits = value & 0xF;
+                        value >>= 4;
+                        while ( nBits-- )
+                        {
+                                xOutVal <<= 1;
+                                xOutVal |= ( value >> nBits ) & 0x1;
+                                if ( ++bitidx == 8 )
+                                {
+                                        bitidx = 0;
+                                        pOutput[iLen++] = xOutVal;
+                                }
+                        }
+                }
+                if ( bitidx )
+                {
+                        pOutput[iLen++] = xOutVal << ( 8 - bitidx );
+                }
+                return iLen;
+        }
+
+        // The original pointer tree decoder, one bit per step.
+        struct ReferenceTree
+        {
+                struct Node
+                {
+                        int value;
+                        int zero;
+                        int one;
+                };
+                std::vector<Node> nodes;
+
+                ReferenceTree()
+                {
+                        nodes.push_back( Node{ -1, -1, -1 } );
+                        for ( int i = 0; i < 256 + 1; i++ )
+                        {
+                                int nBits = g_ReferenceBase[i] & 0xF;
+                                int code = g_ReferenceBase[i] >> 4;
+                                int cur = 0;
+                                while ( nBits-- )
+                                {
+                                        bool bit = ( code >> nBits ) & 1;
+                                        int next = bit ? nodes[cur].one : nodes[cur].zero;
+                                        if ( next < 0 )
+                                        {
+                                                next = static_cast<int>( nodes.size());
+                                                nodes.push_back( Node{ -1, -1, -1 } );
+                                                if ( bit )
+                                                        nodes[cur].one = next;
+                                                else
+                                                        nodes[cur].zero = next;
+                                        }
+                                        cur = next;
+                                }
+                                nodes[cur].value = i;
+                        }
+                }
+
+                int Decode( BYTE * pOutput, const BYTE * pInput, int inpsize ) const
+                {
+                        int dlen = 0;
+                        int cur = 0;
+                        for ( int sbyte = 0; sbyte < inpsize; sbyte++ )
+                        {
+                                BYTE ch = pInput[sbyte];
+                                BYTE mask = 0x80;
+                                for ( int i = 0; i < 8; i++ )
+                                {
+                                        cur = ( ch & mask ) ? nodes[cur].one : nodes[cur].zero;
+                                        if ( cur < 0 )
+                                        {
+                                                return -1;
+                                        }
+                                        if ( nodes[cur].value >= 0 )
+                                        {
+                                                if ( nodes[cur].value >= 256 )
+                                                {
+                                                        cur = 0;
+                                                        break;
+                                                }
+                                                pOutput[dlen++] = static_cast<BYTE>( nodes[cur].value );
+                                                cur = 0;
+                                        }
+                                        mask >>= 1;
+                                }
+                        }
+                        return dlen;
+                }
+        };
+
+        std::vector<BYTE> MakeInput( std::mt19937 & rng, size_t len, int mode )
+        {
+                // mode 0 = random bytes, 1 = packet like (lots of zeros and small values), 2 = one repeated byte
+                std::vector<BYTE> data( len );
+                std::uniform_int_distribution<int> byteDist( 0, 255 );
+                BYTE fill = static_cast<BYTE>( byteDist( rng ));
+                for ( size_t i = 0; i < len; i++ )
+                {
+                        switch ( mode )
+                        {
+                        case 0:
+                                data[i] = static_cast<BYTE>( byteDist( rng ));
+                                break;
+                        case 1:
+                                data[i] = ( byteDist( rng ) < 160 ) ? 0 : static_cast<BYTE>( byteDist( rng ) & 0x1F );
+                                break;
+                        default:
+                                data[i] = fill;
+                                break;
+                        }
+                }
+                return data;
+        }
+
+        std::vector<BYTE> MakePacketStream( size_t len )
+        {
+                // Something like a busy xFlush() buffer: walk, move and speech packets.
+                std::mt19937 rng( 1234 );
+                return MakeInput( rng, len, 1 );
+        }
+
+        template <typename ENCODER>
+        double MeasureMBs( ENCODER encoder, const std::vector<BYTE> & input, std::vector<BYTE> & output )
+        {
+                const int iterations = 200;
+                int total = 0;
+                auto start = std::chrono::steady_clock::now();
+                for ( int i = 0; i < iterations; i++ )
+                {
+                        total += encoder( output.data(), input.data(), static_cast<int>( input.size()));
+                }
+                auto elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+                if ( total <= 0 || elapsed <= 0.0 )
+                {
+                        return 0.0;
+                }
+                return ( static_cast<double>( input.size()) * iterations ) / ( 1024.0 * 1024.0 ) / elapsed;
+        }
+}
+
+TEST_CASE( TestCompressEncodeMatchesReference )
+{
+        std::mt19937 rng( 0x5EED );
+        std::uniform_int_distribution<int> lenDist( 0, MAX_BUFFER );
+        std::vector<BYTE> expected( MAX_BUFFER * 2 );
+        std::vector<BYTE> actual( MAX_BUFFER * 2 );
+
+        for ( int iteration = 0; iteration < 2000; iteration++ )
+        {
+                size_t len = ( iteration < 64 ) ? static_cast<size_t>( iteration ) : static_cast<size_t>( lenDist( rng ) % 2048 );
+                if ( iteration % 100 == 99 )
+                {
+                        len = static_cast<size_t>( lenDist( rng ));
+                }
+                std::vector<BYTE> input = MakeInput( rng, len, iteration % 3 );
+
+                int expectedLen = ReferenceEncode( expected.data(), input.data(), static_cast<int>( len ));
+                int actualLen = CCompressTree::Encode( actual.data(), input.data(), static_cast<int>( len ));
+                if ( expectedLen != actualLen )
+                {
+                        throw std::runtime_error( "Encode length differs from reference for input length " + std::to_string( len ));
+                }
+                if ( memcmp( expected.data(), actual.data(), expectedLen ) != 0 )
+                {
+                        throw std::runtime_error( "Encode output differs from reference for input length " + std::to_string( len ));
+                }
+        }
+}
+
+TEST_CASE( TestCompressEncodeDecodeRoundTrip )
+{
+        CCompressTree tree;
+        if ( !tree.Load())
+        {
+                throw std::runtime_error( "Unable to build the decode tree" );
+        }
+
+        std::mt19937 rng( 42 );
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        std::vector<BYTE> unpacked( MAX_BUFFER * 2 );
+        for ( int iteration = 0; iteration < 200; iteration++ )
+        {
+                std::vector<BYTE> input = MakeInput( rng, static_cast<size_t>( iteration * 37 ), iteration % 3 );
+                int packedLen = CCompressTree::Encode( packed.data(), input.data(), static_cast<int>( input.size()));
+                int unpackedLen = tree.Decode( unpacked.data(), packed.data(), packedLen );
+                if ( unpackedLen != static_cast<int>( input.size()))
+                {
+                        throw std::runtime_error( "Decode length mismatch" );
+                }
+                if ( !input.empty() && memcmp( input.data(), unpacked.data(), input.size()) != 0 )
+                {
+                        throw std::runtime_error( "Decode content mismatch" );
+                }
+        }
+}
+
+TEST_CASE( BenchCompressEncode )
+{
+        std::vector<BYTE> input = MakePacketStream( MAX_BUFFER / 2 );
+        std::vector<BYTE> output( MAX_BUFFER * 2 );
+
+        double reference = MeasureMBs( ReferenceEncode, input, output );
+        double current = MeasureMBs( CCompressTree::Encode, input, output );
+        std::printf( "        Encode %zu bytes: reference %.1f MB/s, current %.1f MB/s\n",
+                input.size(), reference, current );
+}
+
+TEST_CASE( TestCompressDecodeMatchesReference )
+{
+        CCompressTree tree;
+        if ( !tree.Load())
+        {
+                throw std::runtime_error( "Unable to build the decode table" );
+        }
+        ReferenceTree reference;
+
+        // Any bit stream at all, not just what Encode() makes. (odd end codes and partial codes at the end)
+        std::mt19937 rng( 0xDEC0DE );
+        std::uniform_int_distribution<int> lenDist( 0, 4096 );
+        std::vector<BYTE> expected( MAX_BUFFER * 2 );
+        std::vector<BYTE> actual( MAX_BUFFER * 2 );
+        for ( int iteration = 0; iteration < 2000; iteration++ )
+        {
+                size_t len = ( iteration < 64 ) ? static_cast<size_t>( iteration ) : static_cast<size_t>( lenDist( rng ));
+                std::vector<BYTE> input = MakeInput( rng, len, iteration % 3 );
+                if ( iteration % 2 )
+                {
+                        // Several encoded packets back to back, maybe cut short.
+                        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+                        int packedLen = CCompressTree::Encode( packed.data(), input.data(), static_cast<int>( len ));
+                        int cut = packedLen ? static_cast<int>( rng() % packedLen ) : 0;
+                        input.assign( packed.begin(), packed.begin() + ( iteration % 4 == 1 ? packedLen : cut ));
+                        input.insert( input.end(), packed.begin(), packed.begin() + packedLen );
+                }
+
+                int expectedLen = reference.Decode( expected.data(), input.data(), static_cast<int>( input.size()));
+                int actualLen = tree.Decode( actual.data(), input.data(), static_cast<int>( input.size()));
+                if ( expectedLen != actualLen )
+                {
+                        throw std::runtime_error( "Decode length differs from reference for input length " + std::to_string( input.size()));
+                }
+                if ( expectedLen > 0 && memcmp( expected.data(), actual.data(), expectedLen ) != 0 )
+                {
+                        throw std::runtime_error( "Decode output differs from reference for input length " + std::to_string( input.size()));
+                }
+        }
+}
+
+TEST_CASE( BenchCompressDecode )
+{
+        CCompressTree tree;
+        if ( !tree.Load())
+        {
+                throw std::runtime_error( "Unable to build the decode table" );
+        }
+        ReferenceTree reference;
+
+        std::vector<BYTE> input = MakePacketStream( MAX_BUFFER / 2 );
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        packed.resize( CCompressTree::Encode( packed.data(), input.data(), static_cast<int>( input.size())));
+        std::vector<BYTE> output( MAX_BUFFER * 2 );
+
+        // MB/s of decoded output.
+        double scale = static_cast<double>( input.size()) / static_cast<double>( packed.size());
+        double before = MeasureMBs( [&reference]( BYTE * pOut, const BYTE * pIn, int len ) { return reference.Decode( pOut, pIn, len ); }, packed, output ) * scale;
+        double current = MeasureMBs( [&tree]( BYTE * pOut, const BYTE * pIn, int len ) { return tree.Decode( pOut, pIn, len ); }, packed, output ) * scale;
+        std::printf( "        Decode %zu bytes: reference %.1f MB/s, current %.1f MB/s\n",
+                input.size(), before, current );
+}
+
+TEST_CASE( TestCompressBlocksConcatenate )
+{
+        // Blocks ended at different times (each xFlush(), each CNetThread batch) decode as one stream.
+        CCompressTree tree;
+        if ( !tree.Load())
+        {
+                throw std::runtime_error( "Unable to build the decode table" );
+        }
+
+        std::mt19937 rng( 7 );
+        std::vector<BYTE> stream;
+        std::vector<BYTE> expected;
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        for ( int iteration = 0; iteration < 300; iteration++ )
+        {
+                std::vector<BYTE> block = MakeInput( rng, 1 + ( rng() % 300 ), iteration % 3 );
+                int packedLen = CCompressTree::Encode( packed.data(), block.data(), static_cast<int>( block.size()));
+                stream.insert( stream.end(), packed.begin(), packed.begin() + packedLen );
+                expected.insert( expected.end(), block.begin(), block.end());
+        }
+
+        std::vector<BYTE> unpacked( expected.size() + 16 );
+        int unpackedLen = tree.Decode( unpacked.data(), stream.data(), static_cast<int>( stream.size()));
+        if ( unpackedLen != static_cast<int>( expected.size()) || memcmp( unpacked.data(), expected.data(), expected.size()) != 0 )
+        {
+                throw std::runtime_error( "Concatenated blocks did not decode back to the same stream" );
+        }
+}
+
+TEST_CASE( TestCompressStreamMatchesOneBlock )
+{
+        // Blocks and shared packets into one open block = Encode() of all of it at once.
+        std::mt19937 rng( 11 );
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        std::vector<BYTE> bits( MAX_BUFFER * 2 );
+        for ( int iteration = 0; iteration < 200; iteration++ )
+        {
+                CCompressStream stream( MAX_BUFFER );
+                std::vector<BYTE> all;
+                std::vector<BYTE> out;
+                int pieces = 1 + static_cast<int>( rng() % 20 );
+                for ( int i = 0; i < pieces; i++ )
+                {
+                        std::vector<BYTE> piece = MakeInput( rng, 1 + ( rng() % 200 ), i % 3 );
+                        int len;
+                        if ( rng() & 1 )
+                        {
+                                // A CNetBroadcast.
+                                int iBits = CCompressTree::EncodeBits( bits.data(), piece.data(), static_cast<int>( piece.size()));
+                                len = stream.AppendBits( packed.data(), bits.data(), iBits, static_cast<int>( piece.size()));
+                        }
+                        else
+                        {
+                                len = stream.Encode( packed.data(), piece.data(), static_cast<int>( piece.size()));
+                        }
+                        out.insert( out.end(), packed.begin(), packed.begin() + len );
+                        all.insert( all.end(), piece.begin(), piece.end());
+                }
+                if ( stream.GetLengthRaw() != static_cast<int>( all.size()))
+                {
+                        throw std::runtime_error( "Stream raw length wrong" );
+                }
+                int len = stream.Finish( packed.data());
+                out.insert( out.end(), packed.begin(), packed.begin() + len );
+
+                std::vector<BYTE> expected( MAX_BUFFER * 2 );
+                expected.resize( CCompressTree::Encode( expected.data(), all.data(), static_cast<int>( all.size())));
+                if ( out != expected )
+                {
+                        throw std::runtime_error( "Stream output differs from one Encode() of the same bytes" );
+                }
+        }
+}
+
+TEST_CASE( TestCompressStreamEndsBigBlocks )
+{
+        // Never more than the max between end codes. Pieces are never split.
+        CCompressTree tree;
+        if ( !tree.Load())
+        {
+                throw std::runtime_error( "Unable to build the decode table" );
+        }
+        std::mt19937 rng( 12 );
+        CCompressStream stream( 500 );
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        std::vector<BYTE> bits( MAX_BUFFER * 2 );
+        std::vector<BYTE> all;
+        std::vector<BYTE> out;
+        for ( int i = 0; i < 300; i++ )
+        {
+                std::vector<BYTE> piece = MakeInput( rng, 1 + ( rng() % 200 ), i % 3 );
+                int iBefore = stream.GetLengthRaw();
+                int len;
+                if ( i & 1 )
+                {
+                        int iBits = CCompressTree::EncodeBits( bits.data(), piece.data(), static_cast<int>( piece.size()));
+                        len = stream.AppendBits( packed.data(), bits.data(), iBits, static_cast<int>( piece.size()));
+                }
+                else
+                {
+                        len = stream.Encode( packed.data(), piece.data(), static_cast<int>( piece.size()));
+                }
+                int iWant = ( iBefore + static_cast<int>( piece.size()) > 500 ) ? static_cast<int>( piece.size()) : iBefore + static_cast<int>( piece.size());
+                if ( stream.GetLengthRaw() != iWant )
+                {
+                        throw std::runtime_error( "Block not ended at the max" );
+                }
+                out.insert( out.end(), packed.begin(), packed.begin() + len );
+                all.insert( all.end(), piece.begin(), piece.end());
+        }
+        int len = stream.Finish( packed.data());
+        out.insert( out.end(), packed.begin(), packed.begin() + len );
+
+        std::vector<BYTE> unpacked( all.size() + 16 );
+        int unpackedLen = tree.Decode( unpacked.data(), out.data(), static_cast<int>( out.size()));
+        if ( unpackedLen != static_cast<int>( all.size()) || memcmp( unpacked.data(), all.data(), all.size()) != 0 )
+        {
+                throw std::runtime_error( "Ended blocks did not decode back to the same stream" );
+        }
+}
+
+TEST_CASE( BenchCompressShared )
+{
+        // One client's tick: its own packets with shared moves and speech mixed in. Then xFlush().
+        // Before = each shared packet was its own block. (end the open block, then the shared one)
+        // Now = shared codes are shifted into the open block. One end code at the flush.
+        std::mt19937 rng( 13 );
+        std::vector<std::vector<BYTE>> shared;
+        std::vector<std::vector<BYTE>> sharedBlocks;
+        std::vector<std::vector<BYTE>> sharedBits;
+        std::vector<int> sharedBitLen;
+        for ( int i = 0; i < 30; i++ )
+        {
+                shared.push_back( MakeInput( rng, 17, 1 ));    // 0x77 move size.
+                std::vector<BYTE> packed( 64 );
+                packed.resize( CCompressTree::Encode( packed.data(), shared[i].data(), 17 ));
+                sharedBlocks.push_back( packed );
+                std::vector<BYTE> bits( 64 );
+                sharedBitLen.push_back( CCompressTree::EncodeBits( bits.data(), shared[i].data(), 17 ));
+                sharedBits.push_back( bits );
+        }
+        std::vector<std::vector<BYTE>> own;
+        for ( int i = 0; i < 30; i++ )
+        {
+                own.push_back( MakeInput( rng, 5 + ( rng() % 40 ), 1 ));
+        }
+
+        std::vector<BYTE> packed( MAX_BUFFER * 2 );
+        const int clients = 2000;
+        CNetSendQueue queue;
+
+        // The old shared segment. (pool lock to get it, a reference, pool lock to give it back)
+        std::mutex poolLock;
+        std::atomic<int> refs( 1 );
+        size_t bytesBefore = 0;
+        auto start = std::chrono::steady_clock::now();
+        for ( int c = 0; c < clients; c++ )
+        {
+                for ( int i = 0; i < 30; i++ )
+                {
+                        int len = CCompressTree::Encode( packed.data(), own[i].data(), static_cast<int>( own[i].size()));
+                        queue.Append( packed.data(), len );
+                        {
+                                std::lock_guard<std::mutex> lock( poolLock );
+                                refs.fetch_add( 1 );
+                        }
+                        bytesBefore += len + sharedBlocks[i].size();
+                }
+                queue.Empty();
+                for ( int i = 0; i < 30; i++ )
+                {
+                        std::lock_guard<std::mutex> lock( poolLock );
+                        refs.fetch_sub( 1 );
+                }
+        }
+        double before = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        size_t bytesNow = 0;
+        start = std::chrono::steady_clock::now();
+        for ( int c = 0; c < clients; c++ )
+        {
+                CCompressStream stream( MAX_BUFFER );
+                for ( int i = 0; i < 30; i++ )
+                {
+                        int len = stream.Encode( packed.data(), own[i].data(), static_cast<int>( own[i].size()));
+                        queue.Append( packed.data(), len );
+                        bytesNow += len;
+                        len = stream.AppendBits( packed.data(), sharedBits[i].data(), sharedBitLen[i], 17 );
+                        queue.Append( packed.data(), len );
+                        bytesNow += len;
+                }
+                int len = stream.Finish( packed.data());
+                queue.Append( packed.data(), len );
+                bytesNow += len;
+                queue.Empty();
+        }
+        double now = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::printf( "        30 own + 30 shared packets per flush: before %.1f bytes %.2f us, now %.1f bytes %.2f us (per client)\n",
+                static_cast<double>( bytesBefore ) / clients, before * 1e6 / clients,
+                static_cast<double>( bytesNow ) / clients, now * 1e6 / clients );
+}
@@ -0,0 +1,10 @@
+#include "graycom.h"
+
+// ccrypt.cpp only needs a log sink and the assert hook.
+CEventLog g_Log;
+CEventLog * g_pLog = &g_Log;
+
+void Assert_CheckFail( const char *, const char *, unsigned int )
+{
+        // Assertions are ignored in unit tests.
+}
@@ -0,0 +1,285 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        void SetTestDefs()
+        {
+                g_Exp.m_VarDefs.RemoveAll();
+                g_Exp.SetVarDef( "d_ten", "10" );
+                g_Exp.SetVarDef( "d_hex", "0a0" );
+                g_Exp.SetVarDef( "d_range", "{1 5}" );
+                g_Exp.SetVarDef( "d_weight", "{ 400 1 401 1 }" );
+                g_Exp.SetVarDef( "d_expr", "d_ten * 2 + 1" );
+                g_Exp.SetVarDef( "d_big", "0x7fffffff" );
+        }
+
+        struct ExprResult
+        {
+                int m_iVal;
+                int m_iLen;
+
+                bool operator!=( const ExprResult & other ) const
+                {
+                        return( m_iVal != other.m_iVal || m_iLen != other.m_iLen );
+                }
+        };
+
+        ExprResult ParseText( const std::string & text, BYTE bMode, unsigned int uSeed )
+        {
+                bool fCompile = g_Exp.m_fCompile;
+                g_Exp.m_fCompile = false;
+                std::srand( uSeed );
+                const TCHAR * pszText = text.c_str();
+                ExprResult res;
+                bool fHexDef = ( bMode & EXPRMODE_HEX ) ? true : false;
+                res.m_iVal = ( bMode & EXPRMODE_SINGLE ) ? g_Exp.GetSingle( pszText, fHexDef ) : g_Exp.GetVal( pszText, fHexDef );
+                res.m_iLen = (int)( pszText - text.c_str());
+                g_Exp.m_fCompile = fCompile;
+                return( res );
+        }
+
+        ExprResult RunProg( CExprProg & prog, unsigned int uSeed )
+        {
+                std::srand( uSeed );
+                ExprResult res;
+                res.m_iVal = g_Exp.GetProgVal( prog );
+                res.m_iLen = prog.GetLen();
+                return( res );
+        }
+
+        void CheckSame( const std::string & text, BYTE bMode, unsigned int uSeed )
+        {
+                ExprResult text1 = ParseText( text, bMode, uSeed );
+                CExprProg prog;
+                g_Exp.Compile( prog, text.c_str(), bMode );
+                // Twice. The 2nd time the DEF values are compiled too.
+                for ( int i = 0; i < 2; i++ )
+                {
+                        if ( text1 != RunProg( prog, uSeed ))
+                        {
+                                throw std::runtime_error( "Compiled expression differs for '" + text + "' mode " + std::to_string( bMode ));
+                        }
+                }
+        }
+}
+
+TEST_CASE( TestExprCompiledMatchesText )
+{
+        SetTestDefs();
+
+        static const char * sm_Exprs[] =
+        {
+                "", "7933", "-100.0", ".5", "0.5", "073a", "0 1", "0-1", "0 -1", "5-", "1-2-3",
+                "{ 400 1 401 1 }", "{ 1102 1148 1 }", "{ d_range 1 d_ten 1 }", "{ d_weight 1 34 39 1 }",
+                "d_ten", "d_hex", "d_expr", "d_ten+d_expr*2", "d_big + 1", "(d_big + 1) > 0", "d_big + 1 > 0",
+                "2 + 3 * 4", "10 / 0", "10 / 3 + 1", "1 || 0", "0 && RAND(5)", "~0", "!5", "!(3 > 2)",
+                "83 > 50", "1 << 4 >> 2", "5 >= 5", "5 <= 4", "3 != 3", "3 == 3", "3 = 3", "3 ==== 3",
+                "RAND(10)", "rand(d_ten) + 1", "RAND(RAND(100))", "STRLEN(hello)", "STRCMP(abc,abd)",
+                "STRCMP(abc,abc) == 0", "missing_name + 1", "abc", "(1 2 3)", "[4]", "{5 6", "1,2,3", "4;5",
+                "1 ! 2", "1 !", ")", "- 5", "-d_ten", "1 2 3 4 5 6 7", "0.1.2", "1+(2+(3+(4+5)))",
+                "  \t 12  +  3  ", "0ff", "ff", "0.", "12.34",
+        };
+        for ( size_t i = 0; i < COUNTOF( sm_Exprs ); i++ )
+        {
+                for ( BYTE bMode = 0; bMode < 4; bMode++ )
+                {
+                        CheckSame( sm_Exprs[i], bMode, (unsigned) ( 7 + i ));
+                }
+        }
+
+        // Random junk. The quirks must match too.
+        static const char * sm_Tokens[] =
+        {
+                "0", "1", "7", "10", "255", "-3", ".5", "0.5", "073a", "0x1f", "d_ten", "d_hex", "d_range",
+                "d_weight", "d_expr", "d_big", "zz", "RAND(10)", "rand(d_ten)", "STRLEN(abc)", "STRCMP(a,b)",
+                "(", ")", "{", "}", "[", "]", "~", "!", "+", "-", "*", "/", "|", "||", "&", "&&",
+                ">", ">=", ">>", "<", "<=", "<<", "!=", "==", "=", " ", " ", " ", "\t", ",", ";",
+        };
+        std::mt19937 rng( 25 );
+        for ( int iExpr = 0; iExpr < 20000; iExpr++ )
+        {
+                std::string text;
+                int iTokens = 1 + rng() % 12;
+                for ( int i = 0; i < iTokens; i++ )
+                {
+                        text += sm_Tokens[ rng() % COUNTOF( sm_Tokens ) ];
+                }
+                CheckSame( text, (BYTE) ( rng() % 4 ), rng());
+        }
+        g_Exp.m_VarDefs.RemoveAll();
+}
+
+TEST_CASE( TestExprDefChanges )
+{
+        g_Exp.m_VarDefs.RemoveAll();
+        g_Exp.SetVarDef( "t_a", "5" );
+
+        CExprProg prog;
+        g_Exp.Compile( prog, "t_a + t_missing" );
+        if ( g_Exp.GetProgVal( prog ) != 5 )
+        {
+                throw std::runtime_error( "Wrong value to start" );
+        }
+
+        // A name we did not find shows up.
+        g_Exp.SetVarDef( "t_missing", "7" );
+        if ( g_Exp.GetProgVal( prog ) != 12 )
+        {
+                throw std::runtime_error( "Missed a new def" );
+        }
+
+        // A value changes. (and its compiled value too)
+        for ( int i = 0; i < 3; i++ )
+        {
+                g_Exp.SetVarDef( "t_a", std::to_string( i ).c_str());
+                if ( g_Exp.GetProgVal( prog ) != i + 7 || g_Exp.GetProgVal( prog ) != i + 7 )
+                {
+                        throw std::runtime_error( "Missed a new def value" );
+                }
+        }
+
+        // A def we point at goes away.
+        g_Exp.m_VarDefs.DeleteAt( g_Exp.m_VarDefs.FindKey( "t_a" ));
+        if ( g_Exp.GetProgVal( prog ) != ParseText( "t_a + t_missing", EXPRMODE_VAL, 0 ).m_iVal )
+        {
+                throw std::runtime_error( "Kept a deleted def" );
+        }
+
+        // A def that uses itself stops.
+        g_Exp.SetVarDef( "t_self", "t_self + 1" );
+        CExprProg progSelf;
+        g_Exp.Compile( progSelf, "t_self" );
+        for ( int i = 0; i < 3; i++ )
+        {
+                if ( g_Exp.GetProgVal( progSelf ) <= 0 )
+                {
+                        throw std::runtime_error( "Def that uses itself went wrong" );
+                }
+        }
+
+        // Constants are worked out when compiled.
+        CExprProg progConst;
+        g_Exp.Compile( progConst, "(1 + 2) * 3 > STRLEN(abcd) && !0" );
+        if ( ! progConst.IsConst() || g_Exp.GetProgVal( progConst ) != 1 )
+        {
+                throw std::runtime_error( "Constant expression not folded" );
+        }
+        g_Exp.Compile( progConst, "RAND(3 * 4)" );
+        if ( progConst.IsConst() || progConst.GetOpCount() != 2 )
+        {
+                throw std::runtime_error( "RAND() argument not folded" );
+        }
+        g_Exp.m_VarDefs.RemoveAll();
+}
+
+TEST_CASE( TestExprCache )
+{
+        SetTestDefs();
+        bool fCompile = g_Exp.m_fCompile;
+        g_Exp.m_fCompile = true;
+        g_Exp.ClearCache();
+
+        // Compiled the 2nd time it is seen. The caller's text moves on the same.
+        const std::string text = "d_expr * 2 > 40, next";
+        DWORD dwHits = g_Exp.m_dwCacheHits;
+        for ( int i = 0; i < 4; i++ )
+        {
+                const TCHAR * pszText = text.c_str();
+                if ( g_Exp.GetVal( pszText ) != 1 || std::string( pszText ) != ", next" )
+                {
+                        throw std::runtime_error( "Cached expression went wrong" );
+                }
+        }
+        if ( g_Exp.m_dwCacheHits != dwHits + 2 || g_Exp.GetCacheCount() != 1 )
+        {
+                throw std::runtime_error( "Cache did not compile it once" );
+        }
+
+        // Text seen only once does not push out what we have.
+        DWORD dwCompiles = g_Exp.m_dwCompiles;
+        for ( int i = 0; i < 20000; i++ )
+        {
+                const std::string once = std::to_string( i ) + " > 50";
+                const TCHAR * pszText = once.c_str();
+                g_Exp.GetVal( pszText );
+        }
+        if ( g_Exp.m_dwCompiles != dwCompiles || g_Exp.GetCacheCount() != 1 )
+        {
+                throw std::runtime_error( "Compiled text that was seen once" );
+        }
+
+        g_Exp.ClearCache();
+        g_Exp.m_fCompile = fCompile;
+        g_Exp.m_VarDefs.RemoveAll();
+}
+
+TEST_CASE( BenchExpressions )
+{
+        // The sort of thing IF lines and item/char defs are full of.
+        SetTestDefs();
+        static const char * sm_Exprs[] =
+        {
+                "83 > 50",
+                "RAND(10)",
+                "d_ten * 2 + 1 >= 20",
+                "{ 400 1 401 1 }",
+                "d_range",
+                "(d_expr & 0f) == 0a",
+                "{ d_weight 1 34 39 1 }",
+                "STRLEN(hello) + 1 || 0",
+        };
+        static const int sm_iRuns = 100000;
+        bool fCompile = g_Exp.m_fCompile;
+
+        double dTimes[3];
+        long lSums[3];
+        std::vector<CExprProg> progs( COUNTOF( sm_Exprs ));
+        for ( size_t i = 0; i < COUNTOF( sm_Exprs ); i++ )
+        {
+                g_Exp.Compile( progs[i], sm_Exprs[i] );
+        }
+        for ( int iMode = 0; iMode < 3; iMode++ )
+        {
+                // 0 = parse the text, 1 = text through the cache, 2 = compiled already (script lines)
+                g_Exp.m_fCompile = ( iMode != 0 );
+                g_Exp.ClearCache();
+                std::srand( 1 );
+                long lSum = 0;
+                auto start = std::chrono::steady_clock::now();
+                for ( int i = 0; i < sm_iRuns; i++ )
+                {
+                        for ( size_t j = 0; j < COUNTOF( sm_Exprs ); j++ )
+                        {
+                                if ( iMode == 2 )
+                                {
+                                        lSum += g_Exp.GetProgVal( progs[j] );
+                                        continue;
+                                }
+                                const TCHAR * pszText = sm_Exprs[j];
+                                lSum += g_Exp.GetVal( pszText );
+                        }
+                }
+                dTimes[iMode] = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+                lSums[iMode] = lSum;
+        }
+        g_Exp.m_fCompile = fCompile;
+        g_Exp.ClearCache();
+        g_Exp.m_VarDefs.RemoveAll();
+
+        std::printf( "  %d expressions: text %.2f ms, cached %.2f ms, compiled %.2f ms\n",
+                sm_iRuns * (int) COUNTOF( sm_Exprs ), dTimes[0] * 1000.0, dTimes[1] * 1000.0, dTimes[2] * 1000.0 );
+        if ( lSums[0] != lSums[1] || lSums[0] != lSums[2] )
+        {
+                throw std::runtime_error( "Text and compiled expressions got different values" );
+        }
+}
@@ -0,0 +1,80 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+        const char * WriteTestFile( std::vector<unsigned char> & data )
+        {
+                static const char * sm_pszName = "file_view_test.tmp";
+                data.resize( 100000 );
+                for ( size_t i = 0; i < data.size(); i++ )
+                {
+                        data[i] = (unsigned char)( i * 7 + ( i >> 8 ));
+                }
+                FILE * pFile = std::fopen( sm_pszName, "wb" );
+                if ( pFile == NULL )
+                {
+                        throw std::runtime_error( "Can't write the test file" );
+                }
+                std::fwrite( data.data(), 1, data.size(), pFile );
+                std::fclose( pFile );
+                return( sm_pszName );
+        }
+
+        void CheckReads( CFileBin & file, const std::vector<unsigned char> & data )
+        {
+                static const DWORD sm_Offsets[] = { 0, 1, 4095, 4096, 50000, 99990 };
+                for ( DWORD dwOffset : sm_Offsets )
+                {
+                        unsigned char buf[10];
+                        if ( ! file.ReadAt( dwOffset, buf, sizeof(buf)))
+                        {
+                                throw std::runtime_error( "ReadAt failed inside the file" );
+                        }
+                        for ( size_t i = 0; i < sizeof(buf); i++ )
+                        {
+                                if ( buf[i] != data[dwOffset + i] )
+                                {
+                                        throw std::runtime_error( "ReadAt got the wrong bytes" );
+                                }
+                        }
+                }
+                unsigned char buf[10];
+                if ( file.ReadAt( 99995, buf, sizeof(buf)))
+                {
+                        throw std::runtime_error( "ReadAt past the end should fail" );
+                }
+        }
+}
+
+TEST_CASE( TestFileBinReadAtViewMatchesRead )
+{
+        std::vector<unsigned char> data;
+        const char * pszName = WriteTestFile( data );
+
+        CFileBin file;
+        if ( ! file.Open( pszName, OF_READ ))
+        {
+                throw std::runtime_error( "Can't open the test file" );
+        }
+        CheckReads( file, data );        // Seek() and Read()
+
+        if ( ! file.OpenView() || file.m_View.GetSize() != data.size())
+        {
+                throw std::runtime_error( "Can't map the test file" );
+        }
+        file.m_View.Prefetch( 4000, 200000 );
+        CheckReads( file, data );        // from the view.
+
+        file.Close();
+        if ( file.m_View.IsOpen())
+        {
+                throw std::runtime_error( "Close should drop the view" );
+        }
+        std::remove( pszName );
+}
@@ -0,0 +1,343 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "cgridthreads.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+        static const int sm_iCols = 96;         // the sector grid of a 6144x4096 map.
+        static const int sm_iRows = 64;
+
+        // Marks each cell busy while it runs and looks for a busy neighbour.
+        class TestNeighbourJob : public CGridJob
+        {
+        public:
+                std::vector<std::atomic<int>> m_Busy;
+                std::vector<std::atomic<int>> m_Visits;
+                std::vector<std::vector<int>> m_PerThread;      // like CSectorTickCmds.
+                std::atomic<int> m_iClashes;
+
+                explicit TestNeighbourJob( int iThreads ) :
+                        m_Busy( sm_iCols * sm_iRows ),
+                        m_Visits( sm_iCols * sm_iRows ),
+                        m_PerThread( iThreads + 1 ),
+                        m_iClashes( 0 )
+                {
+                }
+
+                virtual void OnGridCell( int iThread, int iCell )
+                {
+                        m_Busy[iCell] = 1;
+                        int x = iCell % sm_iCols;
+                        int y = iCell / sm_iCols;
+                        for ( int spin = 0; spin < 200; spin++ )
+                        {
+                                for ( int dy = -1; dy <= 1; dy++ )
+                                {
+                                        for ( int dx = -1; dx <= 1; dx++ )
+                                        {
+                                                if ( ! dx && ! dy )
+                                                        continue;
+                                                int nx = x + dx;
+                                                int ny = y + dy;
+                                                if ( nx < 0 || ny < 0 || nx >= sm_iCols || ny >= sm_iRows )
+                                                        continue;
+                                                if ( m_Busy[ nx + ny * sm_iCols ].load())
+                                                        m_iClashes ++;
+                                        }
+                                }
+                        }
+                        m_Visits[iCell] ++;
+                        m_PerThread[iThread].push_back( iCell );
+                        m_Busy[iCell] = 0;
+                }
+        };
+
+        void CheckNeighbourRuns( int iThreads )
+        {
+                CGridThreads threads;
+                threads.Start( iThreads );
+                if ( threads.GetThreadCount() != iThreads )
+                {
+                        throw std::runtime_error( "Wrong thread count" );
+                }
+
+                std::vector<int> cells;
+                for ( int i = 0; i < sm_iCols * sm_iRows; i += 3 )     // a spread, not every cell.
+                {
+                        cells.push_back( i );
+                }
+
+                TestNeighbourJob job( iThreads );
+                static const int sm_iRuns = 20;
+                for ( int r = 0; r < sm_iRuns; r++ )
+                {
+                        threads.Run( job, &cells[0], (int) cells.size(), sm_iCols );
+                }
+
+                if ( job.m_iClashes.load())
+                {
+                        throw std::runtime_error( "Two cells that touch ran at the same time" );
+                }
+                size_t iMerged = 0;
+                for ( size_t i = 0; i < job.m_PerThread.size(); i++ )
+                {
+                        iMerged += job.m_PerThread[i].size();
+                }
+                if ( iMerged != cells.size() * sm_iRuns )
+                {
+                        throw std::runtime_error( "Per thread results lost or doubled" );
+                }
+                for ( int i = 0; i < sm_iCols * sm_iRows; i++ )
+                {
+                        int iWant = ( i % 3 ) ? 0 : sm_iRuns;
+                        if ( job.m_Visits[i].load() != iWant )
+                        {
+                                throw std::runtime_error( "Cell not done exactly once per run" );
+                        }
+                }
+        }
+
+        // A char's worth of CChar::OnTickRegen().
+        struct TestChar
+        {
+                int m_regen[4];
+                int m_val[4];
+        };
+
+        class TestRegenJob : public CGridJob
+        {
+        public:
+                std::vector<std::vector<TestChar>> m_Cells;
+                std::vector<std::vector<int>> m_Due;    // per thread.
+
+                TestRegenJob( int iCharsPerCell, int iThreads ) :
+                        m_Cells( sm_iCols * sm_iRows, std::vector<TestChar>( iCharsPerCell )),
+                        m_Due( iThreads + 1 )
+                {
+                        for ( size_t i = 0; i < m_Cells.size(); i++ )
+                        {
+                                for ( size_t j = 0; j < m_Cells[i].size(); j++ )
+                                {
+                                        for ( int s = 0; s < 4; s++ )
+                                        {
+                                                m_Cells[i][j].m_regen[s] = (int)(( i * 7 + j * 13 + s ) % 50 );
+                                                m_Cells[i][j].m_val[s] = 0;
+                                        }
+                                }
+                        }
+                }
+                virtual void OnGridCell( int iThread, int iCell )
+                {
+                        static const int sm_Rate[4] = { 60, 50, 30, 18000 };
+                        std::vector<TestChar> & chars = m_Cells[iCell];
+                        for ( size_t j = 0; j < chars.size(); j++ )
+                        {
+                                int iDue = 0;
+                                for ( int s = 0; s < 4; s++ )
+                                {
+                                        chars[j].m_regen[s] += 10;
+                                        int iRate = sm_Rate[s] + sm_Rate[s] / ( 2 * ( 1 + chars[j].m_val[s] / 32 ));
+                                        if ( chars[j].m_regen[s] < iRate )
+                                                continue;
+                                        chars[j].m_regen[s] = 0;
+                                        chars[j].m_val[s] ++;
+                                        iDue |= 1 << s;
+                                }
+                                if ( iDue )
+                                        m_Due[iThread].push_back( iCell );
+                        }
+                }
+                void Merge()
+                {
+                        for ( size_t i = 0; i < m_Due.size(); i++ )
+                                m_Due[i].clear();
+                }
+        };
+
+        // The first SECTORTHREADS pool. A mutex + condition variable hand off and wait for each colour.
+        class TestColourLockPool
+        {
+        private:
+                std::vector<std::thread> m_Threads;
+                std::mutex m_Lock;
+                std::condition_variable m_Start;
+                std::condition_variable m_Done;
+                bool m_fStop;
+                unsigned int m_uJob;
+                int m_iBusy;
+                CGridJob * m_pJob;
+                const std::vector<int> * m_pCells;
+                std::atomic<int> m_iNext;
+                std::vector<int> m_Colors[ GRID_COLOR_QTY ];
+
+                void DoJob( int iThread )
+                {
+                        int iQty = (int) m_pCells->size();
+                        while ( true )
+                        {
+                                int i = m_iNext.fetch_add( 1 );
+                                if ( i >= iQty )
+                                        break;
+                                m_pJob->OnGridCell( iThread, (*m_pCells)[i] );
+                        }
+                }
+                static void EntryProc( TestColourLockPool * pThis, int iThread )
+                {
+                        unsigned int uJob = 0;
+                        while ( true )
+                        {
+                                {
+                                        std::unique_lock<std::mutex> lock( pThis->m_Lock );
+                                        while ( ! pThis->m_fStop && pThis->m_uJob == uJob )
+                                                pThis->m_Start.wait( lock );
+                                        if ( pThis->m_fStop )
+                                                return;
+                                        uJob = pThis->m_uJob;
+                                }
+                                pThis->DoJob( iThread );
+                                {
+                                        std::lock_guard<std::mutex> lock( pThis->m_Lock );
+                                        if ( ! --pThis->m_iBusy )
+                                                pThis->m_Done.notify_one();
+                                }
+                        }
+                }
+
+        public:
+                explicit TestColourLockPool( int iThreads ) :
+                        m_fStop( false ), m_uJob( 0 ), m_iBusy( 0 ), m_pJob( NULL ), m_pCells( NULL ), m_iNext( 0 )
+                {
+                        for ( int i = 0; i < iThreads; i++ )
+                                m_Threads.push_back( std::thread( EntryProc, this, i + 1 ));
+                }
+                ~TestColourLockPool()
+                {
+                        {
+                                std::lock_guard<std::mutex> lock( m_Lock );
+                                m_fStop = true;
+                        }
+                        m_Start.notify_all();
+                        for ( size_t i = 0; i < m_Threads.size(); i++ )
+                                m_Threads[i].join();
+                }
+                void Run( CGridJob & Job, const int * piCells, int iQty, int iCols )
+                {
+                        for ( int i = 0; i < GRID_COLOR_QTY; i++ )
+                                m_Colors[i].clear();
+                        for ( int i = 0; i < iQty; i++ )
+                        {
+                                int iCell = piCells[i];
+                                m_Colors[(( iCell % iCols ) & 1 ) | ((( iCell / iCols ) & 1 ) << 1 )].push_back( iCell );
+                        }
+                        m_pJob = &Job;
+                        for ( int i = 0; i < GRID_COLOR_QTY; i++ )
+                        {
+                                if ( m_Colors[i].empty())
+                                        continue;
+                                {
+                                        std::lock_guard<std::mutex> lock( m_Lock );
+                                        m_pCells = &m_Colors[i];
+                                        m_iNext = 0;
+                                        m_iBusy = (int) m_Threads.size();
+                                        m_uJob ++;
+                                }
+                                m_Start.notify_all();
+                                DoJob( 0 );
+                                std::unique_lock<std::mutex> lock( m_Lock );
+                                while ( m_iBusy )
+                                        m_Done.wait( lock );
+                        }
+                }
+        };
+
+        template <class TYPE_POOL>
+        double TimePulses( TYPE_POOL & pool, TestRegenJob & job, const std::vector<int> & cells, int iPulses )
+        {
+                auto start = std::chrono::steady_clock::now();
+                for ( int p = 0; p < iPulses; p++ )
+                {
+                        pool.Run( job, &cells[0], (int) cells.size(), sm_iCols );
+                        job.Merge();
+                }
+                return( std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() * 1000.0 / iPulses );
+        }
+}
+
+TEST_CASE( TestGridThreadsNoNeighbours )
+{
+        CheckNeighbourRuns( 0 );
+        CheckNeighbourRuns( 1 );
+        CheckNeighbourRuns( 3 );
+}
+
+TEST_CASE( TestGridThreadsRestart )
+{
+        CGridThreads threads;
+        std::vector<int> cells;
+        for ( int i = 0; i < sm_iCols * sm_iRows; i++ )
+        {
+                cells.push_back( i );
+        }
+        static const int sm_Counts[] = { 2, 4, 0, 1 };
+        for ( int k = 0; k < 4; k++ )
+        {
+                threads.Start( sm_Counts[k] );
+                TestNeighbourJob job( threads.GetThreadCount());
+                threads.Run( job, &cells[0], (int) cells.size(), sm_iCols );
+                for ( int i = 0; i < sm_iCols * sm_iRows; i++ )
+                {
+                        if ( job.m_Visits[i].load() != 1 )
+                        {
+                                throw std::runtime_error( "Cell missed after a thread count change" );
+                        }
+                }
+        }
+        threads.Stop();
+}
+
+TEST_CASE( BenchGridThreads )
+{
+        // Per pulse cost of the two pools against doing it all on the main thread.
+        // Light work = the in-sector part of a pulse today. (regen counters for a few chars)
+        // Heavy work = a crowded shard.
+        std::printf( "  hardware threads: %u\n", std::thread::hardware_concurrency());
+        std::vector<int> cells;
+        for ( int i = 0; i < sm_iCols * sm_iRows; i += 4 )    // the sleepers whose turn it is + the awake ones.
+        {
+                cells.push_back( i );
+        }
+
+        static const int sm_Chars[] = { 4, 200 };
+        for ( int w = 0; w < 2; w++ )
+        {
+                static const int sm_iThreads = 2;
+                TestRegenJob job( sm_Chars[w], sm_iThreads );
+                int iPulses = ( w == 0 ) ? 400 : 40;
+
+                CGridThreads serial;
+                double dSerial = TimePulses( serial, job, cells, iPulses );
+
+                double dLock;
+                {
+                        TestColourLockPool pool( sm_iThreads );
+                        dLock = TimePulses( pool, job, cells, iPulses );
+                }
+
+                CGridThreads grid;
+                grid.Start( sm_iThreads );
+                double dGrid = TimePulses( grid, job, cells, iPulses );
+
+                std::printf( "  %d sectors x %d chars, %d threads: main only %.3f ms, lock per colour %.3f ms, CGridThreads %.3f ms\n",
+                        (int) cells.size(), sm_Chars[w], sm_iThreads, dSerial, dLock, dGrid );
+        }
+}
@@ -0,0 +1,357 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "cnetqueue.h"
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+        std::vector<BYTE> MakeBytes( size_t iLen, unsigned int uSeed )
+        {
+                std::mt19937 rng( uSeed );
+                std::vector<BYTE> data( iLen );
+                for ( size_t i = 0; i < iLen; i++ )
+                {
+                        data[i] = (BYTE) rng();
+                }
+                return data;
+        }
+
+        // Read the whole queue back in odd sized pieces.
+        std::vector<BYTE> ReadAll( CNetSendQueue & queue, int iPiece )
+        {
+                std::vector<BYTE> out;
+                BYTE buf[ 4096 ];
+                while ( true )
+                {
+                        int iRead = queue.Read( buf, iPiece );
+                        if ( ! iRead )
+                                break;
+                        out.insert( out.end(), buf, buf + iRead );
+                }
+                return out;
+        }
+}
+
+TEST_CASE( TestNetSendQueueAppendRead )
+{
+        int iUsedStart = g_NetSegments.GetUsed();
+        std::vector<BYTE> data = MakeBytes( NET_SEGMENT_SIZE * 3 + 123, 1 );
+
+        CNetSendQueue queue;
+        static const int sm_Chunks[] = { 1, 7, 500, NET_SEGMENT_SIZE - 1, 3000 };
+        size_t iPos = 0;
+        for ( int i = 0; iPos < data.size(); i++ )
+        {
+                int iLen = (int) std::min( data.size() - iPos, (size_t) sm_Chunks[ i % 5 ] );
+                queue.Append( &data[iPos], iLen );
+                iPos += iLen;
+        }
+        if ( queue.GetBytes() != (int) data.size())
+        {
+                throw std::runtime_error( "Append byte count wrong" );
+        }
+        if ( g_NetSegments.GetUsed() - iUsedStart != 4 )
+        {
+                throw std::runtime_error( "Append did not fill each segment before taking the next" );
+        }
+
+        std::vector<BYTE> out = ReadAll( queue, 333 );
+        if ( out != data )
+        {
+                throw std::runtime_error( "Read across segments changed the bytes" );
+        }
+        if ( ! queue.IsEmpty() || queue.GetBytes())
+        {
+                throw std::runtime_error( "Queue not empty after reading it all" );
+        }
+        if ( g_NetSegments.GetUsed() != iUsedStart )
+        {
+                throw std::runtime_error( "Read did not give the segments back" );
+        }
+
+        // Usable again after it ran dry.
+        queue.Append( &data[0], 10 );
+        BYTE buf[ 16 ];
+        if ( queue.Read( buf, sizeof(buf)) != 10 || memcmp( buf, &data[0], 10 ))
+        {
+                throw std::runtime_error( "Queue broken after running dry" );
+        }
+}
+
+TEST_CASE( TestNetSendQueueTake )
+{
+        // The same framing as CNetClientQueue::Push() and the CNetThread reading m_Out.
+        int iUsedStart = g_NetSegments.GetUsed();
+        std::vector<BYTE> data = MakeBytes( 20000, 2 );
+
+        CNetSendQueue out;
+        CNetSendQueue pending;
+        std::vector<int> sizes;
+        size_t iPos = 0;
+        for ( int i = 0; iPos < data.size(); i++ )
+        {
+                int iLen = (int) std::min( data.size() - iPos, (size_t)( 1 + ( i * 977 ) % 3000 ));
+                WORD wLen = (WORD) iLen;
+                CNetSendQueue & queue = ( i & 1 ) ? pending : out;
+                queue.Append( (const BYTE *) &wLen, sizeof(wLen));
+                queue.Append( &data[iPos], iLen );
+                if ( i & 1 )
+                {
+                        // Every other block comes from a second queue. Take() it on.
+                        out.Take( pending );
+                }
+                if ( ! pending.IsEmpty() || pending.GetBytes())
+                {
+                        throw std::runtime_error( "Take left bytes behind" );
+                }
+                sizes.push_back( iLen );
+                iPos += iLen;
+        }
+
+        CNetSendQueue work;
+        work.Take( out );
+        if ( ! out.IsEmpty() || work.GetBytes() != (int)( data.size() + sizes.size() * sizeof(WORD)))
+        {
+                throw std::runtime_error( "Take byte count wrong" );
+        }
+
+        std::vector<BYTE> got;
+        for ( size_t i = 0; i < sizes.size(); i++ )
+        {
+                WORD wLen = 0;
+                if ( work.Read( &wLen, sizeof(wLen)) != sizeof(wLen) || wLen != sizes[i] )
+                {
+                        throw std::runtime_error( "Block header lost" );
+                }
+                BYTE buf[ 3000 ];
+                if ( work.Read( buf, wLen ) != wLen )
+                {
+                        throw std::runtime_error( "Block short" );
+                }
+                got.insert( got.end(), buf, buf + wLen );
+        }
+        if ( got != data || ! work.IsEmpty())
+        {
+                throw std::runtime_error( "Take changed the order of the blocks" );
+        }
+        if ( g_NetSegments.GetUsed() != iUsedStart )
+        {
+                throw std::runtime_error( "Take lost segments" );
+        }
+}
+
+TEST_CASE( TestNetBroadcastBits )
+{
+        // Huffman coded once, no end code. Kept alive by its references.
+        std::vector<BYTE> data = MakeBytes( 200, 3 );
+        CNetBroadcast * pPacket = new CNetBroadcast( &data[0], (int) data.size());
+        const BYTE * pBits = pPacket->GetCompressed();
+
+        std::vector<BYTE> bits( data.size() * 2 + 4 );
+        int iBits = CCompressTree::EncodeBits( &bits[0], &data[0], (int) data.size());
+        if ( pPacket->GetCompressedBits() != iBits || memcmp( pBits, &bits[0], ( iBits + 7 ) / 8 ))
+        {
+                throw std::runtime_error( "Broadcast codes differ from EncodeBits()" );
+        }
+        if ( pPacket->GetCompressed() != pBits )
+        {
+                throw std::runtime_error( "Broadcast coded more than once" );
+        }
+
+        pPacket->AddRef();      // a CNetThread has it.
+        pPacket->Release();     // the CNetBroadcastList is done.
+        if ( ! pPacket->IsSame( &data[0], (int) data.size()))
+        {
+                throw std::runtime_error( "Broadcast freed while still referenced" );
+        }
+        pPacket->Release();
+}
+
+TEST_CASE( TestNetRingWrap )
+{
+        CNetRing ring( 10 );
+        if ( ring.GetSize() != 16 )
+        {
+                throw std::runtime_error( "Ring size not rounded up to a power of 2" );
+        }
+
+        std::vector<BYTE> data = MakeBytes( 1000, 4 );
+        size_t iWritten = 0;
+        size_t iRead = 0;
+        std::vector<BYTE> got;
+        for ( int i = 0; iRead < data.size(); i++ )
+        {
+                // Lengths that do not divide the ring, so the copies split at the end.
+                size_t iWant = std::min( data.size() - iWritten, (size_t)( 1 + i % 7 ));
+                size_t iFree = ring.GetFree();
+                size_t iDone = ring.Write( &data[iWritten], iWant );
+                if ( iDone != std::min( iWant, iFree ))
+                {
+                        throw std::runtime_error( "Write did not stop at full" );
+                }
+                iWritten += iDone;
+
+                BYTE buf[ 16 ];
+                size_t iGot = ring.Read( buf, 1 + i % 5 );
+                got.insert( got.end(), buf, buf + iGot );
+                iRead += iGot;
+                if ( ring.GetUsed() != iWritten - iRead )
+                {
+                        throw std::runtime_error( "Ring used count wrong" );
+                }
+        }
+        if ( got != data )
+        {
+                throw std::runtime_error( "Ring wrap changed the bytes" );
+        }
+}
+
+TEST_CASE( TestNetRingThreads )
+{
+        // One writer thread, one reader. (a CNetThread and the main loop)
+        CNetRing ring( 256 );
+        std::vector<BYTE> data = MakeBytes( 1 << 20, 5 );
+
+        std::thread writer( [&ring, &data]()
+        {
+                size_t iPos = 0;
+                for ( int i = 0; iPos < data.size(); i++ )
+                {
+                        size_t iLen = std::min( data.size() - iPos, (size_t)( 1 + ( i * 37 ) % 300 ));
+                        size_t iDone = ring.Write( &data[iPos], iLen );
+                        iPos += iDone;
+                        if ( ! iDone )
+                                std::this_thread::yield();
+                }
+        });
+
+        std::vector<BYTE> got;
+        got.reserve( data.size());
+        for ( int i = 0; got.size() < data.size(); i++ )
+        {
+                BYTE buf[ 300 ];
+                size_t iGot = ring.Read( buf, 1 + ( i * 53 ) % 300 );
+                got.insert( got.end(), buf, buf + iGot );
+                if ( ! iGot )
+                        std::this_thread::yield();
+        }
+        writer.join();
+        if ( got != data || ring.GetUsed())
+        {
+                throw std::runtime_error( "Bytes lost or reordered between threads" );
+        }
+}
+
+namespace
+{
+        // Put up to iLen bytes of the stream in the buffer. the way CClient::xRecvData() does.
+        size_t FillRecvBuf( CNetRecvBuf & buf, const std::vector<BYTE> & data, size_t iPos, size_t iLen )
+        {
+                size_t iDone = 0;
+                while ( iDone < iLen )
+                {
+                        int iRoom;
+                        BYTE * pTail = buf.GetTail( iRoom );
+                        if ( iRoom <= 0 )
+                                break;
+                        int iCopy = (int) std::min( iLen - iDone, (size_t) iRoom );
+                        memcpy( pTail, &data[ iPos + iDone ], iCopy );
+                        buf.AddTail( iCopy );
+                        iDone += iCopy;
+                }
+                return iDone;
+        }
+}
+
+TEST_CASE( TestNetRecvBufWrapCopy )
+{
+        // Packets that straddle the end of the buffer must come out whole at GetHead().
+        static const int sm_iSize = 64;
+        static const int sm_iPacketMax = 40;
+        CNetRecvBuf buf( sm_iSize, sm_iSize, sm_iPacketMax );
+        std::vector<BYTE> data = MakeBytes( 20000, 6 );
+
+        // One that surely wraps. 50 to 74 = 14 at the end + 10 from the front.
+        FillRecvBuf( buf, data, 0, 60 );
+        buf.Skip( 50 );
+        if ( FillRecvBuf( buf, data, 60, 20 ) != 20 || buf.IsWhole( 31 ))
+        {
+                throw std::runtime_error( "Wrong length after the wrap" );
+        }
+        if ( ! buf.IsWhole( 24 ) || memcmp( buf.GetHead(), &data[50], 24 ))
+        {
+                throw std::runtime_error( "Wrapped packet not copied whole" );
+        }
+        buf.Skip( 30 );
+
+        std::mt19937 rng( 7 );
+        size_t iWritten = 0;
+        size_t iRead = 0;
+        while ( iRead < data.size())
+        {
+                iWritten += FillRecvBuf( buf, data, iWritten, std::min( data.size() - iWritten, (size_t)( 1 + rng() % 50 )));
+                while ( iRead < data.size())
+                {
+                        int iLen = (int) std::min( data.size() - iRead, (size_t)( 1 + rng() % sm_iPacketMax ));
+                        if ( ! buf.IsWhole( iLen ))
+                                break;
+                        if ( memcmp( buf.GetHead(), &data[iRead], iLen ))
+                        {
+                                throw std::runtime_error( "Packet at GetHead() not whole" );
+                        }
+                        buf.Skip( iLen );
+                        iRead += iLen;
+                }
+        }
+        if ( buf.GetLength() || buf.GetSize() != sm_iSize )
+        {
+                throw std::runtime_error( "Buffer not empty at the end or it grew past its max" );
+        }
+}
+
+TEST_CASE( TestNetRecvBufGrow )
+{
+        // Starts small. doubles when a read finds it full. keeps the bytes and the order.
+        CNetRecvBuf buf( 16, 256, 40 );
+        std::vector<BYTE> data = MakeBytes( 1000, 8 );
+        FillRecvBuf( buf, data, 0, 12 );
+        buf.Skip( 10 );         // so the data wraps when it fills.
+        size_t iWritten = 12 + FillRecvBuf( buf, data, 12, 14 );
+        if ( buf.GetSize() != 16 || buf.GetLength() != 16 )
+        {
+                throw std::runtime_error( "Grew before it was full" );
+        }
+        iWritten += FillRecvBuf( buf, data, iWritten, data.size() - iWritten );
+        if ( buf.GetSize() != 256 || buf.GetLength() != 256 || buf.GetFree())
+        {
+                throw std::runtime_error( "Did not grow to the max and stop" );
+        }
+        int iRoom;
+        buf.GetTail( iRoom );
+        if ( iRoom )
+        {
+                throw std::runtime_error( "Room past the max" );
+        }
+
+        size_t iRead = 10;
+        while ( buf.GetLength())
+        {
+                int iLen = std::min( buf.GetLength(), 37 );
+                if ( ! buf.IsWhole( iLen ) || memcmp( buf.GetHead(), &data[iRead], iLen ))
+                {
+                        throw std::runtime_error( "Grow lost or moved the bytes" );
+                }
+                buf.Skip( iLen );
+                iRead += iLen;
+        }
+        if ( iRead != iWritten )
+        {
+                throw std::runtime_error( "Grow byte count wrong" );
+        }
+}
@@ -0,0 +1,207 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+        const char * WriteTestScript( const std::string & text )
+        {
+                static const char * sm_pszName = "script_image_test.scp";
+                FILE * pFile = std::fopen( sm_pszName, "wb" );
+                if ( pFile == NULL )
+                {
+                        throw std::runtime_error( "Can't write the test script" );
+                }
+                std::fwrite( text.data(), 1, text.size(), pFile );
+                std::fclose( pFile );
+                return( sm_pszName );
+        }
+
+        void OpenScript( CScript & s, const char * pszName, bool fImage )
+        {
+                if ( ! s.Open( pszName, OF_READ | OF_TEXT ))
+                {
+                        throw std::runtime_error( "Can't open the test script" );
+                }
+                if ( fImage && ! s.LoadImage())
+                {
+                        throw std::runtime_error( "Can't load the script image" );
+                }
+        }
+
+        std::string ReadSection( CScript & s, const char * pszSection )
+        {
+                std::string sKeys;
+                if ( ! s.FindSection( pszSection, OF_NONCRIT ))
+                        return( sKeys );
+                while ( s.ReadKeyParse())
+                {
+                        sKeys += std::string( s.GetKey()) + "=" + s.GetArgStr() + ";";
+                }
+                return( sKeys );
+        }
+}
+
+TEST_CASE( TestScriptImageMatchesFile )
+{
+        // BOM, CR LF, blank lines, a line longer than a read, no newline at the end.
+        std::string text = "\xEF\xBB\xBF[FIRST]\r\nA=1\r\n\r\nB=two // comment\n[SECOND]\nLONG=";
+        text.append( MAX_SCRIPT_LINE_LEN + 100, 'x' );
+        text += "\n\n\n[THIRD]\nC=3";
+        const char * pszName = WriteTestScript( text );
+
+        CScript sFile;
+        OpenScript( sFile, pszName, false );
+        CScript sImage;
+        OpenScript( sImage, pszName, true );
+        if ( sFile.IsImage() || ! sImage.IsImage() || ! sImage.IsFileOpen())
+        {
+                throw std::runtime_error( "Wrong script modes" );
+        }
+
+        // Line by line, the same text and places.
+        for ( int iPass = 0; iPass < 2; iPass++ )
+        {
+                sFile.SeekLine( 0, 0 );
+                sImage.SeekLine( 0, 0 );
+                while ( true )
+                {
+                        bool fFile = sFile.ReadTextLine( iPass != 0 );
+                        bool fImage = sImage.ReadTextLine( iPass != 0 );
+                        if ( fFile != fImage )
+                        {
+                                throw std::runtime_error( "Image ended at a different place" );
+                        }
+                        if ( ! fFile )
+                                break;
+                        if ( std::string( sFile.GetKey()) != sImage.GetKey() ||
+                                sFile.GetPosition() != sImage.GetPosition() ||
+                                sFile.GetLineNumber() != sImage.GetLineNumber())
+                        {
+                                throw std::runtime_error( "Image read a different line" );
+                        }
+                }
+        }
+
+        static const char * sm_Sections[] = { "FIRST", "SECOND", "THIRD", "MISSING" };
+        for ( size_t i = 0; i < COUNTOF( sm_Sections ); i++ )
+        {
+                if ( ReadSection( sFile, sm_Sections[i] ) != ReadSection( sImage, sm_Sections[i] ))
+                {
+                        throw std::runtime_error( "Image read a section differently" );
+                }
+        }
+        std::remove( pszName );
+}
+
+TEST_CASE( TestScriptImageCopiesAndReload )
+{
+        const char * pszName = WriteTestScript( "[A]\nK=old\n[B]\nK=b\n" );
+        CScript sBase;
+        OpenScript( sBase, pszName, true );
+        if ( ! sBase.FindSection( "B", OF_NONCRIT ))
+        {
+                throw std::runtime_error( "No section B" );
+        }
+        DWORD dwPos = sBase.GetPosition();
+
+        CScriptIndex index;
+        {
+                CScriptLock sIndex;
+                if ( ! sIndex.OpenCopy( sBase ) || ! index.Build( sIndex ))
+                {
+                        throw std::runtime_error( "Index build failed" );
+                }
+        }
+
+        // A copy has its own place. Its reads do not move the base.
+        CScriptLock sCopy;
+        if ( ! sCopy.OpenCopy( sBase ) || ! sCopy.IsImage() || sCopy.GetImage() != sBase.GetImage())
+        {
+                throw std::runtime_error( "Copy does not share the image" );
+        }
+        if ( ReadSection( sCopy, "A" ) != "K=old;" || sBase.GetPosition() != dwPos )
+        {
+                throw std::runtime_error( "Copy read moved the base" );
+        }
+
+        // Change the file. The image (and so the index) is what we read before.
+        WriteTestScript( "[A]\nK=new one\n[B]\nK=b\n" );
+        if ( index.IsChanged( sBase ))
+        {
+                throw std::runtime_error( "Index should follow the image, not the file" );
+        }
+
+        // Reload. The base gets the new image. The open copy keeps the old one.
+        const CScriptImage * pOld = sBase.GetImage();
+        if ( ! sBase.LoadImage() || sBase.GetImage() == pOld )
+        {
+                throw std::runtime_error( "Reload did not swap the image" );
+        }
+        if ( ReadSection( sBase, "A" ) != "K=new one;" )
+        {
+                throw std::runtime_error( "Base still reads the old image" );
+        }
+        if ( sCopy.GetImage() != pOld || ReadSection( sCopy, "A" ) != "K=old;" )
+        {
+                throw std::runtime_error( "Copy lost its image" );
+        }
+        if ( ! index.IsChanged( sBase ))
+        {
+                throw std::runtime_error( "Index missed the new image" );
+        }
+        sCopy.Close();
+        std::remove( pszName );
+}
+
+TEST_CASE( BenchScriptImage )
+{
+        // Lots of short script runs. Open a copy, go to the section, read it.
+        static const int sm_iSections = 200;
+        static const int sm_iRuns = 20000;
+        std::string text;
+        for ( int i = 0; i < sm_iSections; i++ )
+        {
+                text += "[" + std::to_string( i ) + "]\n";
+                for ( int j = 0; j < 8; j++ )
+                        text += "KEY" + std::to_string( j ) + "=some value here\n";
+        }
+        const char * pszName = WriteTestScript( text );
+
+        double dTimes[2];
+        size_t iRead[2] = { 0, 0 };
+        for ( int iMode = 0; iMode < 2; iMode++ )
+        {
+                CScript sBase;
+                OpenScript( sBase, pszName, iMode != 0 );
+                CScriptIndex index;
+                {
+                        CScriptLock s;
+                        if ( ! s.OpenCopy( sBase ) || ! index.Build( s ))
+                                throw std::runtime_error( "Index build failed" );
+                }
+                sBase.SetIndex( &index );
+
+                auto start = std::chrono::steady_clock::now();
+                for ( int i = 0; i < sm_iRuns; i++ )
+                {
+                        CScriptLock s;
+                        if ( ! s.OpenCopy( sBase ))
+                                throw std::runtime_error( "Open copy failed" );
+                        iRead[iMode] += ReadSection( s, std::to_string( ( i * 7 ) % sm_iSections ).c_str()).size();
+                }
+                dTimes[iMode] = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        std::printf( "  %d script reads: file %.2f ms, image %.2f ms\n", sm_iRuns, dTimes[0] * 1000.0, dTimes[1] * 1000.0 );
+        std::remove( pszName );
+        if ( iRead[0] != iRead[1] )
+        {
+                throw std::runtime_error( "File and image read different things" );
+        }
+}
@@ -0,0 +1,194 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        const char * WriteTestScript( const std::string & text )
+        {
+                static const char * sm_pszName = "script_index_test.scp";
+                FILE * pFile = std::fopen( sm_pszName, "wb" );
+                if ( pFile == NULL )
+                {
+                        throw std::runtime_error( "Can't write the test script" );
+                }
+                std::fwrite( text.data(), 1, text.size(), pFile );
+                std::fclose( pFile );
+                return( sm_pszName );
+        }
+
+        void OpenScript( CScript & s, const char * pszName )
+        {
+                if ( ! s.Open( pszName, OF_READ | OF_TEXT ))
+                {
+                        throw std::runtime_error( "Can't open the test script" );
+                }
+        }
+
+        void BuildIndex( CScriptIndex & index, const char * pszName )
+        {
+                CScript s;
+                OpenScript( s, pszName );
+                if ( ! index.Build( s ))
+                {
+                        throw std::runtime_error( "Index build failed" );
+                }
+        }
+}
+
+TEST_CASE( TestScriptIndexMatchesScan )
+{
+        // Duplicates, odd case, junk after the ], comments, blank lines, and stuff after [EOF].
+        std::mt19937 rng( 23 );
+        std::string text = "// header comment\n\n";
+        std::vector<std::string> names;
+        for ( int i = 0; i < 300; i++ )
+        {
+                char szName[ 32 ];
+                std::snprintf( szName, sizeof(szName), ( i & 1 ) ? "%04X" : "events e_%x", (unsigned) ( rng() % 200 ));
+                names.push_back( szName );
+                text += "[" + std::string( szName ) + "]";
+                if ( i % 7 == 0 )
+                        text += " // trailing";
+                if ( i % 11 == 0 )
+                        text += "extra]";
+                text += "\nNAME=x\n";
+                if ( i % 3 == 0 )
+                        text += "\n\n";
+        }
+        text += "[Tail Part]\nA=1\n[EOF]\n[AFTER EOF]\nB=2\n";
+        names.push_back( "TAIL PART" );
+        names.push_back( "after eof" );
+        names.push_back( "EOF" );
+        names.push_back( "missing" );
+        names.push_back( "0001]extra" );
+        const char * pszName = WriteTestScript( text );
+
+        CScriptIndex index;
+        BuildIndex( index, pszName );
+
+        CScript sIndex;
+        OpenScript( sIndex, pszName );
+        sIndex.SetIndex( &index );
+        if ( index.IsChanged( sIndex ))
+        {
+                throw std::runtime_error( "Index thinks the file changed" );
+        }
+        CScript sScan;
+        OpenScript( sScan, pszName );
+
+        for ( size_t i = 0; i < names.size(); i++ )
+        {
+                // Find all of them, each from the last one.
+                CScriptLink prevIndex;
+                CScriptLink prevScan;
+                for ( int iPass = 0; iPass < 4; iPass++ )
+                {
+                        sScan.SeekLine( 0, 0 );
+                        bool fIndex = sIndex.FindSection( names[i].c_str(), OF_NONCRIT, iPass ? &prevIndex : NULL );
+                        bool fScan = sScan.FindSection( names[i].c_str(), OF_NONCRIT, iPass ? &prevScan : NULL );
+                        if ( fIndex != fScan )
+                        {
+                                throw std::runtime_error( "Index and scan disagree on '" + names[i] + "'" );
+                        }
+                        if ( ! fScan )
+                                break;
+                        if ( sIndex.GetPosition() != sScan.GetPosition() ||
+                                sIndex.GetLineNumber() != sScan.GetLineNumber())
+                        {
+                                throw std::runtime_error( "Index and scan found different '" + names[i] + "'" );
+                        }
+                        prevIndex.SetLink( &sIndex, sIndex );
+                        prevScan.SetLink( &sScan, sScan );
+                }
+        }
+        if ( index.m_dwLookups == 0 || index.m_dwHits == 0 || index.m_dwMisses == 0 )
+        {
+                throw std::runtime_error( "Index stats did not count" );
+        }
+
+        // Copies of the file use the same index.
+        {
+                CScriptLock sCopy;
+                if ( ! sCopy.OpenCopy( sIndex ) || sCopy.GetIndex() != &index )
+                {
+                        throw std::runtime_error( "A copy lost the index" );
+                }
+                DWORD dwLookups = index.m_dwLookups;
+                if ( ! sCopy.FindSection( "TAIL PART", OF_NONCRIT ) || index.m_dwLookups != dwLookups + 1 )
+                {
+                        throw std::runtime_error( "A copy did not look in the index" );
+                }
+        }
+
+        // Change the file. The index knows.
+        text.insert( 0, "[NEW ONE]\n" );
+        WriteTestScript( text );
+        if ( ! index.IsChanged( sIndex ))
+        {
+                throw std::runtime_error( "Index missed the change" );
+        }
+        std::remove( pszName );
+}
+
+TEST_CASE( BenchScriptIndex )
+{
+        static const int sm_iSections = 4000;
+        static const int sm_iLookups = 2000;
+        std::string text;
+        for ( int i = 0; i < sm_iSections; i++ )
+        {
+                text += "[" + std::to_string( i ) + "]\n";
+                for ( int j = 0; j < 6; j++ )
+                        text += "KEY" + std::to_string( j ) + "=some value here\n";
+        }
+        const char * pszName = WriteTestScript( text );
+
+        CScriptIndex index;
+        auto start = std::chrono::steady_clock::now();
+        BuildIndex( index, pszName );
+        double dBuild = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::mt19937 rng( 3 );
+        std::vector<std::string> names;
+        for ( int i = 0; i < sm_iLookups; i++ )
+        {
+                names.push_back( std::to_string( rng() % sm_iSections ));
+        }
+
+        CScript s;
+        OpenScript( s, pszName );
+        long lScan = 0;
+        start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < names.size(); i++ )
+        {
+                if ( s.FindSection( names[i].c_str(), OF_NONCRIT ))
+                        lScan += s.GetPosition();
+        }
+        double dScan = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        s.SetIndex( &index );
+        long lIndex = 0;
+        start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < names.size(); i++ )
+        {
+                if ( s.FindSection( names[i].c_str(), OF_NONCRIT ))
+                        lIndex += s.GetPosition();
+        }
+        double dIndex = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::printf( "  %d sections, %d lookups: scan %.2f ms, index %.2f ms (build %.2f ms)\n",
+                sm_iSections, sm_iLookups, dScan * 1000.0, dIndex * 1000.0, dBuild * 1000.0 );
+        std::remove( pszName );
+        if ( lScan != lIndex )
+        {
+                throw std::runtime_error( "Scan and index found different sections" );
+        }
+}
@@ -0,0 +1,250 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "cmemoryscriptstream.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        // Writes down every verb it is asked to do. <V> is a value the script can SET.
+        class TestScriptObj : public CScriptObj
+        {
+        public:
+                std::vector<std::string> m_Log;
+                int m_iVal;
+
+                TestScriptObj() : m_iVal( 0 )
+                {
+                }
+                virtual const TCHAR * GetName() const
+                {
+                        return( "test" );
+                }
+                virtual bool r_WriteVal( const TCHAR * pszKey, CGString & sVal, CTextConsole * )
+                {
+                        if ( strcmpi( pszKey, "V" ))
+                                return( false );
+                        sVal.FormatVal( m_iVal );
+                        return( true );
+                }
+                virtual bool r_Verb( CScript & s, CTextConsole * )
+                {
+                        m_Log.push_back( std::string( s.GetKey()) + "=" + s.GetArgStr());
+                        if ( s.IsKey( "SET" ))
+                        {
+                                m_iVal = s.GetArgVal();
+                        }
+                        return( true );
+                }
+
+                int RunText( const std::string & text, const char * pszTrigName, int iVal )
+                {
+                        m_Log.clear();
+                        m_iVal = iVal;
+                        CMemoryScriptStream stream{ text };
+                        CScript s( &stream );
+                        if ( ! s.FindNextSection())
+                                throw std::runtime_error( "No section" );
+                        return( OnTriggerScript( s, pszTrigName, NULL ));
+                }
+                int RunCompiled( const CScriptCompiled & prog, const char * pszTrigName, int iVal )
+                {
+                        m_Log.clear();
+                        m_iVal = iVal;
+                        return( OnTriggerScript( &prog, pszTrigName, NULL ));
+                }
+        };
+
+        void Compile( CScriptCompiled & prog, const std::string & text )
+        {
+                CMemoryScriptStream stream{ text };
+                CScript s( &stream );
+                if ( ! s.FindNextSection())
+                        throw std::runtime_error( "No section" );
+                prog.Compile( s );
+        }
+
+        void CheckSame( const std::string & text, const char * pszTrigName, int iVal )
+        {
+                CScriptCompiled prog;
+                Compile( prog, text );
+
+                TestScriptObj objText;
+                TestScriptObj objProg;
+                int iRetText = objText.RunText( text, pszTrigName, iVal );
+                int iRetProg = objProg.RunCompiled( prog, pszTrigName, iVal );
+                if ( iRetText != iRetProg || objText.m_Log != objProg.m_Log )
+                {
+                        throw std::runtime_error( std::string( "Compiled trigger ran differently for " ) +
+                                pszTrigName + " in:\n" + text );
+                }
+        }
+
+        const char sm_szEvents[] =
+                "[EVENTS e_test]\n"
+                "NAME=not a trigger\n"
+                "ON=@A\n"
+                "SAY=start\n"
+                "IF <V>\n"
+                "  SAY=v is set\n"
+                "  IF 0\n"
+                "    SAY=never\n"
+                "    IF 1\n"
+                "      SAY=never either\n"
+                "    ENDIF\n"
+                "  ELIF <V>\n"
+                "    SAY=elif <V>\n"
+                "  ELSE\n"
+                "    SAY=else\n"
+                "  ENDIF\n"
+                "ELSEIF 1\n"
+                "  SAY=second\n"
+                "ELSE\n"
+                "  SAY=third\n"
+                "ENDIF\n"
+                "BEGIN\n"
+                "SAY=begin is just a verb here\n"
+                "END\n"
+                "SET=0\n"
+                "RETURN <V>\n"
+                "ON=@B\n"
+                "IF 0\n"
+                "  SAY=no\n"
+                "  BEGIN\n"
+                "  ENDIF\n"
+                "ENDIF\n"
+                "SAY=b\n"
+                "on=@c\n"
+                "SAY=c\n"
+                "IF 1\n"
+                "  RETURN 1\n"
+                "ENDIF\n"
+                "[EVENTS e_next]\n"
+                "ON=@D\n"
+                "SAY=not in this section\n";
+}
+
+TEST_CASE( TestCompiledTriggersMatchText )
+{
+        static const char * sm_Trigs[] = { "@A", "@B", "@C", "@D", "@Missing" };
+        for ( size_t i = 0; i < COUNTOF( sm_Trigs ); i++ )
+        {
+                for ( int iVal = 0; iVal < 3; iVal++ )
+                {
+                        CheckSame( sm_szEvents, sm_Trigs[i], iVal );
+                }
+        }
+
+        CScriptCompiled prog;
+        Compile( prog, sm_szEvents );
+        if ( prog.FindTrigger( "@C" ) < 0 || prog.FindTrigger( "@D" ) >= 0 )
+        {
+                throw std::runtime_error( "Compiled the wrong lines" );
+        }
+
+        // Random, often badly nested, scripts. The quirks must match too.
+        static const char * sm_Lines[] =
+        {
+                "IF <V>", "IF 0", "IF 1", "ELIF <V>", "ELIF 0", "ELSEIF 1", "ELSE", "ENDIF", "END", "ENDFOR",
+                "BEGIN", "RETURN 0", "RETURN 1", "SAY=x", "SAY=<V>", "SET=0", "SET=1", "ON=@T1", "ON=@T2",
+                "DORAND 2", "ENDDO",
+        };
+        std::mt19937 rng( 21 );
+        for ( int iScript = 0; iScript < 3000; iScript++ )
+        {
+                std::string text = "[EVENTS e_random]\nON=@T1\n";
+                int iLines = 1 + rng() % 40;
+                for ( int i = 0; i < iLines; i++ )
+                {
+                        text += sm_Lines[ rng() % COUNTOF( sm_Lines ) ];
+                        text += "\n";
+                }
+                CheckSame( text, "@T1", rng() % 2 );
+                CheckSame( text, "@T2", rng() % 2 );
+        }
+}
+
+TEST_CASE( TestCompiledTriggerMask )
+{
+        static const TCHAR * sm_Names[] = { "@A", "@Missing", "@C", "@D", "@B" };
+        CScriptCompiled prog;
+        Compile( prog, sm_szEvents );
+        if ( prog.GetTrigMask( sm_Names, COUNTOF( sm_Names )) != 0x15 )
+        {
+                throw std::runtime_error( "Wrong trigger mask" );
+        }
+
+        // Through a link. The cache shares it and a Clear() makes the link forget it.
+        CMemoryScriptStream stream{ std::string( sm_szEvents ) };
+        CScript s( &stream );
+        if ( ! s.FindNextSection())
+                throw std::runtime_error( "No section" );
+        CScriptLink link;
+        link.SetLink( &s, s );
+        if ( link.GetCompiled() != NULL || link.GetTrigMask( sm_Names, COUNTOF( sm_Names )) != 0 )
+        {
+                throw std::runtime_error( "Link has a mask before it was compiled" );
+        }
+        const CScriptCompiled * pProg = link.Compile( s );
+        if ( pProg == NULL || link.GetCompiled() != pProg ||
+                link.GetTrigMask( sm_Names, COUNTOF( sm_Names )) != 0x15 )
+        {
+                throw std::runtime_error( "Link lost its compiled section" );
+        }
+        g_ScriptCompiled.Clear();
+        if ( link.GetCompiled() != NULL || link.GetTrigMask( sm_Names, COUNTOF( sm_Names )) != 0 )
+        {
+                throw std::runtime_error( "Link kept a cleared section" );
+        }
+}
+
+TEST_CASE( BenchCompiledTriggers )
+{
+        static const int sm_iRuns = 20000;
+        std::string text = "[EVENTS e_bench]\n";
+        for ( int t = 0; t < 8; t++ )
+        {
+                text += "ON=@Other" + std::to_string( t ) + "\n";
+                for ( int i = 0; i < 20; i++ )
+                        text += "SAY=other trigger line " + std::to_string( i ) + "\n";
+        }
+        text += "ON=@Timer\n";
+        for ( int i = 0; i < 10; i++ )
+        {
+                text += "IF <V>\n  SAY=yes " + std::to_string( i ) + "\n  IF 0\n    SAY=never\n  ENDIF\n"
+                        "ELSE\n  SAY=no\n  SAY=no again\nENDIF\n";
+        }
+
+        TestScriptObj obj;
+        auto start = std::chrono::steady_clock::now();
+        size_t iTextVerbs = 0;
+        for ( int i = 0; i < sm_iRuns; i++ )
+        {
+                obj.RunText( text, "@Timer", i & 1 );
+                iTextVerbs += obj.m_Log.size();
+        }
+        double dText = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        CScriptCompiled prog;
+        Compile( prog, text );
+        start = std::chrono::steady_clock::now();
+        size_t iProgVerbs = 0;
+        for ( int i = 0; i < sm_iRuns; i++ )
+        {
+                obj.RunCompiled( prog, "@Timer", i & 1 );
+                iProgVerbs += obj.m_Log.size();
+        }
+        double dProg = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::printf( "  %d trigger runs: text %.2f ms, compiled %.2f ms\n", sm_iRuns, dText * 1000.0, dProg * 1000.0 );
+        if ( iTextVerbs != iProgVerbs )
+        {
+                throw std::runtime_error( "Text and compiled runs did different things" );
+        }
+}
@@ -0,0 +1,263 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "cspatial.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+        struct TestPoint
+        {
+                short m_x;
+                short m_y;
+                signed char m_z;
+        };
+
+        // The old way. Objects scattered on the heap, in a linked list, with a virtual point.
+        class TestObjBase
+        {
+        public:
+                TestObjBase * m_pNext;
+                TestPoint m_p;
+                char m_Pad[ 200 ];      // about the size of a CItem.
+
+                TestObjBase()
+                {
+                        m_pNext = NULL;
+                        m_Pad[0] = 0;
+                }
+                virtual ~TestObjBase()
+                {
+                }
+                virtual const TestPoint & GetTopPoint() const
+                {
+                        return( m_p );
+                }
+        };
+
+        // The new way. Same objects, also in a CSpatialArray.
+        class TestObj : public TestObjBase, public CSpatialRec
+        {
+        };
+
+        int GetDist( const TestPoint & a, const TestPoint & b )
+        {
+                return( std::max( std::abs( a.m_x - b.m_x ), std::abs( a.m_y - b.m_y )));
+        }
+}
+
+TEST_CASE( TestSpatialFindPrevMatchesScan )
+{
+        std::mt19937 rng( 5 );
+        std::vector<TestObj> objs( 1000 );     // outlive the array.
+        CSpatialArray array;
+
+        for ( size_t i = 0; i < objs.size(); i++ )
+        {
+                objs[i].m_p.m_x = (short)( 1000 + rng() % 64 );
+                objs[i].m_p.m_y = (short)( 2000 + rng() % 64 );
+                objs[i].m_p.m_z = (signed char)( rng() % 100 );
+                array.Add( &objs[i], objs[i].m_p.m_x, objs[i].m_p.m_y, objs[i].m_p.m_z );
+        }
+
+        // Move some around. (SpatialMove keeps the array right)
+        for ( size_t i = 0; i < objs.size(); i += 3 )
+        {
+                objs[i].m_p.m_x = (short)( 990 + rng() % 84 );
+                objs[i].SpatialMove( objs[i].m_p.m_x, objs[i].m_p.m_y, objs[i].m_p.m_z );
+        }
+
+        for ( int iQuery = 0; iQuery < 500; iQuery++ )
+        {
+                TestPoint pt;
+                pt.m_x = (short)( 980 + rng() % 100 );
+                pt.m_y = (short)( 1990 + rng() % 90 );
+                pt.m_z = 0;
+                static const int sm_Dists[] = { 0, 1, 5, 18, 31, 0xFFFF, -1 };
+                int iDist = sm_Dists[ iQuery % 7 ];
+
+                std::vector<CSpatialRec *> expect;
+                for ( int i = array.GetCount() - 1; i >= 0; i-- )
+                {
+                        TestObj * pObj = static_cast<TestObj *>( array.GetAt( i ));
+                        if ( GetDist( pt, pObj->m_p ) <= iDist )
+                        {
+                                expect.push_back( pObj );
+                        }
+                }
+
+                std::vector<CSpatialRec *> found;
+                int i = array.GetCount();
+                while (( i = array.FindPrev( i, pt.m_x, pt.m_y, iDist )) >= 0 )
+                {
+                        found.push_back( array.GetAt( i ));
+                }
+                if ( found != expect )
+                {
+                        throw std::runtime_error( "FindPrev does not match a plain scan" );
+                }
+        }
+
+        // Removing what we just found does not skip any.
+        TestPoint pt;
+        pt.m_x = 1032;
+        pt.m_y = 2032;
+        int iExpect = 0;
+        for ( int i = 0; i < array.GetCount(); i++ )
+        {
+                TestObj * pObj = static_cast<TestObj *>( array.GetAt( i ));
+                if ( GetDist( pt, pObj->m_p ) <= 10 )
+                        iExpect++;
+        }
+        int iRemoved = 0;
+        int i = array.GetCount();
+        while (( i = array.FindPrev( i, pt.m_x, pt.m_y, 10 )) >= 0 )
+        {
+                array.Remove( array.GetAt( i ));
+                iRemoved++;
+        }
+        if ( iRemoved != iExpect || array.FindPrev( array.GetCount(), pt.m_x, pt.m_y, 10 ) >= 0 )
+        {
+                throw std::runtime_error( "Removing while searching lost some" );
+        }
+}
+
+TEST_CASE( TestSpatialFindPrevNewMatchesScan )
+{
+        // What comes into view walking from one point to the next. (CClient::addPlayerSee)
+        std::mt19937 rng( 11 );
+        std::vector<TestObj> objs( 2000 );
+        CSpatialArray array;
+
+        for ( size_t i = 0; i < objs.size(); i++ )
+        {
+                objs[i].m_p.m_x = (short)( 1000 + rng() % 128 );
+                objs[i].m_p.m_y = (short)( 2000 + rng() % 128 );
+                objs[i].m_p.m_z = 0;
+                array.Add( &objs[i], objs[i].m_p.m_x, objs[i].m_p.m_y, objs[i].m_p.m_z );
+        }
+
+        for ( int iQuery = 0; iQuery < 500; iQuery++ )
+        {
+                TestPoint ptOld;
+                ptOld.m_x = (short)( 1020 + rng() % 88 );
+                ptOld.m_y = (short)( 2020 + rng() % 88 );
+                ptOld.m_z = 0;
+                TestPoint pt = ptOld;
+                if ( iQuery % 5 == 4 )
+                {
+                        pt.m_x = (short)( pt.m_x + (int)( rng() % 41 ) - 20 );     // a teleport.
+                        pt.m_y = (short)( pt.m_y + (int)( rng() % 41 ) - 20 );
+                }
+                else
+                {
+                        pt.m_x = (short)( pt.m_x + (int)( rng() % 3 ) - 1 );       // a step.
+                        pt.m_y = (short)( pt.m_y + (int)( rng() % 3 ) - 1 );
+                }
+                int iDist = ( iQuery & 1 ) ? 18 : 31;
+
+                std::vector<CSpatialRec *> expect;
+                for ( int i = array.GetCount() - 1; i >= 0; i-- )
+                {
+                        TestObj * pObj = static_cast<TestObj *>( array.GetAt( i ));
+                        if ( GetDist( pt, pObj->m_p ) <= iDist && GetDist( ptOld, pObj->m_p ) > iDist )
+                        {
+                                expect.push_back( pObj );
+                        }
+                }
+
+                std::vector<CSpatialRec *> found;
+                int i = array.GetCount();
+                while (( i = array.FindPrevNew( i, pt.m_x, pt.m_y, iDist, ptOld.m_x, ptOld.m_y )) >= 0 )
+                {
+                        found.push_back( array.GetAt( i ));
+                }
+                if ( found != expect )
+                {
+                        throw std::runtime_error( "FindPrevNew does not match a plain scan" );
+                }
+        }
+}
+
+TEST_CASE( BenchSpatialSearch )
+{
+        // A dense sector. Lots of stuff on the ground, a view range search from each spot.
+        static const int sm_iObjs = 20000;
+        std::mt19937 rng( 17 );
+        std::vector<std::unique_ptr<TestObj>> objs;
+        CSpatialArray array;
+        TestObjBase * pHead = NULL;
+
+        for ( int i = 0; i < sm_iObjs; i++ )
+        {
+                objs.push_back( std::unique_ptr<TestObj>( new TestObj ));
+                // Scatter them on the heap like a long running server does.
+                if ( i % 3 == 0 )
+                {
+                        char * pJunk = new char[ 64 + rng() % 512 ];
+                        delete [] pJunk;
+                }
+        }
+        std::shuffle( objs.begin(), objs.end(), rng );
+        for ( int i = 0; i < sm_iObjs; i++ )
+        {
+                TestObj * pObj = objs[i].get();
+                pObj->m_p.m_x = (short)( 1024 + rng() % 64 );
+                pObj->m_p.m_y = (short)( 1024 + rng() % 64 );
+                pObj->m_p.m_z = 0;
+                pObj->m_pNext = pHead;
+                pHead = pObj;
+                array.Add( pObj, pObj->m_p.m_x, pObj->m_p.m_y, pObj->m_p.m_z );
+        }
+
+        static const int sm_iQueries = 2000;
+        std::vector<TestPoint> queries( sm_iQueries );
+        for ( int i = 0; i < sm_iQueries; i++ )
+        {
+                queries[i].m_x = (short)( 1024 + rng() % 64 );
+                queries[i].m_y = (short)( 1024 + rng() % 64 );
+                queries[i].m_z = 0;
+        }
+
+        // Old CWorldSearch: walk the list, virtual GetTopPoint() on each.
+        long lOld = 0;
+        auto start = std::chrono::steady_clock::now();
+        for ( int q = 0; q < sm_iQueries; q++ )
+        {
+                for ( TestObjBase * pObj = pHead; pObj != NULL; pObj = pObj->m_pNext )
+                {
+                        if ( GetDist( queries[q], pObj->GetTopPoint()) <= 5 )
+                                lOld += pObj->m_Pad[0] + 1;
+                }
+        }
+        double dOld = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        // New CWorldSearch: filter the packed points, only touch the hits.
+        long lNew = 0;
+        start = std::chrono::steady_clock::now();
+        for ( int q = 0; q < sm_iQueries; q++ )
+        {
+                int i = array.GetCount();
+                while (( i = array.FindPrev( i, queries[q].m_x, queries[q].m_y, 5 )) >= 0 )
+                {
+                        TestObj * pObj = static_cast<TestObj *>( array.GetAt( i ));
+                        lNew += pObj->m_Pad[0] + 1;
+                }
+        }
+        double dNew = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::printf( "  %d objects, %d searches: list %.2f ms, packed %.2f ms\n",
+                sm_iObjs, sm_iQueries, dOld * 1000.0, dNew * 1000.0 );
+        if ( lOld != lNew )
+        {
+                throw std::runtime_error( "Old and new searches found different objects" );
+        }
+}
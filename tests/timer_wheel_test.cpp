@@ -0,0 +1,194 @@
+#include "test_harness.h"
+
+#include "graycom.h"
+#include "ctimerwheel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+        struct TestTimer : public CTimerWheelRec
+        {
+                time_t m_When;          // 0 = not set.
+                int m_iFired;
+        };
+
+        void CheckFired( std::vector<TestTimer> & timers, time_t now, const char * pszWhere )
+        {
+                for ( size_t i = 0; i < timers.size(); i++ )
+                {
+                        TestTimer & timer = timers[i];
+                        if ( timer.m_iFired > 1 )
+                        {
+                                throw std::runtime_error( std::string( "Timer fired more than once " ) + pszWhere );
+                        }
+                        if ( timer.m_When && timer.m_When <= now && ! timer.m_iFired )
+                        {
+                                throw std::runtime_error( std::string( "Timer did not fire on time " ) + pszWhere );
+                        }
+                        if ( timer.m_When && timer.m_When > now && timer.m_iFired )
+                        {
+                                throw std::runtime_error( std::string( "Timer fired early " ) + pszWhere );
+                        }
+                }
+        }
+
+        void Fire( CTimerWheel & wheel, time_t now )
+        {
+                wheel.Advance( now );
+                while ( true )
+                {
+                        TestTimer * pTimer = static_cast<TestTimer *>( wheel.GetExpired());
+                        if ( pTimer == NULL )
+                        {
+                                break;
+                        }
+                        pTimer->m_iFired++;
+                }
+        }
+}
+
+TEST_CASE( TestTimerWheelFiresInOrder )
+{
+        std::mt19937 rng( 3 );
+        std::vector<TestTimer> timers( 4000 );     // outlive the wheel.
+        CTimerWheel wheel;
+
+        time_t now = 1000000;
+        wheel.Advance( now );
+
+        // Near, far and very far timers. (every level of the wheel)
+        for ( size_t i = 0; i < timers.size(); i++ )
+        {
+                static const time_t ranges[] = { 0x100, 0x10000, 0x1000000, 0x200000000LL };
+                timers[i].m_When = now + 1 + ( rng() % ranges[ i % 4 ] );
+                timers[i].m_iFired = 0;
+                wheel.Insert( &timers[i], timers[i].m_When );
+        }
+        if ( wheel.GetCount() != (int) timers.size())
+        {
+                throw std::runtime_error( "Wrong count after insert" );
+        }
+
+        // Some get cancelled or moved.
+        for ( size_t i = 0; i < timers.size(); i += 7 )
+        {
+                if ( i % 2 )
+                {
+                        wheel.Remove( &timers[i] );
+                        timers[i].m_When = 0;
+                }
+                else
+                {
+                        timers[i].m_When = now + 1 + ( rng() % 5000 );
+                        wheel.Insert( &timers[i], timers[i].m_When );
+                }
+        }
+
+        // Small steps through the near ones.
+        for ( int step = 0; step < 70000; step++ )
+        {
+                now += 1 + ( rng() % 3 );
+                Fire( wheel, now );
+                if ( ! ( step % 997 ))
+                {
+                        CheckFired( timers, now, "while stepping" );
+                }
+        }
+        CheckFired( timers, now, "after stepping" );
+
+        // Big jumps (clock changes) still fire everything that is due, once.
+        for ( int jump = 0; jump < 40; jump++ )
+        {
+                now += 1 + ( rng() % 0x20000000 );
+                Fire( wheel, now );
+                CheckFired( timers, now, "after a jump" );
+        }
+}
+
+TEST_CASE( TestTimerWheelLateInsertWaitsForNextAdvance )
+{
+        TestTimer timer;
+        CTimerWheel wheel;
+        timer.m_When = 0;
+        timer.m_iFired = 0;
+
+        wheel.Advance( 500 );
+        wheel.Advance( 501 );
+
+        // Already in the past. Goes off on the next Advance, not this one.
+        wheel.Insert( &timer, 400 );
+        if ( wheel.GetExpired() != NULL )
+        {
+                throw std::runtime_error( "Late timer fired before Advance" );
+        }
+        wheel.Advance( 502 );
+        if ( wheel.GetExpired() != &timer || timer.IsInWheel())
+        {
+                throw std::runtime_error( "Late timer did not fire on the next Advance" );
+        }
+        if ( wheel.GetCount() != 0 )
+        {
+                throw std::runtime_error( "Wheel count is wrong after firing" );
+        }
+}
+
+TEST_CASE( BenchTimerWheel )
+{
+        // Lots of long timers, few firing per tick. The old way looked at all of them every pulse.
+        std::mt19937 rng( 11 );
+        std::vector<TestTimer> timers( 300000 );
+        CTimerWheel wheel;
+
+        time_t now = 1000000;
+        wheel.Advance( now );
+        for ( size_t i = 0; i < timers.size(); i++ )
+        {
+                timers[i].m_When = now + 1 + ( rng() % ( 20 * 60 * 10 ));     // up to 20 minutes.
+                timers[i].m_iFired = 0;
+                wheel.Insert( &timers[i], timers[i].m_When );
+        }
+
+        int iTicks = 60 * 10;
+        int iFired = 0;
+        auto start = std::chrono::steady_clock::now();
+        for ( int i = 0; i < iTicks; i++ )
+        {
+                now++;
+                wheel.Advance( now );
+                while ( TestTimer * pTimer = static_cast<TestTimer *>( wheel.GetExpired()))
+                {
+                        pTimer->m_iFired++;
+                        iFired++;
+                        pTimer->m_When = now + 1 + ( rng() % ( 20 * 60 * 10 ));
+                        wheel.Insert( pTimer, pTimer->m_When );
+                }
+        }
+        double dWheel = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        start = std::chrono::steady_clock::now();
+        int iExpired = 0;
+        for ( int i = 0; i < iTicks; i++ )
+        {
+                for ( size_t j = 0; j < timers.size(); j++ )
+                {
+                        if ( timers[j].m_When <= now - i )
+                        {
+                                iExpired++;
+                        }
+                }
+        }
+        double dScan = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::printf( "  %d timers, %d ticks, %d fired: wheel %.2f ms, full scan %.2f ms (%d)\n",
+                (int) timers.size(), iTicks, iFired, dWheel * 1000.0, dScan * 1000.0, iExpired );
+        if ( wheel.GetCount() != (int) timers.size())
+        {
+                throw std::runtime_error( "Timers were lost" );
+        }
+}